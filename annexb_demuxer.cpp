@@ -1,16 +1,50 @@
 #include "annexb_demuxer.h"
 
+#include <algorithm>
+#include <cctype>
 #include <fstream>
 #include <iostream>
+#include <thread>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ANNEXB_X86 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define ANNEXB_NEON 1
+#endif
+
 AnnexBDemuxer::AnnexBDemuxer(const std::filesystem::path& path)
     : base(nullptr), ptr(nullptr), end(nullptr), mapped(false), mappedSize(0)
 {
     mapped = mapFile(path);
+    if (mapped)
+    {
+        detectCodec(path);
+    }
+}
+
+AnnexBDemuxer::AnnexBDemuxer(const std::filesystem::path& path, const StreamReaderOptions& streamOptions)
+{
+    reader = std::make_unique<StreamReader>(path, streamOptions);
+    streaming = reader->valid();
+    if (!streaming)
+    {
+        reader.reset();
+        return;
+    }
+    // Codec detection needs the first parameter sets; peek by pre-filling the window.
+    window.resize(64 * 1024);
+    window.resize(reader->read(window.data(), window.size()));
+    streamEof = window.empty();
+    base = window.data();
+    end = base + window.size();
+    detectCodec(path);
+    base = end = nullptr;
 }
 
 AnnexBDemuxer::~AnnexBDemuxer()
@@ -60,7 +94,7 @@ bool AnnexBDemuxer::mapFile(const std::filesystem::path& path)
     return true;
 }
 
-const uint8_t* AnnexBDemuxer::findStart(const uint8_t* p, const uint8_t* e)
+const uint8_t* AnnexBDemuxer::findStartScalar(const uint8_t* p, const uint8_t* e)
 {
     while (p + 3 < e)
     {
@@ -73,8 +107,962 @@ const uint8_t* AnnexBDemuxer::findStart(const uint8_t* p, const uint8_t* e)
     return e;
 }
 
+// The vector scanners look for "00 00" pairs a block at a time (zero mask at p AND
+// zero mask at p+1) and only inspect the following byte(s) for candidate positions.
+// Blocks stop early enough that every candidate satisfies the scalar bounds, and the
+// tail is finished by findStartScalar, so all paths return identical positions.
+namespace
+{
+inline bool isStartCodeAt(const uint8_t* q)
+{
+    return q[2] == 1 || (q[2] == 0 && q[3] == 1);
+}
+
+#if defined(ANNEXB_X86)
+const uint8_t* findStartSse2(const uint8_t* p, const uint8_t* e)
+{
+    const __m128i zero = _mm_setzero_si128();
+    while (e - p >= 16 + 4)
+    {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 1));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, zero)) &
+                                              _mm_movemask_epi8(_mm_cmpeq_epi8(b, zero)));
+        while (mask)
+        {
+            const uint8_t* q = p + __builtin_ctz(mask);
+            if (isStartCodeAt(q))
+                return q;
+            mask &= mask - 1;
+        }
+        p += 16;
+    }
+    return AnnexBDemuxer::findStartScalar(p, e);
+}
+
+__attribute__((target("avx2"))) const uint8_t* findStartAvx2(const uint8_t* p, const uint8_t* e)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    while (e - p >= 32 + 4)
+    {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 1));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, zero))) &
+                        static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(b, zero)));
+        while (mask)
+        {
+            const uint8_t* q = p + __builtin_ctz(mask);
+            if (isStartCodeAt(q))
+                return q;
+            mask &= mask - 1;
+        }
+        p += 32;
+    }
+    return findStartSse2(p, e);
+}
+
+using ScanFn = const uint8_t* (*)(const uint8_t*, const uint8_t*);
+ScanFn selectScanner(const char*& name)
+{
+    // Runs during static initialisation, before libgcc has necessarily probed the CPU.
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        name = "avx2";
+        return findStartAvx2;
+    }
+    name = "sse2";
+    return findStartSse2;
+}
+#elif defined(ANNEXB_NEON)
+const uint8_t* findStartNeon(const uint8_t* p, const uint8_t* e)
+{
+    while (e - p >= 16 + 4)
+    {
+        const uint8x16_t a = vld1q_u8(p);
+        const uint8x16_t b = vld1q_u8(p + 1);
+        const uint8x16_t z = vandq_u8(vceqzq_u8(a), vceqzq_u8(b));
+        // Narrow to 4 bits per byte to get a 64-bit movemask equivalent.
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(z), 4)), 0);
+        while (mask)
+        {
+            const int bit = __builtin_ctzll(mask);
+            const uint8_t* q = p + (bit >> 2);
+            if (isStartCodeAt(q))
+                return q;
+            mask &= ~(0xFull << (bit & ~3));
+        }
+        p += 16;
+    }
+    return AnnexBDemuxer::findStartScalar(p, e);
+}
+
+using ScanFn = const uint8_t* (*)(const uint8_t*, const uint8_t*);
+ScanFn selectScanner(const char*& name)
+{
+    name = "neon";
+    return findStartNeon;
+}
+#else
+using ScanFn = const uint8_t* (*)(const uint8_t*, const uint8_t*);
+ScanFn selectScanner(const char*& name)
+{
+    name = "scalar";
+    return AnnexBDemuxer::findStartScalar;
+}
+#endif
+
+const char* gScannerName = nullptr;
+const ScanFn gScanner = selectScanner(gScannerName);
+} // namespace
+
+const uint8_t* AnnexBDemuxer::findStart(const uint8_t* p, const uint8_t* e)
+{
+    return gScanner(p, e);
+}
+
+const char* AnnexBDemuxer::scannerName()
+{
+    return gScannerName;
+}
+
+namespace
+{
+// Reads Exp-Golomb / fixed-width fields from a NAL payload, skipping emulation-prevention
+// bytes (00 00 03 -> 00 00) on the fly so no RBSP copy is needed.
+class RbspReader
+{
+public:
+    RbspReader(const uint8_t* data, size_t size) : p(data), e(data + size) {}
+
+    uint32_t u(uint32_t bits)
+    {
+        uint32_t v = 0;
+        for (uint32_t i = 0; i < bits; ++i)
+        {
+            v = (v << 1) | bit();
+        }
+        return v;
+    }
+
+    uint32_t ue()
+    {
+        uint32_t zeros = 0;
+        while (bit() == 0 && zeros < 32 && !overrun)
+        {
+            ++zeros;
+        }
+        if (zeros >= 32)
+        {
+            overrun = true;
+            return 0;
+        }
+        return ((1u << zeros) - 1) + u(zeros);
+    }
+
+    int32_t se()
+    {
+        const uint32_t k = ue();
+        return (k & 1) ? static_cast<int32_t>((k + 1) / 2) : -static_cast<int32_t>(k / 2);
+    }
+
+    void skip(uint32_t bits)
+    {
+        for (uint32_t i = 0; i < bits; ++i)
+        {
+            bit();
+        }
+    }
+
+    bool ok() const { return !overrun; }
+
+private:
+    uint32_t bit()
+    {
+        if (bitPos == 0)
+        {
+            if (p >= e)
+            {
+                overrun = true;
+                return 0;
+            }
+            if (zeroRun >= 2 && *p == 0x03)
+            {
+                zeroRun = 0;
+                if (++p >= e)
+                {
+                    overrun = true;
+                    return 0;
+                }
+            }
+            zeroRun = (*p == 0) ? zeroRun + 1 : 0;
+        }
+        const uint32_t v = (*p >> (7 - bitPos)) & 1u;
+        if (++bitPos == 8)
+        {
+            bitPos = 0;
+            ++p;
+        }
+        return v;
+    }
+
+    const uint8_t* p;
+    const uint8_t* e;
+    uint32_t bitPos = 0;
+    uint32_t zeroRun = 0;
+    bool overrun = false;
+};
+
+uint32_t ceilLog2(uint32_t v)
+{
+    uint32_t bits = 0;
+    while ((1u << bits) < v)
+    {
+        ++bits;
+    }
+    return bits;
+}
+
+void skipH264ScalingList(RbspReader& r, int size)
+{
+    int lastScale = 8;
+    int nextScale = 8;
+    for (int j = 0; j < size; ++j)
+    {
+        if (nextScale != 0)
+        {
+            nextScale = (lastScale + r.se() + 256) % 256;
+        }
+        lastScale = (nextScale == 0) ? lastScale : nextScale;
+    }
+}
+
+bool parseH264Sps(RbspReader& r, AnnexBSps& sps)
+{
+    const uint32_t profileIdc = r.u(8);
+    r.skip(16); // constraint flags + level_idc
+    sps.id = r.ue();
+    if (profileIdc == 100 || profileIdc == 110 || profileIdc == 122 || profileIdc == 244 || profileIdc == 44 ||
+        profileIdc == 83 || profileIdc == 86 || profileIdc == 118 || profileIdc == 128 || profileIdc == 138 ||
+        profileIdc == 139 || profileIdc == 134 || profileIdc == 135)
+    {
+        sps.chromaFormatIdc = r.ue();
+        if (sps.chromaFormatIdc == 3)
+        {
+            sps.separateColourPlane = r.u(1);
+        }
+        sps.bitDepthLuma = r.ue() + 8;
+        sps.bitDepthChroma = r.ue() + 8;
+        r.skip(1); // qpprime_y_zero_transform_bypass_flag
+        if (r.u(1)) // seq_scaling_matrix_present_flag
+        {
+            const int lists = (sps.chromaFormatIdc != 3) ? 8 : 12;
+            for (int i = 0; i < lists; ++i)
+            {
+                if (r.u(1))
+                {
+                    skipH264ScalingList(r, i < 6 ? 16 : 64);
+                }
+            }
+        }
+    }
+    sps.log2MaxFrameNum = r.ue() + 4;
+    sps.picOrderCntType = r.ue();
+    if (sps.picOrderCntType == 0)
+    {
+        sps.log2MaxPicOrderCntLsb = r.ue() + 4;
+    }
+    else if (sps.picOrderCntType == 1)
+    {
+        r.skip(1);
+        r.se();
+        r.se();
+        const uint32_t cycle = r.ue();
+        for (uint32_t i = 0; i < cycle && r.ok(); ++i)
+        {
+            r.se();
+        }
+    }
+    r.ue();    // max_num_ref_frames
+    r.skip(1); // gaps_in_frame_num_value_allowed_flag
+    const uint32_t widthMbs = r.ue() + 1;
+    const uint32_t heightMapUnits = r.ue() + 1;
+    sps.frameMbsOnly = r.u(1);
+    if (!sps.frameMbsOnly)
+    {
+        r.skip(1); // mb_adaptive_frame_field_flag
+    }
+    r.skip(1); // direct_8x8_inference_flag
+    sps.width = widthMbs * 16;
+    sps.height = heightMapUnits * 16 * (sps.frameMbsOnly ? 1 : 2);
+    if (r.u(1)) // frame_cropping_flag
+    {
+        const uint32_t cropX = (sps.chromaFormatIdc == 1 || sps.chromaFormatIdc == 2) ? 2 : 1;
+        const uint32_t cropY = ((sps.chromaFormatIdc == 1) ? 2 : 1) * (sps.frameMbsOnly ? 1 : 2);
+        const uint32_t left = r.ue(), right = r.ue(), top = r.ue(), bottom = r.ue();
+        sps.width -= (left + right) * cropX;
+        sps.height -= (top + bottom) * cropY;
+    }
+    return r.ok();
+}
+
+void skipH265ProfileTierLevel(RbspReader& r, uint32_t maxSubLayersMinus1)
+{
+    r.skip(88); // general profile space/tier/idc, compatibility flags, constraint flags
+    r.skip(8);  // general_level_idc
+    std::array<bool, 8> profilePresent{};
+    std::array<bool, 8> levelPresent{};
+    for (uint32_t i = 0; i < maxSubLayersMinus1; ++i)
+    {
+        profilePresent[i] = r.u(1);
+        levelPresent[i] = r.u(1);
+    }
+    if (maxSubLayersMinus1 > 0)
+    {
+        r.skip(2 * (8 - maxSubLayersMinus1));
+    }
+    for (uint32_t i = 0; i < maxSubLayersMinus1; ++i)
+    {
+        if (profilePresent[i]) r.skip(88);
+        if (levelPresent[i]) r.skip(8);
+    }
+}
+
+bool parseH265Sps(RbspReader& r, AnnexBSps& sps)
+{
+    r.skip(4); // sps_video_parameter_set_id
+    const uint32_t maxSubLayersMinus1 = r.u(3);
+    r.skip(1); // sps_temporal_id_nesting_flag
+    skipH265ProfileTierLevel(r, maxSubLayersMinus1);
+    sps.id = r.ue();
+    sps.chromaFormatIdc = r.ue();
+    if (sps.chromaFormatIdc == 3)
+    {
+        sps.separateColourPlane = r.u(1);
+    }
+    const uint32_t codedWidth = r.ue();
+    const uint32_t codedHeight = r.ue();
+    sps.width = codedWidth;
+    sps.height = codedHeight;
+    if (r.u(1)) // conformance_window_flag
+    {
+        const uint32_t subW = (sps.chromaFormatIdc == 1 || sps.chromaFormatIdc == 2) ? 2 : 1;
+        const uint32_t subH = (sps.chromaFormatIdc == 1) ? 2 : 1;
+        const uint32_t left = r.ue(), right = r.ue(), top = r.ue(), bottom = r.ue();
+        sps.width -= (left + right) * subW;
+        sps.height -= (top + bottom) * subH;
+    }
+    sps.bitDepthLuma = r.ue() + 8;
+    sps.bitDepthChroma = r.ue() + 8;
+    sps.log2MaxPicOrderCntLsb = r.ue() + 4;
+    const bool subLayerOrderingInfo = r.u(1);
+    for (uint32_t i = subLayerOrderingInfo ? 0 : maxSubLayersMinus1; i <= maxSubLayersMinus1; ++i)
+    {
+        r.ue();
+        r.ue();
+        r.ue();
+    }
+    const uint32_t log2MinCb = r.ue() + 3;
+    const uint32_t log2Ctb = log2MinCb + r.ue();
+    const uint32_t ctb = 1u << std::min<uint32_t>(log2Ctb, 16);
+    sps.picSizeInCtbs = ((codedWidth + ctb - 1) / ctb) * ((codedHeight + ctb - 1) / ctb);
+    return r.ok();
+}
+} // namespace
+
+bool AnnexBDemuxer::isVclType(AnnexBCodec codec, uint8_t type)
+{
+    return codec == AnnexBCodec::H265 ? type < 32 : (type >= 1 && type <= 5);
+}
+
+bool AnnexBDemuxer::isParameterSetType(AnnexBCodec codec, uint8_t type)
+{
+    return codec == AnnexBCodec::H265 ? (type >= 32 && type <= 34) : (type == 7 || type == 8);
+}
+
+namespace
+{
+// Whether a NAL header is well-formed for the codec: forbidden_zero_bit clear and a type the
+// spec assigns. H.265 also needs nuh_layer_id 0 and nuh_temporal_id_plus1 != 0; H.264
+// parameter sets need a nonzero nal_ref_idc.
+bool plausibleHeader(AnnexBCodec codec, const uint8_t* nal)
+{
+    if (nal[0] & 0x80)
+    {
+        return false;
+    }
+    if (codec == AnnexBCodec::H265)
+    {
+        const uint8_t type = (nal[0] >> 1) & 0x3F;
+        const bool reserved = (type >= 10 && type <= 15) || (type >= 22 && type <= 31) || type >= 41;
+        return !reserved && (nal[0] & 0x01) == 0 && (nal[1] & 0xF8) == 0 && (nal[1] & 0x07) != 0;
+    }
+    const uint8_t type = nal[0] & 0x1F;
+    if (type == 0 || type >= 22)
+    {
+        return false;
+    }
+    return (type != 7 && type != 8) || (nal[0] & 0x60) != 0;
+}
+
+// Progress through the parameter sets a stream must open with: VPS, SPS, PPS for H.265,
+// SPS, PPS for H.264 (repeats allowed), then the first slice. A slice before the sequence
+// is complete, or any malformed header, rules the codec out.
+struct CodecEvidence
+{
+    AnnexBCodec codec;
+    int stage = 0;
+    bool ruledOut = false;
+
+    void feed(const uint8_t* nal)
+    {
+        if (ruledOut)
+        {
+            return;
+        }
+        if (!plausibleHeader(codec, nal))
+        {
+            ruledOut = true;
+            return;
+        }
+        const bool h265 = codec == AnnexBCodec::H265;
+        const uint8_t type = h265 ? (nal[0] >> 1) & 0x3F : nal[0] & 0x1F;
+        const int setCount = h265 ? 3 : 2;
+        const int setIndex = AnnexBDemuxer::isParameterSetType(codec, type) ? type - (h265 ? 32 : 7) : -1;
+        if (setIndex >= 0)
+        {
+            // Each set may follow its predecessor; later sets may come back at any time.
+            if (setIndex > stage)
+            {
+                ruledOut = true;
+            }
+            else if (setIndex == stage && stage < setCount)
+            {
+                ++stage;
+            }
+            return;
+        }
+        if (AnnexBDemuxer::isVclType(codec, type) && stage < setCount)
+        {
+            ruledOut = true;
+        }
+    }
+
+    bool confirmed() const { return !ruledOut && stage == (codec == AnnexBCodec::H265 ? 3 : 2); }
+};
+} // namespace
+
+void AnnexBDemuxer::detectCodec(const std::filesystem::path& path)
+{
+    // A single NAL header is ambiguous (an H.265 TSA_R header reads as an H.264 SPS), so
+    // both readings are checked against the first NAL units: every header must be
+    // well-formed and the parameter sets must arrive in order before the first slice.
+    CodecEvidence h264{AnnexBCodec::H264};
+    CodecEvidence h265{AnnexBCodec::H265};
+    const uint8_t* firstNal = nullptr;
+    const uint8_t* start = findStart(base, end);
+    for (int n = 0; n < 64 && start != end; ++n)
+    {
+        const uint8_t* nal = start + 3 + (start[2] == 0);
+        if (nal + 1 >= end)
+        {
+            break;
+        }
+        if (!firstNal)
+        {
+            firstNal = nal;
+        }
+        h264.feed(nal);
+        h265.feed(nal);
+        if ((h264.confirmed() || h264.ruledOut) && (h265.confirmed() || h265.ruledOut))
+        {
+            break;
+        }
+        start = findStart(nal, end);
+    }
+    if (h264.confirmed() != h265.confirmed())
+    {
+        streamCodec = h265.confirmed() ? AnnexBCodec::H265 : AnnexBCodec::H264;
+    }
+    const char* how = "parameter sets";
+    if (streamCodec == AnnexBCodec::Unknown)
+    {
+        std::string ext = path.extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+        if (ext == ".h265" || ext == ".265" || ext == ".hevc")
+            streamCodec = AnnexBCodec::H265;
+        else if (ext == ".h264" || ext == ".264" || ext == ".avc")
+            streamCodec = AnnexBCodec::H264;
+        if (streamCodec != AnnexBCodec::Unknown)
+            how = "file extension";
+    }
+    if (streamCodec == AnnexBCodec::Unknown && firstNal)
+    {
+        // Legacy guess for streams without parameter sets or a telling extension. It is made
+        // once, so indexing, parameter sets and slice headers all read the same syntax.
+        streamCodec = ((firstNal[0] & 0x7E) == 0) ? AnnexBCodec::H264 : AnnexBCodec::H265;
+        how = "guessed from the first NAL header";
+    }
+    std::cout << "[Demux] Detected codec: "
+              << (streamCodec == AnnexBCodec::H265 ? "H.265" : streamCodec == AnnexBCodec::H264 ? "H.264" : "unknown")
+              << " (" << how << ")\n";
+}
+
+void AnnexBDemuxer::classifyNal(const uint8_t* nal, size_t size, AnnexBNalEntry& entry) const
+{
+    const uint8_t header = nal[0];
+    const AnnexBCodec codec = syntaxCodec();
+    if (codec == AnnexBCodec::H264)
+    {
+        entry.type = header & 0x1F;
+        entry.isIdr = (entry.type == 5);
+        // first_mb_in_slice == 0 is ue(v) "1": the first payload bit is set.
+        entry.firstSliceInPic = (isVclType(codec, entry.type) && size > 1) ? (nal[1] >> 7) : 0;
+    }
+    else
+    {
+        entry.type = (header >> 1) & 0x3F;
+        entry.isIdr = (entry.type >= 16 && entry.type <= 21);
+        entry.firstSliceInPic = (isVclType(codec, entry.type) && size > 2) ? (nal[2] >> 7) : 0;
+    }
+}
+
+void AnnexBDemuxer::indexRange(const uint8_t* chunkBegin, const uint8_t* chunkEnd, std::vector<AnnexBNalEntry>& out) const
+{
+    const uint8_t* start = findStart(chunkBegin, end);
+    // A 4-byte start code straddling the chunk boundary belongs to the previous chunk,
+    // which finds it one byte earlier.
+    if (start == chunkBegin && start > base && start[-1] == 0 && start[2] == 1)
+    {
+        start = findStart(start + 3, end);
+    }
+    while (start < chunkEnd)
+    {
+        const uint8_t* nalStart = start + 3 + (start[2] == 0);
+        const uint8_t* next = findStart(nalStart, end);
+        AnnexBNalEntry entry{};
+        entry.offset = static_cast<uint64_t>(nalStart - base);
+        entry.size = static_cast<uint32_t>(next - nalStart);
+        entry.startCodeSize = static_cast<uint8_t>(nalStart - start);
+        if (entry.size > 0)
+        {
+            classifyNal(nalStart, entry.size, entry);
+        }
+        out.push_back(entry);
+        start = next;
+    }
+}
+
+bool AnnexBDemuxer::buildIndex(unsigned threadCount)
+{
+    if (!mapped)
+    {
+        if (streaming)
+        {
+            std::cerr << "[Demux] Indexing needs a mapped file; not available in streaming mode.\n";
+        }
+        return false;
+    }
+    if (threadCount == 0)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // Small files are not worth the thread start-up.
+    constexpr size_t kMinChunk = 8u << 20;
+    threadCount = static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(threadCount, mappedSize / kMinChunk)));
+
+    std::vector<std::vector<AnnexBNalEntry>> chunks(threadCount);
+    const size_t chunkSize = (mappedSize + threadCount - 1) / threadCount;
+    auto work = [&](unsigned i) {
+        const uint8_t* chunkBegin = base + std::min(mappedSize, i * chunkSize);
+        const uint8_t* chunkEnd = base + std::min(mappedSize, (i + 1) * chunkSize);
+        // Typical streams average well above 1 KiB per NAL; avoid regrowth on large files.
+        chunks[i].reserve(chunkSize / 4096 + 16);
+        indexRange(chunkBegin, chunkEnd, chunks[i]);
+    };
+    if (threadCount == 1)
+    {
+        work(0);
+    }
+    else
+    {
+        std::vector<std::thread> threads;
+        for (unsigned i = 0; i < threadCount; ++i)
+        {
+            threads.emplace_back(work, i);
+        }
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+    }
+
+    size_t total = 0;
+    for (const auto& c : chunks)
+    {
+        total += c.size();
+    }
+    nalIndex.clear();
+    nalIndex.reserve(total);
+    for (const auto& c : chunks)
+    {
+        nalIndex.insert(nalIndex.end(), c.begin(), c.end());
+    }
+    indexed = true;
+    indexCursor = static_cast<size_t>(std::lower_bound(nalIndex.begin(), nalIndex.end(), static_cast<uint64_t>(ptr - base),
+                                                       [](const AnnexBNalEntry& n, uint64_t off) { return n.offset < off; }) -
+                                      nalIndex.begin());
+    std::cout << "[Demux] Indexed " << nalIndex.size() << " NAL units (" << scannerName() << " scanner, "
+              << threadCount << " threads).\n";
+    return true;
+}
+
+void AnnexBDemuxer::parseParameterSet(const AnnexBNalEntry& entry)
+{
+    const AnnexBCodec codec = syntaxCodec();
+    const uint8_t* nal = base + entry.offset;
+    const size_t headerBytes = (codec == AnnexBCodec::H265) ? 2 : 1;
+    if (entry.size <= headerBytes)
+    {
+        return;
+    }
+    RbspReader r(nal + headerBytes, entry.size - headerBytes);
+    std::vector<uint8_t> raw(nal, nal + entry.size);
+    if (codec == AnnexBCodec::H265 && entry.type == 32)
+    {
+        vpsCache[r.u(4)] = std::move(raw);
+        return;
+    }
+    const bool isSps = (codec == AnnexBCodec::H265) ? entry.type == 33 : entry.type == 7;
+    if (isSps)
+    {
+        AnnexBSps parsed{};
+        const bool ok = (codec == AnnexBCodec::H265) ? parseH265Sps(r, parsed) : parseH264Sps(r, parsed);
+        if (ok && parsed.id < spsCache.size())
+        {
+            parsed.valid = true;
+            parsed.raw = std::move(raw);
+            spsCache[parsed.id] = std::move(parsed);
+        }
+        return;
+    }
+    AnnexBPps parsed{};
+    parsed.id = r.ue();
+    parsed.spsId = r.ue();
+    if (codec == AnnexBCodec::H265)
+    {
+        parsed.dependentSliceSegmentsEnabled = r.u(1);
+        parsed.outputFlagPresent = r.u(1);
+        parsed.numExtraSliceHeaderBits = r.u(3);
+    }
+    if (r.ok() && parsed.id < ppsCache.size())
+    {
+        parsed.valid = true;
+        parsed.raw = std::move(raw);
+        ppsCache[parsed.id] = std::move(parsed);
+    }
+}
+
+bool AnnexBDemuxer::parseSliceHeader(const AnnexBNalEntry& entry, AnnexBAccessUnit& au) const
+{
+    const AnnexBCodec codec = syntaxCodec();
+    const uint8_t* nal = base + entry.offset;
+    const size_t headerBytes = (codec == AnnexBCodec::H265) ? 2 : 1;
+    if (entry.size <= headerBytes)
+    {
+        return false;
+    }
+    RbspReader r(nal + headerBytes, entry.size - headerBytes);
+    if (codec == AnnexBCodec::H265)
+    {
+        const bool firstSlice = r.u(1);
+        if (entry.type >= 16 && entry.type <= 23)
+        {
+            r.skip(1); // no_output_of_prior_pics_flag
+        }
+        au.ppsId = r.ue();
+        const AnnexBPps* p = pps(au.ppsId);
+        const AnnexBSps* s = p ? sps(p->spsId) : nullptr;
+        if (!p || !s)
+        {
+            return false;
+        }
+        au.spsId = s->id;
+        bool dependent = false;
+        if (!firstSlice)
+        {
+            if (p->dependentSliceSegmentsEnabled)
+            {
+                dependent = r.u(1);
+            }
+            r.skip(ceilLog2(s->picSizeInCtbs));
+        }
+        if (!dependent)
+        {
+            r.skip(p->numExtraSliceHeaderBits);
+            au.sliceType = r.ue();
+            if (p->outputFlagPresent)
+            {
+                r.skip(1);
+            }
+            if (s->separateColourPlane)
+            {
+                r.skip(2);
+            }
+            if (entry.type != 19 && entry.type != 20) // not IDR_W_RADL / IDR_N_LP
+            {
+                au.picOrderCntLsb = r.u(s->log2MaxPicOrderCntLsb);
+            }
+        }
+        return r.ok();
+    }
+
+    r.ue(); // first_mb_in_slice
+    au.sliceType = r.ue();
+    au.ppsId = r.ue();
+    const AnnexBPps* p = pps(au.ppsId);
+    const AnnexBSps* s = p ? sps(p->spsId) : nullptr;
+    if (!p || !s)
+    {
+        return false;
+    }
+    au.spsId = s->id;
+    if (s->separateColourPlane)
+    {
+        r.skip(2);
+    }
+    au.frameNum = r.u(s->log2MaxFrameNum);
+    if (!s->frameMbsOnly && r.u(1)) // field_pic_flag
+    {
+        r.skip(1); // bottom_field_flag
+    }
+    if (entry.type == 5)
+    {
+        r.ue(); // idr_pic_id
+    }
+    if (s->picOrderCntType == 0)
+    {
+        au.picOrderCntLsb = r.u(s->log2MaxPicOrderCntLsb);
+    }
+    return r.ok();
+}
+
+bool AnnexBDemuxer::buildAccessUnits()
+{
+    if (!indexed)
+    {
+        return false;
+    }
+    units.clear();
+    unitCursor = 0;
+    const AnnexBCodec codec = syntaxCodec();
+
+    // AU boundaries follow the spec's "first of" rules, simplified: a new AU starts at an
+    // AUD, at parameter sets / prefix SEI after the current AU already has a picture, and
+    // at the first slice of a new picture.
+    AnnexBAccessUnit current{};
+    bool open = false;
+    bool hasVcl = false;
+    auto closeUnit = [&](size_t nextNal) {
+        if (!open)
+        {
+            return;
+        }
+        const AnnexBNalEntry& first = nalIndex[current.firstNal];
+        const AnnexBNalEntry& last = nalIndex[nextNal - 1];
+        current.nalCount = static_cast<uint32_t>(nextNal - current.firstNal);
+        current.offset = first.offset - first.startCodeSize;
+        current.size = last.offset + last.size - current.offset;
+        units.push_back(current);
+        open = false;
+        hasVcl = false;
+    };
+
+    for (size_t i = 0; i < nalIndex.size(); ++i)
+    {
+        const AnnexBNalEntry& entry = nalIndex[i];
+        const bool vcl = isVclType(codec, entry.type);
+        bool startsUnit = false;
+        if (vcl)
+        {
+            startsUnit = hasVcl && entry.firstSliceInPic;
+        }
+        else if (codec == AnnexBCodec::H265)
+        {
+            // AUD(35), VPS/SPS/PPS(32-34), prefix SEI(39), reserved 41..44, 48..55
+            startsUnit = entry.type == 35 ||
+                         (hasVcl && ((entry.type >= 32 && entry.type <= 34) || entry.type == 39 ||
+                                     (entry.type >= 41 && entry.type <= 44) || (entry.type >= 48 && entry.type <= 55)));
+        }
+        else
+        {
+            // AUD(9), SEI(6), SPS(7), PPS(8), 14..18
+            startsUnit = entry.type == 9 ||
+                         (hasVcl && (entry.type == 6 || entry.type == 7 || entry.type == 8 ||
+                                     (entry.type >= 14 && entry.type <= 18)));
+        }
+        if (startsUnit)
+        {
+            closeUnit(i);
+        }
+        if (!open)
+        {
+            current = AnnexBAccessUnit{};
+            current.firstNal = i;
+            open = true;
+        }
+
+        if (isParameterSetType(codec, entry.type))
+        {
+            parseParameterSet(entry);
+        }
+        else if (vcl && !hasVcl)
+        {
+            current.isIdr = entry.isIdr != 0;
+            parseSliceHeader(entry, current);
+            hasVcl = true;
+        }
+    }
+    closeUnit(nalIndex.size());
+    unitsBuilt = true;
+    std::cout << "[Demux] Assembled " << units.size() << " access units.\n";
+    return true;
+}
+
+const AnnexBSps* AnnexBDemuxer::sps(uint32_t id) const
+{
+    return (id < spsCache.size() && spsCache[id].valid) ? &spsCache[id] : nullptr;
+}
+
+const AnnexBPps* AnnexBDemuxer::pps(uint32_t id) const
+{
+    return (id < ppsCache.size() && ppsCache[id].valid) ? &ppsCache[id] : nullptr;
+}
+
+bool AnnexBDemuxer::nextAccessUnit(AnnexBAccessUnit& au)
+{
+    if (!unitsBuilt)
+    {
+        if ((!indexed && !buildIndex()) || !buildAccessUnits())
+        {
+            return false;
+        }
+    }
+    if (unitCursor >= units.size())
+    {
+        return false;
+    }
+    au = units[unitCursor++];
+    seekToNal(au.firstNal + au.nalCount);
+    return true;
+}
+
+bool AnnexBDemuxer::seekToAccessUnit(size_t i)
+{
+    if (!unitsBuilt || i > units.size())
+    {
+        return false;
+    }
+    unitCursor = i;
+    return seekToNal(i < units.size() ? units[i].firstNal : nalIndex.size());
+}
+
+bool AnnexBDemuxer::nalAt(size_t i, const uint8_t*& data, size_t& size, bool& isIdr) const
+{
+    if (!indexed || i >= nalIndex.size())
+    {
+        size = 0;
+        return false;
+    }
+    const AnnexBNalEntry& entry = nalIndex[i];
+    data = base + entry.offset;
+    size = entry.size;
+    isIdr = entry.isIdr != 0;
+    return true;
+}
+
+bool AnnexBDemuxer::seekToNal(size_t i)
+{
+    if (!indexed || i > nalIndex.size())
+    {
+        return false;
+    }
+    indexCursor = i;
+    ptr = (i < nalIndex.size()) ? base + nalIndex[i].offset : end;
+    return true;
+}
+
+// Returns the window offset of the next start code at or after `from`, reading more
+// input as needed; window.size() at end of stream. Positions within 5 bytes of the old
+// window end are rescanned after a refill, so matches are identical to a whole-file scan.
+size_t AnnexBDemuxer::findStartStreaming(size_t from)
+{
+    size_t searchFrom = from;
+    while (true)
+    {
+        const uint8_t* w = window.data();
+        const uint8_t* hit = findStart(w + searchFrom, w + window.size());
+        if (hit != w + window.size() || streamEof)
+        {
+            return static_cast<size_t>(hit - w);
+        }
+        const size_t oldSize = window.size();
+        const size_t chunk = reader->options().chunkSize;
+        window.resize(oldSize + chunk);
+        const size_t got = reader->read(window.data() + oldSize, chunk);
+        window.resize(oldSize + got);
+        streamEof = (got == 0);
+        searchFrom = std::max(from, oldSize > 5 ? oldSize - 5 : size_t{0});
+    }
+}
+
+bool AnnexBDemuxer::nextNaluStreaming(const uint8_t*& data, size_t& size, bool& isIdr)
+{
+    // Drop consumed bytes once they outweigh a read chunk so the window stays bounded.
+    if (windowPos > reader->options().chunkSize)
+    {
+        window.erase(window.begin(), window.begin() + static_cast<std::ptrdiff_t>(windowPos));
+        windowPos = 0;
+    }
+    const size_t start = findStartStreaming(windowPos);
+    if (start >= window.size())
+    {
+        windowPos = window.size();
+        size = 0;
+        return false;
+    }
+    const size_t nalStart = start + 3 + (window[start + 2] == 0);
+    const size_t next = findStartStreaming(nalStart);
+    data = window.data() + nalStart;
+    size = next - nalStart;
+    windowPos = next;
+
+    AnnexBNalEntry entry{};
+    if (size > 0)
+    {
+        classifyNal(data, size, entry);
+    }
+    isIdr = entry.isIdr != 0;
+    return true;
+}
+
 bool AnnexBDemuxer::nextNalu(const uint8_t*& data, size_t& size, bool& isIdr)
 {
+    if (streaming)
+    {
+        return nextNaluStreaming(data, size, isIdr);
+    }
+    if (indexed)
+    {
+        if (!nalAt(indexCursor, data, size, isIdr))
+        {
+            ptr = end;
+            return false;
+        }
+        ++indexCursor;
+        ptr = data + size;
+        return true;
+    }
     if (!mapped || ptr >= end)
     {
         size = 0;
@@ -92,23 +1080,24 @@ bool AnnexBDemuxer::nextNalu(const uint8_t*& data, size_t& size, bool& isIdr)
     size = static_cast<size_t>(next - nalStart);
     ptr = next;
 
-    // H.264: NAL type in lower 5 bits; H.265: lower 6 bits >>1
-    uint8_t header = nalStart[0];
-    uint8_t nalType = (header & 0x1F);
-    if ((header & 0x7E) == 0) // likely H.264, leave nalType as-is
-    {
-        isIdr = (nalType == 5);
-    }
-    else
+    AnnexBNalEntry entry{};
+    if (size > 0)
     {
-        // H.265
-        nalType = (header >> 1) & 0x3F;
-        isIdr = (nalType >= 16 && nalType <= 21);
+        classifyNal(nalStart, size, entry);
     }
+    isIdr = entry.isIdr != 0;
     return true;
 }
 
 void AnnexBDemuxer::rewind()
 {
+    if (streaming && reader->seek(0, SEEK_SET) == 0)
+    {
+        window.clear();
+        windowPos = 0;
+        streamEof = false;
+    }
     ptr = base;
+    indexCursor = 0;
+    unitCursor = 0;
 }
@@ -1,27 +1,151 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <filesystem>
+#include <memory>
 #include <vector>
 #include <string>
 
+#include "stream_reader.h"
+
+enum class AnnexBCodec : uint8_t
+{
+    Unknown,
+    H264,
+    H265,
+};
+
+// One entry per NAL unit in the optional one-pass index (16 bytes).
+struct AnnexBNalEntry
+{
+    uint64_t offset = 0; // payload offset from start of file (after the start code)
+    uint32_t size = 0;   // payload size in bytes
+    uint8_t type = 0;    // codec NAL unit type
+    uint8_t isIdr = 0;
+    uint8_t startCodeSize = 0; // 3 or 4
+    uint8_t firstSliceInPic = 0; // VCL only: first_mb_in_slice == 0 / first_slice_segment_in_pic_flag
+};
+
+// Parsed subset of an SPS that slice-header parsing and AU assembly need.
+struct AnnexBSps
+{
+    bool valid = false;
+    uint32_t id = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t chromaFormatIdc = 1;
+    uint32_t bitDepthLuma = 8;
+    uint32_t bitDepthChroma = 8;
+    bool separateColourPlane = false;
+    // H.264
+    uint32_t log2MaxFrameNum = 4;
+    uint32_t picOrderCntType = 0;
+    bool frameMbsOnly = true;
+    // H.264 (poc type 0) and H.265
+    uint32_t log2MaxPicOrderCntLsb = 4;
+    // H.265
+    uint32_t picSizeInCtbs = 0;
+    std::vector<uint8_t> raw; // NAL bytes including header, as found in the stream
+};
+
+struct AnnexBPps
+{
+    bool valid = false;
+    uint32_t id = 0;
+    uint32_t spsId = 0;
+    // H.265
+    bool dependentSliceSegmentsEnabled = false;
+    bool outputFlagPresent = false;
+    uint32_t numExtraSliceHeaderBits = 0;
+    std::vector<uint8_t> raw;
+};
+
+// A complete coded picture: parameter sets / SEI / AUD plus all of its slices.
+// [offset, offset + size) is a self-contained Annex-B byte range (start codes included).
+struct AnnexBAccessUnit
+{
+    size_t firstNal = 0;
+    uint32_t nalCount = 0;
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    bool isIdr = false;      // random access point (IDR, and CRA/BLA for H.265)
+    uint32_t frameNum = 0;   // H.264 frame_num
+    uint32_t picOrderCntLsb = 0;
+    uint32_t sliceType = 0;
+    uint32_t ppsId = 0;
+    uint32_t spsId = 0;
+};
+
 // Minimal Annex-B elementary stream reader (H.264/H.265).
 // No container parsing; expects raw .h264/.h265 streams.
+// Files are mmap'd by default; the streaming constructor reads through a StreamReader
+// instead (pipes, stdin, growing files). Streaming supports nextNalu only: the index,
+// access units and random access need the whole file mapped.
 class AnnexBDemuxer
 {
 public:
     explicit AnnexBDemuxer(const std::filesystem::path& path);
+    AnnexBDemuxer(const std::filesystem::path& path, const StreamReaderOptions& streamOptions);
     ~AnnexBDemuxer();
-    bool valid() const { return mapped; }
+    bool valid() const { return mapped || streaming; }
+    bool isStreaming() const { return streaming; }
+    AnnexBCodec codec() const { return streamCodec; }
 
     // Returns next NALU range [data,data+size). size==0 on EOF.
+    // O(1) once buildIndex() has run. In streaming mode the range stays valid until the next call.
     bool nextNalu(const uint8_t*& data, size_t& size, bool& isIdr);
 
+    // Returns the next complete access unit; builds the index and AU table on first use.
+    bool nextAccessUnit(AnnexBAccessUnit& au);
+    const uint8_t* accessUnitData(const AnnexBAccessUnit& au) const { return base + au.offset; }
+
     void rewind();
 
+    // Scans the whole file once and records every NAL offset/size/type. The file is split
+    // into one chunk per thread (0 = hardware concurrency); results match a serial scan.
+    bool buildIndex(unsigned threadCount = 0);
+    bool hasIndex() const { return indexed; }
+    size_t nalCount() const { return nalIndex.size(); }
+    const std::vector<AnnexBNalEntry>& index() const { return nalIndex; }
+
+    // Groups indexed NALs into access units, parsing parameter sets and the first slice
+    // header of every picture. Requires buildIndex().
+    bool buildAccessUnits();
+    const std::vector<AnnexBAccessUnit>& accessUnits() const { return units; }
+
+    // Random access (requires buildIndex()).
+    bool nalAt(size_t i, const uint8_t*& data, size_t& size, bool& isIdr) const;
+    bool seekToNal(size_t i);
+    bool seekToAccessUnit(size_t i);
+
+    // Parameter set cache, filled while building access units.
+    const AnnexBSps* sps(uint32_t id) const;
+    const AnnexBPps* pps(uint32_t id) const;
+    const std::vector<uint8_t>& vps(uint32_t id) const { return vpsCache[id & 15]; }
+
+    static bool isVclType(AnnexBCodec codec, uint8_t type);
+    static bool isParameterSetType(AnnexBCodec codec, uint8_t type);
+
+    // Start-code scanners; findStart picks the widest SIMD path available at runtime.
+    static const uint8_t* findStart(const uint8_t* p, const uint8_t* end);
+    static const uint8_t* findStartScalar(const uint8_t* p, const uint8_t* end);
+    static const char* scannerName();
+
+    const uint8_t* data() const { return base; }
+    size_t size() const { return mappedSize; }
+
 private:
     bool mapFile(const std::filesystem::path& path);
-    const uint8_t* findStart(const uint8_t* p, const uint8_t* end);
+    void detectCodec(const std::filesystem::path& path);
+    // The codec whose NAL syntax every parser uses; H.265 only for an empty stream.
+    AnnexBCodec syntaxCodec() const { return streamCodec == AnnexBCodec::Unknown ? AnnexBCodec::H265 : streamCodec; }
+    bool nextNaluStreaming(const uint8_t*& data, size_t& size, bool& isIdr);
+    size_t findStartStreaming(size_t from);
+    void classifyNal(const uint8_t* nal, size_t size, AnnexBNalEntry& entry) const;
+    void indexRange(const uint8_t* chunkBegin, const uint8_t* chunkEnd, std::vector<AnnexBNalEntry>& out) const;
+    void parseParameterSet(const AnnexBNalEntry& entry);
+    bool parseSliceHeader(const AnnexBNalEntry& entry, AnnexBAccessUnit& au) const;
 
     std::vector<uint8_t> buffer; // unused if mmap
     const uint8_t* base = nullptr; // start of mmap region
@@ -29,4 +153,24 @@ private:
     const uint8_t* end = nullptr;
     bool mapped = false;
     size_t mappedSize = 0;
+    AnnexBCodec streamCodec = AnnexBCodec::Unknown;
+
+    // Streaming mode: a sliding window over the reader; windowPos is the next unread byte.
+    std::unique_ptr<StreamReader> reader;
+    std::vector<uint8_t> window;
+    size_t windowPos = 0;
+    bool streaming = false;
+    bool streamEof = false;
+
+    std::vector<AnnexBNalEntry> nalIndex;
+    size_t indexCursor = 0;
+    bool indexed = false;
+
+    std::vector<AnnexBAccessUnit> units;
+    size_t unitCursor = 0;
+    bool unitsBuilt = false;
+
+    std::array<AnnexBSps, 32> spsCache{};
+    std::array<AnnexBPps, 256> ppsCache{};
+    std::array<std::vector<uint8_t>, 16> vpsCache{};
 };
@@ -26,8 +26,8 @@ manifest_path = os.path.join(this_dir, ".build_manifest.json")
 ffmpeg_install_dir = os.path.abspath(os.path.join(this_dir, "FFmpeg/.build/install"))
 
 # Source and object files
-main_sources = ["motive2d.cpp"]
-exclude_sources = ["vulkan_video_bridge.cpp", "encode.cpp", "decoder_cpu.cpp", "font.cpp", "fps.cpp", "subtitle.cpp"]  # missing Vulkan-Video-Samples libraries
+main_sources = ["motive2d.cpp", "video_editor_orchestrator.cpp", "annexb_bench.cpp", "font_bench.cpp", "widgets_bench.cpp", "lut_bench.cpp", "precision_bench.cpp", "scopes_bench.cpp", "yuv_convert_check.cpp", "frame_cache_check.cpp", "nv12_bench.cpp", "mosaic_bench.cpp", "speed_bench.cpp", "thumbnail_bench.cpp", "encode.cpp"]
+exclude_sources = ["vulkan_video_bridge.cpp", "decoder_cpu.cpp", "fps.cpp"]  # missing Vulkan-Video-Samples libraries
 so_sources = []
 for file in os.listdir(this_dir):
     if file.endswith(".cpp") and file not in main_sources and file not in exclude_sources:
@@ -244,7 +244,8 @@ for shaderFilename in os.listdir(shader_dir):
         dst_mtime = os.path.getmtime(dst) if os.path.exists(dst) else -1
         if src_mtime <= dst_mtime:
             continue
-    cmd = f"glslangValidator -V {src} -o {dst}"
+    # SPIR-V 1.3 for the subgroup operations in scopes_accumulate; no newer than the device needs
+    cmd = f"glslangValidator -V --target-env vulkan1.1 {src} -o {dst}"
     print(f"Running: {cmd}")
     result = subprocess.run(cmd, shell=True)
     if result.returncode != 0:
@@ -4,11 +4,14 @@
 
 #include "color_grading_pass.h"
 
+#include "cube_lut.h"
 #include "engine2d.h"
 #include "utils.h"
 #include "debug_logging.h"
 
+#include <algorithm>
 #include <array>
+#include <cmath>
 #include <cstring>
 #include <iostream>
 #include <stdexcept>
@@ -33,6 +36,38 @@ static const std::array<float, kCurveLutSize>& identityCurveLut()
 
 namespace
 {
+// IEEE half, round to nearest even; LUT values are finite and well inside the half range.
+static uint16_t floatToHalf(float value)
+{
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+    const int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xffu) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffffu;
+
+    if (exponent <= 0)
+    {
+        if (exponent < -10)
+            return sign;
+        mantissa |= 0x800000u;
+        const uint32_t shift = static_cast<uint32_t>(14 - exponent);
+        uint32_t half = mantissa >> shift;
+        const uint32_t rest = mantissa & ((1u << shift) - 1u);
+        const uint32_t midpoint = 1u << (shift - 1);
+        if (rest > midpoint || (rest == midpoint && (half & 1u)))
+            ++half;
+        return static_cast<uint16_t>(sign | half);
+    }
+    if (exponent >= 31)
+        return static_cast<uint16_t>(sign | 0x7bffu); // clamp to the largest finite half
+
+    uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    const uint32_t rest = mantissa & 0x1fffu;
+    if (rest > 0x1000u || (rest == 0x1000u && (half & 1u)))
+        ++half; // may carry into the exponent, which is still the right rounding
+    return static_cast<uint16_t>(sign | std::min<uint32_t>(half, 0x7bffu));
+}
+
 static void destroyImageAndView(VkDevice device,
                                VkImage& img,
                                VkImageView& view,
@@ -117,12 +152,16 @@ ColorGrading::ColorGrading(Engine2D* eng, uint32_t framesInFlight)
     outViews_.assign(framesInFlight_, VK_NULL_HANDLE);
     outLayouts_.assign(framesInFlight_, VK_IMAGE_LAYOUT_UNDEFINED);
     descriptorSets_.assign(framesInFlight_, VK_NULL_HANDLE);
+    timestampsPending_.assign(framesInFlight_, false);
 
     // 256 floats packed into 64 vec4s (matches your shader UBO layout).
     curveUBOSize_ = sizeof(glm::vec4) * 64;
 
     createPipeline_();
     createCurveResources_();
+    createLutResources_();
+    createBakeResources_();
+    createTimestampQueries_();
     // Outputs + descriptors are created lazily in resize().
 }
 
@@ -136,6 +175,13 @@ ColorGrading::~ColorGrading()
     destroyDescriptors_();
     destroyOutputs_();
     destroyCurveResources_();
+    destroyLutResources_();
+    destroyBakeResources_();
+    if (timestampPool_ != VK_NULL_HANDLE)
+    {
+        vkDestroyQueryPool(engine->logicalDevice, timestampPool_, nullptr);
+        timestampPool_ = VK_NULL_HANDLE;
+    }
     destroyPipeline_();
 }
 
@@ -222,6 +268,38 @@ void ColorGrading::dispatch(VkCommandBuffer cmd, uint32_t frameIndex)
     // Upload curve if needed.
     applyCurve();
 
+    // This slot's previous submission has completed by the time it is recorded again.
+    readTimestamps_(fi);
+
+    static const ColorAdjustments kDefaultAdjustments{};
+    const ColorAdjustments& current = adjustments ? *adjustments : kDefaultAdjustments;
+
+    ColorGradingPush push{};
+    push.outputSize = glm::vec2(static_cast<float>(outputExtent_.width), static_cast<float>(outputExtent_.height));
+    push.bakeSize = static_cast<float>(kGradingBakeSize);
+    // RGBA8 output is the graded frame's only 8-bit quantisation; the shader dithers it
+    const bool ditherOutput = outputFormat_ == VK_FORMAT_R8G8B8A8_UNORM || outputFormat_ == VK_FORMAT_B8G8R8A8_UNORM;
+    push.grading = glm::vec4(current.exposure, current.contrast, current.saturation, ditherOutput ? 1.0f : 0.0f);
+    push.shadows = glm::vec4(current.shadows, 0.0f);
+    push.midtones = glm::vec4(current.midtones, 0.0f);
+    push.highlights = glm::vec4(current.highlights, 0.0f);
+    if (lutLoaded_)
+    {
+        push.lutParams = glm::vec4(1.0f,
+                                   current.lutInterpolation == LutInterpolation::Tetrahedral ? 1.0f : 0.0f,
+                                   static_cast<float>(lutSize_),
+                                   std::clamp(current.lutStrength, 0.0f, 1.0f));
+        push.lutDomainMin = glm::vec4(lutDomainMin_, 0.0f);
+        push.lutDomainMax = glm::vec4(lutDomainMax_, 0.0f);
+    }
+
+    // Baking costs one lattice of evaluations, so it only pays off once the output has more
+    // pixels than the lattice has points; after that every frame is a single fetch.
+    const uint64_t outputPixels = static_cast<uint64_t>(outputExtent_.width) * outputExtent_.height;
+    const uint64_t bakePoints = static_cast<uint64_t>(kGradingBakeSize) * kGradingBakeSize * kGradingBakeSize;
+    const bool useBake = bakeEnabled && bakeView_ != VK_NULL_HANDLE && outputPixels >= bakePoints;
+    const bool rebake = useBake && !bakeIsCurrent_(current);
+
     // Output must be GENERAL for imageStore().
     ensureImageLayout(cmd,
                       outImages_[fi],
@@ -236,9 +314,20 @@ void ColorGrading::dispatch(VkCommandBuffer cmd, uint32_t frameIndex)
     {
         std::cout << "[ColorGrading] dispatch fi=" << fi
                   << " extent=" << outputExtent_.width << "x" << outputExtent_.height
+                  << " lut=" << (lutLoaded_ ? lutSize_ : 0u)
+                  << (push.lutParams.y != 0.0f ? " tetrahedral" : "")
+                  << (useBake ? (rebake ? " rebake" : " baked") : " direct")
+                  << " bakes=" << bakeCount_
+                  << " gpu=" << lastGpuMs_ << "ms"
                   << std::endl;
     }
 
+    if (timestampPool_ != VK_NULL_HANDLE)
+    {
+        vkCmdResetQueryPool(cmd, timestampPool_, fi * 2, 2);
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampPool_, fi * 2);
+    }
+
     vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_);
     vkCmdBindDescriptorSets(cmd,
                             VK_PIPELINE_BIND_POINT_COMPUTE,
@@ -249,10 +338,59 @@ void ColorGrading::dispatch(VkCommandBuffer cmd, uint32_t frameIndex)
                             0,
                             nullptr);
 
+    if (rebake)
+    {
+        // Earlier submissions may still be sampling the previous bake
+        VkImageMemoryBarrier toWrite = makeImageBarrier(bakeImage_,
+                                                        VK_IMAGE_LAYOUT_GENERAL,
+                                                        VK_IMAGE_LAYOUT_GENERAL,
+                                                        VK_ACCESS_SHADER_READ_BIT,
+                                                        VK_ACCESS_SHADER_WRITE_BIT);
+        vkCmdPipelineBarrier(cmd,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0,
+                             0, nullptr,
+                             0, nullptr,
+                             1, &toWrite);
+
+        push.mode = 1.0f;
+        vkCmdPushConstants(cmd, pipelineLayout_, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ColorGradingPush), &push);
+        const uint32_t bakeGroups = (kGradingBakeSize + 15u) / 16u;
+        vkCmdDispatch(cmd, bakeGroups, bakeGroups, kGradingBakeSize);
+
+        VkImageMemoryBarrier toRead = makeImageBarrier(bakeImage_,
+                                                       VK_IMAGE_LAYOUT_GENERAL,
+                                                       VK_IMAGE_LAYOUT_GENERAL,
+                                                       VK_ACCESS_SHADER_WRITE_BIT,
+                                                       VK_ACCESS_SHADER_READ_BIT);
+        vkCmdPipelineBarrier(cmd,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0,
+                             0, nullptr,
+                             0, nullptr,
+                             1, &toRead);
+
+        bakedAdjustments_ = current;
+        bakedLutGeneration_ = lutGeneration_;
+        bakeValid_ = true;
+        ++bakeCount_;
+    }
+
+    push.mode = useBake ? 2.0f : 0.0f;
+    vkCmdPushConstants(cmd, pipelineLayout_, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ColorGradingPush), &push);
+
     const uint32_t groupX = (outputExtent_.width + 15u) / 16u;
     const uint32_t groupY = (outputExtent_.height + 15u) / 16u;
     vkCmdDispatch(cmd, groupX, groupY, 1);
 
+    if (timestampPool_ != VK_NULL_HANDLE)
+    {
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, timestampPool_, fi * 2 + 1);
+        timestampsPending_[fi] = true;
+    }
+
     // Make shader writes visible.
     VkImageMemoryBarrier after = makeImageBarrier(outImages_[fi],
                                                   VK_IMAGE_LAYOUT_GENERAL,
@@ -308,7 +446,9 @@ void ColorGrading::createPipeline_()
     // 0 = outImage (storage)
     // 1 = texRGBA (combined sampler)
     // 5 = curveUBO (uniform buffer)
-    std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+    // 6 = lut3d (combined sampler, 3D)
+    // 7 = bakeTarget (storage, 3D), 8 = bakedGrading (combined sampler, 3D)
+    std::array<VkDescriptorSetLayoutBinding, 6> bindings{};
 
     bindings[0].binding = 0;
     bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
@@ -325,6 +465,21 @@ void ColorGrading::createPipeline_()
     bindings[2].descriptorCount = 1;
     bindings[2].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
 
+    bindings[3].binding = 6;
+    bindings[3].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    bindings[3].descriptorCount = 1;
+    bindings[3].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    bindings[4].binding = 7;
+    bindings[4].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    bindings[4].descriptorCount = 1;
+    bindings[4].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    bindings[5].binding = 8;
+    bindings[5].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    bindings[5].descriptorCount = 1;
+    bindings[5].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
     VkDescriptorSetLayoutCreateInfo dsl{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
     dsl.bindingCount = static_cast<uint32_t>(bindings.size());
     dsl.pBindings = bindings.data();
@@ -335,7 +490,7 @@ void ColorGrading::createPipeline_()
     VkPushConstantRange pcRange{};
     pcRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
     pcRange.offset = 0;
-    pcRange.size = 128; // HACK: Guessing push constant size, max is 256
+    pcRange.size = sizeof(ColorGradingPush);
 
     VkPipelineLayoutCreateInfo pli{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
     pli.setLayoutCount = 1;
@@ -461,6 +616,330 @@ void ColorGrading::uploadCurveData_(const std::array<float, kCurveLutSize>& curv
     std::memcpy(curveUBOMapped_, packed.data(), curveUBOSize_);
 }
 
+bool ColorGrading::loadLut(const std::filesystem::path& cubePath)
+{
+    CubeLut lut;
+    if (!loadCubeLut(cubePath, lut))
+        return false;
+    if (!setLut(lut))
+        return false;
+    std::cout << "[ColorGrading] Loaded " << lut.size << "^3 LUT " << cubePath << std::endl;
+    return true;
+}
+
+bool ColorGrading::setLut(const CubeLut& lut)
+{
+    if (!uploadLut_(lut))
+        return false;
+    lutSize_ = lut.size;
+    lutDomainMin_ = lut.domainMin;
+    lutDomainMax_ = lut.domainMax;
+    lutLoaded_ = true;
+    ++lutGeneration_;
+    return true;
+}
+
+void ColorGrading::clearLut()
+{
+    // The identity table only keeps binding 6 valid; the shader skips the LUT entirely.
+    lutLoaded_ = false;
+    ++lutGeneration_;
+}
+
+void ColorGrading::createLutResources_()
+{
+    VkSamplerCreateInfo si{VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
+    si.magFilter = VK_FILTER_LINEAR;
+    si.minFilter = VK_FILTER_LINEAR;
+    si.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    si.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    si.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    si.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    si.maxLod = 0.0f;
+
+    if (vkCreateSampler(engine->logicalDevice, &si, nullptr, &lutSampler_) != VK_SUCCESS)
+        throw std::runtime_error("ColorGrading: failed to create LUT sampler");
+
+    CubeLut identity;
+    identity.size = 2;
+    identity.rgb = {0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 1, 0,
+                    0, 0, 1, 1, 0, 1, 0, 1, 1, 1, 1, 1};
+    if (!uploadLut_(identity))
+        throw std::runtime_error("ColorGrading: failed to create identity LUT");
+    lutLoaded_ = false;
+}
+
+void ColorGrading::destroyLutImage_()
+{
+    destroyImageAndView(engine->logicalDevice, lutImage_, lutView_, lutMemory_);
+}
+
+void ColorGrading::destroyLutResources_()
+{
+    if (!engine || engine->logicalDevice == VK_NULL_HANDLE)
+        return;
+
+    destroyLutImage_();
+    if (lutSampler_ != VK_NULL_HANDLE)
+    {
+        vkDestroySampler(engine->logicalDevice, lutSampler_, nullptr);
+        lutSampler_ = VK_NULL_HANDLE;
+    }
+    lutLoaded_ = false;
+}
+
+bool ColorGrading::uploadLut_(const CubeLut& lut)
+{
+    if (!engine || !lut.valid())
+        return false;
+
+    VkDevice device = engine->logicalDevice;
+    const uint32_t n = lut.size;
+    const size_t texelCount = static_cast<size_t>(n) * n * n;
+
+    // RGBA16F: linear filtering of it is mandatory, unlike RGBA32F
+    std::vector<uint16_t> texels(texelCount * 4);
+    const uint16_t one = floatToHalf(1.0f);
+    for (size_t i = 0; i < texelCount; ++i)
+    {
+        texels[i * 4 + 0] = floatToHalf(lut.rgb[i * 3 + 0]);
+        texels[i * 4 + 1] = floatToHalf(lut.rgb[i * 3 + 1]);
+        texels[i * 4 + 2] = floatToHalf(lut.rgb[i * 3 + 2]);
+        texels[i * 4 + 3] = one;
+    }
+    const VkDeviceSize bytes = static_cast<VkDeviceSize>(texels.size() * sizeof(uint16_t));
+
+    VkBuffer staging = VK_NULL_HANDLE;
+    VkDeviceMemory stagingMemory = VK_NULL_HANDLE;
+    engine->createBuffer(bytes,
+                         VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         staging,
+                         stagingMemory);
+    void* mapped = nullptr;
+    if (staging == VK_NULL_HANDLE || vkMapMemory(device, stagingMemory, 0, bytes, 0, &mapped) != VK_SUCCESS)
+    {
+        std::cerr << "[ColorGrading] Failed to create LUT staging buffer" << std::endl;
+        if (staging != VK_NULL_HANDLE)
+            vkDestroyBuffer(device, staging, nullptr);
+        if (stagingMemory != VK_NULL_HANDLE)
+            vkFreeMemory(device, stagingMemory, nullptr);
+        return false;
+    }
+    std::memcpy(mapped, texels.data(), static_cast<size_t>(bytes));
+    vkUnmapMemory(device, stagingMemory);
+
+    VkImage image = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkImageView view = VK_NULL_HANDLE;
+    auto fail = [&](const char* what) {
+        std::cerr << "[ColorGrading] " << what << std::endl;
+        destroyImageAndView(device, image, view, memory);
+        vkDestroyBuffer(device, staging, nullptr);
+        vkFreeMemory(device, stagingMemory, nullptr);
+        return false;
+    };
+
+    VkImageCreateInfo ii{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+    ii.imageType = VK_IMAGE_TYPE_3D;
+    ii.format = VK_FORMAT_R16G16B16A16_SFLOAT;
+    ii.extent = VkExtent3D{n, n, n};
+    ii.mipLevels = 1;
+    ii.arrayLayers = 1;
+    ii.samples = VK_SAMPLE_COUNT_1_BIT;
+    ii.tiling = VK_IMAGE_TILING_OPTIMAL;
+    ii.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    ii.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    ii.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    if (vkCreateImage(device, &ii, nullptr, &image) != VK_SUCCESS)
+        return fail("Failed to create LUT image");
+
+    VkMemoryRequirements mr{};
+    vkGetImageMemoryRequirements(device, image, &mr);
+    VkMemoryAllocateInfo ai{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+    ai.allocationSize = mr.size;
+    ai.memoryTypeIndex = engine->findMemoryType(mr.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (vkAllocateMemory(device, &ai, nullptr, &memory) != VK_SUCCESS)
+        return fail("Failed to allocate LUT memory");
+    vkBindImageMemory(device, image, memory, 0);
+
+    VkImageViewCreateInfo vi{VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
+    vi.image = image;
+    vi.viewType = VK_IMAGE_VIEW_TYPE_3D;
+    vi.format = ii.format;
+    vi.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    vi.subresourceRange.levelCount = 1;
+    vi.subresourceRange.layerCount = 1;
+    if (vkCreateImageView(device, &vi, nullptr, &view) != VK_SUCCESS)
+        return fail("Failed to create LUT view");
+
+    VkCommandBuffer cmd = engine->beginSingleTimeCommands();
+    VkImageMemoryBarrier toTransfer = makeImageBarrier(image,
+                                                       VK_IMAGE_LAYOUT_UNDEFINED,
+                                                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                                       0,
+                                                       VK_ACCESS_TRANSFER_WRITE_BIT);
+    vkCmdPipelineBarrier(cmd,
+                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0,
+                         0, nullptr,
+                         0, nullptr,
+                         1, &toTransfer);
+
+    VkBufferImageCopy region{};
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent = VkExtent3D{n, n, n};
+    vkCmdCopyBufferToImage(cmd, staging, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+    VkImageMemoryBarrier toRead = makeImageBarrier(image,
+                                                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                                   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                                   VK_ACCESS_TRANSFER_WRITE_BIT,
+                                                   VK_ACCESS_SHADER_READ_BIT);
+    vkCmdPipelineBarrier(cmd,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0,
+                         0, nullptr,
+                         0, nullptr,
+                         1, &toRead);
+    engine->endSingleTimeCommands(cmd);
+
+    vkDestroyBuffer(device, staging, nullptr);
+    vkFreeMemory(device, stagingMemory, nullptr);
+
+    // Earlier frames may still sample the old table
+    if (lutImage_ != VK_NULL_HANDLE)
+        vkDeviceWaitIdle(device);
+    destroyLutImage_();
+    lutImage_ = image;
+    lutMemory_ = memory;
+    lutView_ = view;
+
+    if (descriptorPool_ != VK_NULL_HANDLE)
+        rebuildDescriptorSets_();
+    return true;
+}
+
+void ColorGrading::createBakeResources_()
+{
+    VkDevice device = engine->logicalDevice;
+
+    VkImageCreateInfo ii{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+    ii.imageType = VK_IMAGE_TYPE_3D;
+    ii.format = VK_FORMAT_R16G16B16A16_SFLOAT;
+    ii.extent = VkExtent3D{kGradingBakeSize, kGradingBakeSize, kGradingBakeSize};
+    ii.mipLevels = 1;
+    ii.arrayLayers = 1;
+    ii.samples = VK_SAMPLE_COUNT_1_BIT;
+    ii.tiling = VK_IMAGE_TILING_OPTIMAL;
+    ii.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    ii.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    ii.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    if (vkCreateImage(device, &ii, nullptr, &bakeImage_) != VK_SUCCESS)
+        throw std::runtime_error("ColorGrading: failed to create bake image");
+
+    VkMemoryRequirements mr{};
+    vkGetImageMemoryRequirements(device, bakeImage_, &mr);
+    VkMemoryAllocateInfo ai{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+    ai.allocationSize = mr.size;
+    ai.memoryTypeIndex = engine->findMemoryType(mr.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (vkAllocateMemory(device, &ai, nullptr, &bakeMemory_) != VK_SUCCESS)
+        throw std::runtime_error("ColorGrading: failed to allocate bake image memory");
+    vkBindImageMemory(device, bakeImage_, bakeMemory_, 0);
+
+    VkImageViewCreateInfo vi{VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
+    vi.image = bakeImage_;
+    vi.viewType = VK_IMAGE_VIEW_TYPE_3D;
+    vi.format = ii.format;
+    vi.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    vi.subresourceRange.levelCount = 1;
+    vi.subresourceRange.layerCount = 1;
+    if (vkCreateImageView(device, &vi, nullptr, &bakeView_) != VK_SUCCESS)
+        throw std::runtime_error("ColorGrading: failed to create bake image view");
+
+    // Stays in GENERAL: written as a storage image and sampled from the same layout
+    VkCommandBuffer cmd = engine->beginSingleTimeCommands();
+    VkImageMemoryBarrier toGeneral = makeImageBarrier(bakeImage_,
+                                                      VK_IMAGE_LAYOUT_UNDEFINED,
+                                                      VK_IMAGE_LAYOUT_GENERAL,
+                                                      0,
+                                                      VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+    vkCmdPipelineBarrier(cmd,
+                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0,
+                         0, nullptr,
+                         0, nullptr,
+                         1, &toGeneral);
+    engine->endSingleTimeCommands(cmd);
+    bakeValid_ = false;
+}
+
+void ColorGrading::destroyBakeResources_()
+{
+    if (!engine || engine->logicalDevice == VK_NULL_HANDLE)
+        return;
+
+    destroyImageAndView(engine->logicalDevice, bakeImage_, bakeView_, bakeMemory_);
+    bakeValid_ = false;
+}
+
+bool ColorGrading::bakeIsCurrent_(const ColorAdjustments& current) const
+{
+    const ColorAdjustments& baked = bakedAdjustments_;
+    if (!bakeValid_ || bakedLutGeneration_ != lutGeneration_)
+        return false;
+    if (baked.exposure != current.exposure || baked.contrast != current.contrast ||
+        baked.saturation != current.saturation || baked.shadows != current.shadows ||
+        baked.midtones != current.midtones || baked.highlights != current.highlights)
+        return false;
+    if (baked.curveEnabled != current.curveEnabled ||
+        (current.curveEnabled && baked.curveLut != current.curveLut))
+        return false;
+    return baked.lutStrength == current.lutStrength && baked.lutInterpolation == current.lutInterpolation;
+}
+
+void ColorGrading::createTimestampQueries_()
+{
+    const VkPhysicalDeviceLimits& limits = engine->getDeviceProperties().limits;
+    if (!limits.timestampComputeAndGraphics || limits.timestampPeriod <= 0.0f)
+        return;
+
+    VkQueryPoolCreateInfo qi{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+    qi.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    qi.queryCount = framesInFlight_ * 2;
+    if (vkCreateQueryPool(engine->logicalDevice, &qi, nullptr, &timestampPool_) != VK_SUCCESS)
+    {
+        timestampPool_ = VK_NULL_HANDLE;
+        return;
+    }
+    timestampPeriodNs_ = static_cast<double>(limits.timestampPeriod);
+}
+
+void ColorGrading::readTimestamps_(uint32_t frameIndex)
+{
+    if (timestampPool_ == VK_NULL_HANDLE || !timestampsPending_[frameIndex])
+        return;
+
+    std::array<uint64_t, 2> ticks{};
+    if (vkGetQueryPoolResults(engine->logicalDevice,
+                              timestampPool_,
+                              frameIndex * 2,
+                              2,
+                              sizeof(ticks),
+                              ticks.data(),
+                              sizeof(uint64_t),
+                              VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+        return;
+
+    timestampsPending_[frameIndex] = false;
+    if (ticks[1] >= ticks[0])
+        lastGpuMs_ = static_cast<double>(ticks[1] - ticks[0]) * timestampPeriodNs_ * 1e-6;
+}
+
 void ColorGrading::createOutputs_()
 {
     destroyOutputs_();
@@ -551,10 +1030,10 @@ void ColorGrading::createDescriptors_()
 
     std::array<VkDescriptorPoolSize, 3> sizes{};
     sizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-    sizes[0].descriptorCount = framesInFlight_;
+    sizes[0].descriptorCount = framesInFlight_ * 2; // output + bake target
 
     sizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    sizes[1].descriptorCount = framesInFlight_;
+    sizes[1].descriptorCount = framesInFlight_ * 3; // RGBA input + 3D LUT + baked grading
 
     sizes[2].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
     sizes[2].descriptorCount = framesInFlight_;
@@ -610,7 +1089,7 @@ void ColorGrading::rebuildDescriptorSets_()
 
     for (uint32_t i = 0; i < framesInFlight_; ++i)
     {
-        std::array<VkWriteDescriptorSet, 3> writes{};
+        std::array<VkWriteDescriptorSet, 6> writes{};
 
         // binding 0: output storage image
         VkDescriptorImageInfo outInfo{};
@@ -653,6 +1132,46 @@ void ColorGrading::rebuildDescriptorSets_()
         writes[2].descriptorCount = 1;
         writes[2].pBufferInfo = &bufInfo;
 
+        // binding 6: 3D LUT
+        VkDescriptorImageInfo lutInfo{};
+        lutInfo.imageView = lutView_;
+        lutInfo.sampler = lutSampler_;
+        lutInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        writes[3].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[3].dstSet = descriptorSets_[i];
+        writes[3].dstBinding = 6;
+        writes[3].dstArrayElement = 0;
+        writes[3].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writes[3].descriptorCount = 1;
+        writes[3].pImageInfo = &lutInfo;
+
+        // bindings 7 / 8: baked grading, written and sampled in GENERAL
+        VkDescriptorImageInfo bakeStorageInfo{};
+        bakeStorageInfo.imageView = bakeView_;
+        bakeStorageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+        writes[4].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[4].dstSet = descriptorSets_[i];
+        writes[4].dstBinding = 7;
+        writes[4].dstArrayElement = 0;
+        writes[4].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        writes[4].descriptorCount = 1;
+        writes[4].pImageInfo = &bakeStorageInfo;
+
+        VkDescriptorImageInfo bakeSampledInfo{};
+        bakeSampledInfo.imageView = bakeView_;
+        bakeSampledInfo.sampler = lutSampler_;
+        bakeSampledInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+        writes[5].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[5].dstSet = descriptorSets_[i];
+        writes[5].dstBinding = 8;
+        writes[5].dstArrayElement = 0;
+        writes[5].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writes[5].descriptorCount = 1;
+        writes[5].pImageInfo = &bakeSampledInfo;
+
         vkUpdateDescriptorSets(engine->logicalDevice,
                                static_cast<uint32_t>(writes.size()),
                                writes.data(),
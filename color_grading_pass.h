@@ -3,15 +3,25 @@
 
 #include <array>
 #include <cstdint>
+#include <filesystem>
 #include <vector>
 
 #include <vulkan/vulkan.h>
 #include <glm/glm.hpp>
 
 class Engine2D;
+struct CubeLut;
 
 
 constexpr size_t kCurveLutSize = 256;
+// Lattice points per axis when the whole grading stack is baked into a 3D LUT
+constexpr uint32_t kGradingBakeSize = 65;
+
+enum class LutInterpolation : uint32_t
+{
+    Trilinear = 0,   // hardware-filtered 3D texture fetch
+    Tetrahedral = 1, // four texel fetches per pixel, matches most grading tools
+};
 
 struct ColorAdjustments
 {
@@ -23,8 +33,27 @@ struct ColorAdjustments
     glm::vec3 highlights{1.0f};
     std::array<float, kCurveLutSize> curveLut{};
     bool curveEnabled = false;
+    // Applied after the curve when a 3D LUT is loaded (ColorGrading::loadLut)
+    float lutStrength = 1.0f;
+    LutInterpolation lutInterpolation = LutInterpolation::Trilinear;
 };
 
+// Push constants of color_grading_pass.comp
+struct ColorGradingPush
+{
+    glm::vec2 outputSize{0.0f};
+    float mode = 0.0f;                         // 0 direct, 1 bake, 2 sample the bake
+    float bakeSize = 0.0f;
+    glm::vec4 grading{0.0f, 1.0f, 1.0f, 0.0f}; // exposure, contrast, saturation, dither
+    glm::vec4 shadows{1.0f};
+    glm::vec4 midtones{1.0f};
+    glm::vec4 highlights{1.0f};
+    glm::vec4 lutParams{0.0f};                 // enabled, tetrahedral, size, strength
+    glm::vec4 lutDomainMin{0.0f};
+    glm::vec4 lutDomainMax{1.0f};
+};
+static_assert(sizeof(ColorGradingPush) == 128, "Push constant size must match shader");
+
 
 class ColorGrading
 {
@@ -66,8 +95,23 @@ public:
     // (e.g. SHADER_READ_ONLY_OPTIMAL if you transition it at end)
     VkImageLayout outputLayout(uint32_t frameIndex) const;
 
+    // 3D LUT applied after the curve. loadLut() goes through the .cube binary cache; both
+    // wait for the device to go idle before replacing the texture.
+    bool loadLut(const std::filesystem::path& cubePath);
+    bool setLut(const CubeLut& lut);
+    void clearLut();
+    bool hasLut() const { return lutLoaded_; }
+
+    // GPU time of the last completed dispatch in milliseconds (0 until one has finished).
+    double lastGpuMilliseconds() const { return lastGpuMs_; }
+
     // Adjustments storage (same as you have today)
     ColorAdjustments* adjustments = nullptr;
+
+    // Bake exposure / 3-way / contrast / saturation / curve / LUT into one 65^3 table and
+    // fetch it once per pixel; re-baked only when the adjustments change. Outputs smaller
+    // than the lattice are evaluated directly instead.
+    bool bakeEnabled = true;
     
     VkExtent2D outputExtent_{0, 0};
     VkFormat outputFormat_ = VK_FORMAT_UNDEFINED;
@@ -82,6 +126,18 @@ private:
     void applyCurve();
     void uploadCurveData_(const std::array<float, /*kCurveLutSize*/ 256>& curveData);
 
+    void createLutResources_();
+    void destroyLutResources_();
+    bool uploadLut_(const CubeLut& lut);
+    void destroyLutImage_();
+
+    void createBakeResources_();
+    void destroyBakeResources_();
+    bool bakeIsCurrent_(const ColorAdjustments& current) const;
+
+    void createTimestampQueries_();
+    void readTimestamps_(uint32_t frameIndex);
+
     void createOutputs_();
     void destroyOutputs_();
 
@@ -122,4 +178,30 @@ private:
     bool curveUploaded_ = false;
     bool lastCurveEnabled_ = false;
     std::array<float, 256> lastCurveLut_{};
+
+    // 3D LUT texture; an identity 2^3 table stays bound while none is loaded
+    VkImage lutImage_ = VK_NULL_HANDLE;
+    VkDeviceMemory lutMemory_ = VK_NULL_HANDLE;
+    VkImageView lutView_ = VK_NULL_HANDLE;
+    VkSampler lutSampler_ = VK_NULL_HANDLE;
+    uint32_t lutSize_ = 0;
+    glm::vec3 lutDomainMin_{0.0f};
+    glm::vec3 lutDomainMax_{1.0f};
+    bool lutLoaded_ = false;
+    uint64_t lutGeneration_ = 0;
+
+    // Baked grading stack and what it was baked from
+    VkImage bakeImage_ = VK_NULL_HANDLE;
+    VkDeviceMemory bakeMemory_ = VK_NULL_HANDLE;
+    VkImageView bakeView_ = VK_NULL_HANDLE;
+    bool bakeValid_ = false;
+    ColorAdjustments bakedAdjustments_{};
+    uint64_t bakedLutGeneration_ = 0;
+    uint64_t bakeCount_ = 0;
+
+    // Two timestamps per frame slot around the dispatch
+    VkQueryPool timestampPool_ = VK_NULL_HANDLE;
+    std::vector<bool> timestampsPending_;
+    double timestampPeriodNs_ = 0.0;
+    double lastGpuMs_ = 0.0;
 };
@@ -336,6 +336,7 @@ ColorGradingUi::ColorGradingUi(Engine2D *engine,
                                 static_cast<float>(y0) + static_cast<float>(h) * 0.5f);
         desc.size = glm::vec2(static_cast<float>(w), static_cast<float>(h));
         desc.borderThickness = 3.0f;
+        desc.cornerRadius = 6.0f;
         desc.backgroundColor = color;
         desc.borderColor = glm::vec4(0.06f, 0.06f, 0.06f, 1.0f);
         widgets::appendButtonCommands(commands, desc);
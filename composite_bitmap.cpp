@@ -2,6 +2,7 @@
 
 #include "debug_logging.h"
 #include "engine2d.h"
+#include "queue_lock.h"
 #include "utils.h"
 
 #include <glm/glm.hpp>
@@ -11,6 +12,7 @@
 #include <cstdint>
 #include <cstring>
 #include <cmath>
+#include <mutex>
 #include <vector>
 
 namespace
@@ -395,7 +397,11 @@ bool compositeBitmap(Engine2D* engine,
     VkSubmitInfo submitInfo{VK_STRUCTURE_TYPE_SUBMIT_INFO};
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &comp.commandBuffer;
-    vkQueueSubmit(comp.queue, 1, &submitInfo, comp.fence);
+    {
+        // Shared with the decoders and the render loop
+        std::lock_guard<std::mutex> queueLock(vulkanQueueMutex(engine->graphicsQueueFamilyIndex));
+        vkQueueSubmit(comp.queue, 1, &submitInfo, comp.fence);
+    }
     vkWaitForFences(comp.device, 1, &comp.fence, VK_TRUE, UINT64_MAX);
 
     target.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
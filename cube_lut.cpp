@@ -0,0 +1,341 @@
+#include "cube_lut.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <system_error>
+
+namespace
+{
+constexpr char kCacheMagic[4] = {'L', 'U', 'T', '3'};
+constexpr uint32_t kCacheVersion = 1;
+constexpr uint32_t kMaxLutSize = 256;
+
+struct CacheHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    uint32_t size;
+    uint32_t titleLength;
+    float domainMin[3];
+    float domainMax[3];
+};
+
+bool sourceStamp(const std::filesystem::path& path, uint64_t& size, int64_t& time)
+{
+    std::error_code ec;
+    size = static_cast<uint64_t>(std::filesystem::file_size(path, ec));
+    if (ec)
+    {
+        return false;
+    }
+    const auto written = std::filesystem::last_write_time(path, ec);
+    if (ec)
+    {
+        return false;
+    }
+    time = static_cast<int64_t>(written.time_since_epoch().count());
+    return true;
+}
+
+bool readCache(const std::filesystem::path& cachePath, uint64_t sourceSize, int64_t sourceTime, CubeLut& lut)
+{
+    std::ifstream file(cachePath, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+    CacheHeader header{};
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, kCacheMagic, sizeof(kCacheMagic)) != 0 || header.version != kCacheVersion ||
+        header.sourceSize != sourceSize || header.sourceTime != sourceTime || header.size < 2 ||
+        header.size > kMaxLutSize || header.titleLength > 4096)
+    {
+        return false;
+    }
+
+    CubeLut loaded;
+    loaded.size = header.size;
+    loaded.domainMin = glm::vec3(header.domainMin[0], header.domainMin[1], header.domainMin[2]);
+    loaded.domainMax = glm::vec3(header.domainMax[0], header.domainMax[1], header.domainMax[2]);
+    loaded.title.resize(header.titleLength);
+    loaded.rgb.resize(static_cast<size_t>(header.size) * header.size * header.size * 3);
+    if (!file.read(loaded.title.data(), static_cast<std::streamsize>(loaded.title.size())) ||
+        !file.read(reinterpret_cast<char*>(loaded.rgb.data()),
+                   static_cast<std::streamsize>(loaded.rgb.size() * sizeof(float))))
+    {
+        return false;
+    }
+    lut = std::move(loaded);
+    return true;
+}
+
+void writeCache(const std::filesystem::path& cachePath, uint64_t sourceSize, int64_t sourceTime, const CubeLut& lut)
+{
+    CacheHeader header{};
+    std::memcpy(header.magic, kCacheMagic, sizeof(kCacheMagic));
+    header.version = kCacheVersion;
+    header.sourceSize = sourceSize;
+    header.sourceTime = sourceTime;
+    header.size = lut.size;
+    header.titleLength = static_cast<uint32_t>(std::min<size_t>(lut.title.size(), 4096));
+    for (int c = 0; c < 3; ++c)
+    {
+        header.domainMin[c] = lut.domainMin[c];
+        header.domainMax[c] = lut.domainMax[c];
+    }
+
+    // Write to a temporary name first so a concurrent reader never sees a partial cache
+    std::filesystem::path tmpPath = cachePath;
+    tmpPath += ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            return;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(lut.title.data(), header.titleLength);
+        file.write(reinterpret_cast<const char*>(lut.rgb.data()),
+                   static_cast<std::streamsize>(lut.rgb.size() * sizeof(float)));
+        if (!file)
+        {
+            file.close();
+            std::error_code ec;
+            std::filesystem::remove(tmpPath, ec);
+            return;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, cachePath, ec);
+    if (ec)
+    {
+        std::filesystem::remove(tmpPath, ec);
+    }
+}
+
+bool parseFloats(const char* text, float* out, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        char* end = nullptr;
+        out[i] = std::strtof(text, &end);
+        if (end == text)
+        {
+            return false;
+        }
+        text = end;
+    }
+    return true;
+}
+
+glm::vec3 lutEntry(const CubeLut& lut, uint32_t r, uint32_t g, uint32_t b)
+{
+    const size_t index = (static_cast<size_t>(b) * lut.size + g) * lut.size + r;
+    return glm::vec3(lut.rgb[index * 3 + 0], lut.rgb[index * 3 + 1], lut.rgb[index * 3 + 2]);
+}
+
+// Lattice cell containing color and the position inside it
+void latticeCell(const CubeLut& lut, const glm::vec3& color, uint32_t base[3], glm::vec3& frac)
+{
+    const float last = static_cast<float>(lut.size - 1);
+    for (int c = 0; c < 3; ++c)
+    {
+        const float p = std::clamp(color[c], 0.0f, 1.0f) * last;
+        const float cell = std::min(std::floor(p), last - 1.0f);
+        base[c] = static_cast<uint32_t>(cell);
+        frac[c] = p - cell;
+    }
+}
+} // namespace
+
+bool parseCubeLut(std::istream& in, CubeLut& lut)
+{
+    CubeLut parsed;
+    size_t expected = 0;
+    size_t entries = 0;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        size_t first = 0;
+        while (first < line.size() && std::isspace(static_cast<unsigned char>(line[first])))
+        {
+            ++first;
+        }
+        if (first == line.size() || line[first] == '#')
+        {
+            continue;
+        }
+        const char* text = line.c_str() + first;
+
+        if (std::isalpha(static_cast<unsigned char>(*text)))
+        {
+            std::istringstream keywordLine(text);
+            std::string keyword;
+            keywordLine >> keyword;
+            if (keyword == "TITLE")
+            {
+                const size_t open = line.find('"');
+                const size_t close = line.rfind('"');
+                if (open != std::string::npos && close > open)
+                {
+                    parsed.title = line.substr(open + 1, close - open - 1);
+                }
+            }
+            else if (keyword == "LUT_3D_SIZE")
+            {
+                uint32_t size = 0;
+                if (!(keywordLine >> size) || size < 2 || size > kMaxLutSize)
+                {
+                    std::cerr << "[CubeLut] Unsupported LUT_3D_SIZE" << std::endl;
+                    return false;
+                }
+                parsed.size = size;
+                expected = static_cast<size_t>(size) * size * size;
+                parsed.rgb.resize(expected * 3);
+            }
+            else if (keyword == "DOMAIN_MIN" || keyword == "DOMAIN_MAX")
+            {
+                float v[3];
+                if (!parseFloats(text + keyword.size(), v, 3))
+                {
+                    std::cerr << "[CubeLut] Malformed " << keyword << std::endl;
+                    return false;
+                }
+                (keyword == "DOMAIN_MIN" ? parsed.domainMin : parsed.domainMax) = glm::vec3(v[0], v[1], v[2]);
+            }
+            else if (keyword == "LUT_1D_SIZE")
+            {
+                std::cerr << "[CubeLut] 1D .cube tables are not supported" << std::endl;
+                return false;
+            }
+            // Other keywords (LUT_3D_INPUT_RANGE, vendor extensions) are ignored
+            continue;
+        }
+
+        if (expected == 0)
+        {
+            std::cerr << "[CubeLut] Table data before LUT_3D_SIZE" << std::endl;
+            return false;
+        }
+        if (entries >= expected || !parseFloats(text, &parsed.rgb[entries * 3], 3))
+        {
+            std::cerr << "[CubeLut] Malformed or extra table entry " << entries << std::endl;
+            return false;
+        }
+        ++entries;
+    }
+
+    if (expected == 0 || entries != expected)
+    {
+        std::cerr << "[CubeLut] Expected " << expected << " entries, found " << entries << std::endl;
+        return false;
+    }
+    for (int c = 0; c < 3; ++c)
+    {
+        if (!(parsed.domainMax[c] > parsed.domainMin[c]))
+        {
+            std::cerr << "[CubeLut] Empty domain" << std::endl;
+            return false;
+        }
+    }
+    lut = std::move(parsed);
+    return true;
+}
+
+std::filesystem::path cubeLutCachePath(const std::filesystem::path& path)
+{
+    std::filesystem::path cache = path;
+    cache += ".bin";
+    return cache;
+}
+
+bool loadCubeLut(const std::filesystem::path& path, CubeLut& lut)
+{
+    uint64_t sourceSize = 0;
+    int64_t sourceTime = 0;
+    if (!sourceStamp(path, sourceSize, sourceTime))
+    {
+        std::cerr << "[CubeLut] Failed to stat " << path << std::endl;
+        return false;
+    }
+
+    const std::filesystem::path cachePath = cubeLutCachePath(path);
+    if (readCache(cachePath, sourceSize, sourceTime, lut))
+    {
+        return true;
+    }
+
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cerr << "[CubeLut] Failed to open " << path << std::endl;
+        return false;
+    }
+    if (!parseCubeLut(file, lut))
+    {
+        std::cerr << "[CubeLut] Failed to parse " << path << std::endl;
+        return false;
+    }
+    writeCache(cachePath, sourceSize, sourceTime, lut);
+    return true;
+}
+
+glm::vec3 sampleCubeLutTrilinear(const CubeLut& lut, const glm::vec3& color)
+{
+    uint32_t b[3];
+    glm::vec3 f;
+    latticeCell(lut, color, b, f);
+    const glm::vec3 c00 = glm::mix(lutEntry(lut, b[0], b[1], b[2]), lutEntry(lut, b[0] + 1, b[1], b[2]), f.x);
+    const glm::vec3 c10 = glm::mix(lutEntry(lut, b[0], b[1] + 1, b[2]), lutEntry(lut, b[0] + 1, b[1] + 1, b[2]), f.x);
+    const glm::vec3 c01 = glm::mix(lutEntry(lut, b[0], b[1], b[2] + 1), lutEntry(lut, b[0] + 1, b[1], b[2] + 1), f.x);
+    const glm::vec3 c11 =
+        glm::mix(lutEntry(lut, b[0], b[1] + 1, b[2] + 1), lutEntry(lut, b[0] + 1, b[1] + 1, b[2] + 1), f.x);
+    return glm::mix(glm::mix(c00, c10, f.y), glm::mix(c01, c11, f.y), f.z);
+}
+
+glm::vec3 sampleCubeLutTetrahedral(const CubeLut& lut, const glm::vec3& color)
+{
+    uint32_t b[3];
+    glm::vec3 f;
+    latticeCell(lut, color, b, f);
+    const uint32_t r = b[0], g = b[1], bl = b[2];
+    const glm::vec3 c000 = lutEntry(lut, r, g, bl);
+    const glm::vec3 c111 = lutEntry(lut, r + 1, g + 1, bl + 1);
+
+    // Walk the cube diagonal through the tetrahedron selected by the ordering of f
+    if (f.x > f.y)
+    {
+        if (f.y > f.z)
+        {
+            const glm::vec3 c100 = lutEntry(lut, r + 1, g, bl), c110 = lutEntry(lut, r + 1, g + 1, bl);
+            return c000 + f.x * (c100 - c000) + f.y * (c110 - c100) + f.z * (c111 - c110);
+        }
+        if (f.x > f.z)
+        {
+            const glm::vec3 c100 = lutEntry(lut, r + 1, g, bl), c101 = lutEntry(lut, r + 1, g, bl + 1);
+            return c000 + f.x * (c100 - c000) + f.z * (c101 - c100) + f.y * (c111 - c101);
+        }
+        const glm::vec3 c001 = lutEntry(lut, r, g, bl + 1), c101 = lutEntry(lut, r + 1, g, bl + 1);
+        return c000 + f.z * (c001 - c000) + f.x * (c101 - c001) + f.y * (c111 - c101);
+    }
+    if (f.z > f.y)
+    {
+        const glm::vec3 c001 = lutEntry(lut, r, g, bl + 1), c011 = lutEntry(lut, r, g + 1, bl + 1);
+        return c000 + f.z * (c001 - c000) + f.y * (c011 - c001) + f.x * (c111 - c011);
+    }
+    if (f.z > f.x)
+    {
+        const glm::vec3 c010 = lutEntry(lut, r, g + 1, bl), c011 = lutEntry(lut, r, g + 1, bl + 1);
+        return c000 + f.y * (c010 - c000) + f.z * (c011 - c010) + f.x * (c111 - c011);
+    }
+    const glm::vec3 c010 = lutEntry(lut, r, g + 1, bl), c110 = lutEntry(lut, r + 1, g + 1, bl);
+    return c000 + f.y * (c010 - c000) + f.x * (c110 - c010) + f.z * (c111 - c110);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+// A 3D colour LUT as delivered in .cube files (Resolve / Adobe flavour). Entries are RGB
+// triplets with red varying fastest, then green, then blue, which is also the texel order of
+// a 3D image with x = red, so the table uploads without reordering.
+struct CubeLut
+{
+    std::string title;
+    uint32_t size = 0;
+    glm::vec3 domainMin{0.0f};
+    glm::vec3 domainMax{1.0f};
+    std::vector<float> rgb; // size^3 * 3
+
+    bool valid() const { return size >= 2 && rgb.size() == static_cast<size_t>(size) * size * size * 3; }
+};
+
+// Parses .cube text. Only 3D tables are accepted (LUT_1D_SIZE is rejected).
+bool parseCubeLut(std::istream& in, CubeLut& lut);
+
+// Loads a .cube file, going through a binary cache next to it (see cubeLutCachePath()).
+// The cache is used when it records the source's current size and modification time;
+// otherwise the text is parsed and the cache rewritten (best effort).
+bool loadCubeLut(const std::filesystem::path& path, CubeLut& lut);
+std::filesystem::path cubeLutCachePath(const std::filesystem::path& path);
+
+// CPU reference lookups of a colour already mapped into [0, 1] over the LUT domain; they
+// mirror the GPU paths in color_grading_pass.comp.
+glm::vec3 sampleCubeLutTrilinear(const CubeLut& lut, const glm::vec3& color);
+glm::vec3 sampleCubeLutTetrahedral(const CubeLut& lut, const glm::vec3& color);
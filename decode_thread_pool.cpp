@@ -0,0 +1,113 @@
+// decode_thread_pool.cpp
+#include "decode_thread_pool.h"
+
+#include "debug_logging.h"
+#include "decoder_vulkan.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+DecodeThreadPool::DecodeThreadPool(uint32_t threadCount)
+    : requestedThreads_(threadCount)
+{
+}
+
+DecodeThreadPool::~DecodeThreadPool()
+{
+    stop();
+}
+
+void DecodeThreadPool::add(DecoderVulkan* decoder)
+{
+    if (!decoder || !workers_.empty())
+        return;
+    auto entry = std::make_unique<Entry>();
+    entry->decoder = decoder;
+    entries_.push_back(std::move(entry));
+}
+
+void DecodeThreadPool::start()
+{
+    if (!workers_.empty() || entries_.empty())
+        return;
+
+    uint32_t count = requestedThreads_;
+    if (count == 0)
+    {
+        // Half the cores, at most one per stream: a starting value, not yet checked with mosaic_bench
+        const uint32_t hw = std::max(2u, std::thread::hardware_concurrency());
+        count = std::min(static_cast<uint32_t>(entries_.size()), std::max(1u, hw / 2));
+    }
+
+    stopRequested_.store(false);
+    for (uint32_t i = 0; i < count; ++i)
+        workers_.emplace_back(&DecodeThreadPool::workerLoop_, this, i);
+
+    if (renderDebugEnabled())
+        std::cout << "[DecodeThreadPool] " << count << " worker(s) for " << entries_.size() << " stream(s)" << std::endl;
+}
+
+void DecodeThreadPool::stop()
+{
+    stopRequested_.store(true);
+    notify();
+    for (auto& worker : workers_)
+    {
+        if (worker.joinable())
+            worker.join();
+    }
+    workers_.clear();
+}
+
+void DecodeThreadPool::notify()
+{
+    wakeCv_.notify_all();
+}
+
+bool DecodeThreadPool::allFinished() const
+{
+    for (const auto& entry : entries_)
+    {
+        if (!entry->decoder->isFinished())
+            return false;
+    }
+    return true;
+}
+
+void DecodeThreadPool::workerLoop_(uint32_t workerIndex)
+{
+    const size_t count = entries_.size();
+    // Workers start their scan at different streams so they spread out from the first pass
+    size_t next = workerIndex % count;
+
+    while (!stopRequested_.load())
+    {
+        bool worked = false;
+        for (size_t i = 0; i < count && !stopRequested_.load(); ++i)
+        {
+            Entry& entry = *entries_[(next + i) % count];
+            if (entry.decoder->isFinished() || !(entry.decoder->hasQueueSpace() || entry.decoder->wantsPrefill()))
+                continue;
+
+            bool expected = false;
+            if (!entry.busy.compare_exchange_strong(expected, true))
+                continue;
+
+            entry.decoder->decodeStep();
+            entry.busy.store(false);
+
+            // Round-robin: the next scan starts after the stream just served
+            next = (next + i + 1) % count;
+            worked = true;
+            break;
+        }
+
+        if (!worked)
+        {
+            // Every queue is full (or claimed); wait for the consumer to make room
+            std::unique_lock<std::mutex> lk(wakeMutex_);
+            wakeCv_.wait_for(lk, std::chrono::milliseconds(2));
+        }
+    }
+}
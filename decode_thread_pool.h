@@ -0,0 +1,59 @@
+// decode_thread_pool.h
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class DecoderVulkan;
+
+// Shared decode workers for many DecoderVulkan instances (multi-stream mosaic), instead of one
+// startAsyncDecoding() thread per stream. A worker claims a decoder whose queue has room (or
+// that wants to prefill its frame cache while paused), runs one decodeStep() and releases it,
+// so a stream is never decoded on two threads at once and 16 streams need only a handful of
+// threads.
+class DecodeThreadPool
+{
+public:
+    // threadCount 0 picks min(decoders, hardware threads / 2) at start()
+    explicit DecodeThreadPool(uint32_t threadCount = 0);
+    ~DecodeThreadPool();
+
+    DecodeThreadPool(const DecodeThreadPool&) = delete;
+    DecodeThreadPool& operator=(const DecodeThreadPool&) = delete;
+
+    // Decoders must outlive the pool (or stop()); add them before start().
+    void add(DecoderVulkan* decoder);
+    void start();
+    void stop();
+
+    // Wakes idle workers after a consumer has drained queue space.
+    void notify();
+
+    uint32_t threadCount() const { return static_cast<uint32_t>(workers_.size()); }
+    // Every decoder is exhausted. A seek() un-finishes its decoder and the workers pick it up
+    // again, so this is not sticky.
+    bool allFinished() const;
+
+private:
+    struct Entry
+    {
+        DecoderVulkan* decoder = nullptr;
+        std::atomic<bool> busy{false};
+    };
+
+    void workerLoop_(uint32_t workerIndex);
+
+private:
+    uint32_t requestedThreads_ = 0;
+    std::vector<std::unique_ptr<Entry>> entries_;
+    std::vector<std::thread> workers_;
+
+    std::mutex wakeMutex_;
+    std::condition_variable wakeCv_;
+    std::atomic<bool> stopRequested_{false};
+};
@@ -217,11 +217,24 @@ void DecoderCPU::copyDecodedFrameToBuffer(const AVFrame *frame, std::vector<uint
 
 // Constructor
 DecoderCPU::DecoderCPU(const std::filesystem::path &videoPath,
-    bool debugLogging)
+    bool debugLogging, const std::optional<StreamReaderOptions> &streamOptions)
     : engine(nullptr)
 {
     
     std::cout << "[Video] Loading video file: " << videoPath << std::endl;
+    if (streamOptions)
+    {
+        streamReader = std::make_unique<StreamReader>(videoPath, *streamOptions);
+        AVIOContext *pb = streamReader->valid() ? streamReader->avioContext() : nullptr;
+        if (!pb)
+        {
+            // Same as DecoderVulkan: --stream was asked for, so don't quietly read the file instead
+            throw std::runtime_error("[Video] Failed to open stream: " + videoPath.string());
+        }
+        formatCtx = avformat_alloc_context();
+        formatCtx->pb = pb;
+        formatCtx->flags |= AVFMT_FLAG_CUSTOM_IO;
+    }
     if (avformat_open_input(&formatCtx, videoPath.string().c_str(), nullptr, nullptr) < 0)
     {
         std::cerr << "[Video] Failed to open file: " << videoPath << std::endl;
@@ -844,6 +857,7 @@ void DecoderCPU::cleanupVideoDecoderCPU()
     {
         avformat_close_input(&formatCtx);
     }
+    streamReader.reset();
 
     // Cleanup Vulkan resources
     if (engine)
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <filesystem>
+#include <memory>
 #include <optional>
 #include <string>
 #include <vector>
@@ -25,6 +26,8 @@ extern "C"
 #include <libavutil/pixfmt.h>
 }
 
+#include "stream_reader.h"
+
 // Forward declarations
 class Engine2D;
 
@@ -38,7 +41,8 @@ struct DecodedFrame
 class DecoderCPU
 {
 public:
-    DecoderCPU(const std::filesystem::path &videoPath, bool debugLogging = false);
+    DecoderCPU(const std::filesystem::path &videoPath, bool debugLogging = false,
+               const std::optional<StreamReaderOptions> &streamOptions = std::nullopt);
     ~DecoderCPU();
 
     // Public interface
@@ -85,6 +89,7 @@ private:
     void destroyExternalVideoViews();
 
     // FFmpeg resources
+    std::unique_ptr<StreamReader> streamReader; // custom IO for formatCtx when streaming
     AVFormatContext *formatCtx = nullptr;
     AVCodecContext *codecCtx = nullptr;
     AVFrame *frame = nullptr;
@@ -2,6 +2,7 @@
 #include "decoder_vulkan.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <iostream>
 #include <limits>
@@ -19,11 +20,24 @@ extern "C" {
 #include <libavutil/hwcontext_vulkan.h>
 }
 
+#include "debug_logging.h"
 #include "engine2d.h"
+#include "media_clock.h"
+#include "queue_lock.h"
 
 // Interrupt callback forward declaration
 static int interrupt_callback(void *opaque);
 
+static void lockSharedQueue(AVHWDeviceContext* /*ctx*/, uint32_t queueFamily, uint32_t index)
+{
+    vulkanQueueMutex(queueFamily, index).lock();
+}
+
+static void unlockSharedQueue(AVHWDeviceContext* /*ctx*/, uint32_t queueFamily, uint32_t index)
+{
+    vulkanQueueMutex(queueFamily, index).unlock();
+}
+
 // Returns a readable description of an FFmpeg pixel format.
 static std::string pixelFormatDescription(AVPixelFormat fmt)
 {
@@ -89,6 +103,32 @@ static std::string avErrStr(int err)
     return std::string(buf);
 }
 
+// Display refresh the skip policy assumes: past one source frame per refresh, frames are
+// dropped whether they were decoded or not
+static constexpr double kNominalDisplayHz = 60.0;
+// Keyframes alone must still update the picture at least this often to be used. Neither value
+// has been checked against speed_bench's decode work per displayed frame yet.
+static constexpr double kMinKeyframeUpdatesPerSecond = 8.0;
+
+static DecoderVulkan::FrameSkip frameSkipForRate(double rate, double fps, double keyframeIntervalSeconds)
+{
+    const double speed = std::abs(rate);
+    if (speed * fps <= kNominalDisplayHz)
+        return DecoderVulkan::FrameSkip::None;
+    if (keyframeIntervalSeconds > 0.0 && speed / keyframeIntervalSeconds >= kMinKeyframeUpdatesPerSecond)
+        return DecoderVulkan::FrameSkip::KeyframesOnly;
+    return DecoderVulkan::FrameSkip::NonReference;
+}
+
+const char* frameSkipName(DecoderVulkan::FrameSkip skip)
+{
+    switch (skip) {
+    case DecoderVulkan::FrameSkip::NonReference: return "non-reference";
+    case DecoderVulkan::FrameSkip::KeyframesOnly: return "keyframes-only";
+    default: return "none";
+    }
+}
+
 // ------------------------------
 // DecodedFrame RAII
 // ------------------------------
@@ -119,6 +159,16 @@ void DecodedFrame::reset() {
     vk = VulkanSurface{};
 }
 
+bool DecodedFrame::ref(const DecodedFrame& other) {
+    reset();
+    if (!other.avFrame) return false;
+    avFrame = av_frame_clone(other.avFrame);
+    if (!avFrame) return false;
+    ptsSeconds = other.ptsSeconds;
+    vk = other.vk;
+    return true;
+}
+
 // ------------------------------
 // BoundedQueue impl
 // ------------------------------
@@ -194,10 +244,11 @@ template class BoundedQueue<DecodedFrame, DecoderVulkan::kBufferedFrames>;
 // ------------------------------
 // DecoderVulkan
 // ------------------------------
-DecoderVulkan::DecoderVulkan(const std::filesystem::path& videoPath, Engine2D* eng)
+DecoderVulkan::DecoderVulkan(const std::filesystem::path& videoPath, Engine2D* eng,
+                             const std::optional<StreamReaderOptions>& streamOptions)
     : engine(eng)
 {
-    if (!openInputAndCodec(videoPath)) {
+    if (!openInputAndCodec(videoPath, streamOptions)) {
         valid = false;
         return;
     }
@@ -212,6 +263,9 @@ DecoderVulkan::DecoderVulkan(const std::filesystem::path& videoPath, Engine2D* e
 DecoderVulkan::~DecoderVulkan() {
     stopAsyncDecoding();
     destroyExternalVideoViews();
+    // Cached and reverse frames reference surfaces of the FFmpeg frames context
+    reverseFrames.clear();
+    frameCache.clear();
 
     if (engine && sampler != VK_NULL_HANDLE) {
         vkDestroySampler(engine->logicalDevice, sampler, nullptr);
@@ -221,24 +275,113 @@ DecoderVulkan::~DecoderVulkan() {
     cleanupFFmpeg();
 }
 
-static AVPixelFormat chooseUsefulPixFmtForConfig(const AVCodecContext* c)
+// Vulkan surface layout for a decoded stream: the source's own plane arrangement (3-plane
+// sources keep three images) at its subsampling and depth, one single-channel or two-channel
+// VkFormat per image so the converters can sample each plane directly.
+struct SurfaceFormat
 {
-    if (!c) return AV_PIX_FMT_NONE;
+    AVPixelFormat swFormat = AV_PIX_FMT_NONE;
+    std::array<VkFormat, 3> planeFormats{VK_FORMAT_UNDEFINED, VK_FORMAT_UNDEFINED, VK_FORMAT_UNDEFINED};
+};
 
-    // With hwaccel, codecCtx->pix_fmt is usually the hw surface (e.g. AV_PIX_FMT_VULKAN),
-    // and the *actual* subsampling/bit depth lives in sw_pix_fmt.
-    if (c->pix_fmt == AV_PIX_FMT_VULKAN && c->sw_pix_fmt != AV_PIX_FMT_NONE)
-        return c->sw_pix_fmt;
+static bool surfaceFormatForSource(AVPixelFormat source, bool forceSemiPlanar, SurfaceFormat& out)
+{
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(source);
+    if (!desc || (desc->flags & (AV_PIX_FMT_FLAG_RGB | AV_PIX_FMT_FLAG_HWACCEL)) || desc->nb_components < 3)
+        return false;
 
-    // If pix_fmt is unknown but sw_pix_fmt is known, use sw_pix_fmt.
-    if (c->pix_fmt == AV_PIX_FMT_NONE && c->sw_pix_fmt != AV_PIX_FMT_NONE)
-        return c->sw_pix_fmt;
+    static const struct
+    {
+        int log2ChromaW;
+        int log2ChromaH;
+        int depth;
+        AVPixelFormat planar;
+        AVPixelFormat semiPlanar;
+    } layouts[] = {
+        {1, 1, 8, AV_PIX_FMT_YUV420P, AV_PIX_FMT_NV12},
+        {1, 0, 8, AV_PIX_FMT_YUV422P, AV_PIX_FMT_NV16},
+        {0, 0, 8, AV_PIX_FMT_YUV444P, AV_PIX_FMT_NV24},
+        {1, 1, 10, AV_PIX_FMT_YUV420P10, AV_PIX_FMT_P010},
+        {1, 0, 10, AV_PIX_FMT_YUV422P10, AV_PIX_FMT_P210},
+        {0, 0, 10, AV_PIX_FMT_YUV444P10, AV_PIX_FMT_P410},
+        {1, 1, 12, AV_PIX_FMT_YUV420P12, AV_PIX_FMT_P012},
+        {1, 0, 12, AV_PIX_FMT_YUV422P12, AV_PIX_FMT_P212},
+        {0, 0, 12, AV_PIX_FMT_YUV444P12, AV_PIX_FMT_P412},
+    };
 
-    return c->pix_fmt;
+    const int depth = desc->comp[0].depth;
+    for (const auto& l : layouts) {
+        if (l.log2ChromaW != desc->log2_chroma_w || l.log2ChromaH != desc->log2_chroma_h || l.depth != depth)
+            continue;
+
+        const bool planar = !forceSemiPlanar && av_pix_fmt_count_planes(source) == 3;
+        const VkFormat one = depth > 8 ? VK_FORMAT_R16_UNORM : VK_FORMAT_R8_UNORM;
+        const VkFormat two = depth > 8 ? VK_FORMAT_R16G16_UNORM : VK_FORMAT_R8G8_UNORM;
+
+        out.swFormat = planar ? l.planar : l.semiPlanar;
+        out.planeFormats = planar ? std::array<VkFormat, 3>{one, one, one}
+                                  : std::array<VkFormat, 3>{one, two, VK_FORMAT_UNDEFINED};
+        return true;
+    }
+    return false;
 }
 
-bool DecoderVulkan::openInputAndCodec(const std::filesystem::path& videoPath)
+// Creates codecCtx->hw_frames_ctx with one image per plane in the given layout.
+static int initVulkanFramesContext(AVCodecContext* codecCtx, const SurfaceFormat& surface)
 {
+    AVBufferRef* hw_frames_ref = av_hwframe_ctx_alloc(codecCtx->hw_device_ctx);
+    if (!hw_frames_ref) {
+        throw std::runtime_error("[DecoderVulkan] av_hwframe_ctx_alloc failed.");
+    }
+    AVHWFramesContext* frames_ctx = (AVHWFramesContext*)(hw_frames_ref->data);
+    AVVulkanFramesContext* vk_frames_ctx = (AVVulkanFramesContext*)frames_ctx->hwctx;
+
+    frames_ctx->format = AV_PIX_FMT_VULKAN;
+    frames_ctx->sw_format = surface.swFormat;
+    frames_ctx->width = codecCtx->width;
+    frames_ctx->height = codecCtx->height;
+
+    // One single-plane format per image (Y, UV or Y, U, V)
+    for (size_t i = 0; i < surface.planeFormats.size(); ++i) {
+        vk_frames_ctx->format[i] = surface.planeFormats[i];
+    }
+
+    // Set the image usage flags required for video decoding
+    vk_frames_ctx->usage = static_cast<VkImageUsageFlagBits>(
+                           VK_IMAGE_USAGE_VIDEO_DECODE_DST_BIT_KHR |
+                           VK_IMAGE_USAGE_VIDEO_DECODE_DPB_BIT_KHR |
+                           VK_IMAGE_USAGE_SAMPLED_BIT |
+                           VK_IMAGE_USAGE_STORAGE_BIT |
+                           VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                           VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+
+    // Set image creation flags, including PROFILE_INDEPENDENT to resolve the VUID-VkImageCreateInfo-usage-04815 error.
+    vk_frames_ctx->img_flags = VK_IMAGE_CREATE_VIDEO_PROFILE_INDEPENDENT_BIT_KHR |
+                               VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT |
+                               VK_IMAGE_CREATE_ALIAS_BIT |
+                               VK_IMAGE_CREATE_EXTENDED_USAGE_BIT;
+
+    int ret = av_hwframe_ctx_init(hw_frames_ref);
+    if (ret >= 0) {
+        codecCtx->hw_frames_ctx = av_buffer_ref(hw_frames_ref);
+    }
+    av_buffer_unref(&hw_frames_ref);
+    return ret;
+}
+
+bool DecoderVulkan::openInputAndCodec(const std::filesystem::path& videoPath,
+                                      const std::optional<StreamReaderOptions>& streamOptions)
+{
+    if (streamOptions) {
+        streamReader = std::make_unique<StreamReader>(videoPath, *streamOptions);
+        AVIOContext* pb = streamReader->valid() ? streamReader->avioContext() : nullptr;
+        if (!pb) {
+            throw std::runtime_error("[DecoderVulkan] Failed to open stream: " + videoPath.string());
+        }
+        formatCtx = avformat_alloc_context();
+        formatCtx->pb = pb;
+        formatCtx->flags |= AVFMT_FLAG_CUSTOM_IO;
+    }
     if (avformat_open_input(&formatCtx, videoPath.string().c_str(), nullptr, nullptr) < 0) {
         throw std::runtime_error("[DecoderVulkan] Failed to open input: " + videoPath.string());
     }
@@ -258,6 +401,15 @@ bool DecoderVulkan::openInputAndCodec(const std::filesystem::path& videoPath)
     AVStream* videoStream = formatCtx->streams[videoStreamIndex];
     streamTimeBase = videoStream->time_base;
 
+    // Presentation time 0 is the stream's start; without one, the first frame's pts
+    if (videoStream->start_time != AV_NOPTS_VALUE) {
+        streamStartSeconds = static_cast<double>(videoStream->start_time) * av_q2d(streamTimeBase);
+        streamStartKnown = true;
+    } else if (formatCtx->start_time != AV_NOPTS_VALUE) {
+        streamStartSeconds = static_cast<double>(formatCtx->start_time) / static_cast<double>(AV_TIME_BASE);
+        streamStartKnown = true;
+    }
+
     const AVCodec* codec = avcodec_find_decoder(videoStream->codecpar->codec_id);
     if (!codec) {
         throw std::runtime_error("[DecoderVulkan] Decoder not found.");
@@ -278,47 +430,33 @@ bool DecoderVulkan::openInputAndCodec(const std::filesystem::path& videoPath)
     }
 
     // Manually create a hw_frames_ctx to override the image format selected by FFmpeg.
-    // The default format (VK_FORMAT_G8_B8R8_2PLANE_420_UNORM) used for NV12 is not
-    // supported by the user's driver for video decoding. We will force a 2-plane
-    // format using VK_FORMAT_R8_UNORM and VK_FORMAT_R8G8_UNORM, which is a common fallback.
-    AVBufferRef* hw_frames_ref = av_hwframe_ctx_alloc(codecCtx->hw_device_ctx);
-    if (!hw_frames_ref) {
-        throw std::runtime_error("[DecoderVulkan] av_hwframe_ctx_alloc failed.");
+    // The default multi-planar formats (e.g. VK_FORMAT_G8_B8R8_2PLANE_420_UNORM) are not
+    // supported by every driver for video decoding, so each plane gets its own image with a
+    // single- or two-channel format. The plane arrangement, subsampling and depth follow the
+    // source, so 4:2:2 / 4:4:4 and 3-plane streams reach the converters without a repack.
+    const AVPixelFormat sourceFormat = static_cast<AVPixelFormat>(videoStream->codecpar->format);
+    SurfaceFormat surface;
+    if (!surfaceFormatForSource(sourceFormat, false, surface)) {
+        if (sourceFormat != AV_PIX_FMT_NONE) {
+            throw std::runtime_error("[DecoderVulkan] No zero-copy Vulkan surface layout for " +
+                                     pixelFormatDescription(sourceFormat));
+        }
+        // Pixel format not probed (raw streams); 8-bit 4:2:0 is by far the common case.
+        surfaceFormatForSource(AV_PIX_FMT_NV12, true, surface);
     }
-    AVHWFramesContext* frames_ctx = (AVHWFramesContext*)(hw_frames_ref->data);
-    AVVulkanFramesContext* vk_frames_ctx = (AVVulkanFramesContext*)frames_ctx->hwctx;
-
-    frames_ctx->format = AV_PIX_FMT_VULKAN;
-    frames_ctx->sw_format = AV_PIX_FMT_NV12; // Assume NV12, which matches the failing format
-    frames_ctx->width = codecCtx->width;
-    frames_ctx->height = codecCtx->height;
-
-    // Set the Vulkan formats for the two planes of NV12
-    vk_frames_ctx->format[0] = VK_FORMAT_R8_UNORM;   // Y plane
-    vk_frames_ctx->format[1] = VK_FORMAT_R8G8_UNORM; // Interleaved UV plane
-
-    // Set the image usage flags required for video decoding
-    vk_frames_ctx->usage = static_cast<VkImageUsageFlagBits>(
-                           VK_IMAGE_USAGE_VIDEO_DECODE_DST_BIT_KHR |
-                           VK_IMAGE_USAGE_VIDEO_DECODE_DPB_BIT_KHR |
-                           VK_IMAGE_USAGE_SAMPLED_BIT |
-                           VK_IMAGE_USAGE_STORAGE_BIT |
-                           VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
-                           VK_IMAGE_USAGE_TRANSFER_DST_BIT);
-
-    // Set image creation flags, including PROFILE_INDEPENDENT to resolve the VUID-VkImageCreateInfo-usage-04815 error.
-    vk_frames_ctx->img_flags = VK_IMAGE_CREATE_VIDEO_PROFILE_INDEPENDENT_BIT_KHR |
-                               VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT |
-                               VK_IMAGE_CREATE_ALIAS_BIT |
-                               VK_IMAGE_CREATE_EXTENDED_USAGE_BIT;
 
-    int ret = av_hwframe_ctx_init(hw_frames_ref);
+    int ret = initVulkanFramesContext(codecCtx, surface);
+    if (ret < 0 && surface.planeFormats[2] != VK_FORMAT_UNDEFINED) {
+        // Some drivers only decode into two images; the semi-planar sibling keeps the
+        // subsampling and depth, and is still sampled in place.
+        std::cerr << "[DecoderVulkan] 3-plane " << av_get_pix_fmt_name(surface.swFormat)
+                  << " surfaces rejected (" << avErrStr(ret) << "), using semi-planar\n";
+        surfaceFormatForSource(sourceFormat, true, surface);
+        ret = initVulkanFramesContext(codecCtx, surface);
+    }
     if (ret < 0) {
-        av_buffer_unref(&hw_frames_ref);
         throw std::runtime_error("[DecoderVulkan] av_hwframe_ctx_init failed: " + avErrStr(ret));
     }
-    codecCtx->hw_frames_ctx = av_buffer_ref(hw_frames_ref);
-    av_buffer_unref(&hw_frames_ref);
 
     // Allow FFmpeg internal threading
     unsigned int hwThreads = std::thread::hardware_concurrency();
@@ -348,18 +486,37 @@ bool DecoderVulkan::openInputAndCodec(const std::filesystem::path& videoPath)
         durationSeconds = static_cast<double>(formatCtx->duration) / static_cast<double>(AV_TIME_BASE);
     }
 
-    // Pixel format config:
-    // Use sw_pix_fmt when decode output is AV_PIX_FMT_VULKAN.
-    const AVPixelFormat cfgFmt = chooseUsefulPixFmtForConfig(codecCtx);
+    // Pixel format config follows the surfaces the frames context hands out, not the
+    // codec's software format (the two differ once surfaces are semi-planar).
+    const AVPixelFormat cfgFmt = surface.swFormat;
     if (!configureFormatForPixelFormat(cfgFmt)) {
         throw std::runtime_error("[DecoderVulkan] Unsupported pixel format: " +
                                  pixelFormatDescription(cfgFmt));
     }
 
+    // Matrix and range the converters are specialised on. Untagged streams follow the usual
+    // player convention: BT.709 from 720 lines up, BT.601 below.
+    switch (codecCtx->colorspace) {
+    case AVCOL_SPC_BT709:
+        colorSpace = 1;
+        break;
+    case AVCOL_SPC_BT2020_NCL:
+    case AVCOL_SPC_BT2020_CL:
+        colorSpace = 2;
+        break;
+    case AVCOL_SPC_UNSPECIFIED:
+        colorSpace = height >= 720 ? 1 : 0;
+        break;
+    default:
+        colorSpace = 0;
+        break;
+    }
+    colorRange = codecCtx->color_range == AVCOL_RANGE_JPEG ? 1 : 0;
+
     // Helpful logging: shows both hw pix_fmt and sw_pix_fmt.
     std::cerr << "[DecoderVulkan] codecCtx->pix_fmt=" << pixelFormatDescription(codecCtx->pix_fmt)
               << " sw_pix_fmt=" << pixelFormatDescription(codecCtx->sw_pix_fmt)
-              << " (config fmt=" << pixelFormatDescription(cfgFmt) << ")\n";
+              << " (surface fmt=" << pixelFormatDescription(cfgFmt) << ")\n";
 
     return true;
 }
@@ -433,9 +590,10 @@ bool DecoderVulkan::initFFmpegVulkanDevice()
 
     vkctx->nb_qf = q;
 
-    // Let FFmpeg manage queue locking internally
-    vkctx->lock_queue = nullptr;
-    vkctx->unlock_queue = nullptr;
+    // Every decoder's device context wraps the engine's VkDevice; FFmpeg's default locks are
+    // per context, so several decoders (mosaic) would submit to the same VkQueue concurrently.
+    vkctx->lock_queue = lockSharedQueue;
+    vkctx->unlock_queue = unlockSharedQueue;
 
         // Extensions.
         // NOTE: Keeping Vulkan Video extensions enabled is what triggers FFmpeg/driver probing.
@@ -500,6 +658,7 @@ void DecoderVulkan::cleanupFFmpeg()
 
     if (codecCtx) avcodec_free_context(&codecCtx);
     if (formatCtx) avformat_close_input(&formatCtx);
+    streamReader.reset();
 }
 
 bool DecoderVulkan::configureFormatForPixelFormat(AVPixelFormat pix_fmt)
@@ -509,31 +668,41 @@ bool DecoderVulkan::configureFormatForPixelFormat(AVPixelFormat pix_fmt)
     const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(pix_fmt);
     if (!desc) return false;
 
-    chromaDivX = 1u << desc->log2_chroma_w;
-    chromaDivY = 1u << desc->log2_chroma_h;
+    chromaShiftX = static_cast<uint32_t>(desc->log2_chroma_w);
+    chromaShiftY = static_cast<uint32_t>(desc->log2_chroma_h);
+    chromaDivX = 1u << chromaShiftX;
+    chromaDivY = 1u << chromaShiftY;
 
     chromaWidth  = std::max<uint32_t>(1u, (width  + chromaDivX - 1) / chromaDivX);
     chromaHeight = std::max<uint32_t>(1u, (height + chromaDivY - 1) / chromaDivY);
 
-    swapChromaUV = false;
-    if (pix_fmt == AV_PIX_FMT_NV12) {
-        swapChromaUV = false;
+    const bool is420 = (desc->log2_chroma_w == 1 && desc->log2_chroma_h == 1);
+    const bool is422 = (desc->log2_chroma_w == 1 && desc->log2_chroma_h == 0);
+    const bool is444 = (desc->log2_chroma_w == 0 && desc->log2_chroma_h == 0);
+    if (! (is420 || is422 || is444)) {
+        throw std::runtime_error(
+            "[DecoderVulkan] Unsupported pixel format (only NV12/NV21/4:2:0, 4:2:2, 4:4:4 supported): " +
+            pixelFormatDescription(pix_fmt));
     }
-    else if (pix_fmt == AV_PIX_FMT_NV21) {
-        swapChromaUV = true;
+
+    swapChromaUV = (pix_fmt == AV_PIX_FMT_NV21);
+
+    // Two images (Y + interleaved chroma) go through Nv12ToRgbaPass at any subsampling,
+    // three images through the planar converter.
+    const int planeCount = av_pix_fmt_count_planes(pix_fmt);
+    if (planeCount == 2) {
+        yuvLayout = YuvLayout::NV12;
+    }
+    else if (planeCount == 3) {
+        yuvLayout = is420 ? YuvLayout::Planar420 : (is422 ? YuvLayout::Planar422 : YuvLayout::Planar444);
     }
     else {
-        // Accept common planar subsampling shapes if you later add planar support.
-        const bool is420 = (desc->log2_chroma_w == 1 && desc->log2_chroma_h == 1);
-        const bool is422 = (desc->log2_chroma_w == 1 && desc->log2_chroma_h == 0);
-        const bool is444 = (desc->log2_chroma_w == 0 && desc->log2_chroma_h == 0);
-        if (! (is420 || is422 || is444)) {
-            throw std::runtime_error(
-                "[DecoderVulkan] Unsupported pixel format (only NV12/NV21/4:2:0, 4:2:2, 4:4:4 supported): " +
-                pixelFormatDescription(pix_fmt));
-        }
+        throw std::runtime_error("[DecoderVulkan] Unsupported plane count for " + pixelFormatDescription(pix_fmt));
     }
 
+    // MSB-aligned 16-bit samples (P010) read back differently from LSB-aligned ones (yuv420p10)
+    sampleShift = static_cast<uint32_t>(desc->comp[0].shift);
+
     // FIX: compute max component depth (not just comp[0])
     int maxDepth = 0;
     for (int i = 0; i < desc->nb_components; ++i) {
@@ -559,6 +728,7 @@ bool DecoderVulkan::startAsyncDecoding()
 
     decodedQ.reset();
     candidate.reset();
+    lookahead.reset();
 
     asyncDecoding = true;
     decodeThread = std::thread(&DecoderVulkan::asyncDecodeLoop, this);
@@ -580,32 +750,20 @@ void DecoderVulkan::stopAsyncDecoding()
 
     decodedQ.reset();
     candidate.reset();
+    lookahead.reset();
 }
 
 void DecoderVulkan::asyncDecodeLoop()
 {
     try {
         while (!stopRequested.load()) {
-            DecodedFrame f;
-            if (!decodeNextFrame(f)) break;
-
-            // seek-drop logic
-            const int64_t target = seekTargetMicroseconds.load();
-            if (target >= 0) {
-                const int64_t micros = static_cast<int64_t>(f.ptsSeconds * 1'000'000.0);
-                if (micros < target) {
-                    continue; // drop
-                }
-                seekTargetMicroseconds.store(-1);
-            }
-
-            if (!f.vk.validate()) {
-                throw std::runtime_error("[DecoderVulkan] decoded frame missing/invalid Vulkan surface");
-            }
-
-            if (!decodedQ.push(std::move(f))) {
-                break; // stopped
+            // Full queue: prefill the frame cache while paused, otherwise wait for the consumer
+            if (!hasQueueSpace()) {
+                if (!prefillStep())
+                    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                continue;
             }
+            if (!produceFrame()) break;
         }
     } catch (const std::exception& e) {
         std::cerr << "[DecoderVulkan] asyncDecodeLoop exception: " << e.what() << std::endl;
@@ -615,6 +773,312 @@ void DecoderVulkan::asyncDecodeLoop()
     decodedQ.stop();
 }
 
+bool DecoderVulkan::produceFrame()
+{
+    updateFrameSkip();
+    if (reverse.load()) return produceReverseFrame();
+
+    // The playhead moves on; a later pause prefills around wherever it stops
+    prefillBehindDone = false;
+    prefillAheadFrames = 0;
+    prefillComplete.store(false);
+
+    DecodedFrame f;
+    if (takeCachedSuccessor(f)) return queueFrame(std::move(f));
+
+    if (!decoderPositioned) repositionDecoder();
+    if (!decodeFrame(f)) return false;
+
+    // seek-drop logic
+    const int64_t target = seekTargetMicroseconds.load();
+    if (target >= 0) {
+        const int64_t micros = static_cast<int64_t>(f.ptsSeconds * 1'000'000.0);
+        if (micros < target) {
+            return true; // drop
+        }
+        seekTargetMicroseconds.store(-1);
+    }
+
+    // Decoded again after a reposition: already queued from the cache
+    if (lastQueuedKnown && f.ptsMicros() <= static_cast<int64_t>(std::llround(lastQueuedPtsSeconds * 1'000'000.0))) {
+        return true;
+    }
+
+    if (!f.vk.validate()) {
+        throw std::runtime_error("[DecoderVulkan] decoded frame missing/invalid Vulkan surface");
+    }
+
+    return queueFrame(std::move(f));
+}
+
+bool DecoderVulkan::produceReverseFrame()
+{
+    if (reverseFrames.empty() && !decodeReverseSegment()) return false;
+
+    DecodedFrame f = std::move(reverseFrames.back());
+    reverseFrames.pop_back();
+    return queueFrame(std::move(f));
+}
+
+bool DecoderVulkan::queueFrame(DecodedFrame&& f)
+{
+    lastQueuedPtsSeconds = f.ptsSeconds;
+    lastQueuedKnown = true;
+    return decodedQ.push(std::move(f)); // false when stopped
+}
+
+bool DecoderVulkan::decodeFrame(DecodedFrame& out)
+{
+    if (!decodeNextFrame(out)) return false;
+    framesDecodedTotal.fetch_add(1);
+
+    // Only back-to-back full decodes form a cached run; skip_frame leaves gaps
+    const int64_t micros = out.ptsMicros();
+    const bool contiguous = frameSkip.load() == FrameSkip::None;
+    frameCache.insert(out, contiguous ? lastInsertedMicros : -1, surfaceBytes());
+    lastInsertedMicros = contiguous ? micros : -1;
+    lastDecodedMicros = micros;
+    return true;
+}
+
+bool DecoderVulkan::takeCachedSuccessor(DecodedFrame& out)
+{
+    int64_t next = cacheNextMicros;
+    cacheNextMicros = -1;
+    if (next < 0 && lastQueuedKnown) {
+        next = frameCache.next(static_cast<int64_t>(std::llround(lastQueuedPtsSeconds * 1'000'000.0)));
+    }
+    if (next < 0 || !frameCache.get(next, out)) return false;
+
+    // A codec that is ahead just has its duplicates dropped. One that is behind would decode
+    // the whole gap; past a keyframe interval re-seeking is cheaper.
+    if (decoderPositioned && lastDecodedMicros < next) {
+        const double gapSeconds = static_cast<double>(next - lastDecodedMicros) / 1'000'000.0;
+        decoderPositioned = keyframeIntervalSeconds > 0.0 && gapSeconds < keyframeIntervalSeconds;
+    }
+    return true;
+}
+
+void DecoderVulkan::repositionDecoder()
+{
+    decoderPositioned = true;
+    if (!lastQueuedKnown) return;
+
+    const int ret = seekToPts(lastQueuedPtsSeconds);
+    if (ret < 0) {
+        throw std::runtime_error("[DecoderVulkan] re-seek after cached frames failed: " + avErrStr(ret));
+    }
+    finished.store(false);
+}
+
+size_t DecoderVulkan::surfaceBytes() const
+{
+    const size_t luma = static_cast<size_t>(width) * height * static_cast<size_t>(bytesPerComponent);
+    return luma + 2 * (luma / (static_cast<size_t>(chromaDivX) * chromaDivY));
+}
+
+bool DecoderVulkan::wantsPrefill() const
+{
+    const MediaClock& clock = presentationClock();
+    return !prefillComplete.load() && !reverse.load() && clock.started() && clock.paused();
+}
+
+bool DecoderVulkan::prefillStep()
+{
+    if (!wantsPrefill()) return false;
+
+    // Prefill must not end the stream for the producer: EOF here is found again by decoding
+    const bool wasFinished = finished.load();
+    const double frameSeconds = fps > 0.0 ? (1.0 / fps) : (1.0 / 30.0);
+
+    if (!prefillBehindDone) {
+        // The run up to the playhead, so stepping back needs no decode
+        prefillBehindDone = true;
+        const double playhead = playheadPtsSeconds.load();
+        const double from = std::max(streamStartSeconds, playhead - static_cast<double>(kPrefillFrames) * frameSeconds);
+        if (seekToPts(from) >= 0) {
+            finished.store(false);
+            decoderPositioned = false;
+            const int64_t playheadMicros = static_cast<int64_t>(std::llround(playhead * 1'000'000.0));
+            DecodedFrame f;
+            while (!stopRequested.load() && decodeFrame(f)) {
+                if (f.ptsMicros() >= playheadMicros) break;
+            }
+        }
+        finished.store(wasFinished);
+        return true;
+    }
+
+    if (prefillAheadFrames < kPrefillFrames && !wasFinished) {
+        // Past the queued frames, cached only: produceFrame() serves them once playback resumes
+        if (!decoderPositioned) repositionDecoder();
+        DecodedFrame f;
+        if (!decodeFrame(f)) {
+            finished.store(wasFinished);
+            prefillComplete.store(true);
+            return true;
+        }
+        if (!lastQueuedKnown || f.ptsSeconds > lastQueuedPtsSeconds) prefillAheadFrames++;
+        return true;
+    }
+
+    prefillComplete.store(true);
+    return false;
+}
+
+bool DecoderVulkan::decodeReverseSegment()
+{
+    const double frameSeconds = fps > 0.0 ? (1.0 / fps) : (1.0 / 30.0);
+    if (reverseCursorSeconds <= streamStartSeconds + frameSeconds * 0.5) {
+        finished.store(true);
+        return false;
+    }
+
+    // Seek to the keyframe before the cursor and decode forwards up to it. A demuxer that lands
+    // at or after the cursor yields nothing; reach further back until something comes out.
+    double backoff = frameSeconds * 0.5;
+    while (reverseFrames.empty()) {
+        const double target = std::max(streamStartSeconds, reverseCursorSeconds - backoff);
+        const int ret = seekToPts(target);
+        if (ret < 0) {
+            throw std::runtime_error("[DecoderVulkan] reverse seek failed: " + avErrStr(ret));
+        }
+        finished.store(false);
+
+        DecodedFrame f;
+        while (!stopRequested.load() && decodeFrame(f)) {
+            if (f.ptsSeconds >= reverseCursorSeconds) break;
+            // Bounded: a long GOP keeps its last frames, and the earlier ones are decoded again
+            // as the next segment
+            if (reverseFrames.size() == kMaxReverseFrames)
+                reverseFrames.erase(reverseFrames.begin());
+            reverseFrames.push_back(std::move(f));
+        }
+        // Hitting EOF inside a segment does not end reverse playback
+        finished.store(false);
+        if (stopRequested.load()) return false;
+
+        if (reverseFrames.empty()) {
+            if (target <= streamStartSeconds) {
+                finished.store(true);
+                return false;
+            }
+            backoff *= 2.0;
+        }
+    }
+
+    reverseCursorSeconds = reverseFrames.front().ptsSeconds;
+    return true;
+}
+
+int DecoderVulkan::seekToPts(double ptsSeconds)
+{
+    AVStream* st = formatCtx->streams[videoStreamIndex];
+    const int64_t targetTs =
+        av_rescale_q(static_cast<int64_t>(ptsSeconds * AV_TIME_BASE),
+                     AV_TIME_BASE_Q,
+                     st->time_base);
+
+    const int ret = avformat_seek_file(formatCtx,
+                                       videoStreamIndex,
+                                       std::numeric_limits<int64_t>::min(),
+                                       targetTs,
+                                       targetTs,
+                                       AVSEEK_FLAG_BACKWARD);
+    if (ret < 0) return ret;
+
+    avcodec_flush_buffers(codecCtx);
+    avformat_flush(formatCtx);
+    draining.store(false);
+    lastKeyframePtsSeconds = -1.0;
+    lastInsertedMicros = -1;
+    return ret;
+}
+
+void DecoderVulkan::updateFrameSkip()
+{
+    const FrameSkip previous = frameSkip.load();
+    const FrameSkip skip = frameSkipForRate(playbackRate.load(), fps, keyframeIntervalSeconds);
+    if (skip == previous) return;
+
+    applyFrameSkip(skip);
+    if (renderDebugEnabled())
+        std::cout << "[DecoderVulkan] " << playbackRate.load() << "x: skipping " << frameSkipName(skip) << " frames\n";
+
+    // Leaving keyframes-only going forwards, the next packets reference frames that were never
+    // decoded: restart at the keyframe before the last queued frame and drop up to it
+    if (previous == FrameSkip::KeyframesOnly && !reverse.load() && framesDecoded > 0) {
+        if (seekToPts(lastQueuedPtsSeconds) >= 0)
+            seekTargetMicroseconds.store(static_cast<int64_t>(lastQueuedPtsSeconds * 1'000'000.0) + 1);
+    }
+}
+
+void DecoderVulkan::applyFrameSkip(FrameSkip skip)
+{
+    codecCtx->skip_frame = skip == FrameSkip::KeyframesOnly ? AVDISCARD_NONKEY
+                         : skip == FrameSkip::NonReference  ? AVDISCARD_NONREF
+                                                            : AVDISCARD_DEFAULT;
+    // Keyframes-only lets the demuxer drop the other packets before they are even read
+    formatCtx->streams[videoStreamIndex]->discard =
+        skip == FrameSkip::KeyframesOnly ? AVDISCARD_NONKEY : AVDISCARD_DEFAULT;
+    frameSkip.store(skip);
+}
+
+bool DecoderVulkan::decodeKeyframeAt(double seconds, DecodedFrame& out)
+{
+    if (!formatCtx || !codecCtx) return false;
+    if (asyncDecoding) {
+        throw std::runtime_error("[DecoderVulkan] decodeKeyframeAt needs the decode thread stopped");
+    }
+    std::lock_guard<std::mutex> stepLock(stepMutex);
+
+    if (frameSkip.load() != FrameSkip::KeyframesOnly) applyFrameSkip(FrameSkip::KeyframesOnly);
+
+    // Only keyframes come out, so the first frame after the backward seek is the one at or before
+    if (seekToPts(std::max(0.0, seconds) + streamStartSeconds) < 0) return false;
+    finished.store(false);
+    decoderPositioned = false;
+    if (!decodeFrame(out)) return false;
+
+    if (engine && !waitForVulkanFrameReady(out.vk)) {
+        throw std::runtime_error("[DecoderVulkan] vkWaitSemaphores failed for a keyframe");
+    }
+    return true;
+}
+
+double DecoderVulkan::indexedKeyframeAt(double seconds) const
+{
+    if (!formatCtx || videoStreamIndex < 0) return -1.0;
+
+    AVStream* st = formatCtx->streams[videoStreamIndex];
+    const int64_t ts = av_rescale_q(static_cast<int64_t>((std::max(0.0, seconds) + streamStartSeconds) * AV_TIME_BASE),
+                                    AV_TIME_BASE_Q,
+                                    st->time_base);
+    const int index = av_index_search_timestamp(st, ts, AVSEEK_FLAG_BACKWARD);
+    const AVIndexEntry* entry = index >= 0 ? avformat_index_get_entry(st, index) : nullptr;
+    if (!entry) return -1.0;
+    return std::max(0.0, static_cast<double>(entry->timestamp) * av_q2d(st->time_base) - streamStartSeconds);
+}
+
+bool DecoderVulkan::decodeStep()
+{
+    std::lock_guard<std::mutex> lk(stepMutex);
+    if (finished.load() || stopRequested.load()) return false;
+
+    try {
+        // Full queue: only prefill work (while paused) is left
+        if (!hasQueueSpace()) {
+            prefillStep();
+            return true;
+        }
+        if (produceFrame()) return true;
+    } catch (const std::exception& e) {
+        std::cerr << "[DecoderVulkan] decodeStep exception: " << e.what() << std::endl;
+    }
+    finished.store(true);
+    return false;
+}
+
 // ------------------------------
 // Decode one frame (keeps AVFrame alive in DecodedFrame)
 // ------------------------------
@@ -654,10 +1118,14 @@ bool DecoderVulkan::decodeNextFrame(DecodedFrame& out)
                 height = static_cast<uint32_t>(frame->height);
             }
 
-            // When hwaccel is used, frameFmt is AV_PIX_FMT_VULKAN; configureFormat must be based on sw_format.
+            // When hwaccel is used, frameFmt is AV_PIX_FMT_VULKAN; configureFormat must be based on
+            // the frames context's sw_format (the surface layout, not the codec's software format).
             // If the underlying sw format changes (rare, but can happen), update config.
-            const AVPixelFormat cfgFmt = (frameFmt == AV_PIX_FMT_VULKAN)
-                ? codecCtx->sw_pix_fmt
+            const AVHWFramesContext* hwFrames = frame->hw_frames_ctx
+                ? reinterpret_cast<const AVHWFramesContext*>(frame->hw_frames_ctx->data)
+                : nullptr;
+            const AVPixelFormat cfgFmt = (frameFmt == AV_PIX_FMT_VULKAN && hwFrames)
+                ? hwFrames->sw_format
                 : frameFmt;
 
             if (cfgFmt != sourcePixelFormat) {
@@ -698,7 +1166,9 @@ bool DecoderVulkan::decodeNextFrame(DecodedFrame& out)
             while (nb_images < AV_NUM_DATA_POINTERS && vkf->img[nb_images]) nb_images++;
             out.vk.planes = std::min<uint32_t>(static_cast<uint32_t>(std::max(nb_images, 0)), 3u);
 
-            const VkFormat* vkFormats = av_vkfmt_from_pixfmt(codecCtx->sw_pix_fmt);
+            const AVVulkanFramesContext* vkFrames = hwFrames
+                ? static_cast<const AVVulkanFramesContext*>(hwFrames->hwctx)
+                : nullptr;
 
             for (uint32_t i = 0; i < out.vk.planes; ++i) {
                 out.vk.images[i] = vkf->img[i];
@@ -706,7 +1176,7 @@ bool DecoderVulkan::decodeNextFrame(DecodedFrame& out)
                 out.vk.semaphores[i] = vkf->sem[i];
                 out.vk.semaphoreValues[i] = vkf->sem_value[i];
                 out.vk.queueFamily[i] = vkf->queue_family[i];
-                out.vk.planeFormats[i] = vkFormats ? vkFormats[i] : VK_FORMAT_UNDEFINED;
+                out.vk.planeFormats[i] = vkFrames ? vkFrames->format[i] : VK_FORMAT_UNDEFINED;
             }
 
             // Compute PTS seconds
@@ -726,6 +1196,13 @@ bool DecoderVulkan::decodeNextFrame(DecodedFrame& out)
             framesDecoded++;
             out.ptsSeconds = ptsSeconds;
 
+            // Keyframe spacing, for the keyframes-only decision
+            if (out.avFrame->flags & AV_FRAME_FLAG_KEY) {
+                if (lastKeyframePtsSeconds >= 0.0 && ptsSeconds > lastKeyframePtsSeconds)
+                    keyframeIntervalSeconds = ptsSeconds - lastKeyframePtsSeconds;
+                lastKeyframePtsSeconds = ptsSeconds;
+            }
+
             av_frame_unref(frame);
             return true;
         }
@@ -780,6 +1257,10 @@ void DecoderVulkan::destroyExternalVideoViews()
         vkDestroyImageView(engine->logicalDevice, externalChromaView, nullptr);
         externalChromaView = VK_NULL_HANDLE;
     }
+    if (externalChromaCrView != VK_NULL_HANDLE) {
+        vkDestroyImageView(engine->logicalDevice, externalChromaCrView, nullptr);
+        externalChromaCrView = VK_NULL_HANDLE;
+    }
     usingExternal = false;
 }
 
@@ -844,20 +1325,20 @@ bool DecoderVulkan::createExternalViewsFromSurface(const VulkanSurface& s)
     externalLumaView = createImageView(s.images[0], f0, VK_IMAGE_ASPECT_COLOR_BIT);
 
     if (s.planes > 1) {
-        // For 2-plane NV12, chroma is interleaved UV (R8G8)
-        // For 3-plane YUV420P, we might want to create separate U and V views,
-        // but the current pipeline expects only 2 views (luma + chroma).
-        // For now, create chroma view from plane 1 (U plane for 3-plane).
+        // 2-plane: interleaved CbCr (R8G8 / R16G16); 3-plane: Cb alone
         VkFormat f1 = s.planeFormats[1] != VK_FORMAT_UNDEFINED ? s.planeFormats[1] : VK_FORMAT_R8_UNORM;
         externalChromaView = createImageView(s.images[1], f1, VK_IMAGE_ASPECT_COLOR_BIT);
     }
 
-    // TODO: For 3-plane YUV420P, we might need to handle plane 2 (V) separately
-    // or modify the compute shader to sample from 3 separate textures.
+    if (s.planes > 2) {
+        VkFormat f2 = s.planeFormats[2] != VK_FORMAT_UNDEFINED ? s.planeFormats[2] : VK_FORMAT_R8_UNORM;
+        externalChromaCrView = createImageView(s.images[2], f2, VK_IMAGE_ASPECT_COLOR_BIT);
+    }
 
     usingExternal =
         (externalLumaView != VK_NULL_HANDLE) &&
-        (s.planes == 1 || externalChromaView != VK_NULL_HANDLE);
+        (s.planes == 1 || externalChromaView != VK_NULL_HANDLE) &&
+        (s.planes < 3 || externalChromaCrView != VK_NULL_HANDLE);
 
     return usingExternal;
 }
@@ -867,83 +1348,108 @@ bool DecoderVulkan::createExternalViewsFromSurface(const VulkanSurface& s)
 // ------------------------------
 void DecoderVulkan::resetPlaybackClock()
 {
-    clockInitialized = false;
-    firstPtsSeconds = 0.0;
-    lastFramePtsSeconds = 0.0;
-    lastDisplayedSeconds = 0.0;
+    // Drop held frames; whatever arrives next is latched immediately
     candidate.reset();
+    lookahead.reset();
+    latchPending = true;
 }
 
-void DecoderVulkan::updatePlaybackTimestamps(const DecodedFrame& frame, std::chrono::steady_clock::time_point now)
+void DecoderVulkan::setPlaying(bool p)
 {
-    lastFramePtsSeconds = frame.ptsSeconds;
-    lastFrameRenderWall = now;
-    lastDisplayedSeconds = std::max(0.0, frame.ptsSeconds - firstPtsSeconds);
+    // A master clock is paused by its owner, for every stream at once
+    if (masterClock) return;
+
+    if (!p) {
+        ownClock.start();
+        ownClock.pause();
+    } else if (ownClock.started()) {
+        ownClock.resume();
+    }
 }
 
-bool DecoderVulkan::shouldDisplayNow(const DecodedFrame& frame, std::chrono::steady_clock::time_point now) const
+bool DecoderVulkan::isDue(const DecodedFrame& frame, double clockSeconds) const
 {
-    if (!clockInitialized) return true;
+    // Backwards, a frame is up while the clock is inside [pts, pts + frame) counting down
+    if (reverse.load()) {
+        const double frameSeconds = fps > 0.0 ? (1.0 / fps) : (1.0 / 30.0);
+        return presentationSeconds(frame) + frameSeconds > clockSeconds + 0.001;
+    }
+    return presentationSeconds(frame) <= clockSeconds + 0.001;
+}
 
-    const double ptsOffset = frame.ptsSeconds - firstPtsSeconds;
-    const auto target = playbackStartWall + std::chrono::duration<double>(ptsOffset);
+void DecoderVulkan::setPlaybackRate(double rate)
+{
+    const double speed = std::abs(rate);
+    if (!(speed >= kMinPlaybackRate && speed <= kMaxPlaybackRate)) {
+        throw std::runtime_error("[DecoderVulkan] playback rate must be 0.25x..16x in either direction");
+    }
+
+    const bool flip = (rate < 0.0) != (playbackRate.load() < 0.0);
+    playbackRate.store(rate);
+    if (!masterClock) ownClock.setRate(rate);
 
-    return (now + std::chrono::milliseconds(1) >= target);
+    // Queued frames run the other way; start again from what is on screen
+    if (flip) seek(static_cast<float>(lastDisplayedSeconds));
 }
 
-void DecoderVulkan::dropLateFrames(std::chrono::steady_clock::time_point now)
+bool DecoderVulkan::takeQueuedFrame(std::optional<DecodedFrame>& slot)
 {
-    if (!clockInitialized) return;
-
-    while (true) {
-        DecodedFrame tmp;
-        if (!decodedQ.try_pop(tmp)) break;
+    DecodedFrame f;
+    if (!decodedQ.try_pop(f)) return false;
+    slot = std::move(f);
+    return true;
+}
 
-        const double ptsOffset = tmp.ptsSeconds - firstPtsSeconds;
-        const auto target = playbackStartWall + std::chrono::duration<double>(ptsOffset);
+DecoderVulkan::SyncStats DecoderVulkan::getSyncStats() const
+{
+    SyncStats out = syncStats;
+    out.meanAbsDriftMs = driftSamples > 0 ? driftAbsSumMs / static_cast<double>(driftSamples) : 0.0;
+    return out;
+}
 
-        if (now + std::chrono::milliseconds(1) >= target) {
-            continue; // drop
-        } else {
-            candidate = std::move(tmp);
-            break;
-        }
-    }
+void DecoderVulkan::updatePlaybackTimestamps(const DecodedFrame& frame, double clockSeconds, bool sampleDrift)
+{
+    lastFramePtsSeconds = frame.ptsSeconds;
+    playheadPtsSeconds.store(frame.ptsSeconds);
+    lastDisplayedSeconds = std::max(0.0, presentationSeconds(frame));
+    syncStats.presented++;
+
+    if (!sampleDrift) return;
+    const double driftMs = (presentationSeconds(frame) - clockSeconds) * 1000.0;
+    syncStats.lastDriftMs = driftMs;
+    syncStats.maxAbsDriftMs = std::max(syncStats.maxAbsDriftMs, std::abs(driftMs));
+    driftAbsSumMs += std::abs(driftMs);
+    driftSamples++;
 }
 
 double DecoderVulkan::advancePlayback()
 {
-    if (!playing) return lastDisplayedSeconds;
+    // A shared clock starts once every stream has a frame; hold the first one until then
+    if (masterClock && !masterClock->started()) return lastDisplayedSeconds;
 
-    auto now = std::chrono::steady_clock::now();
+    const auto now = std::chrono::steady_clock::now();
+    if (!candidate && !takeQueuedFrame(candidate)) return lastDisplayedSeconds;
 
-    if (!candidate) {
-        DecodedFrame f;
-        if (!decodedQ.try_pop(f)) {
-            return lastDisplayedSeconds;
-        }
-        candidate = std::move(f);
+    if (!streamStartKnown) {
+        streamStartSeconds = candidate->ptsSeconds;
+        streamStartKnown = true;
     }
 
-    if (!clockInitialized) {
-        clockInitialized = true;
-        firstPtsSeconds = candidate->ptsSeconds;
-        playbackStartWall = now;
-    }
-
-    {
-        const double ptsOffset = candidate->ptsSeconds - firstPtsSeconds;
-        const auto target = playbackStartWall + std::chrono::duration<double>(ptsOffset);
-        if (now - target > std::chrono::milliseconds(50)) {
-            dropLateFrames(now);
-            if (!candidate) return lastDisplayedSeconds;
+    // After open / seek the first frame goes up at once; otherwise pick the newest due frame,
+    // whose display interval [pts, next pts) contains the clock
+    const bool forced = latchPending;
+    if (!forced) {
+        const double clock = presentationClock().seconds(now);
+        if (!isDue(*candidate, clock)) return lastDisplayedSeconds;
+
+        while (lookahead || takeQueuedFrame(lookahead)) {
+            if (!isDue(*lookahead, clock)) break;
+            candidate = std::move(lookahead);
+            lookahead.reset();
+            syncStats.dropped++;
         }
     }
 
-    if (!shouldDisplayNow(*candidate, now)) {
-        return lastDisplayedSeconds;
-    }
-
     if (engine && candidate->vk.validate()) {
         if (!waitForVulkanFrameReady(candidate->vk)) {
             std::cerr << "[DecoderVulkan] vkWaitSemaphores failed\n";
@@ -952,8 +1458,21 @@ double DecoderVulkan::advancePlayback()
         }
     }
 
-    updatePlaybackTimestamps(*candidate, now);
+    // The own clock runs from the first frame actually shown, not from open()
+    if (!masterClock && !ownClock.started()) ownClock.start(now);
+    updatePlaybackTimestamps(*candidate, presentationClock().seconds(now), !forced);
+
     candidate.reset();
+    if (lookahead) {
+        candidate = std::move(lookahead);
+        lookahead.reset();
+    }
+
+    latchPending = false;
+    if (resumeOwnClock) {
+        ownClock.resume(now);
+        resumeOwnClock = false;
+    }
     return lastDisplayedSeconds;
 }
 
@@ -968,43 +1487,72 @@ bool DecoderVulkan::seek(float timeSeconds)
 
     const bool wasAsync = asyncDecoding;
     if (wasAsync) stopAsyncDecoding();
+    std::lock_guard<std::mutex> stepLock(stepMutex);
 
     decodedQ.reset();
-    seekTargetMicroseconds.store(static_cast<int64_t>(timeSeconds * 1'000'000.0));
-
-    AVStream* st = formatCtx->streams[videoStreamIndex];
-    const int64_t targetTs =
-        av_rescale_q(static_cast<int64_t>(timeSeconds * AV_TIME_BASE),
-                     AV_TIME_BASE_Q,
-                     st->time_base);
-
-    const int ret = avformat_seek_file(formatCtx,
-                                       videoStreamIndex,
-                                       std::numeric_limits<int64_t>::min(),
-                                       targetTs,
-                                       targetTs,
-                                       AVSEEK_FLAG_BACKWARD);
-    if (ret < 0) {
+    reverseFrames.clear();
+    cacheNextMicros = -1;
+    lastQueuedKnown = false;
+    prefillBehindDone = false;
+    prefillAheadFrames = 0;
+    prefillComplete.store(false);
+
+    // Direction only changes here, with the producer stopped
+    reverse.store(playbackRate.load() < 0.0);
+
+    // Presentation time -> stream pts
+    const double targetPtsSeconds = static_cast<double>(timeSeconds) + streamStartSeconds;
+    const int64_t halfFrameMicros = static_cast<int64_t>(500'000.0 / std::max(fps, 1.0));
+    const int64_t cacheHit = reverse.load()
+        ? -1
+        : frameCache.find(static_cast<int64_t>(std::llround(targetPtsSeconds * 1'000'000.0)), halfFrameMicros);
+    if (reverse.load()) {
+        // decodeReverseSegment() seeks for itself; the frame on screen at the target comes first
+        const double frameSeconds = fps > 0.0 ? (1.0 / fps) : (1.0 / 30.0);
+        seekTargetMicroseconds.store(-1);
+        reverseCursorSeconds = targetPtsSeconds + frameSeconds * 0.5;
+    } else if (cacheHit >= 0) {
+        // In a cached run: served from the cache, the codec follows once the run ends
         seekTargetMicroseconds.store(-1);
-        if (wasAsync) startAsyncDecoding();
-        throw std::runtime_error("[DecoderVulkan] seek failed: " + avErrStr(ret));
+        cacheNextMicros = cacheHit;
+        decoderPositioned = false;
+    } else {
+        seekTargetMicroseconds.store(static_cast<int64_t>(targetPtsSeconds * 1'000'000.0));
+        const int ret = seekToPts(targetPtsSeconds);
+        if (ret < 0) {
+            seekTargetMicroseconds.store(-1);
+            if (wasAsync) startAsyncDecoding();
+            throw std::runtime_error("[DecoderVulkan] seek failed: " + avErrStr(ret));
+        }
+        decoderPositioned = true;
     }
 
-    avcodec_flush_buffers(codecCtx);
-    avformat_flush(formatCtx);
-
     finished.store(false);
     draining.store(false);
     framesDecoded = 0;
-    fallbackPtsSeconds = timeSeconds;
+    fallbackPtsSeconds = targetPtsSeconds;
 
     destroyExternalVideoViews();
     resetPlaybackClock();
+    lastDisplayedSeconds = timeSeconds;
+
+    // Hold the own clock at the target until the first frame from there is up
+    if (!masterClock) {
+        resumeOwnClock = resumeOwnClock || (ownClock.started() && !ownClock.paused());
+        ownClock.pause();
+        ownClock.seek(timeSeconds);
+    }
 
     if (wasAsync) startAsyncDecoding();
     return true;
 }
 
+bool DecoderVulkan::stepFrames(int count)
+{
+    const double frameSeconds = fps > 0.0 ? (1.0 / fps) : (1.0 / 30.0);
+    return seek(static_cast<float>(std::max(0.0, lastDisplayedSeconds + count * frameSeconds)));
+}
+
 // ------------------------------
 // Benchmark helper (decode-only)
 // ------------------------------
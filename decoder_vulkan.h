@@ -4,10 +4,12 @@
 #include <array>
 #include <atomic>
 #include <chrono>
+#include <cmath>
 #include <condition_variable>
 #include <cstdint>
 #include <deque>
 #include <filesystem>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <string>
@@ -18,6 +20,10 @@
 #include <libavutil/pixfmt.h>
 #include <libavutil/rational.h>
 
+#include "frame_cache.h"
+#include "media_clock.h"
+#include "stream_reader.h"
+
 // Forward decl
 class Engine2D;
 
@@ -81,6 +87,10 @@ struct DecodedFrame
     DecodedFrame& operator=(DecodedFrame&& other) noexcept;
 
     void reset();
+    // Makes this a second reference to other's surface (no copy); false if FFmpeg refuses
+    bool ref(const DecodedFrame& other);
+    // Cache / ordering key
+    int64_t ptsMicros() const { return static_cast<int64_t>(std::llround(ptsSeconds * 1'000'000.0)); }
 };
 
 // Simple bounded queue for decoded frames (producer/consumer).
@@ -111,8 +121,8 @@ private:
 // (This is not the old PrimitiveYuvFormat; it’s local to this decoder.)
 enum class YuvLayout
 {
-    NV12,      // NV12/NV21 two-plane interleaved chroma
-    Planar420, // 4:2:0 planar (3 planes logically; FFmpeg Vulkan decode may still expose 2 images depending on impl)
+    NV12,      // two images, Y + interleaved chroma (NV12/NV21/NV16/NV24/P010...), any subsampling
+    Planar420, // three images Y, Cb, Cr
     Planar422,
     Planar444,
     Unknown
@@ -122,8 +132,19 @@ class DecoderVulkan
 {
 public:
     static constexpr size_t kBufferedFrames = 10;
-
-    DecoderVulkan(const std::filesystem::path& videoPath, Engine2D* eng);
+    // Frames of one reverse segment held back (GPU surfaces) for playing backwards; a longer GOP
+    // is decoded again for each earlier part of it
+    static constexpr size_t kMaxReverseFrames = 24;
+    // Frames prefilled into the frame cache on each side of a paused playhead (about a second
+    // at 30 fps; a guess, not yet sized against real stepping patterns)
+    static constexpr size_t kPrefillFrames = 30;
+    static constexpr double kMinPlaybackRate = 0.25;
+    static constexpr double kMaxPlaybackRate = 16.0;
+
+    // With streamOptions set, input is read through a StreamReader (pipes, stdin "-",
+    // growing files) instead of FFmpeg's own file protocol.
+    DecoderVulkan(const std::filesystem::path& videoPath, Engine2D* eng,
+                  const std::optional<StreamReaderOptions>& streamOptions = std::nullopt);
     ~DecoderVulkan();
 
     DecoderVulkan(const DecoderVulkan&) = delete;
@@ -138,10 +159,26 @@ public:
     int getHeight() const { return static_cast<int>(height); }
     double getFps() const { return fps; }
     double getDurationSeconds() const { return durationSeconds; }
+    int getBitDepth() const { return bitDepth; }
+
+    // Surface layout of the decoded frames; selects the converter (Nv12ToRgbaPass for NV12,
+    // Yuv420pToRgbaPass for the planar layouts).
+    YuvLayout getYuvLayout() const { return yuvLayout; }
+    uint32_t getChromaShiftX() const { return chromaShiftX; } // log2 horizontal subsampling
+    uint32_t getChromaShiftY() const { return chromaShiftY; } // log2 vertical subsampling
+    int getChromaWidth() const { return static_cast<int>(chromaWidth); }
+    int getChromaHeight() const { return static_cast<int>(chromaHeight); }
+    // Bit position of >8-bit samples in their 16-bit words (6 for P010, 0 for yuv420p10)
+    uint32_t getSampleShift() const { return sampleShift; }
+    bool getSwapChromaUV() const { return swapChromaUV; }
+    // Converter convention: 0=BT.601, 1=BT.709, 2=BT.2020; range 0=limited, 1=full
+    int getColorSpace() const { return colorSpace; }
+    int getColorRange() const { return colorRange; }
 
     // Output views (rebuilt per presented frame)
     VkImageView externalLumaView = VK_NULL_HANDLE;
-    VkImageView externalChromaView = VK_NULL_HANDLE;
+    VkImageView externalChromaView = VK_NULL_HANDLE;   // CbCr (2-plane) or Cb (3-plane)
+    VkImageView externalChromaCrView = VK_NULL_HANDLE; // Cr, 3-plane surfaces only
     VkSampler sampler = VK_NULL_HANDLE;
 
     // Latched surface metadata for the currently displayed frame.
@@ -158,19 +195,94 @@ public:
     void stopAsyncDecoding();
     bool isStopRequested() const { return stopRequested.load(); }
 
+    // Pooled decoding (DecodeThreadPool) instead of startAsyncDecoding(): a pool worker calls
+    // decodeStep() while the queue has room; it decodes and queues one frame. Returns false
+    // once the stream is exhausted; isFinished() stays true until the next seek().
+    bool decodeStep();
+    bool isFinished() const { return finished.load(); }
+    bool hasQueueSpace() const { return decodedQ.size() < kBufferedFrames; }
+    // Work for decodeStep() even with a full queue: prefilling the frame cache while paused
+    bool wantsPrefill() const;
+    bool hasQueuedFrame() const { return candidate.has_value() || lookahead.has_value() || decodedQ.size() > 0; }
+
     // Playback (consumer side)
-    // Returns "seconds displayed since playback start".
+    // Latches the frame whose presentation interval contains the clock's time (the newest
+    // queued frame with pts <= clock; older due frames are skipped) and returns the latched
+    // frame's presentation time in seconds.
     double advancePlayback();
+    // Seeks the stream to presentation time `timeSeconds`. The next decoded frame is latched
+    // as soon as it arrives, whatever the clock says; the decoder's own clock (no master) is
+    // moved along with it and resumes once that frame is up.
     bool seek(float timeSeconds);
+    // Seeks `count` frames from the displayed one (negative: back).
+    bool stepFrames(int count);
+    // Presentation time of the frame on screen (a seek's target until its frame is up)
+    double displayedSeconds() const { return lastDisplayedSeconds; }
     void resetPlaybackClock();
 
-    // Optional: allow consumer to toggle playback without killing decode thread.
-    void setPlaying(bool p) { playing = p; }
-    bool isPlaying() const { return playing; }
+    // Every decoded frame is also kept by reference in a FrameCache, up to a byte budget, and
+    // the decode thread prefills it around the playhead while the clock is paused. A seek or
+    // step landing in a cached run is served from it without decoding, and playback carries on
+    // through the run the same way; the codec is only re-positioned once the run ends.
+    void setFrameCacheBudget(size_t bytes) { frameCache.setBudget(bytes); }
+    FrameCache::Stats getFrameCacheStats() const { return frameCache.stats(); }
+
+    // Pause / resume the decoder's own clock; with a master clock its owner does this.
+    void setPlaying(bool p);
+    bool isPlaying() const { return !presentationClock().paused(); }
+
+    // Present against a shared clock instead of this decoder's own. Frames are not latched
+    // until the clock has been started.
+    void setMasterClock(const MediaClock* clock) { masterClock = clock; }
+    const MediaClock& presentationClock() const { return masterClock ? *masterClock : ownClock; }
+
+    // Frame times are pts minus this (the stream's start time)
+    double getStreamStartSeconds() const { return streamStartSeconds; }
+
+    // True from a seek (or open) until its first frame has been latched.
+    bool awaitingFrame() const { return latchPending; }
+
+    // Consumer-side sync. Drift is the latched frame's presentation time minus the clock when it
+    // was latched (negative: late); frames after a seek are not sampled.
+    struct SyncStats
+    {
+        uint64_t presented = 0;
+        uint64_t dropped = 0; // due frames superseded by a newer due frame before being shown
+        double lastDriftMs = 0.0;
+        double meanAbsDriftMs = 0.0;
+        double maxAbsDriftMs = 0.0;
+    };
+    SyncStats getSyncStats() const;
+    uint64_t getFramesDecoded() const { return framesDecodedTotal.load(); }
+
+    // Playback speed, kMinPlaybackRate..kMaxPlaybackRate either way; negative plays backwards
+    // (GOPs decoded forwards, one segment at a time, and queued in reverse). Sets the own
+    // clock's rate; with a master clock its owner sets that and calls this on every stream.
+    // Changing direction re-seeks to the displayed frame. Throws std::runtime_error out of range.
+    void setPlaybackRate(double rate);
+    double getPlaybackRate() const { return playbackRate.load(); }
+
+    // What the codec skips at the current speed (AVCodecContext::skip_frame). Once the clock
+    // outruns the display, frames are dropped anyway, so those nothing references (typically
+    // B-frames) are not decoded; when keyframes alone still update the picture often enough,
+    // only keyframes are read at all.
+    enum class FrameSkip { None, NonReference, KeyframesOnly };
+    FrameSkip getFrameSkip() const { return frameSkip.load(); }
+
+    // Scrubber thumbnails (ThumbnailStrip): decodes the keyframe at or before presentation time
+    // `seconds` with every other frame skipped, and waits until its surface can be sampled.
+    // Synchronous, for a decoder that is not decoding asynchronously; keyframes-only stays set
+    // until playback picks the skip level again. False at end of stream or if the seek fails.
+    bool decodeKeyframeAt(double seconds, DecodedFrame& out);
+    // Presentation time of the keyframe the demuxer's index lists at or before `seconds`, or a
+    // negative value if the container has no index. Two times with the same keyframe show the
+    // same picture in a keyframes-only decode, found here without seeking or decoding.
+    double indexedKeyframeAt(double seconds) const;
 
 private:
     // ---- FFmpeg setup / teardown ----
-    bool openInputAndCodec(const std::filesystem::path& videoPath);
+    bool openInputAndCodec(const std::filesystem::path& videoPath,
+                           const std::optional<StreamReaderOptions>& streamOptions);
     bool initFFmpegVulkanDevice();
     void cleanupFFmpeg();
 
@@ -182,6 +294,28 @@ private:
 
     // ---- Async decode loop ----
     void asyncDecodeLoop();
+    // Decodes one frame (applying the seek drop) and queues it; false at end of stream / stop
+    bool produceFrame();
+    // decodeNextFrame() plus decode accounting and frame cache insertion
+    bool decodeFrame(DecodedFrame& out);
+    bool queueFrame(DecodedFrame&& f);
+    // The frame after the last queued one, if the cache has it linked (no decode)
+    bool takeCachedSuccessor(DecodedFrame& out);
+    // Codec back to the last queued frame after frames came from the cache; frames up to it
+    // are decoded again and dropped
+    void repositionDecoder();
+    // One unit of cache prefill around a paused playhead; false when there is nothing to do
+    bool prefillStep();
+    size_t surfaceBytes() const;
+    // Reverse: queues the next-earlier frame, decoding the segment before it when empty
+    bool produceReverseFrame();
+    bool decodeReverseSegment();
+    // Demuxer to the keyframe at or before ptsSeconds, codec flushed; returns the FFmpeg result
+    int seekToPts(double ptsSeconds);
+    // Applies the skip level for playbackRate before the next packet
+    void updateFrameSkip();
+    // skip_frame and the demuxer's discard level for `skip`
+    void applyFrameSkip(FrameSkip skip);
 
     // ---- Vulkan helpers ----
     VkSampler createLinearClampSampler();
@@ -192,14 +326,16 @@ private:
     bool createExternalViewsFromSurface(const VulkanSurface& s);
 
     // ---- Playback timing ----
-    void updatePlaybackTimestamps(const DecodedFrame& frame, std::chrono::steady_clock::time_point now);
-    bool shouldDisplayNow(const DecodedFrame& frame, std::chrono::steady_clock::time_point now) const;
-    void dropLateFrames(std::chrono::steady_clock::time_point now);
+    double presentationSeconds(const DecodedFrame& frame) const { return frame.ptsSeconds - streamStartSeconds; }
+    bool isDue(const DecodedFrame& frame, double clockSeconds) const;
+    bool takeQueuedFrame(std::optional<DecodedFrame>& slot);
+    void updatePlaybackTimestamps(const DecodedFrame& frame, double clockSeconds, bool sampleDrift);
 
 private:
     Engine2D* engine = nullptr;
 
     // FFmpeg core objects
+    std::unique_ptr<StreamReader> streamReader; // custom IO for formatCtx when streaming
     AVFormatContext* formatCtx = nullptr;
     AVCodecContext* codecCtx = nullptr;
     AVFrame* frame = nullptr;
@@ -219,6 +355,8 @@ private:
     AVPixelFormat sourcePixelFormat = static_cast<AVPixelFormat>(-1);
 
     // Chroma subsampling divisors (2^log2_chroma_w / 2^log2_chroma_h)
+    uint32_t chromaShiftX = 1;
+    uint32_t chromaShiftY = 1;
     uint32_t chromaDivX = 2;
     uint32_t chromaDivY = 2;
     uint32_t chromaWidth = 0;
@@ -227,6 +365,11 @@ private:
     // Bit depth info (for future 10/12-bit handling)
     int bitDepth = 8;
     int bytesPerComponent = 1;
+    uint32_t sampleShift = 0;
+
+    // Colour matrix / range of the stream (see getColorSpace())
+    int colorSpace = 0;
+    int colorRange = 0;
 
     // High-level layout info
     YuvLayout yuvLayout = YuvLayout::Unknown;
@@ -243,23 +386,58 @@ private:
     std::atomic<bool> finished{false};
     std::atomic<bool> draining{false};
 
+    // Held by decodeStep() and seek() so pool workers never decode through a seek
+    std::mutex stepMutex;
+
     // Seeking: when set >=0, producer drops frames until pts >= target
     std::atomic<int64_t> seekTargetMicroseconds{-1};
 
-    // Playback
-    bool playing = true;
-    bool clockInitialized = false;
-    double firstPtsSeconds = 0.0;
+    // Speed / direction (set by the consumer, read by the decode thread)
+    std::atomic<double> playbackRate{1.0};
+    std::atomic<bool> reverse{false};
+    std::atomic<FrameSkip> frameSkip{FrameSkip::None};
+    // Decode side: measured keyframe spacing (0 until two have been seen), last queued pts,
+    // and the reverse segment (ascending pts; frames before reverseCursorSeconds come next)
+    double keyframeIntervalSeconds = 0.0;
+    double lastKeyframePtsSeconds = -1.0;
+    double lastQueuedPtsSeconds = 0.0;
+    std::vector<DecodedFrame> reverseFrames;
+    double reverseCursorSeconds = 0.0;
+
+    // Frame cache (decode side). The codec's next output follows the last queued frame while
+    // decoderPositioned; serving a run from the cache can leave it behind.
+    FrameCache frameCache;
+    int64_t lastInsertedMicros = -1; // previous frame of the current back-to-back decode run
+    int64_t lastDecodedMicros = -1;
+    int64_t cacheNextMicros = -1;    // set by a seek that hit the cache
+    bool lastQueuedKnown = false;
+    bool decoderPositioned = true;
+    bool prefillBehindDone = false;
+    size_t prefillAheadFrames = 0;
+    std::atomic<bool> prefillComplete{false};
+    std::atomic<double> playheadPtsSeconds{0.0}; // latched frame, written by the consumer
+
+    // Playback: frames are timed on presentationClock(); ownClock starts at the first latch
+    MediaClock ownClock;
+    const MediaClock* masterClock = nullptr;
+    bool latchPending = true;
+    bool resumeOwnClock = false; // ownClock was running when seek() paused it
+    double streamStartSeconds = 0.0;
+    bool streamStartKnown = false; // false: taken from the first latched frame
     double lastFramePtsSeconds = 0.0;
     double lastDisplayedSeconds = 0.0;
 
-    std::chrono::steady_clock::time_point playbackStartWall{};
-    std::chrono::steady_clock::time_point lastFrameRenderWall{};
-
     size_t framesDecoded = 0;
     double fallbackPtsSeconds = 0.0;
 
+    SyncStats syncStats{};
+    uint64_t driftSamples = 0;
+    double driftAbsSumMs = 0.0;
+    std::atomic<uint64_t> framesDecodedTotal{0};
+
+    // Oldest not-yet-shown frame, and the one after it once the candidate is due
     std::optional<DecodedFrame> candidate;
+    std::optional<DecodedFrame> lookahead;
 
     // Current latched surface metadata for the most recently presented frame
     mutable std::mutex currentSurfaceMutex_;
@@ -274,3 +452,6 @@ private:
     // Allow decode-only benchmark to call decodeNextFrame
     friend int runDecodeOnlyBenchmark(const std::filesystem::path& videoPath, double benchmarkSeconds);
 };
+
+// "none", "non-reference" or "keyframes-only", for logs and benches
+const char* frameSkipName(DecoderVulkan::FrameSkip skip);
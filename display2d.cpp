@@ -1,6 +1,7 @@
 // display2d.cpp
 #include "display2d.h"
 #include "engine2d.h"
+#include "queue_lock.h"
 
 #include <stdexcept>
 #include <algorithm>
@@ -500,9 +501,6 @@ void Display2D::renderFrame(VkSemaphore externalWaitSemaphore,
     si.signalSemaphoreCount = 1;
     si.pSignalSemaphores = &fr.renderFinished;
 
-    if (vkQueueSubmit(graphicsQueue_, 1, &si, fr.inFlight) != VK_SUCCESS)
-        throw std::runtime_error("vkQueueSubmit failed");
-
     VkPresentInfoKHR pi{VK_STRUCTURE_TYPE_PRESENT_INFO_KHR};
     pi.waitSemaphoreCount = 1;
     pi.pWaitSemaphores = &fr.renderFinished;
@@ -510,7 +508,14 @@ void Display2D::renderFrame(VkSemaphore externalWaitSemaphore,
     pi.pSwapchains = &swapchain_;
     pi.pImageIndices = &imageIndex;
 
-    VkResult pr = vkQueuePresentKHR(graphicsQueue_, &pi);
+    // Decoders and background workers submit to the same queue from their own threads
+    VkResult pr = VK_SUCCESS;
+    {
+        std::lock_guard<std::mutex> queueLock(vulkanQueueMutex(engine->graphicsQueueFamilyIndex));
+        if (vkQueueSubmit(graphicsQueue_, 1, &si, fr.inFlight) != VK_SUCCESS)
+            throw std::runtime_error("vkQueueSubmit failed");
+        pr = vkQueuePresentKHR(graphicsQueue_, &pi);
+    }
     if (pr == VK_ERROR_OUT_OF_DATE_KHR || pr == VK_SUBOPTIMAL_KHR)
         recreateSwapchain_();
     else if (pr != VK_SUCCESS)
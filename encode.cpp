@@ -1,191 +1,368 @@
+#include <algorithm>
 #include <array>
 #include <chrono>
 #include <cstdint>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
-#include <optional>
+#include <mutex>
 #include <string>
 #include <vector>
 
 #include <vulkan/vulkan.h>
 
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/error.h>
+#include <libavutil/hwcontext.h>
+#include <libavutil/hwcontext_vulkan.h>
+#include <libavutil/opt.h>
+#include <libavutil/pixdesc.h>
+}
+
 #include "engine2d.h"
-#include "color_grading_ui.h"
-#include "utils.h"
 #include "annexb_demuxer.h"
+#include "queue_lock.h"
 
 namespace
 {
 // For raw Annex-B elementary streams (e.g., .h264 / .h265)
 const std::filesystem::path kDefaultVideoPath("input.h264");
 
-struct OffscreenBlit
+// Frames in flight: decode of N+2, encode of N+1 and the bitstream readback of N overlap.
+constexpr size_t kPipelineDepth = 3;
+
+// One encode source picture per frame in flight. The decoded frame is copied into the slot's
+// picture on the graphics queue, and the encoder reads it from there; the slot is refilled only
+// after its previous frame's packet has come back.
+struct PipelineSlot
 {
-    Engine2D* engine = nullptr;
-    VkExtent2D extent{0, 0};
-    VkImage image = VK_NULL_HANDLE;
-    VkDeviceMemory memory = VK_NULL_HANDLE;
-    VkImageView view = VK_NULL_HANDLE;
-    VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
-    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
-    VkPipeline computePipeline = VK_NULL_HANDLE;
-    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
-    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
-    bool ready() const { return image != VK_NULL_HANDLE; }
-
-    bool initialize(Engine2D* inEngine, uint32_t width, uint32_t height, const std::array<float, kCurveLutSize>&)
-    {
-        engine = inEngine;
-        extent = {width, height};
-        if (!engine || width == 0 || height == 0)
-        {
-            return false;
-        }
+    AVFrame* picture = nullptr;
+    VkCommandBuffer copyCommands = VK_NULL_HANDLE;
+    size_t frameIndex = 0;
+    bool inFlight = false;
+};
 
-        VkImageCreateInfo imageInfo{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
-        imageInfo.imageType = VK_IMAGE_TYPE_2D;
-        imageInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
-        imageInfo.extent = {extent.width, extent.height, 1};
-        imageInfo.mipLevels = 1;
-        imageInfo.arrayLayers = 1;
-        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-        imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
-        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        if (vkCreateImage(engine->logicalDevice, &imageInfo, nullptr, &image) != VK_SUCCESS)
-        {
-            return false;
-        }
-        VkMemoryRequirements memReq{};
-        vkGetImageMemoryRequirements(engine->logicalDevice, image, &memReq);
-        VkMemoryAllocateInfo alloc{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
-        alloc.allocationSize = memReq.size;
-        alloc.memoryTypeIndex = engine->renderDevice.findMemoryType(memReq.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-        if (vkAllocateMemory(engine->logicalDevice, &alloc, nullptr, &memory) != VK_SUCCESS)
-        {
-            return false;
-        }
-        vkBindImageMemory(engine->logicalDevice, image, memory, 0);
-        VkImageViewCreateInfo viewInfo{VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
-        viewInfo.image = image;
-        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-        viewInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
-        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        viewInfo.subresourceRange.levelCount = 1;
-        viewInfo.subresourceRange.layerCount = 1;
-        if (vkCreateImageView(engine->logicalDevice, &viewInfo, nullptr, &view) != VK_SUCCESS)
-        {
-            return false;
-        }
-        return true;
+std::string avErrorString(int err)
+{
+    char buf[AV_ERROR_MAX_STRING_SIZE] = {};
+    av_strerror(err, buf, sizeof(buf));
+    return buf;
+}
+
+void lockQueue(AVHWDeviceContext* /*ctx*/, uint32_t queueFamily, uint32_t index)
+{
+    vulkanQueueMutex(queueFamily, index).lock();
+}
+
+void unlockQueue(AVHWDeviceContext* /*ctx*/, uint32_t queueFamily, uint32_t index)
+{
+    vulkanQueueMutex(queueFamily, index).unlock();
+}
+
+// FFmpeg device context on the engine's VkDevice, with its decode and encode queue families.
+AVBufferRef* createVulkanDevice(Engine2D& engine, std::string& error)
+{
+    RenderDevice& device = engine.renderDevice;
+    const uint32_t graphicsFamily = device.getGraphicsQueueFamilyIndex();
+    const uint32_t decodeFamily = device.getVideoDecodeQueueFamilyIndex();
+    const uint32_t encodeFamily = device.getVideoEncodeQueueFamilyIndex();
+    if (decodeFamily == static_cast<uint32_t>(-1) || encodeFamily == static_cast<uint32_t>(-1))
+    {
+        error = "device has no video decode and encode queues";
+        return nullptr;
+    }
+
+    AVBufferRef* ref = av_hwdevice_ctx_alloc(AV_HWDEVICE_TYPE_VULKAN);
+    if (!ref)
+    {
+        error = "failed to allocate Vulkan hwdevice context";
+        return nullptr;
+    }
+    AVHWDeviceContext* deviceCtx = reinterpret_cast<AVHWDeviceContext*>(ref->data);
+    AVVulkanDeviceContext* vkctx = static_cast<AVVulkanDeviceContext*>(deviceCtx->hwctx);
+    vkctx->inst = engine.instance;
+    vkctx->phys_dev = engine.physicalDevice;
+    vkctx->act_dev = engine.logicalDevice;
+    vkctx->get_proc_addr = vkGetInstanceProcAddr;
+    vkctx->device_features = device.getEnabledFeatures2();
+
+    const std::vector<const char*>& instanceExts = device.getEnabledInstanceExtensionNames();
+    const std::vector<const char*>& deviceExts = device.getEnabledDeviceExtensionNames();
+    vkctx->enabled_inst_extensions = instanceExts.data();
+    vkctx->nb_enabled_inst_extensions = static_cast<int>(instanceExts.size());
+    vkctx->enabled_dev_extensions = deviceExts.data();
+    vkctx->nb_enabled_dev_extensions = static_cast<int>(deviceExts.size());
+
+    int q = 0;
+    vkctx->qf[q].idx = static_cast<int>(graphicsFamily);
+    vkctx->qf[q].num = 1;
+    vkctx->qf[q].flags = static_cast<VkQueueFlagBits>(VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT);
+    vkctx->qf[q].video_caps = static_cast<VkVideoCodecOperationFlagBitsKHR>(0);
+    q++;
+    vkctx->qf[q].idx = static_cast<int>(decodeFamily);
+    vkctx->qf[q].num = 1;
+    vkctx->qf[q].flags = static_cast<VkQueueFlagBits>(VK_QUEUE_VIDEO_DECODE_BIT_KHR);
+    vkctx->qf[q].video_caps = static_cast<VkVideoCodecOperationFlagBitsKHR>(
+        VK_VIDEO_CODEC_OPERATION_DECODE_H264_BIT_KHR | VK_VIDEO_CODEC_OPERATION_DECODE_H265_BIT_KHR);
+    q++;
+    vkctx->qf[q].idx = static_cast<int>(encodeFamily);
+    vkctx->qf[q].num = 1;
+    vkctx->qf[q].flags = static_cast<VkQueueFlagBits>(VK_QUEUE_VIDEO_ENCODE_BIT_KHR);
+    vkctx->qf[q].video_caps = static_cast<VkVideoCodecOperationFlagBitsKHR>(
+        VK_VIDEO_CODEC_OPERATION_ENCODE_H264_BIT_KHR | VK_VIDEO_CODEC_OPERATION_ENCODE_H265_BIT_KHR);
+    q++;
+    vkctx->nb_qf = q;
+
+    // The copies below go to the graphics queue FFmpeg also uses; one lock per VkQueue
+    vkctx->lock_queue = lockQueue;
+    vkctx->unlock_queue = unlockQueue;
+
+    const int ret = av_hwdevice_ctx_init(ref);
+    if (ret < 0)
+    {
+        error = "av_hwdevice_ctx_init(Vulkan) failed: " + avErrorString(ret);
+        av_buffer_unref(&ref);
+        return nullptr;
     }
+    return ref;
+}
 
-    bool copyFrom(VkImage srcImage, VkExtent2D srcExtent, VkImageLayout srcLayout)
+AVPixelFormat pickVulkanFormat(AVCodecContext* /*ctx*/, const AVPixelFormat* formats)
+{
+    // GPU-only pipeline: no software fallback
+    for (const AVPixelFormat* f = formats; *f != AV_PIX_FMT_NONE; ++f)
     {
-        if (!engine || image == VK_NULL_HANDLE || srcImage == VK_NULL_HANDLE)
+        if (*f == AV_PIX_FMT_VULKAN)
         {
-            return false;
+            return *f;
         }
-        VkCommandBuffer cmd = engine->beginSingleTimeCommands();
-        VkImageSubresourceRange range{};
-        range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        range.levelCount = 1;
-        range.layerCount = 1;
-
-        VkImageMemoryBarrier2 srcBarrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2};
-        srcBarrier.image = srcImage;
-        srcBarrier.oldLayout = srcLayout;
-        srcBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-        srcBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        srcBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        srcBarrier.subresourceRange = range;
-        srcBarrier.srcAccessMask = VK_ACCESS_2_VIDEO_DECODE_WRITE_BIT_KHR;
-        srcBarrier.dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT;
-        srcBarrier.srcStageMask = VK_PIPELINE_STAGE_2_VIDEO_DECODE_BIT_KHR;
-        srcBarrier.dstStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
-
-        VkImageMemoryBarrier2 dstBarrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2};
-        dstBarrier.image = image;
-        dstBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        dstBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        dstBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        dstBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        dstBarrier.subresourceRange = range;
-        dstBarrier.srcAccessMask = 0;
-        dstBarrier.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
-        dstBarrier.srcStageMask = VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT;
-        dstBarrier.dstStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
-
-        std::array<VkImageMemoryBarrier2, 2> barriers{srcBarrier, dstBarrier};
-        VkDependencyInfo dep{VK_STRUCTURE_TYPE_DEPENDENCY_INFO};
-        dep.imageMemoryBarrierCount = static_cast<uint32_t>(barriers.size());
-        dep.pImageMemoryBarriers = barriers.data();
-        vkCmdPipelineBarrier2(cmd, &dep);
-
-        VkImageCopy copy{};
-        copy.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        copy.srcSubresource.layerCount = 1;
-        copy.dstSubresource = copy.srcSubresource;
-        copy.extent = {std::min(extent.width, srcExtent.width), std::min(extent.height, srcExtent.height), 1};
-        vkCmdCopyImage(cmd,
-                       srcImage,
+    }
+    std::cerr << "[Encode] Decoder offers no Vulkan surface format for this stream\n";
+    return AV_PIX_FMT_NONE;
+}
+
+// Encode source pictures: same format as the decoder's, usable as encode input under any video
+// profile (VK_KHR_video_maintenance1) and as a copy destination. Exactly one per slot.
+AVBufferRef* createEncodeFrames(AVBufferRef* device, const AVHWFramesContext& decoded, int width, int height)
+{
+    AVBufferRef* ref = av_hwframe_ctx_alloc(device);
+    if (!ref)
+    {
+        return nullptr;
+    }
+    AVHWFramesContext* frames = reinterpret_cast<AVHWFramesContext*>(ref->data);
+    frames->format = AV_PIX_FMT_VULKAN;
+    frames->sw_format = decoded.sw_format;
+    frames->width = width;
+    frames->height = height;
+    frames->initial_pool_size = static_cast<int>(kPipelineDepth);
+    AVVulkanFramesContext* vk = static_cast<AVVulkanFramesContext*>(frames->hwctx);
+    vk->tiling = VK_IMAGE_TILING_OPTIMAL;
+    vk->usage = static_cast<VkImageUsageFlagBits>(VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_VIDEO_ENCODE_SRC_BIT_KHR);
+    vk->img_flags = static_cast<VkImageCreateFlags>(VK_IMAGE_CREATE_VIDEO_PROFILE_INDEPENDENT_BIT_KHR);
+    const int ret = av_hwframe_ctx_init(ref);
+    if (ret < 0)
+    {
+        std::cerr << "[Encode] av_hwframe_ctx_init failed: " << avErrorString(ret) << "\n";
+        av_buffer_unref(&ref);
+    }
+    return ref;
+}
+
+AVCodecContext* openEncoder(AnnexBCodec codec, const AVCodecContext& decoder, const AVFrame& first, AVBufferRef* frames)
+{
+    const char* name = codec == AnnexBCodec::H264 ? "h264_vulkan" : "hevc_vulkan";
+    const AVCodec* encoder = avcodec_find_encoder_by_name(name);
+    if (!encoder)
+    {
+        std::cerr << "[Encode] FFmpeg has no " << name << " encoder\n";
+        return nullptr;
+    }
+    AVCodecContext* ctx = avcodec_alloc_context3(encoder);
+    if (!ctx)
+    {
+        return nullptr;
+    }
+    const AVRational rate = decoder.framerate.num > 0 ? decoder.framerate : AVRational{30, 1};
+    ctx->width = first.width;
+    ctx->height = first.height;
+    ctx->pix_fmt = AV_PIX_FMT_VULKAN;
+    ctx->framerate = rate;
+    ctx->time_base = av_inv_q(rate);
+    ctx->color_primaries = first.color_primaries;
+    ctx->color_trc = first.color_trc;
+    ctx->colorspace = first.colorspace;
+    ctx->color_range = first.color_range;
+    // Packets come back in input order, one per slot
+    ctx->max_b_frames = 0;
+    ctx->hw_frames_ctx = av_buffer_ref(frames);
+    // Frames the encoder keeps submitted before it waits for the oldest one's feedback query;
+    // one short of the slot count so the oldest slot's packet is always out before it is reused.
+    av_opt_set_int(ctx->priv_data, "async_depth", static_cast<int64_t>(kPipelineDepth - 1), 0);
+
+    const int ret = avcodec_open2(ctx, encoder, nullptr);
+    if (ret < 0)
+    {
+        std::cerr << "[Encode] avcodec_open2(" << name << ") failed: " << avErrorString(ret) << "\n";
+        avcodec_free_context(&ctx);
+    }
+    return ctx;
+}
+
+uint32_t imageCount(const AVVkFrame* vkf)
+{
+    uint32_t n = 0;
+    while (n < AV_NUM_DATA_POINTERS && vkf->img[n] != VK_NULL_HANDLE) n++;
+    return n;
+}
+
+// Records the decoded frame -> slot picture copy and submits it. The submit waits for the
+// decode (the decoded frame's timeline value) and for the encode that last read the slot picture
+// (the slot's timeline value, signalled by the encoder), so neither a pending decode write nor
+// an in-flight encode read is overtaken. Both timelines are then advanced, as FFmpeg expects from
+// every user of an AVVkFrame.
+bool submitCopy(Engine2D& engine, PipelineSlot& slot, const AVFrame& decoded)
+{
+    AVHWFramesContext* srcFrames = reinterpret_cast<AVHWFramesContext*>(decoded.hw_frames_ctx->data);
+    AVHWFramesContext* dstFrames = reinterpret_cast<AVHWFramesContext*>(slot.picture->hw_frames_ctx->data);
+    AVVulkanFramesContext* srcVk = static_cast<AVVulkanFramesContext*>(srcFrames->hwctx);
+    AVVulkanFramesContext* dstVk = static_cast<AVVulkanFramesContext*>(dstFrames->hwctx);
+    AVVkFrame* src = reinterpret_cast<AVVkFrame*>(decoded.data[0]);
+    AVVkFrame* dst = reinterpret_cast<AVVkFrame*>(slot.picture->data[0]);
+
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(dstFrames->sw_format);
+    const uint32_t srcImages = imageCount(src);
+    const uint32_t dstImages = imageCount(dst);
+    const int planes = av_pix_fmt_count_planes(dstFrames->sw_format);
+    if (!desc || srcImages == 0 || srcImages != dstImages || (srcImages != 1 && static_cast<int>(srcImages) != planes))
+    {
+        std::cerr << "[Encode] Decoded and encode surfaces have different layouts\n";
+        return false;
+    }
+
+    srcVk->lock_frame(srcFrames, src);
+    dstVk->lock_frame(dstFrames, dst);
+
+    VkCommandBufferBeginInfo begin{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    begin.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkResetCommandBuffer(slot.copyCommands, 0);
+    vkBeginCommandBuffer(slot.copyCommands, &begin);
+
+    std::vector<VkImageMemoryBarrier2> barriers;
+    for (uint32_t i = 0; i < srcImages; ++i)
+    {
+        VkImageMemoryBarrier2 b{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2};
+        b.srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+        b.dstStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+        b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        b.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+
+        b.image = src->img[i];
+        b.oldLayout = src->layout[i];
+        b.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        b.dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT;
+        barriers.push_back(b);
+
+        // The old contents were only ever encoder input
+        b.image = dst->img[i];
+        b.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        b.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        b.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        barriers.push_back(b);
+    }
+    VkDependencyInfo dep{VK_STRUCTURE_TYPE_DEPENDENCY_INFO};
+    dep.imageMemoryBarrierCount = static_cast<uint32_t>(barriers.size());
+    dep.pImageMemoryBarriers = barriers.data();
+    vkCmdPipelineBarrier2(slot.copyCommands, &dep);
+
+    // One multi-plane image (copied plane by plane) or one image per plane
+    for (int p = 0; p < planes; ++p)
+    {
+        const uint32_t img = srcImages == 1 ? 0 : static_cast<uint32_t>(p);
+        const bool chroma = p > 0 && p < 3;
+        VkImageCopy region{};
+        region.srcSubresource.aspectMask =
+            srcImages == 1 ? static_cast<VkImageAspectFlags>(VK_IMAGE_ASPECT_PLANE_0_BIT << p) : VK_IMAGE_ASPECT_COLOR_BIT;
+        region.srcSubresource.layerCount = 1;
+        region.dstSubresource = region.srcSubresource;
+        const uint32_t w = static_cast<uint32_t>(slot.picture->width);
+        const uint32_t h = static_cast<uint32_t>(slot.picture->height);
+        region.extent.width = chroma ? AV_CEIL_RSHIFT(w, desc->log2_chroma_w) : w;
+        region.extent.height = chroma ? AV_CEIL_RSHIFT(h, desc->log2_chroma_h) : h;
+        region.extent.depth = 1;
+        vkCmdCopyImage(slot.copyCommands,
+                       src->img[img],
                        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                       image,
+                       dst->img[img],
                        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
                        1,
-                       &copy);
+                       &region);
+    }
+    vkEndCommandBuffer(slot.copyCommands);
 
-        VkImageMemoryBarrier2 toGeneral{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2};
-        toGeneral.image = image;
-        toGeneral.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        toGeneral.newLayout = VK_IMAGE_LAYOUT_GENERAL;
-        toGeneral.subresourceRange = range;
-        toGeneral.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
-        toGeneral.dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
-        toGeneral.srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
-        toGeneral.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+    std::vector<VkSemaphoreSubmitInfo> waits;
+    std::vector<VkSemaphoreSubmitInfo> signals;
+    auto addTimeline = [&](AVVkFrame* f, uint32_t i) {
+        VkSemaphoreSubmitInfo s{VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO};
+        s.semaphore = f->sem[i];
+        s.value = f->sem_value[i];
+        s.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+        waits.push_back(s);
+        s.value = f->sem_value[i] + 1;
+        signals.push_back(s);
+    };
+    for (uint32_t i = 0; i < srcImages; ++i)
+    {
+        addTimeline(src, i);
+        addTimeline(dst, i);
+    }
 
-        VkDependencyInfo dep2{VK_STRUCTURE_TYPE_DEPENDENCY_INFO};
-        dep2.imageMemoryBarrierCount = 1;
-        dep2.pImageMemoryBarriers = &toGeneral;
-        vkCmdPipelineBarrier2(cmd, &dep2);
+    VkCommandBufferSubmitInfo cmdInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO};
+    cmdInfo.commandBuffer = slot.copyCommands;
+    VkSubmitInfo2 submit{VK_STRUCTURE_TYPE_SUBMIT_INFO_2};
+    submit.waitSemaphoreInfoCount = static_cast<uint32_t>(waits.size());
+    submit.pWaitSemaphoreInfos = waits.data();
+    submit.commandBufferInfoCount = 1;
+    submit.pCommandBufferInfos = &cmdInfo;
+    submit.signalSemaphoreInfoCount = static_cast<uint32_t>(signals.size());
+    submit.pSignalSemaphoreInfos = signals.data();
 
-        engine->endSingleTimeCommands(cmd);
-        return true;
+    VkResult result = VK_SUCCESS;
+    {
+        std::lock_guard<std::mutex> queueLock(vulkanQueueMutex(engine.graphicsQueueFamilyIndex));
+        result = vkQueueSubmit2(engine.graphicsQueue, 1, &submit, VK_NULL_HANDLE);
     }
-
-    void shutdown()
+    if (result == VK_SUCCESS)
     {
-        if (!engine) return;
-        if (view) vkDestroyImageView(engine->logicalDevice, view, nullptr);
-        if (image) vkDestroyImage(engine->logicalDevice, image, nullptr);
-        if (memory) vkFreeMemory(engine->logicalDevice, memory, nullptr);
-        view = VK_NULL_HANDLE;
-        image = VK_NULL_HANDLE;
-        memory = VK_NULL_HANDLE;
+        for (uint32_t i = 0; i < srcImages; ++i)
+        {
+            src->layout[i] = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            src->access[i] = static_cast<VkAccessFlagBits>(VK_ACCESS_TRANSFER_READ_BIT);
+            src->sem_value[i]++;
+            dst->layout[i] = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            dst->access[i] = static_cast<VkAccessFlagBits>(VK_ACCESS_TRANSFER_WRITE_BIT);
+            dst->sem_value[i]++;
+        }
     }
-};
 
-ColorAdjustments gradingToAdjustments(const GradingSettings& settings)
-{
-    ColorAdjustments adj{};
-    adj.exposure = settings.exposure;
-    adj.contrast = settings.contrast;
-    adj.saturation = settings.saturation;
-    adj.shadows = settings.shadows;
-    adj.midtones = settings.midtones;
-    adj.highlights = settings.highlights;
-    grading::buildCurveLut(settings, adj.curveLut);
-    adj.curveEnabled = true;
-    return adj;
+    dstVk->unlock_frame(dstFrames, dst);
+    srcVk->unlock_frame(srcFrames, src);
+    if (result != VK_SUCCESS)
+    {
+        std::cerr << "[Encode] vkQueueSubmit2 failed for the decode -> encode copy (" << result << ")\n";
+        return false;
+    }
+    return true;
 }
 } // namespace
 
 int main(int argc, char** argv)
 {
     std::filesystem::path videoPath = kDefaultVideoPath;
+    std::filesystem::path outputPath;
     bool showHelp = false;
     size_t frameLimit = 0; // 0 means no limit
     for (int i = 1; i < argc; ++i)
@@ -203,6 +380,18 @@ int main(int argc, char** argv)
                 return 1;
             }
         }
+        else if (arg == "--output" || arg == "-o")
+        {
+            if (i + 1 < argc)
+            {
+                outputPath = std::filesystem::path(argv[++i]);
+            }
+            else
+            {
+                std::cerr << "[Encode] Error: --output requires a file path\n";
+                return 1;
+            }
+        }
         else if (arg == "--framecount" || arg == "-f")
         {
             if (i + 1 < argc)
@@ -242,171 +431,299 @@ int main(int argc, char** argv)
     if (showHelp)
     {
         std::cout << "Usage: encode [OPTIONS] [VIDEO_FILE]\n";
-        std::cout << "Vulkan-only skeleton (no FFmpeg) — decode/encode not yet implemented\n\n";
+        std::cout << "Re-encodes a raw Annex-B H.264/H.265 stream with Vulkan Video decode and encode (FFmpeg hwaccel)\n\n";
         std::cout << "Options:\n";
         std::cout << "  -v, --video FILE      Input video file (default: " << kDefaultVideoPath << ")\n";
-        std::cout << "  -f, --framecount N    Process only first N frames (0 = no limit)\n";
+        std::cout << "  -o, --output FILE     Encoded output (default: VIDEO.encoded.<input extension>)\n";
+        std::cout << "  -f, --framecount N    Process only first N frames (0 = no limit); reports frames/sec\n";
         std::cout << "  -h, --help            Show this help message\n";
         return 0;
     }
 
-    std::cout << "[Encode] Engine2D constructed\n";
     Engine2D engine;
-
-    // Minimal decoder path setup
-    // Try H.265 first (since our test file is H.265), fall back to H.264
-    std::cout << "[Encode] Selecting decode profile...\n";
-    auto profile = selectDecodeProfile(engine, MiniCodec::H265);
-    if (!profile)
-    {
-        std::cerr << "[Encode] H.265 decode not available, trying H.264...\n";
-        profile = selectDecodeProfile(engine, MiniCodec::H264);
-    }
-    if (!profile)
+    if (!engine.initialize(false))
     {
-        std::cerr << "[Encode] No suitable decode profile found.\n";
+        std::cerr << "[Encode] Failed to initialise Vulkan\n";
         return 1;
     }
-    std::cout << "[Encode] Profile selected, creating decode session...\n";
-    auto session = createDecodeSession(engine, *profile, VkExtent2D{1920, 1080}, /*maxDpbSlots*/4);
-    if (!session)
+    std::cout << "[Encode] Engine2D initialised\n";
+
+    std::cout << "[Encode] Opening Annex-B demuxer for " << videoPath << "...\n";
+    AnnexBDemuxer demux(videoPath);
+    if (!demux.valid() || demux.codec() == AnnexBCodec::Unknown)
     {
-        std::cerr << "[Encode] Failed to create decode session.\n";
+        std::cerr << "[Encode] Failed to open Annex-B input (or not H.264/H.265).\n";
         return 1;
     }
-    std::cout << "[Encode] Decode session created, initializing resources...\n";
-    MiniDecodeResources decRes{};
-    if (!initDecodeResources(engine, *session, decRes, 4 * 1024 * 1024))
+    const AnnexBCodec codec = demux.codec();
+
+    std::string deviceError;
+    AVBufferRef* hwDevice = createVulkanDevice(engine, deviceError);
+    if (!hwDevice)
     {
-        std::cerr << "[Encode] Failed to init decode resources.\n";
+        std::cerr << "[Encode] " << deviceError << "\n";
         return 1;
     }
-    std::cout << "[Encode] Decode resources initialized.\n";
 
-    // Encode pipeline setup
-    std::cout << "[Encode] Selecting encode profile...\n";
-    MiniEncodeCodec encodeCodec = (profile->codec == MiniCodec::H264) ? MiniEncodeCodec::H264 : MiniEncodeCodec::H265;
-    auto encodeProfile = selectEncodeProfile(engine, encodeCodec);
-    if (!encodeProfile)
+    const AVCodec* decoder = avcodec_find_decoder(codec == AnnexBCodec::H264 ? AV_CODEC_ID_H264 : AV_CODEC_ID_HEVC);
+    AVCodecContext* decodeCtx = decoder ? avcodec_alloc_context3(decoder) : nullptr;
+    if (!decodeCtx)
     {
-        std::cerr << "[Encode] No suitable encode profile found.\n";
+        std::cerr << "[Encode] No decoder for this stream\n";
+        av_buffer_unref(&hwDevice);
         return 1;
     }
-    std::cout << "[Encode] Encode profile selected, creating encode session...\n";
-    auto encodeSession = createEncodeSession(engine, *encodeProfile, VkExtent2D{1920, 1080}, /*maxDpbSlots*/4);
-    if (!encodeSession)
+    decodeCtx->hw_device_ctx = av_buffer_ref(hwDevice);
+    decodeCtx->get_format = pickVulkanFormat;
+    if (const int ret = avcodec_open2(decodeCtx, decoder, nullptr); ret < 0)
     {
-        std::cerr << "[Encode] Failed to create encode session.\n";
+        std::cerr << "[Encode] avcodec_open2(decoder) failed: " << avErrorString(ret) << "\n";
+        avcodec_free_context(&decodeCtx);
+        av_buffer_unref(&hwDevice);
         return 1;
     }
-    std::cout << "[Encode] Encode session created, initializing resources...\n";
-    MiniEncodeResources encRes{};
-    if (!initEncodeResources(engine, *encodeSession, encRes))
+
+    // Open output file for encoded bitstream; same codec as the input, so the same extension
+    if (outputPath.empty())
     {
-        std::cerr << "[Encode] Failed to init encode resources.\n";
-        return 1;
+        outputPath = videoPath;
+        outputPath.replace_extension(".encoded" + videoPath.extension().string());
     }
-    std::cout << "[Encode] Encode resources initialized.\n";
-
-    // Open output file for encoded bitstream
-    std::filesystem::path outputPath = videoPath;
-    outputPath.replace_extension("encoded.h265");
     std::ofstream outFile(outputPath, std::ios::binary);
     if (!outFile)
     {
         std::cerr << "[Encode] Failed to open output file " << outputPath << "\n";
+        avcodec_free_context(&decodeCtx);
+        av_buffer_unref(&hwDevice);
         return 1;
     }
     std::cout << "[Encode] Writing encoded bitstream to " << outputPath << "\n";
 
-    std::cout << "[Encode] Opening Annex-B demuxer for " << videoPath << "...\n";
-    AnnexBDemuxer demux(videoPath);
-    std::cout << "[Encode] Demuxer constructed, valid=" << demux.valid() << "\n";
-    if (!demux.valid())
+    // Per-slot copy command buffers on the graphics queue
+    VkCommandPool copyPool = VK_NULL_HANDLE;
+    VkCommandPoolCreateInfo poolInfo{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = engine.graphicsQueueFamilyIndex;
+    std::array<VkCommandBuffer, kPipelineDepth> copyCommands{};
+    bool commandsReady = vkCreateCommandPool(engine.logicalDevice, &poolInfo, nullptr, &copyPool) == VK_SUCCESS;
+    if (commandsReady)
+    {
+        VkCommandBufferAllocateInfo cmdAlloc{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+        cmdAlloc.commandPool = copyPool;
+        cmdAlloc.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        cmdAlloc.commandBufferCount = static_cast<uint32_t>(kPipelineDepth);
+        commandsReady = vkAllocateCommandBuffers(engine.logicalDevice, &cmdAlloc, copyCommands.data()) == VK_SUCCESS;
+    }
+    if (!commandsReady)
     {
-        std::cerr << "[Encode] Failed to open Annex-B input.\n";
+        std::cerr << "[Encode] Failed to create copy command buffers\n";
+        if (copyPool) vkDestroyCommandPool(engine.logicalDevice, copyPool, nullptr);
+        avcodec_free_context(&decodeCtx);
+        av_buffer_unref(&hwDevice);
         return 1;
     }
-    std::cout << "[Encode] Demuxer ready, starting decode loop\n";
 
-    size_t framesProcessed = 0;
-    OffscreenBlit blit;
-    const uint8_t* nal = nullptr;
-    size_t nalSize = 0;
-    bool isIdr = false;
-    while (demux.nextNalu(nal, nalSize, isIdr))
+    std::array<PipelineSlot, kPipelineDepth> slots{};
+    for (size_t i = 0; i < kPipelineDepth; ++i)
     {
-        if (nalSize == 0)
+        slots[i].copyCommands = copyCommands[i];
+    }
+    AVBufferRef* encodeFrames = nullptr;
+    AVCodecContext* encodeCtx = nullptr;
+    AVPacket* packet = av_packet_alloc();
+    AVPacket* encoded = av_packet_alloc();
+    AVFrame* decoded = av_frame_alloc();
+
+    size_t framesSubmitted = 0;
+    size_t framesProcessed = 0;
+    size_t bytesWritten = 0;
+    bool failed = false;
+
+    // Writes every packet the encoder has finished. With `untilSlot` set, keeps going until that
+    // slot's packet is out: the encoder holds at most async_depth frames, so the oldest slot's
+    // packet comes out once the newer ones are submitted (its wait is the feedback query of that
+    // frame). Otherwise returns as soon as the encoder would block.
+    auto drainPackets = [&](const PipelineSlot* untilSlot) -> bool {
+        while (true)
         {
-            std::cout << "[Encode] NAL size zero, breaking.\n";
-            break;
+            if (untilSlot && !untilSlot->inFlight)
+            {
+                return true;
+            }
+            const int ret = avcodec_receive_packet(encodeCtx, encoded);
+            if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
+            {
+                if (untilSlot)
+                {
+                    std::cerr << "[Encode] Encoder holds frame " << untilSlot->frameIndex << " past the pipeline depth\n";
+                    return false;
+                }
+                return true;
+            }
+            if (ret < 0)
+            {
+                std::cerr << "[Encode] avcodec_receive_packet failed: " << avErrorString(ret) << "\n";
+                return false;
+            }
+            outFile.write(reinterpret_cast<const char*>(encoded->data), encoded->size);
+            if (!outFile)
+            {
+                std::cerr << "[Encode] Failed to write to output file\n";
+                av_packet_unref(encoded);
+                return false;
+            }
+            bytesWritten += static_cast<size_t>(encoded->size);
+            framesProcessed++;
+            if (encoded->pts >= 0)
+            {
+                slots[static_cast<size_t>(encoded->pts) % kPipelineDepth].inFlight = false;
+            }
+            av_packet_unref(encoded);
         }
-        std::cout << "[Encode] Decoding NAL of size " << nalSize << " bytes (IDR=" << isIdr << ")\n";
-        // Check frame limit
-        if (frameLimit > 0 && framesProcessed >= frameLimit)
+    };
+
+    // Copies one decoded frame into the next slot and hands it to the encoder.
+    auto encodeFrame = [&](const AVFrame& frame) -> bool {
+        if (!encodeCtx)
         {
-            std::cout << "[Encode] Reached frame limit of " << frameLimit << " frames\n";
-            break;
+            const AVHWFramesContext* decodedFrames = reinterpret_cast<const AVHWFramesContext*>(frame.hw_frames_ctx->data);
+            encodeFrames = createEncodeFrames(hwDevice, *decodedFrames, frame.width, frame.height);
+            if (!encodeFrames)
+            {
+                return false;
+            }
+            for (PipelineSlot& slot : slots)
+            {
+                slot.picture = av_frame_alloc();
+                if (!slot.picture || av_hwframe_get_buffer(encodeFrames, slot.picture, 0) < 0)
+                {
+                    std::cerr << "[Encode] Failed to allocate an encode source picture\n";
+                    return false;
+                }
+            }
+            encodeCtx = openEncoder(codec, *decodeCtx, frame, encodeFrames);
+            if (!encodeCtx)
+            {
+                return false;
+            }
+            std::cout << "[Encode] " << frame.width << "x" << frame.height << " "
+                      << av_get_pix_fmt_name(decodedFrames->sw_format) << ", " << kPipelineDepth << " slots\n";
+        }
+
+        PipelineSlot& slot = slots[framesSubmitted % kPipelineDepth];
+        // Reusing a slot means its previous frame (N - kPipelineDepth) must be out of the encoder.
+        if (slot.inFlight && !drainPackets(&slot))
+        {
+            return false;
         }
-        
-        uint32_t slot = 0;
-        std::cout << "[Encode] Calling recordDecode...\n";
-        if (!recordDecode(engine, *session, decRes, nal, nalSize, VkExtent2D{1920, 1080}, slot))
+        if (!submitCopy(engine, slot, frame))
+        {
+            return false;
+        }
+        slot.picture->pts = static_cast<int64_t>(framesSubmitted);
+        slot.frameIndex = framesSubmitted;
+        slot.inFlight = true;
+        framesSubmitted++;
+        const int ret = avcodec_send_frame(encodeCtx, slot.picture);
+        if (ret < 0)
+        {
+            std::cerr << "[Encode] avcodec_send_frame failed at frame " << slot.frameIndex << ": " << avErrorString(ret) << "\n";
+            return false;
+        }
+        return drainPackets(nullptr);
+    };
+
+    // Takes every frame the decoder has ready; decode submissions return before the GPU is done,
+    // so the next access unit is demuxed and submitted while this one still decodes.
+    auto receiveDecoded = [&]() -> bool {
+        while (true)
+        {
+            const int ret = avcodec_receive_frame(decodeCtx, decoded);
+            if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
+            {
+                return true;
+            }
+            if (ret < 0)
+            {
+                std::cerr << "[Encode] avcodec_receive_frame failed: " << avErrorString(ret) << "\n";
+                return false;
+            }
+            const bool limited = frameLimit > 0 && framesSubmitted >= frameLimit;
+            const bool ok = limited || encodeFrame(*decoded);
+            av_frame_unref(decoded);
+            if (!ok)
+            {
+                return false;
+            }
+        }
+    };
+
+    std::cout << "[Encode] Starting decode loop\n";
+    const auto loopStart = std::chrono::steady_clock::now();
+    AnnexBAccessUnit au{};
+    int64_t auIndex = 0;
+    // Each access unit is a whole coded picture (parameter sets, SEI and all slices).
+    while (!failed && demux.nextAccessUnit(au))
+    {
+        if (au.size == 0)
         {
-            std::cerr << "[Encode] Decode submit failed at frame " << framesProcessed << "\n";
             break;
         }
-        std::cout << "[Encode] Decode submitted, slot=" << slot << "\n";
-        // Temporary sync: ensure decode queue idle before handoff to encode.
-        vkQueueWaitIdle(engine.getVideoDecodeQueue());
-        // Encode the decoded DPB image directly (same format as encoder expects)
-        std::cout << "[Encode] Encoding frame...\n";
-        uint32_t encodeSlot = 0;
-        // Use the decoded DPB image as source, it's already in the right YUV format
-        if (!recordEncode(engine,
-                          *encodeSession,
-                          encRes,
-                          session->dpbImages[slot],
-                          session->codedExtent,
-                          VK_IMAGE_LAYOUT_GENERAL,
-                          engine.getVideoDecodeQueueFamilyIndex(),
-                          encodeSlot))
+        if (frameLimit > 0 && framesSubmitted >= frameLimit)
         {
-            std::cerr << "[Encode] Encode submit failed at frame " << framesProcessed << "\n";
+            std::cout << "[Encode] Reached frame limit of " << frameLimit << " frames\n";
             break;
         }
-        std::cout << "[Encode] Encode submitted, retrieving bitstream...\n";
-        std::vector<uint8_t> bitstream;
-        if (!retrieveEncodedBitstream(engine, *encodeSession, encRes, bitstream))
+        if (av_new_packet(packet, static_cast<int>(au.size)) < 0)
         {
-            std::cerr << "[Encode] Failed to retrieve encoded bitstream\n";
+            failed = true;
             break;
         }
-        // Write bitstream to file (TODO: need actual encoded size)
-        outFile.write(reinterpret_cast<const char*>(bitstream.data()), bitstream.size());
-        if (!outFile)
+        std::memcpy(packet->data, demux.accessUnitData(au), au.size);
+        packet->pts = auIndex++;
+        const int ret = avcodec_send_packet(decodeCtx, packet);
+        av_packet_unref(packet);
+        if (ret < 0 && ret != AVERROR(EAGAIN))
         {
-            std::cerr << "[Encode] Failed to write to output file\n";
+            std::cerr << "[Encode] avcodec_send_packet failed: " << avErrorString(ret) << "\n";
+            failed = true;
             break;
         }
-        std::cout << "[Encode] Wrote " << bitstream.size() << " bytes to output.\n";
-        
-        framesProcessed++;
-        std::cout << "[Encode] Frame " << framesProcessed << " processed.\n";
+        failed = !receiveDecoded();
     }
-    if (blit.ready())
+
+    // Flush the decoder, then the encoder; the remaining packets come out in submission order.
+    if (!failed)
     {
-        blit.shutdown();
+        avcodec_send_packet(decodeCtx, nullptr);
+        failed = !receiveDecoded();
     }
+    if (!failed && encodeCtx)
+    {
+        avcodec_send_frame(encodeCtx, nullptr);
+        failed = !drainPackets(nullptr);
+    }
+    const double elapsedSeconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - loopStart).count();
+
+    // Nothing may still reference the slot pictures or copy command buffers when they go.
+    vkDeviceWaitIdle(engine.logicalDevice);
 
-    // Cleanup encode resources
-    destroyEncodeResources(engine, encRes);
-    if (encodeSession)
+    avcodec_free_context(&encodeCtx);
+    for (PipelineSlot& slot : slots)
     {
-        destroyEncodeSession(engine, *encodeSession);
+        av_frame_free(&slot.picture);
     }
-    // decode resources cleanup already handled by destructors? Not yet, but we can add later.
+    av_buffer_unref(&encodeFrames);
+    av_frame_free(&decoded);
+    av_packet_free(&encoded);
+    av_packet_free(&packet);
+    avcodec_free_context(&decodeCtx);
+    av_buffer_unref(&hwDevice);
+    vkDestroyCommandPool(engine.logicalDevice, copyPool, nullptr);
 
-    std::cout << "[Encode] Processed " << framesProcessed << " Annex-B frames (decode functional, encode attempted).\n";
-    return 0;
+    const double fps = elapsedSeconds > 0.0 ? static_cast<double>(framesProcessed) / elapsedSeconds : 0.0;
+    std::cout << "[Encode] Processed " << framesProcessed << " Annex-B frames in " << elapsedSeconds << " s ("
+              << fps << " frames/sec, " << bytesWritten << " bytes, pipeline depth " << kPipelineDepth << ").\n";
+    return failed ? 1 : 0;
 }
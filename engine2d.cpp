@@ -188,6 +188,27 @@ VkPhysicalDeviceProperties& Engine2D::getDeviceProperties() {
     return renderDevice.getDeviceProperties();
 }
 
+void Engine2D::play() {
+    if (clock.started())
+        clock.resume();
+    else
+        clock.start();
+}
+
+void Engine2D::pause() {
+    // Pausing before the first frame keeps the clock at 0 until play()
+    clock.start();
+    clock.pause();
+}
+
+void Engine2D::seek(float timeSeconds) {
+    clock.seek(std::max(0.0f, timeSeconds));
+}
+
+void Engine2D::setCurrentTime(float timeSeconds) {
+    seek(timeSeconds);
+}
+
 
 // Helper: Create a Vulkan image view
 VkImageView Engine2D::createImageView(VkImage image, VkFormat format)
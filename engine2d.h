@@ -11,6 +11,7 @@
 #include "crop.h"
 #include "graphicsdevice.h"
 #include "image_resource.h"
+#include "media_clock.h"
 
 
 class Engine2D {
@@ -52,14 +53,23 @@ public:
     };
     VideoInfo getVideoInfo() const;
 
+    // Master playback clock, shared by every decoder (DecoderVulkan::setMasterClock), window,
+    // the scrubber and overlay lookups. The controls below drive it; seeking the decoders
+    // themselves is up to their owner.
+    MediaClock clock;
+
     // Playback control
     void play();
     void pause();
-    bool isPlaying() const { return playing; }
+    bool isPlaying() const { return !clock.paused(); }
     void seek(float timeSeconds);
-    float getCurrentTime() const { return currentTime; }
+    float getCurrentTime() const { return static_cast<float>(clock.seconds()); }
     float getDuration() const { return duration; }
     void setCurrentTime(float timeSeconds);
+    // Negative plays backwards; decoders presenting against `clock` need the same rate
+    // (DecoderVulkan::setPlaybackRate).
+    void setPlaybackRate(double rate) { clock.setRate(rate); }
+    double getPlaybackRate() const { return clock.rate(); }
 
     // Render a frame to all windows
     bool renderFrame();
@@ -99,8 +109,6 @@ public:
     // Video state
     bool videoLoaded = false;
     float duration = 0.0f;
-    float currentTime = 0.0f;
-    bool playing = true;
     bool decodeDebugEnabled = false;
     
     
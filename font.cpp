@@ -15,21 +15,32 @@
 //   - engine->findMemoryType(typeBits, props) exists
 //
 // If your Engine2D names differ, search/replace those calls.
-// This file intentionally owns its own tiny "immediate submit" command pool for atlas uploads.
+//
+// Atlas uploads:
+//   - rasterizeAndCacheGlyph() only records a dirty rectangle + its pixels on the CPU.
+//   - update(frameIndex) packs the dirty rectangles into that slot's staging buffer.
+//   - dispatch(cmd, frameIndex) records them into the frame command buffer as ONE
+//     vkCmdCopyBufferToImage with one region per glyph; no extra submits or fence waits.
+//   - When the shelf packer runs out of rows the atlas doubles in height (old contents are
+//     copied on the GPU); only at the device limit does it fall back to clearing the cache.
 //
 // Atlas format:
-//   - Uses VK_FORMAT_R8_UNORM (single-channel) and samples .r in shader.
-//   - If you want MSDF, you’d switch to VK_FORMAT_R8G8B8A8_UNORM and change the shader sampling.
+//   - AtlasMode::Coverage: VK_FORMAT_R8_UNORM FT_LOAD_RENDER bitmaps, one entry per
+//     (codepoint, pixel height). Edges are not scale-perfect; every size re-rasterizes.
+//   - AtlasMode::Msdf: VK_FORMAT_R8G8B8A8_UNORM multi-channel distance fields (msdf.h), one
+//     entry per codepoint baked at kMsdfBakePx and scaled to any pixel height. The outline is
+//     read on the calling thread; the distance field is computed on a worker thread and
+//     uploaded once collected, so a new glyph shows up a frame or two after first use.
 //
 // Shader expectation:
 //   - The Text pass uses shaders/text_sdf.spv and expects sampler2D fontAtlas.
-//   - SDF/MSDF decoding is done in shader; here we’re uploading a plain grayscale coverage bitmap.
-//     That will still render, but edges will not be scale-perfect like true SDF.
-//     (To get true SDF, you must generate SDF bitmaps, not FT_LOAD_RENDER coverage.)
+//   - GlyphInstance flag bit1 selects MSDF reconstruction (median of RGB, true distance in A);
+//     otherwise .r is treated as coverage/SDF.
 
 #include "font.h"
 
 #include "engine2d.h"
+#include "msdf.h"
 #include "text.h"
 #include "utils.h"
 #include "debug_logging.h"
@@ -37,13 +48,21 @@
 #include <algorithm>
 #include <array>
 #include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
 #include <cstdint>
 #include <cstring>
+#include <deque>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -55,6 +74,12 @@ namespace
 {
 static uint32_t ceilDiv(uint32_t a, uint32_t b) { return (a + b - 1u) / b; }
 
+// MSDF glyphs are baked once at this size and scaled to every pixel height.
+constexpr uint32_t kMsdfBakePx = 48;
+constexpr float kMsdfPxRange = 6.0f; // distance band in atlas texels
+
+static uint32_t texelBytes(VkFormat format) { return format == VK_FORMAT_R8G8B8A8_UNORM ? 4u : 1u; }
+
 // --- font locate helper (mirrors your earlier style) ---
 static std::filesystem::path locateFontFile(const std::filesystem::path& preferred)
 {
@@ -230,6 +255,41 @@ struct GlyphKeyEq
 } // namespace
 
 // -------------------- Font private state (glyph map) --------------------
+// A laid-out line: glyph quads relative to the line's top-left pen position, with atlas
+// rects in pixels (UVs are derived at emit time, so atlas growth does not invalidate it).
+struct FontLineLayout
+{
+    struct Placed
+    {
+        int32_t x0 = 0, y0 = 0;
+        uint16_t w = 0, h = 0;           // quad size in output pixels
+        uint16_t atlasX = 0, atlasY = 0;
+        uint16_t atlasW = 0, atlasH = 0; // differs from w/h when MSDF glyphs are scaled
+        uint16_t word = 0;               // index of the whitespace-separated word in the line
+    };
+    std::vector<Placed> glyphs;
+};
+
+// Line cache key: the shaped quads depend on the text, the pixel height and the atlas mode
+// (glyph metrics and atlas rects differ between coverage and MSDF glyphs). Colours, origin
+// and line spacing are applied when instances are emitted.
+struct FontLineKey
+{
+    std::string text;
+    uint32_t px = 0;
+    Font::AtlasMode mode = Font::AtlasMode::Coverage;
+
+    bool operator==(const FontLineKey& o) const { return px == o.px && mode == o.mode && text == o.text; }
+};
+
+struct FontLineKeyHash
+{
+    size_t operator()(const FontLineKey& k) const noexcept
+    {
+        return std::hash<std::string>{}(k.text) ^ (size_t(k.px) * 0x9e3779b97f4a7c15ull) ^ size_t(k.mode);
+    }
+};
+
 struct FontGlyphMap
 {
     std::unordered_map<Font::GlyphKey, Font::GlyphEntry, GlyphKeyHash, GlyphKeyEq> map;
@@ -238,23 +298,140 @@ struct FontGlyphMap
     uint32_t cursorX = 1;
     uint32_t cursorY = 1;
     uint32_t rowH = 0;
+
+    // Set when the atlas is full at its size limit. The reset happens at the start of the next
+    // update(), never mid-layout: rects already emitted this frame must stay valid.
+    bool evictPending = false;
+
+    std::unordered_map<FontLineKey, FontLineLayout, FontLineKeyHash> lineCache;
+    static constexpr size_t kMaxCachedLines = 1024;
+    FontLineLayout partialLine; // a line missing glyphs until the eviction; never cached
+    FontLineKey lookupKey;      // reused so cache hits do not allocate
+
+    // Face metrics for the current pixel size (0 = not yet queried).
+    uint32_t metricsPx = 0;
+    int ascent = 0;
+    int lineH = 1;
+
+    // Scratch reused across frames so steady-state layout does not allocate.
+    std::vector<Text::GlyphInstance> instances;
+    std::vector<Text::TileSpan> spans;
+    std::vector<uint32_t> tileGlyphs;
+    std::vector<uint32_t> tileCursor;
+    std::vector<glm::ivec2> wordExtents; // [x0, x1) per word of the line being emitted
 };
 
 // -------------------- Vulkan upload state --------------------
 struct FontUploadContext
 {
-    VkCommandPool pool = VK_NULL_HANDLE;
-    VkCommandBuffer cmd = VK_NULL_HANDLE;
-    VkFence fence = VK_NULL_HANDLE;
-
-    VkBuffer staging = VK_NULL_HANDLE;
-    VkDeviceMemory stagingMem = VK_NULL_HANDLE;
-    void* stagingMapped = nullptr;
-    VkDeviceSize stagingSize = 0;
+    // Glyph bitmaps rasterized since the last update(), tightly packed R8.
+    struct DirtyRect
+    {
+        uint32_t x = 0, y = 0, w = 0, h = 0;
+        size_t offset = 0; // into pixels
+    };
+    std::vector<DirtyRect> dirty;
+    std::vector<uint8_t> pixels;
+
+    // Per frame slot: staging written by update(fi), consumed by dispatch(cmd, fi).
+    struct FrameStaging
+    {
+        VkBuffer buf = VK_NULL_HANDLE;
+        VkDeviceMemory mem = VK_NULL_HANDLE;
+        void* mapped = nullptr;
+        VkDeviceSize capacity = 0;
+        VkDeviceSize used = 0;
+        std::vector<VkBufferImageCopy> regions;
+    };
+    std::vector<FrameStaging> frames;
+
+    // Pending GPU-side copy of the previous atlas into a grown one.
+    VkImage growSrc = VK_NULL_HANDLE;
+    VkImageLayout growSrcLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkExtent2D growSrcExtent{0, 0};
+
+    // Old atlas images stay alive until every slot that may reference them has retired.
+    struct Retired
+    {
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        VkDeviceMemory mem = VK_NULL_HANDLE;
+        uint32_t framesLeft = 0;
+    };
+    std::vector<Retired> retired;
 
     VkImageLayout atlasLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 };
 
+// -------------------- MSDF worker --------------------
+// FT_Face is not thread-safe, so outlines are extracted by the caller; the worker only
+// evaluates distance fields. Results are collected by update() on the render thread.
+struct FontMsdfWorker
+{
+    struct Job
+    {
+        MsdfShape shape;
+        uint32_t x = 0, y = 0, w = 0, h = 0; // atlas rect
+        float left = 0, top = 0;             // rect origin in outline space
+        uint64_t epoch = 0;
+    };
+    struct Result
+    {
+        uint32_t x = 0, y = 0, w = 0, h = 0;
+        std::vector<uint8_t> rgba;
+        uint64_t epoch = 0;
+        double ms = 0.0;
+    };
+
+    std::mutex m;
+    std::condition_variable cv;
+    std::deque<Job> jobs;
+    std::vector<Result> done;
+    uint64_t epoch = 1; // bumped by clearCache(); results of older epochs are discarded
+    bool stopping = false;
+    std::thread thread;
+
+    void start()
+    {
+        if (!thread.joinable())
+            thread = std::thread(&FontMsdfWorker::run, this);
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lk(m);
+            stopping = true;
+        }
+        cv.notify_all();
+        if (thread.joinable())
+            thread.join();
+    }
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lk(m);
+        while (true)
+        {
+            cv.wait(lk, [&] { return stopping || !jobs.empty(); });
+            if (stopping)
+                return;
+            Job job = std::move(jobs.front());
+            jobs.pop_front();
+            lk.unlock();
+
+            Result r{job.x, job.y, job.w, job.h, {}, job.epoch, 0.0};
+            r.rgba.resize(size_t(job.w) * job.h * 4);
+            const auto t0 = std::chrono::steady_clock::now();
+            generateMsdf(job.shape, job.w, job.h, job.left, job.top, kMsdfPxRange, r.rgba.data());
+            r.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+            lk.lock();
+            done.push_back(std::move(r));
+        }
+    }
+};
+
 // -------------------- Font implementation --------------------
 
 Font::Font(Engine2D* engine, uint32_t framesInFlight)
@@ -268,6 +445,7 @@ Font::Font(Engine2D* engine, uint32_t framesInFlight)
 
     text_ = new Text(engine_, framesInFlight_);
     frame_.resize(framesInFlight_);
+    boundAtlasViews_.assign(framesInFlight_, VK_NULL_HANDLE);
 
     glyphMap_ = new FontGlyphMap();
 
@@ -287,46 +465,28 @@ Font::Font(Engine2D* engine, uint32_t framesInFlight)
     if (vkCreateSampler(engine_->logicalDevice, &si, nullptr, &atlasSampler_) != VK_SUCCESS)
         throw std::runtime_error("Font: failed to create atlas sampler");
 
-    // Create upload context (small immediate submit)
     auto* up = new FontUploadContext();
-    // command pool
-    VkCommandPoolCreateInfo pci{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
-    pci.queueFamilyIndex = engine_->getGraphicsQueueFamilyIndex();
-    pci.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-    if (vkCreateCommandPool(engine_->logicalDevice, &pci, nullptr, &up->pool) != VK_SUCCESS)
-        throw std::runtime_error("Font: failed to create upload command pool");
-
-    VkCommandBufferAllocateInfo cai{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
-    cai.commandPool = up->pool;
-    cai.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    cai.commandBufferCount = 1;
-    if (vkAllocateCommandBuffers(engine_->logicalDevice, &cai, &up->cmd) != VK_SUCCESS)
-        throw std::runtime_error("Font: failed to alloc upload command buffer");
-
-    VkFenceCreateInfo fci{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
-    if (vkCreateFence(engine_->logicalDevice, &fci, nullptr, &up->fence) != VK_SUCCESS)
-        throw std::runtime_error("Font: failed to create upload fence");
-
-    // store in pointer slot we can reach via atlasDirty_ (we’ll just reinterpret-cast)
-    // (keeps header simple)
-    // We'll stash it in glyphMap_ map pointer by abusing nullptr? No—keep as member by using atlasDirty_? not ok.
-    // Instead: store it in ftLibrary_ when ft not initialized? No.
-    // We'll store it via glyphMap_ as a sidecar: simplest is to keep a static map from this pointer, but no.
-    // We'll instead use ftLibrary_ pointer slot once initialized? Also no.
-    //
-    // Since header does not provide a field, we’ll keep it as a function-static map keyed by this.
-    //
-    // To avoid that mess, we embed upload ctx into glyphMap_ object using a trailing pointer.
-    // (Still safe and private to this TU.)
-    // We'll just keep a global side-table:
-    //
-    // (This is purely internal; if you dislike it, add a `void* uploadCtx_` member to the header.)
-    static std::unordered_map<const Font*, FontUploadContext*> gUpload;
-    gUpload[this] = up;
+    up->frames.resize(framesInFlight_);
+    uploadCtx_ = up;
+
+    msdfWorker_ = new FontMsdfWorker();
+
+    VkPhysicalDeviceProperties props{};
+    vkGetPhysicalDeviceProperties(engine_->physicalDevice, &props);
+    maxAtlasHeight_ = std::min(maxAtlasHeight_, props.limits.maxImageDimension2D);
+    atlasStats_.atlasWidth = atlasWidth_;
+    atlasStats_.atlasHeight = atlasHeight_;
 }
 
 Font::~Font()
 {
+    if (auto* worker = reinterpret_cast<FontMsdfWorker*>(msdfWorker_))
+    {
+        worker->stop();
+        delete worker;
+        msdfWorker_ = nullptr;
+    }
+
     if (!engine_ || engine_->logicalDevice == VK_NULL_HANDLE)
         return;
 
@@ -353,20 +513,14 @@ Font::~Font()
     destroyImageAndView(engine_->logicalDevice, atlasImage_, atlasView_, atlasMem_);
 
     // Destroy upload context
-    static std::unordered_map<const Font*, FontUploadContext*> gUpload;
-    auto it = gUpload.find(this);
-    if (it != gUpload.end())
+    if (auto* up = reinterpret_cast<FontUploadContext*>(uploadCtx_))
     {
-        FontUploadContext* up = it->second;
-        if (up)
-        {
-            if (up->fence) vkDestroyFence(engine_->logicalDevice, up->fence, nullptr);
-            if (up->cmd) vkFreeCommandBuffers(engine_->logicalDevice, up->pool, 1, &up->cmd);
-            if (up->pool) vkDestroyCommandPool(engine_->logicalDevice, up->pool, nullptr);
-            destroyBuffer(engine_->logicalDevice, up->staging, up->stagingMem, up->stagingMapped);
-            delete up;
-        }
-        gUpload.erase(it);
+        for (auto& f : up->frames)
+            destroyBuffer(engine_->logicalDevice, f.buf, f.mem, f.mapped);
+        for (auto& r : up->retired)
+            destroyImageAndView(engine_->logicalDevice, r.image, r.view, r.mem);
+        delete up;
+        uploadCtx_ = nullptr;
     }
 
     // Destroy glyph map
@@ -394,6 +548,7 @@ void Font::resize(VkExtent2D extent, VkFormat format)
         text_->outputExtent_ = extent;
         text_->outputFormat_ = format;
     }
+    ++layoutGeneration_;
 }
 
 bool Font::ensureFreeType_()
@@ -468,9 +623,29 @@ void Font::setPixelHeight(uint32_t px)
     {
         FT_Set_Pixel_Sizes(reinterpret_cast<FT_Face>(ftFace_), 0, pixelHeight_);
     }
+    if (atlasMode_ == AtlasMode::Msdf && glyphMap_)
+    {
+        // Distance fields serve every size; only the metrics change (lines are keyed by size).
+        auto* gm = reinterpret_cast<FontGlyphMap*>(glyphMap_);
+        gm->metricsPx = 0;
+        ++layoutGeneration_;
+        return;
+    }
     clearCache();
 }
 
+void Font::setAtlasMode(AtlasMode mode)
+{
+    if (mode == atlasMode_)
+        return;
+    atlasMode_ = mode;
+
+    // Recreate the atlas in the new format on next use.
+    retireAtlas_();
+    atlasFormat_ = (mode == AtlasMode::Msdf) ? VK_FORMAT_R8G8B8A8_UNORM : VK_FORMAT_R8_UNORM;
+    clearCache(); // also forgets a pending grow copy out of an old-format image
+}
+
 void Font::setSdfPxRange(float pxRange)
 {
     sdfPxRange_ = std::max(0.0001f, pxRange);
@@ -479,8 +654,12 @@ void Font::setSdfPxRange(float pxRange)
 
 void Font::setText(std::string textUtf8)
 {
+    if (textUtf8 == textUtf8_ && !lines_.empty())
+        return;
+    ++layoutGeneration_;
     textUtf8_ = std::move(textUtf8);
     lines_.clear();
+    lineTimings_.clear();
 
     // Split on '\n'
     size_t start = 0;
@@ -498,12 +677,27 @@ void Font::setText(std::string textUtf8)
 
 void Font::setLines(std::vector<std::string> lines)
 {
+    if (lines == lines_ && textUtf8_.empty())
+        return;
+    ++layoutGeneration_;
     lines_ = std::move(lines);
     textUtf8_.clear();
 }
 
+void Font::setLineTimings(std::vector<LineTiming> timings)
+{
+    ++layoutGeneration_;
+    lineTimings_ = std::move(timings);
+}
+
 void Font::setStyle(const Style& s)
 {
+    // highlightColor/fadeSeconds are push constants and do not touch the instances
+    const bool same = s.textColor == style_.textColor && s.backgroundColor == style_.backgroundColor &&
+                      s.originPx == style_.originPx && s.lineSpacingPx == style_.lineSpacingPx &&
+                      s.enableBackground == style_.enableBackground;
+    if (!same)
+        ++layoutGeneration_;
     style_ = s;
 }
 
@@ -516,27 +710,64 @@ void Font::clearCache()
         gm->cursorX = 1;
         gm->cursorY = 1;
         gm->rowH = 0;
+        gm->evictPending = false;
+        gm->lineCache.clear();
+        gm->metricsPx = 0;
+    }
+    ++layoutGeneration_;
+
+    // Glyphs staged but not yet recorded would land on top of the new packing; drop them.
+    if (auto* up = reinterpret_cast<FontUploadContext*>(uploadCtx_))
+    {
+        up->dirty.clear();
+        up->pixels.clear();
+        for (auto& f : up->frames)
+        {
+            f.regions.clear();
+            f.used = 0;
+        }
+        up->growSrc = VK_NULL_HANDLE; // stays in the retired list until slots cycle
+    }
+
+    // Queued distance fields target the old packing; running/finished ones are dropped on collect.
+    if (auto* worker = reinterpret_cast<FontMsdfWorker*>(msdfWorker_))
+    {
+        std::lock_guard<std::mutex> lk(worker->m);
+        atlasStats_.glyphsPending -= uint32_t(worker->jobs.size());
+        worker->jobs.clear();
+        ++worker->epoch;
     }
 
-    // Mark atlas dirty and also clear it to 0 (we'll reupload on next update)
+    // The next dispatch clears the atlas image on the GPU (no staging bytes).
     atlasDirty_ = true;
 }
 
-static void ensureStagingCapacity(Engine2D* engine, FontUploadContext* up, VkDeviceSize bytes)
+// Grows a slot's staging buffer, preserving bytes staged but not yet recorded.
+static void ensureStagingCapacity(Engine2D* engine, FontUploadContext::FrameStaging& f, VkDeviceSize bytes)
 {
-    if (up->staging != VK_NULL_HANDLE && up->stagingSize >= bytes)
+    if (f.buf != VK_NULL_HANDLE && f.capacity >= bytes)
         return;
 
-    destroyBuffer(engine->logicalDevice, up->staging, up->stagingMem, up->stagingMapped);
+    const VkDeviceSize capacity = std::max<VkDeviceSize>(bytes, std::max<VkDeviceSize>(f.capacity * 2, 64 * 1024));
 
-    engine->createBuffer(bytes,
+    VkBuffer buf = VK_NULL_HANDLE;
+    VkDeviceMemory mem = VK_NULL_HANDLE;
+    void* mapped = nullptr;
+    engine->createBuffer(capacity,
                          VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                         up->staging,
-                         up->stagingMem);
-
-    up->stagingSize = bytes;
-    vkMapMemory(engine->logicalDevice, up->stagingMem, 0, bytes, 0, &up->stagingMapped);
+                         buf,
+                         mem);
+    vkMapMemory(engine->logicalDevice, mem, 0, capacity, 0, &mapped);
+
+    if (f.mapped && f.used > 0)
+        std::memcpy(mapped, f.mapped, size_t(f.used));
+    destroyBuffer(engine->logicalDevice, f.buf, f.mem, f.mapped);
+
+    f.buf = buf;
+    f.mem = mem;
+    f.mapped = mapped;
+    f.capacity = capacity;
 }
 
 void Font::rebuildAtlasIfNeeded_()
@@ -555,7 +786,7 @@ void Font::rebuildAtlasIfNeeded_()
     ii.arrayLayers = 1;
     ii.samples = VK_SAMPLE_COUNT_1_BIT;
     ii.tiling = VK_IMAGE_TILING_OPTIMAL;
-    ii.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    ii.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
     ii.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
     ii.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 
@@ -587,88 +818,258 @@ void Font::rebuildAtlasIfNeeded_()
     if (vkCreateImageView(engine_->logicalDevice, &vi, nullptr, &atlasView_) != VK_SUCCESS)
         throw std::runtime_error("Font: failed to create atlas view");
 
-    // Inform Text about the atlas now (descriptor rebuild will happen there)
-    if (text_)
-        text_->setAtlas(atlasView_, atlasSampler_);
+    // Text picks up the new view in dispatch(); the first recorded upload clears it.
+    if (auto* up = reinterpret_cast<FontUploadContext*>(uploadCtx_))
+        up->atlasLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 
+    atlasStats_.atlasWidth = atlasWidth_;
+    atlasStats_.atlasHeight = atlasHeight_;
+    atlasStats_.atlasBytes = uint64_t(atlasWidth_) * atlasHeight_ * texelBytes(atlasFormat_);
     atlasDirty_ = true;
 }
 
-void Font::ensureAtlasUploaded_()
+// Hands the atlas image to the retired list. Slots in flight may still sample it; each slot
+// rebinds the new view in its own dispatch(), and the old image is destroyed once all of them
+// have cycled, so nothing waits on the queue.
+void Font::retireAtlas_()
+{
+    auto* up = reinterpret_cast<FontUploadContext*>(uploadCtx_);
+    if (!up || atlasImage_ == VK_NULL_HANDLE)
+        return;
+
+    up->retired.push_back(FontUploadContext::Retired{atlasImage_, atlasView_, atlasMem_, framesInFlight_ + 1});
+    atlasImage_ = VK_NULL_HANDLE;
+    atlasView_ = VK_NULL_HANDLE;
+    atlasMem_ = VK_NULL_HANDLE;
+}
+
+bool Font::growAtlas_()
 {
-    if (!atlasDirty_) return;
+    auto* up = reinterpret_cast<FontUploadContext*>(uploadCtx_);
+    if (!up || atlasImage_ == VK_NULL_HANDLE || atlasHeight_ * 2 > maxAtlasHeight_)
+        return false;
+
+    if (up->growSrc == VK_NULL_HANDLE)
+    {
+        up->growSrc = atlasImage_;
+        up->growSrcLayout = up->atlasLayout;
+        up->growSrcExtent = VkExtent2D{atlasWidth_, atlasHeight_};
+    }
+    // else: a grow is already pending and this image never received data; the pending
+    // copy keeps reading from the original source.
+    retireAtlas_();
+
+    atlasHeight_ *= 2;
     rebuildAtlasIfNeeded_();
-    if (atlasImage_ == VK_NULL_HANDLE) return;
+    ++layoutGeneration_; // V coordinates of every uploaded instance changed
 
-    // Upload a full clear to 0 on first dirty (simple approach).
-    // For incremental updates, you’d upload only dirty rectangles; start with full upload.
-    static std::unordered_map<const Font*, FontUploadContext*> gUpload;
-    FontUploadContext* up = gUpload[this];
-    if (!up) return;
+    ++atlasStats_.growCount;
+    LOG_DEBUG(std::cout << "[Font] Atlas grown to " << atlasWidth_ << "x" << atlasHeight_ << "\n");
+    return true;
+}
 
-    const VkDeviceSize bytes = VkDeviceSize(atlasWidth_) * VkDeviceSize(atlasHeight_); // R8
-    ensureStagingCapacity(engine_, up, bytes);
+void Font::stageDirtyGlyphs_(uint32_t frameIndex)
+{
+    auto* up = reinterpret_cast<FontUploadContext*>(uploadCtx_);
+    if (!up || up->dirty.empty()) return;
 
-    std::memset(up->stagingMapped, 0, size_t(bytes));
+    auto& f = up->frames[frameIndex % framesInFlight_];
 
-    // record + submit
-    vkResetFences(engine_->logicalDevice, 1, &up->fence);
-    vkResetCommandBuffer(up->cmd, 0);
+    // Offsets kept 4-byte aligned so the same regions are valid on transfer-only queues.
+    const uint32_t bpp = texelBytes(atlasFormat_);
+    VkDeviceSize needed = f.used;
+    for (const auto& r : up->dirty)
+        needed += (VkDeviceSize(r.w) * r.h * bpp + 3) & ~VkDeviceSize(3);
+    ensureStagingCapacity(engine_, f, needed);
 
-    VkCommandBufferBeginInfo bi{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
-    bi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-    vkBeginCommandBuffer(up->cmd, &bi);
+    uint8_t* dst = reinterpret_cast<uint8_t*>(f.mapped);
+    for (const auto& r : up->dirty)
+    {
+        const size_t bytes = size_t(r.w) * r.h * bpp;
+        std::memcpy(dst + f.used, up->pixels.data() + r.offset, bytes);
+
+        VkBufferImageCopy copy{};
+        copy.bufferOffset = f.used;
+        copy.bufferRowLength = 0; // tightly packed
+        copy.bufferImageHeight = 0;
+        copy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        copy.imageSubresource.mipLevel = 0;
+        copy.imageSubresource.baseArrayLayer = 0;
+        copy.imageSubresource.layerCount = 1;
+        copy.imageOffset = VkOffset3D{int32_t(r.x), int32_t(r.y), 0};
+        copy.imageExtent = VkExtent3D{r.w, r.h, 1};
+        f.regions.push_back(copy);
+
+        f.used += (VkDeviceSize(bytes) + 3) & ~VkDeviceSize(3);
+    }
 
-    cmdTransitionImage(up->cmd,
+    up->dirty.clear();
+    up->pixels.clear();
+}
+
+void Font::recordAtlasUploads_(VkCommandBuffer cmd, uint32_t frameIndex)
+{
+    auto* up = reinterpret_cast<FontUploadContext*>(uploadCtx_);
+    if (!up || cmd == VK_NULL_HANDLE || atlasImage_ == VK_NULL_HANDLE) return;
+
+    // Retire old atlas images once no slot can still be sampling them.
+    for (size_t i = 0; i < up->retired.size();)
+    {
+        auto& r = up->retired[i];
+        if (r.image == up->growSrc || --r.framesLeft > 0)
+        {
+            ++i;
+            continue;
+        }
+        destroyImageAndView(engine_->logicalDevice, r.image, r.view, r.mem);
+        up->retired.erase(up->retired.begin() + std::ptrdiff_t(i));
+    }
+
+    auto& f = up->frames[frameIndex % framesInFlight_];
+    if (!atlasDirty_ && up->growSrc == VK_NULL_HANDLE && f.regions.empty())
+        return;
+
+    const VkAccessFlags readAccess =
+        (up->atlasLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) ? VK_ACCESS_SHADER_READ_BIT : 0;
+    cmdTransitionImage(cmd,
                        atlasImage_,
                        up->atlasLayout,
                        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                       0,
+                       readAccess,
                        VK_ACCESS_TRANSFER_WRITE_BIT,
-                       VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
                        VK_PIPELINE_STAGE_TRANSFER_BIT);
 
-    VkBufferImageCopy copy{};
-    copy.bufferOffset = 0;
-    copy.bufferRowLength = 0;   // tightly packed
-    copy.bufferImageHeight = 0;
-    copy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    copy.imageSubresource.mipLevel = 0;
-    copy.imageSubresource.baseArrayLayer = 0;
-    copy.imageSubresource.layerCount = 1;
-    copy.imageOffset = VkOffset3D{0, 0, 0};
-    copy.imageExtent = VkExtent3D{atlasWidth_, atlasHeight_, 1};
-
-    vkCmdCopyBufferToImage(up->cmd,
-                           up->staging,
+    // Orders clear -> grow copy -> glyph copies, which may overlap.
+    auto transferBarrier = [&]() {
+        cmdTransitionImage(cmd,
                            atlasImage_,
                            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                           1,
-                           &copy);
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           VK_ACCESS_TRANSFER_WRITE_BIT,
+                           VK_ACCESS_TRANSFER_WRITE_BIT,
+                           VK_PIPELINE_STAGE_TRANSFER_BIT,
+                           VK_PIPELINE_STAGE_TRANSFER_BIT);
+    };
+
+    if (atlasDirty_)
+    {
+        VkClearColorValue zero{};
+        VkImageSubresourceRange range{VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+        vkCmdClearColorImage(cmd, atlasImage_, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &zero, 1, &range);
+        atlasDirty_ = false;
+        if (up->growSrc != VK_NULL_HANDLE || !f.regions.empty())
+            transferBarrier();
+    }
+
+    // A source that never had anything recorded into it has nothing worth copying.
+    if (up->growSrc != VK_NULL_HANDLE && up->growSrcLayout == VK_IMAGE_LAYOUT_UNDEFINED)
+        up->growSrc = VK_NULL_HANDLE;
+
+    if (up->growSrc != VK_NULL_HANDLE)
+    {
+        cmdTransitionImage(cmd,
+                           up->growSrc,
+                           up->growSrcLayout,
+                           VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           (up->growSrcLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) ? VK_ACCESS_SHADER_READ_BIT : 0,
+                           VK_ACCESS_TRANSFER_READ_BIT,
+                           VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                           VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+        VkImageCopy ic{};
+        ic.srcSubresource = VkImageSubresourceLayers{VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+        ic.dstSubresource = ic.srcSubresource;
+        ic.extent = VkExtent3D{up->growSrcExtent.width, up->growSrcExtent.height, 1};
+        vkCmdCopyImage(cmd,
+                       up->growSrc, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                       atlasImage_, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                       1, &ic);
+
+        // The source is retired from the list below once this slot has cycled.
+        for (auto& r : up->retired)
+            if (r.image == up->growSrc)
+                r.framesLeft = framesInFlight_ + 1;
+        up->growSrc = VK_NULL_HANDLE;
+        up->growSrcLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        if (!f.regions.empty())
+            transferBarrier();
+    }
+
+    uint64_t bytes = 0;
+    if (!f.regions.empty())
+    {
+        vkCmdCopyBufferToImage(cmd,
+                               f.buf,
+                               atlasImage_,
+                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               uint32_t(f.regions.size()),
+                               f.regions.data());
+        for (const auto& r : f.regions)
+            bytes += uint64_t(r.imageExtent.width) * r.imageExtent.height * texelBytes(atlasFormat_);
+    }
 
-    cmdTransitionImage(up->cmd,
+    cmdTransitionImage(cmd,
                        atlasImage_,
                        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
                        VK_ACCESS_TRANSFER_WRITE_BIT,
                        VK_ACCESS_SHADER_READ_BIT,
                        VK_PIPELINE_STAGE_TRANSFER_BIT,
-                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    up->atlasLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    atlasStats_.uploadBytesLastFrame = bytes;
+    atlasStats_.uploadRegionsLastFrame = uint32_t(f.regions.size());
+    atlasStats_.uploadBytesTotal += bytes;
+    if (bytes > 0)
+    {
+        LOG_DEBUG(std::cout << "[Font] Atlas upload: " << f.regions.size() << " glyphs, " << bytes
+                            << " bytes (" << atlasStats_.uploadBytesTotal << " total)\n");
+    }
 
-    vkEndCommandBuffer(up->cmd);
+    f.regions.clear();
+    f.used = 0;
+}
 
-    VkSubmitInfo si{VK_STRUCTURE_TYPE_SUBMIT_INFO};
-    si.commandBufferCount = 1;
-    si.pCommandBuffers = &up->cmd;
+// Shelf-packs a w x h rect (1px padding), growing the atlas when needed. At the size limit it
+// returns false and schedules the cache reset for the next update(); the glyph is skipped
+// until then. Also false if the rect cannot fit even in an empty atlas.
+bool Font::packGlyph_(uint32_t w, uint32_t h, uint32_t& x, uint32_t& y)
+{
+    auto* gm = reinterpret_cast<FontGlyphMap*>(glyphMap_);
 
-    vkQueueSubmit(engine_->graphicsQueue, 1, &si, up->fence);
-    vkWaitForFences(engine_->logicalDevice, 1, &up->fence, VK_TRUE, UINT64_MAX);
+    const uint32_t pad = 1;
+    const uint32_t needW = w + pad;
+    const uint32_t needH = h + pad;
 
-    up->atlasLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    atlasDirty_ = false;
+    if (gm->cursorX + needW >= atlasWidth_)
+    {
+        gm->cursorX = 1;
+        gm->cursorY += gm->rowH + 1;
+        gm->rowH = 0;
+    }
+    if (gm->cursorY + needH >= atlasHeight_ && !growAtlas_())
+    {
+        // A rect that would not fit an empty atlas either must not trigger resets every frame.
+        if (!gm->evictPending && needW + 1 < atlasWidth_ && needH + 1 < atlasHeight_)
+        {
+            LOG_DEBUG(std::cout << "[Font] Atlas full; clearing cache next frame\n");
+            gm->evictPending = true;
+        }
+        return false;
+    }
+
+    x = gm->cursorX;
+    y = gm->cursorY;
+
+    gm->cursorX += needW;
+    gm->rowH = std::max(gm->rowH, needH);
+    return true;
 }
 
-// Rasterize a glyph and place it into atlas; uploads only that glyph region (incremental).
+// Rasterize a glyph and pack it into the atlas; the pixels are uploaded by the next dispatch().
 // Returns cached GlyphEntry on success.
 bool Font::rasterizeAndCacheGlyph(uint32_t codepoint, Font::GlyphEntry& out)
 {
@@ -677,13 +1078,19 @@ bool Font::rasterizeAndCacheGlyph(uint32_t codepoint, Font::GlyphEntry& out)
     rebuildAtlasIfNeeded_();
     if (atlasImage_ == VK_NULL_HANDLE) return false;
 
-    auto* gm = reinterpret_cast<FontGlyphMap*>(glyphMap_);
+    if (atlasMode_ == AtlasMode::Msdf)
+        return queueMsdfGlyph_(codepoint, out);
+
     FT_Face face = reinterpret_cast<FT_Face>(ftFace_);
 
     FT_Set_Pixel_Sizes(face, 0, std::max<uint32_t>(pixelHeight_, 1));
 
+    const auto t0 = std::chrono::steady_clock::now();
     if (FT_Load_Char(face, codepoint, FT_LOAD_RENDER) != 0)
         return false;
+    atlasStats_.rasterizeMsTotal +=
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    ++atlasStats_.glyphsRasterized;
 
     FT_GlyphSlot slot = face->glyph;
     const FT_Bitmap& bmp = slot->bitmap;
@@ -691,309 +1098,445 @@ bool Font::rasterizeAndCacheGlyph(uint32_t codepoint, Font::GlyphEntry& out)
     const uint32_t gw = bmp.width;
     const uint32_t gh = bmp.rows;
 
+    out.bearingX = int16_t(slot->bitmap_left);
+    out.bearingY = int16_t(slot->bitmap_top);
+    out.advanceX = int16_t(slot->advance.x >> 6);
+    out.advance = float(out.advanceX);
+
     // Handle space / empty glyphs
     if (gw == 0 || gh == 0)
     {
         out.x = out.y = out.w = out.h = 0;
-        out.bearingX = int16_t(slot->bitmap_left);
-        out.bearingY = int16_t(slot->bitmap_top);
-        out.advanceX = int16_t(slot->advance.x >> 6);
         return true;
     }
 
-    // Simple shelf packing with 1px padding
-    const uint32_t pad = 1;
-    const uint32_t needW = gw + pad;
-    const uint32_t needH = gh + pad;
-
-    if (gm->cursorX + needW >= atlasWidth_)
-    {
-        gm->cursorX = 1;
-        gm->cursorY += gm->rowH + 1;
-        gm->rowH = 0;
-    }
-    if (gm->cursorY + needH >= atlasHeight_)
-    {
-        // Atlas full; simplest policy: clear cache + atlas and restart.
-        // (You can implement multi-page atlases later.)
-        LOG_DEBUG(std::cout << "[Font] Atlas full; clearing cache\n");
-        clearCache();
-        ensureAtlasUploaded_(); // clears atlas image to zero
-        gm = reinterpret_cast<FontGlyphMap*>(glyphMap_);
-        // retry pack at start
-        gm->cursorX = 1;
-        gm->cursorY = 1;
-        gm->rowH = 0;
-
-        if (gm->cursorX + needW >= atlasWidth_ || gm->cursorY + needH >= atlasHeight_)
-            return false;
-    }
-
-    const uint32_t ax = gm->cursorX;
-    const uint32_t ay = gm->cursorY;
-
-    gm->cursorX += needW;
-    gm->rowH = std::max(gm->rowH, needH);
+    uint32_t ax = 0, ay = 0;
+    if (!packGlyph_(gw, gh, ax, ay))
+        return false;
 
     out.x = uint16_t(ax);
     out.y = uint16_t(ay);
     out.w = uint16_t(gw);
     out.h = uint16_t(gh);
-    out.bearingX = int16_t(slot->bitmap_left);
-    out.bearingY = int16_t(slot->bitmap_top);
-    out.advanceX = int16_t(slot->advance.x >> 6);
 
-    // Upload glyph bitmap into atlas as R8; FreeType bitmap.buffer is 8-bit coverage.
-    static std::unordered_map<const Font*, FontUploadContext*> gUpload;
-    FontUploadContext* up = gUpload[self];
+    // Queue the glyph bitmap as a dirty rectangle (R8; FreeType bitmap.buffer is 8-bit coverage).
+    auto* up = reinterpret_cast<FontUploadContext*>(uploadCtx_);
     if (!up) return false;
 
-    // Staging: tightly packed gw*gh bytes.
-    const VkDeviceSize bytes = VkDeviceSize(gw) * VkDeviceSize(gh);
-    ensureStagingCapacity(engine_, up, bytes);
+    FontUploadContext::DirtyRect rect{ax, ay, gw, gh, up->pixels.size()};
+    up->pixels.resize(up->pixels.size() + size_t(gw) * gh);
 
     // Copy rows (bmp.pitch may differ)
-    uint8_t* dst = reinterpret_cast<uint8_t*>(up->stagingMapped);
+    uint8_t* dst = up->pixels.data() + rect.offset;
     for (uint32_t row = 0; row < gh; ++row)
     {
         const uint8_t* srcRow = bmp.buffer + row * bmp.pitch;
         std::memcpy(dst + row * gw, srcRow, gw);
     }
+    up->dirty.push_back(rect);
 
-    vkResetFences(engine_->logicalDevice, 1, &up->fence);
-    vkResetCommandBuffer(up->cmd, 0);
+    return true;
+}
 
-    VkCommandBufferBeginInfo bi{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
-    bi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-    vkBeginCommandBuffer(up->cmd, &bi);
+// MSDF path: read the outline at kMsdfBakePx, reserve its atlas rect (distance band included)
+// and hand the distance field to the worker. Metrics are final immediately, so layout does not
+// wait; the texels arrive through collectMsdfGlyphs_().
+bool Font::queueMsdfGlyph_(uint32_t codepoint, Font::GlyphEntry& out)
+{
+    auto* worker = reinterpret_cast<FontMsdfWorker*>(msdfWorker_);
+    FT_Face face = reinterpret_cast<FT_Face>(ftFace_);
+    if (!worker) return false;
 
-    // transition atlas to transfer dst
-    cmdTransitionImage(up->cmd,
-                       atlasImage_,
-                       up->atlasLayout,
-                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                       (up->atlasLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) ? VK_ACCESS_SHADER_READ_BIT : 0,
-                       VK_ACCESS_TRANSFER_WRITE_BIT,
-                       VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-                       VK_PIPELINE_STAGE_TRANSFER_BIT);
+    FT_Set_Pixel_Sizes(face, 0, kMsdfBakePx);
+    if (FT_Load_Char(face, codepoint, FT_LOAD_NO_BITMAP | FT_LOAD_NO_HINTING) != 0)
+        return false;
 
-    VkBufferImageCopy copy{};
-    copy.bufferOffset = 0;
-    copy.bufferRowLength = 0;
-    copy.bufferImageHeight = 0;
-    copy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    copy.imageSubresource.mipLevel = 0;
-    copy.imageSubresource.baseArrayLayer = 0;
-    copy.imageSubresource.layerCount = 1;
-    copy.imageOffset = VkOffset3D{int32_t(ax), int32_t(ay), 0};
-    copy.imageExtent = VkExtent3D{gw, gh, 1};
-
-    vkCmdCopyBufferToImage(up->cmd,
-                           up->staging,
-                           atlasImage_,
-                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                           1,
-                           &copy);
+    FT_GlyphSlot slot = face->glyph;
+    out = GlyphEntry{};
+    out.advance = float(slot->advance.x) / 64.0f;
+    out.advanceX = int16_t(std::lround(out.advance));
+
+    MsdfShape shape;
+    if (slot->format != FT_GLYPH_FORMAT_OUTLINE || !msdfShapeFromOutline(&slot->outline, shape))
+        return true; // space / empty glyph: advance only
+
+    const int pad = int(std::ceil(kMsdfPxRange * 0.5f)) + 1;
+    const int left = int(std::floor(shape.minX)) - pad;
+    const int right = int(std::ceil(shape.maxX)) + pad;
+    const int bottom = int(std::floor(shape.minY)) - pad;
+    const int top = int(std::ceil(shape.maxY)) + pad;
+    const uint32_t gw = uint32_t(right - left);
+    const uint32_t gh = uint32_t(top - bottom);
+
+    uint32_t ax = 0, ay = 0;
+    if (!packGlyph_(gw, gh, ax, ay))
+        return false;
 
-    // back to shader read
-    cmdTransitionImage(up->cmd,
-                       atlasImage_,
-                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                       VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                       VK_ACCESS_TRANSFER_WRITE_BIT,
-                       VK_ACCESS_SHADER_READ_BIT,
-                       VK_PIPELINE_STAGE_TRANSFER_BIT,
-                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    out.x = uint16_t(ax);
+    out.y = uint16_t(ay);
+    out.w = uint16_t(gw);
+    out.h = uint16_t(gh);
+    out.bearingX = int16_t(left);
+    out.bearingY = int16_t(top);
 
-    vkEndCommandBuffer(up->cmd);
+    {
+        std::lock_guard<std::mutex> lk(worker->m);
+        FontMsdfWorker::Job job;
+        job.shape = std::move(shape);
+        job.x = ax;
+        job.y = ay;
+        job.w = gw;
+        job.h = gh;
+        job.left = float(left);
+        job.top = float(top);
+        job.epoch = worker->epoch;
+        worker->jobs.push_back(std::move(job));
+    }
+    worker->start();
+    worker->cv.notify_one();
+    ++atlasStats_.glyphsPending;
+    return true;
+}
 
-    VkSubmitInfo si{VK_STRUCTURE_TYPE_SUBMIT_INFO};
-    si.commandBufferCount = 1;
-    si.pCommandBuffers = &up->cmd;
+// Moves finished distance fields into the dirty list for this frame's upload.
+void Font::collectMsdfGlyphs_()
+{
+    auto* worker = reinterpret_cast<FontMsdfWorker*>(msdfWorker_);
+    auto* up = reinterpret_cast<FontUploadContext*>(uploadCtx_);
+    if (!worker || !up) return;
 
-    vkQueueSubmit(engine_->graphicsQueue, 1, &si, up->fence);
-    vkWaitForFences(engine_->logicalDevice, 1, &up->fence, VK_TRUE, UINT64_MAX);
+    std::vector<FontMsdfWorker::Result> done;
+    uint64_t epoch = 0;
+    {
+        std::lock_guard<std::mutex> lk(worker->m);
+        if (worker->done.empty())
+            return;
+        done.swap(worker->done);
+        epoch = worker->epoch;
+    }
 
-    up->atlasLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    for (auto& r : done)
+    {
+        atlasStats_.rasterizeMsTotal += r.ms;
+        ++atlasStats_.glyphsRasterized;
+        --atlasStats_.glyphsPending;
+        if (r.epoch != epoch)
+            continue; // started before clearCache(); its rect belongs to the old packing
+
+        FontUploadContext::DirtyRect rect{r.x, r.y, r.w, r.h, up->pixels.size()};
+        up->pixels.insert(up->pixels.end(), r.rgba.begin(), r.rgba.end());
+        up->dirty.push_back(rect);
+    }
+}
 
+// Face, atlas and line metrics for the current pixel height; false without a usable face.
+bool Font::prepareLayout_()
+{
+    if (!ensureFace_())
+        return false;
+
+    rebuildAtlasIfNeeded_();
+
+    auto* gm = reinterpret_cast<FontGlyphMap*>(glyphMap_);
+    if (gm->metricsPx != pixelHeight_)
+    {
+        FT_Face face = reinterpret_cast<FT_Face>(ftFace_);
+        FT_Set_Pixel_Sizes(face, 0, std::max<uint32_t>(pixelHeight_, 1));
+        const int descent = int(-(face->size->metrics.descender >> 6)); // make positive
+        gm->ascent = int(face->size->metrics.ascender >> 6);
+        gm->lineH = std::max<int>(1, gm->ascent + descent);
+        gm->metricsPx = pixelHeight_;
+    }
     return true;
 }
 
-void Font::buildInstancesAndTiles_(uint32_t frameIndex)
+// Shapes one line into glyph quads on cache miss, rasterizing glyphs the atlas does not have yet.
+// Requires prepareLayout_().
+const FontLineLayout& Font::cachedLineLayout_(const std::string& line)
 {
-    if (!text_) return;
-    if (outputExtent_.width == 0 || outputExtent_.height == 0) return;
+    auto* gm = reinterpret_cast<FontGlyphMap*>(glyphMap_);
+    gm->lookupKey.text.assign(line);
+    gm->lookupKey.px = pixelHeight_;
+    gm->lookupKey.mode = atlasMode_;
+    auto cached = gm->lineCache.find(gm->lookupKey);
+    if (cached != gm->lineCache.end())
+        return cached->second;
+
+    // MSDF entries are shared by all sizes (px = 0) and scaled from the bake size.
+    const bool msdf = atlasMode_ == AtlasMode::Msdf;
+    const uint32_t keyPx = msdf ? 0u : pixelHeight_;
+    const float scale = msdf ? float(pixelHeight_) / float(kMsdfBakePx) : 1.0f;
+
+    FontLineLayout out;
+    float penX = 0.0f;
+    uint16_t word = 0;
+    bool inWord = false;
+    for (uint32_t cp : utf8ToCodepoints(line))
+    {
+        // handle tab as spaces
+        if (cp == '\t') cp = ' ';
 
-    const uint32_t fi = frameIndex % framesInFlight_;
+        if (cp == ' ')
+        {
+            if (inWord) ++word;
+            inWord = false;
+        }
+        else
+        {
+            inWord = true;
+        }
 
-    // Choose lines: if setLines used, use that; else split from textUtf8_ already done by setText
-    const std::vector<std::string>& lines = lines_;
+        GlyphKey key{cp, keyPx};
+        GlyphEntry ge{};
 
-    // If no text, make empty upload
-    if (lines.empty())
-    {
-        std::vector<Text::GlyphInstance> glyphs;
-        std::vector<Text::TileSpan> spans(uint32_t(ceilDiv(outputExtent_.width, 16) * ceilDiv(outputExtent_.height, 16)));
-        std::vector<uint32_t> indices;
-        text_->upload(frameIndex, glyphs, spans, indices);
-        return;
+        auto it = gm->map.find(key);
+        if (it == gm->map.end())
+        {
+            if (!rasterizeAndCacheGlyph(cp, ge))
+            {
+                penX += ge.advance * scale; // metrics are known even when the atlas is full
+                continue;
+            }
+            gm->map.emplace(key, ge);
+        }
+        else
+        {
+            ge = it->second;
+        }
+
+        // advance-only glyph (space)
+        if (ge.w != 0 && ge.h != 0)
+        {
+            FontLineLayout::Placed p{};
+            p.x0 = int32_t(std::lround(penX + float(ge.bearingX) * scale));
+            p.y0 = gm->ascent - int32_t(std::lround(float(ge.bearingY) * scale));
+            p.w = uint16_t(std::max<long>(1, std::lround(float(ge.w) * scale)));
+            p.h = uint16_t(std::max<long>(1, std::lround(float(ge.h) * scale)));
+            p.atlasX = ge.x;
+            p.atlasY = ge.y;
+            p.atlasW = ge.w;
+            p.atlasH = ge.h;
+            p.word = word;
+            out.glyphs.push_back(p);
+        }
+        penX += ge.advance * scale;
     }
 
-    if (!ensureFace_()) return;
-    rebuildAtlasIfNeeded_();
+    // Glyphs skipped for a full atlas come back after the eviction; don't cache the gap.
+    if (gm->evictPending)
+    {
+        gm->partialLine = std::move(out);
+        return gm->partialLine;
+    }
+    if (gm->lineCache.size() >= FontGlyphMap::kMaxCachedLines)
+        gm->lineCache.clear();
+    return gm->lineCache.emplace(gm->lookupKey, std::move(out)).first->second;
+}
 
-    auto* gm = reinterpret_cast<FontGlyphMap*>(glyphMap_);
-    FT_Face face = reinterpret_cast<FT_Face>(ftFace_);
-    FT_Set_Pixel_Sizes(face, 0, std::max<uint32_t>(pixelHeight_, 1));
+void Font::prefetchLines(const std::vector<std::string>& lines)
+{
+    if (lines.empty() || !prepareLayout_())
+        return;
+    for (const std::string& line : lines)
+        cachedLineLayout_(line);
+}
 
-    const int ascent  = int(face->size->metrics.ascender >> 6);
-    const int descent = int(-(face->size->metrics.descender >> 6)); // make positive
-    const int lineH   = std::max<int>(1, ascent + descent);
+void Font::buildInstancesAndTiles_(uint32_t frameIndex)
+{
+    if (!text_) return;
+    if (outputExtent_.width == 0 || outputExtent_.height == 0) return;
 
+    auto* gm = reinterpret_cast<FontGlyphMap*>(glyphMap_);
     const uint32_t tileW = ceilDiv(outputExtent_.width, 16);
     const uint32_t tileH = ceilDiv(outputExtent_.height, 16);
     const uint32_t tileCount = tileW * tileH;
 
-    // Build glyph instances
-    std::vector<Text::GlyphInstance> glyphInstances;
-    glyphInstances.reserve(256);
+    auto& instances = gm->instances;
+    auto& spans = gm->spans;
+    auto& tileGlyphs = gm->tileGlyphs;
+    instances.clear();
+    tileGlyphs.clear();
+    spans.assign(tileCount, Text::TileSpan{});
 
-    // For tile binning: one vector per tile
-    std::vector<std::vector<uint32_t>> tileLists(tileCount);
+    // Choose lines: if setLines used, use that; else split from textUtf8_ already done by setText
+    const std::vector<std::string>& lines = lines_;
 
-    const int originX = style_.originPx.x;
-    const int originY = style_.originPx.y;
+    // If no text, make empty upload
+    if (lines.empty() || !prepareLayout_())
+    {
+        text_->upload(frameIndex, instances, spans, tileGlyphs);
+        return;
+    }
+
+    const bool msdf = atlasMode_ == AtlasMode::Msdf;
 
-    int penY = originY;
+    const int originX = style_.originPx.x;
+    int penY = style_.originPx.y;
+    const int outW = int(outputExtent_.width);
+    const int outH = int(outputExtent_.height);
 
+    // Emit instances from cached line layouts (shaping only on cache miss).
     for (size_t li = 0; li < lines.size(); ++li)
     {
-        const std::string& line = lines[li];
-        std::vector<uint32_t> cps = utf8ToCodepoints(line);
+        const FontLineLayout& layout = cachedLineLayout_(lines[li]);
 
-        int penX = originX;
-        const int baselineY = penY + ascent;
-
-        for (uint32_t cp : cps)
+        // Timed lines: each word's interval is spread over its glyphs by x, so the shader
+        // sweeps the highlight across the word as one edge.
+        const LineTiming* timing = li < lineTimings_.size() ? &lineTimings_[li] : nullptr;
+        auto& wordX = gm->wordExtents;
+        if (timing)
         {
-            // handle tab as spaces
-            if (cp == '\t') cp = ' ';
-
-            GlyphKey key{cp, pixelHeight_};
-            GlyphEntry ge{};
-
-            auto it = gm->map.find(key);
-            if (it == gm->map.end())
-            {
-                if (!rasterizeAndCacheGlyph(this, cp, ge))
-                    continue;
-                gm->map.emplace(key, ge);
-            }
-            else
-            {
-                ge = it->second;
-            }
-
-            // advance-only glyph (space)
-            if (ge.w == 0 || ge.h == 0)
+            wordX.assign(layout.glyphs.empty() ? 0 : layout.glyphs.back().word + 1u,
+                         glm::ivec2(std::numeric_limits<int>::max(), std::numeric_limits<int>::min()));
+            for (const auto& g : layout.glyphs)
             {
-                penX += ge.advanceX;
-                continue;
+                wordX[g.word].x = std::min(wordX[g.word].x, g.x0);
+                wordX[g.word].y = std::max(wordX[g.word].y, g.x0 + int(g.w));
             }
+        }
 
-            const int x0 = penX + ge.bearingX;
-            const int y0 = baselineY - ge.bearingY;
-            const int x1 = x0 + int(ge.w);
-            const int y1 = y0 + int(ge.h);
+        for (const auto& g : layout.glyphs)
+        {
+            const int x0 = originX + g.x0;
+            const int y0 = penY + g.y0;
+            const int x1 = x0 + int(g.w);
+            const int y1 = y0 + int(g.h);
 
-            // clip early if fully off-screen (optional)
-            if (x1 <= 0 || y1 <= 0 || x0 >= int(outputExtent_.width) || y0 >= int(outputExtent_.height))
-            {
-                penX += ge.advanceX;
+            // clip early if fully off-screen
+            if (x1 <= 0 || y1 <= 0 || x0 >= outW || y0 >= outH)
                 continue;
-            }
 
             Text::GlyphInstance inst{};
             inst.x0 = x0; inst.y0 = y0; inst.x1 = x1; inst.y1 = y1;
-
-            const float invW = 1.0f / float(atlasWidth_);
-            const float invH = 1.0f / float(atlasHeight_);
-
-            inst.u0 = float(ge.x) * invW;
-            inst.v0 = float(ge.y) * invH;
-            inst.u1 = float(ge.x + ge.w) * invW;
-            inst.v1 = float(ge.y + ge.h) * invH;
-
+            // UVs from the atlas size at the end of layout; fixed up below if it grew.
+            inst.u0 = float(g.atlasX);
+            inst.v0 = float(g.atlasY);
+            inst.u1 = float(g.atlasX + g.atlasW);
+            inst.v1 = float(g.atlasY + g.atlasH);
             inst.textColor = style_.textColor;
             inst.bgColor = style_.backgroundColor;
-            inst.flags = (style_.enableBackground ? 1u : 0u);
-
-            const uint32_t glyphIndex = uint32_t(glyphInstances.size());
-            glyphInstances.push_back(inst);
-
-            // Bin into tiles
-            const int tx0 = std::max(0, x0) / 16;
-            const int ty0 = std::max(0, y0) / 16;
-            const int tx1 = std::min(int(outputExtent_.width - 1), x1 - 1) / 16;
-            const int ty1 = std::min(int(outputExtent_.height - 1), y1 - 1) / 16;
-
-            for (int ty = ty0; ty <= ty1; ++ty)
+            inst.flags = (style_.enableBackground ? 1u : 0u) | (msdf ? 2u : 0u);
+            if (timing)
             {
-                for (int tx = tx0; tx <= tx1; ++tx)
-                {
-                    const uint32_t t = uint32_t(ty) * tileW + uint32_t(tx);
-                    if (t < tileCount)
-                        tileLists[t].push_back(glyphIndex);
-                }
+                // Words past the timed list (alignment dropped them) follow the last timed one.
+                WordTiming w{timing->start, timing->start};
+                if (g.word < timing->words.size())
+                    w = timing->words[g.word];
+                else if (!timing->words.empty())
+                    w = WordTiming{timing->words.back().end, timing->words.back().end};
+
+                const glm::ivec2 span = wordX[g.word];
+                const double width = double(std::max(1, span.y - span.x));
+                const double duration = std::max(0.0, w.end - w.start);
+                inst.timing.x = float(w.start + duration * double(g.x0 - span.x) / width);
+                inst.timing.y = float(w.start + duration * double(g.x0 + int(g.w) - span.x) / width);
+                inst.timing.z = float(timing->start);
+                inst.timing.w = float(timing->end);
+                inst.flags |= 4u;
             }
-
-            penX += ge.advanceX;
+            instances.push_back(inst);
         }
 
-        penY += int(float(lineH) + style_.lineSpacingPx);
+        penY += int(float(gm->lineH) + style_.lineSpacingPx);
     }
 
-    // Flatten tile lists -> spans + indices
-    std::vector<Text::TileSpan> spans(tileCount);
-    std::vector<uint32_t> tileGlyphIndices;
-    tileGlyphIndices.reserve(glyphInstances.size() * 2);
+    const float invW = 1.0f / float(atlasWidth_);
+    const float invH = 1.0f / float(atlasHeight_);
+    for (auto& inst : instances)
+    {
+        inst.u0 *= invW; inst.u1 *= invW;
+        inst.v0 *= invH; inst.v1 *= invH;
+    }
+
+    // Tile binning, two passes over flat arrays:
+    //   1) count glyph refs per tile, 2) exclusive prefix sum -> span starts, 3) scatter.
+    auto tileRange = [&](const Text::GlyphInstance& inst, int& tx0, int& ty0, int& tx1, int& ty1) {
+        tx0 = std::max(0, inst.x0) / 16;
+        ty0 = std::max(0, inst.y0) / 16;
+        tx1 = std::min(outW - 1, inst.x1 - 1) / 16;
+        ty1 = std::min(outH - 1, inst.y1 - 1) / 16;
+    };
 
-    uint32_t cursor = 0;
+    for (const auto& inst : instances)
+    {
+        int tx0, ty0, tx1, ty1;
+        tileRange(inst, tx0, ty0, tx1, ty1);
+        for (int ty = ty0; ty <= ty1; ++ty)
+            for (int tx = tx0; tx <= tx1; ++tx)
+                ++spans[uint32_t(ty) * tileW + uint32_t(tx)].count;
+    }
+
+    uint32_t total = 0;
+    auto& cursor = gm->tileCursor;
+    cursor.resize(tileCount);
     for (uint32_t t = 0; t < tileCount; ++t)
     {
-        spans[t].start = cursor;
-        spans[t].count = uint32_t(tileLists[t].size());
-        if (!tileLists[t].empty())
-        {
-            tileGlyphIndices.insert(tileGlyphIndices.end(), tileLists[t].begin(), tileLists[t].end());
-            cursor += uint32_t(tileLists[t].size());
-        }
+        spans[t].start = total;
+        cursor[t] = total;
+        total += spans[t].count;
+    }
+
+    tileGlyphs.resize(total);
+    for (uint32_t gi = 0; gi < uint32_t(instances.size()); ++gi)
+    {
+        int tx0, ty0, tx1, ty1;
+        tileRange(instances[gi], tx0, ty0, tx1, ty1);
+        for (int ty = ty0; ty <= ty1; ++ty)
+            for (int tx = tx0; tx <= tx1; ++tx)
+                tileGlyphs[cursor[uint32_t(ty) * tileW + uint32_t(tx)]++] = gi;
     }
 
     // Upload via Text
-    text_->upload(frameIndex, glyphInstances, spans, tileGlyphIndices);
+    text_->upload(frameIndex, instances, spans, tileGlyphs);
 }
 
 void Font::update(uint32_t frameIndex)
 {
-    // Ensure atlas exists and is cleared at least once
+    // The atlas filled up during the last layout; reset it before laying out again
+    auto* gm = reinterpret_cast<FontGlyphMap*>(glyphMap_);
+    if (gm && gm->evictPending)
+        clearCache();
+
+    // Ensure atlas exists (cleared by the first dispatch)
     rebuildAtlasIfNeeded_();
-    ensureAtlasUploaded_();
 
-    // Build instances + tiles and upload to Text
-    buildInstancesAndTiles_(frameIndex);
+    // Distance fields finished on the worker since the last frame
+    collectMsdfGlyphs_();
+
+    // Build instances + tiles and upload to Text; rasterizes any new glyphs.
+    // Each slot keeps its own Text SSBOs, so a slot that already holds the current
+    // layout needs neither the CPU rebuild nor the upload.
+    FrameData& fd = frame_[frameIndex % framesInFlight_];
+    if (fd.uploadedGeneration != layoutGeneration_)
+    {
+        buildInstancesAndTiles_(frameIndex);
+        fd.uploadedGeneration = layoutGeneration_;
+    }
+
+    // Move this frame's new glyphs into the slot's staging buffer
+    stageDirtyGlyphs_(frameIndex);
 }
 
 void Font::dispatch(VkCommandBuffer cmd, uint32_t frameIndex)
 {
     if (!text_) return;
 
-    // Make sure Text has atlas
-    if (atlasView_ != VK_NULL_HANDLE && atlasSampler_ != VK_NULL_HANDLE)
-        text_->setAtlas(atlasView_, atlasSampler_);
+    recordAtlasUploads_(cmd, frameIndex);
+
+    // Rebind only this slot's set: the others may still be pending with the old atlas
+    const uint32_t fi = frameIndex % framesInFlight_;
+    if (atlasView_ != boundAtlasViews_[fi] && atlasSampler_ != VK_NULL_HANDLE)
+    {
+        text_->setAtlas(frameIndex, atlasView_, atlasSampler_);
+        boundAtlasViews_[fi] = atlasView_;
+    }
+
+    // Keep sdfPxRange in sync; MSDF glyphs carry the band they were baked with
+    text_->setSdfPxRange(atlasMode_ == AtlasMode::Msdf ? kMsdfPxRange : sdfPxRange_);
 
-    // Keep sdfPxRange in sync
-    text_->setSdfPxRange(sdfPxRange_);
+    // Timed lines animate from the clock alone
+    text_->setHighlight(style_.highlightColor, style_.fadeSeconds);
+    text_->setTime(float(time_));
 
     text_->dispatch(cmd, frameIndex);
 }
@@ -11,6 +11,7 @@
 
 class Engine2D;
 class Text; // from text.h (the pass we wrapped)
+struct FontLineLayout; // cached line layout (font.cpp)
 
 class Font
 {
@@ -35,16 +36,57 @@ public:
         glm::ivec2 originPx{0, 0};                 // top-left origin in output pixel space
         float lineSpacingPx = 4.0f;                // extra spacing between lines
         bool enableBackground = false;             // per-glyph quad background (flag bit0)
+        glm::vec4 highlightColor{1.0f, 0.8f, 0.2f, 1.0f}; // timed lines: colour of sung words
+        float fadeSeconds = 0.15f;                 // timed lines: fade in/out at start/end
+    };
+
+    // Karaoke timing for one line of setLines(): words[i] belongs to the i-th
+    // whitespace-separated word of the line. Times are seconds on the setTime() clock.
+    struct WordTiming
+    {
+        double start = 0.0;
+        double end = 0.0;
+    };
+    struct LineTiming
+    {
+        double start = 0.0; // line visible from start until end
+        double end = 0.0;
+        std::vector<WordTiming> words;
     };
 
     struct GlyphEntry
     {
         // packing location in atlas (pixels)
         uint16_t x = 0, y = 0, w = 0, h = 0;
-        // FreeType metrics (pixels)
+        // FreeType metrics (pixels at the rasterized size)
         int16_t bearingX = 0;
         int16_t bearingY = 0;
         int16_t advanceX = 0;
+        float advance = 0.0f; // unrounded advanceX
+    };
+
+    // Coverage: FT_LOAD_RENDER bitmaps (R8), one atlas entry per codepoint and pixel height.
+    // Msdf: multi-channel distance fields (RGBA8) baked once per codepoint on a worker thread
+    //       and scaled to any pixel height in text.comp; new glyphs appear a frame or two late.
+    enum class AtlasMode
+    {
+        Coverage,
+        Msdf,
+    };
+
+    // Atlas upload accounting; "last frame" is the most recent dispatch() that recorded uploads.
+    struct AtlasStats
+    {
+        uint64_t uploadBytesLastFrame = 0;
+        uint32_t uploadRegionsLastFrame = 0;
+        uint64_t uploadBytesTotal = 0;
+        uint32_t growCount = 0;
+        uint32_t atlasWidth = 0;
+        uint32_t atlasHeight = 0;
+        uint64_t atlasBytes = 0;        // device memory of the atlas image (texels * texel size)
+        uint32_t glyphsRasterized = 0;  // bitmaps / distance fields produced so far
+        uint32_t glyphsPending = 0;     // MSDF jobs not yet collected from the worker
+        double rasterizeMsTotal = 0.0;  // CPU time spent producing them
     };
 
 
@@ -69,6 +111,10 @@ public:
     // Set pixel height for glyph rasterization (FreeType pixel size).
     void setPixelHeight(uint32_t px);
 
+    // Switches the atlas kind; drops every cached glyph and recreates the atlas image.
+    void setAtlasMode(AtlasMode mode);
+    AtlasMode atlasMode() const { return atlasMode_; }
+
     // SDF tuning passed through to Text shader (if your atlas is SDF; for bitmap atlas you can still set it, but it won't matter much).
     void setSdfPxRange(float pxRange);
 
@@ -78,6 +124,17 @@ public:
     // Provide explicit lines (already split), e.g. for subtitles.
     void setLines(std::vector<std::string> lines);
 
+    // Timings parallel to the lines (empty = static text). Timed glyphs are uploaded once per
+    // line set; highlighting and fades are then driven by setTime() alone.
+    void setLineTimings(std::vector<LineTiming> timings);
+
+    // Per-frame clock for timed lines; costs a push constant, no rebuild or upload.
+    void setTime(double seconds) { time_ = seconds; }
+
+    // Lays lines out into the glyph and line caches without drawing them, e.g. the next
+    // subtitle segments, so they do not cost a rasterization spike when they appear.
+    void prefetchLines(const std::vector<std::string>& lines);
+
     // Style controls
     void setStyle(const Style& s);
     const Style& style() const { return style_; }
@@ -87,11 +144,17 @@ public:
 
     // Per-frame: ensure atlas has required glyphs, build glyph instances + tile bins, upload to Text.
     // Safe to call multiple times; does CPU work and host buffer writes, no command recording.
+    // Lines are laid out once and cached; a slot whose buffers already hold the current text,
+    // style and size skips both the rebuild and the upload.
+    // New glyphs are staged into this slot's staging buffer, so call it after the slot's fence.
     void update(uint32_t frameIndex);
 
-    // Per-frame: record compute dispatch that draws into this pass output (via internal Text).
+    // Per-frame: record pending atlas writes (one batched vkCmdCopyBufferToImage) followed by
+    // the compute dispatch that draws into this pass output (via internal Text).
     void dispatch(VkCommandBuffer cmd, uint32_t frameIndex);
 
+    const AtlasStats& atlasStats() const { return atlasStats_; }
+
     // Output access mirrors ColorGrading/Text.
     Output output(uint32_t frameIndex) const;
     VkImageLayout outputLayout(uint32_t frameIndex) const;
@@ -105,9 +168,17 @@ private:
     bool ensureFreeType_();
     bool ensureFace_();
     void rebuildAtlasIfNeeded_();
-    void ensureAtlasUploaded_();              // upload any dirty regions to GPU
+    void retireAtlas_();
+    bool growAtlas_();                        // double atlas height, keeping existing glyphs
+    void stageDirtyGlyphs_(uint32_t frameIndex);
+    void recordAtlasUploads_(VkCommandBuffer cmd, uint32_t frameIndex);
     void buildInstancesAndTiles_(uint32_t frameIndex);
+    bool prepareLayout_();
+    const FontLineLayout& cachedLineLayout_(const std::string& line);
+    bool packGlyph_(uint32_t w, uint32_t h, uint32_t& x, uint32_t& y);
     bool rasterizeAndCacheGlyph(uint32_t codepoint, GlyphEntry& out);
+    bool queueMsdfGlyph_(uint32_t codepoint, GlyphEntry& out);
+    void collectMsdfGlyphs_();
 
 private:
     Engine2D* engine_ = nullptr;
@@ -120,10 +191,13 @@ private:
     std::filesystem::path fontPath_;
     uint32_t pixelHeight_ = 32;
     float sdfPxRange_ = 8.0f;
+    AtlasMode atlasMode_ = AtlasMode::Coverage;
 
     Style style_{};
     std::string textUtf8_;
     std::vector<std::string> lines_;
+    std::vector<LineTiming> lineTimings_;
+    double time_ = 0.0;
 
     // ---- FreeType objects (opaque here; defined/used in font.cpp) ----
     void* ftLibrary_ = nullptr;  // FT_Library
@@ -140,7 +214,16 @@ private:
 
     uint32_t atlasWidth_ = 1024;
     uint32_t atlasHeight_ = 1024;
-    bool atlasDirty_ = false;
+    uint32_t maxAtlasHeight_ = 8192;          // clamped to maxImageDimension2D
+    bool atlasDirty_ = false;                 // whole image needs a clear (new or reset atlas)
+    std::vector<VkImageView> boundAtlasViews_;   // per slot: view last handed to Text::setAtlas
+    AtlasStats atlasStats_{};
+
+    // Dirty glyph rectangles, per-slot staging buffers and retired atlas images (font.cpp).
+    void* uploadCtx_ = nullptr; // FontUploadContext*
+
+    // MSDF distance-field jobs, started on first use (font.cpp).
+    void* msdfWorker_ = nullptr; // FontMsdfWorker*
 
     // We avoid including <unordered_map> in the header unless you want it; implementation can hold the real map.
     void* glyphMap_ = nullptr; // pointer to an internal map<GlyphKey,GlyphEntry> stored/managed in font.cpp
@@ -157,7 +240,11 @@ private:
 
         uint32_t glyphCount = 0;
         bool prepared = false;
+        uint64_t uploadedGeneration = 0; // layoutGeneration_ held by this slot's Text buffers
     };
 
     std::vector<FrameData> frame_;
+
+    // Bumped by anything that changes the emitted instances (text, style, size, atlas).
+    uint64_t layoutGeneration_ = 1;
 };
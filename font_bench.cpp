@@ -0,0 +1,187 @@
+// font_bench.cpp
+//
+// Glyph atlas cost per text size: FreeType coverage bitmaps (one atlas entry per codepoint
+// and size, what Font::AtlasMode::Coverage does) vs. one MSDF bake that Font::AtlasMode::Msdf
+// scales to every size. Reports CPU rasterization time and shelf-packed atlas bytes.
+// CPU only; no Vulkan device needed.
+
+#include "msdf.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+namespace
+{
+// Must match font.cpp.
+constexpr uint32_t kMsdfBakePx = 48;
+constexpr float kMsdfPxRange = 6.0f;
+constexpr uint32_t kAtlasWidth = 1024;
+
+volatile uint32_t texelSink = 0; // keeps the generated fields alive
+
+// Same shelf packing as Font::packGlyph_ (1px padding, fixed width); returns rows used.
+struct ShelfPacker
+{
+    uint32_t cursorX = 1, cursorY = 1, rowH = 0;
+
+    void add(uint32_t w, uint32_t h)
+    {
+        if (cursorX + w + 1 >= kAtlasWidth)
+        {
+            cursorX = 1;
+            cursorY += rowH + 1;
+            rowH = 0;
+        }
+        cursorX += w + 1;
+        rowH = std::max(rowH, h + 1);
+    }
+    uint32_t height() const { return cursorY + rowH; }
+};
+
+struct AtlasCost
+{
+    uint32_t glyphs = 0;
+    double ms = 0.0;
+    uint64_t atlasBytes = 0; // kAtlasWidth x packed height
+};
+
+AtlasCost runCoverage(FT_Face face, const std::vector<uint32_t>& charset, uint32_t px)
+{
+    AtlasCost cost{};
+    ShelfPacker packer;
+    FT_Set_Pixel_Sizes(face, 0, px);
+    const auto t0 = std::chrono::steady_clock::now();
+    for (uint32_t cp : charset)
+    {
+        if (FT_Load_Char(face, cp, FT_LOAD_RENDER) != 0)
+            continue;
+        const FT_Bitmap& bmp = face->glyph->bitmap;
+        if (bmp.width == 0 || bmp.rows == 0)
+            continue;
+        texelSink = texelSink + bmp.buffer[0];
+        packer.add(bmp.width, bmp.rows);
+        ++cost.glyphs;
+    }
+    cost.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    cost.atlasBytes = uint64_t(kAtlasWidth) * packer.height();
+    return cost;
+}
+
+AtlasCost runMsdf(FT_Face face, const std::vector<uint32_t>& charset)
+{
+    AtlasCost cost{};
+    ShelfPacker packer;
+    std::vector<uint8_t> texels;
+    FT_Set_Pixel_Sizes(face, 0, kMsdfBakePx);
+    const int pad = int(std::ceil(kMsdfPxRange * 0.5f)) + 1;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (uint32_t cp : charset)
+    {
+        if (FT_Load_Char(face, cp, FT_LOAD_NO_BITMAP | FT_LOAD_NO_HINTING) != 0)
+            continue;
+        MsdfShape shape;
+        if (face->glyph->format != FT_GLYPH_FORMAT_OUTLINE || !msdfShapeFromOutline(&face->glyph->outline, shape))
+            continue;
+        const int left = int(std::floor(shape.minX)) - pad;
+        const int top = int(std::ceil(shape.maxY)) + pad;
+        const uint32_t w = uint32_t(int(std::ceil(shape.maxX)) + pad - left);
+        const uint32_t h = uint32_t(top - (int(std::floor(shape.minY)) - pad));
+        texels.resize(size_t(w) * h * 4);
+        generateMsdf(shape, w, h, float(left), float(top), kMsdfPxRange, texels.data());
+        texelSink = texelSink + texels[0];
+        packer.add(w, h);
+        ++cost.glyphs;
+    }
+    cost.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    cost.atlasBytes = uint64_t(kAtlasWidth) * packer.height() * 4;
+    return cost;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::filesystem::path fontPath = "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf";
+    bool latin1 = false;
+    std::vector<uint32_t> sizes{12, 16, 24, 32, 48, 72, 96};
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--latin1")
+        {
+            latin1 = true;
+        }
+        else if (arg == "--sizes" && i + 1 < argc)
+        {
+            sizes.clear();
+            std::string list = argv[++i];
+            for (size_t pos = 0; pos < list.size();)
+            {
+                size_t comma = list.find(',', pos);
+                if (comma == std::string::npos) comma = list.size();
+                sizes.push_back(uint32_t(std::stoul(list.substr(pos, comma - pos))));
+                pos = comma + 1;
+            }
+        }
+        else if (arg == "--help" || arg == "-h")
+        {
+            std::cout << "Usage: font_bench [font.ttf] [--latin1] [--sizes 12,16,32]\n";
+            return 0;
+        }
+        else
+        {
+            fontPath = arg;
+        }
+    }
+
+    FT_Library library = nullptr;
+    FT_Face face = nullptr;
+    if (FT_Init_FreeType(&library) != 0 || FT_New_Face(library, fontPath.string().c_str(), 0, &face) != 0)
+    {
+        std::cerr << "[FontBench] Failed to load " << fontPath << "\n";
+        return 1;
+    }
+
+    std::vector<uint32_t> charset;
+    for (uint32_t cp = 0x20; cp < 0x7F; ++cp)
+        charset.push_back(cp);
+    if (latin1)
+        for (uint32_t cp = 0xA0; cp <= 0xFF; ++cp)
+            charset.push_back(cp);
+
+    std::cout << "[FontBench] " << fontPath.filename().string() << ", " << charset.size() << " codepoints, atlas width "
+              << kAtlasWidth << "\n";
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  coverage (R8, one atlas entry per size)\n";
+    std::cout << "      px   glyphs     raster ms    atlas KiB   cumulative KiB\n";
+    uint64_t cumulative = 0;
+    double cumulativeMs = 0.0;
+    for (uint32_t px : sizes)
+    {
+        const AtlasCost c = runCoverage(face, charset, px);
+        cumulative += c.atlasBytes;
+        cumulativeMs += c.ms;
+        std::cout << "  " << std::setw(6) << px << std::setw(9) << c.glyphs << std::setw(14) << c.ms << std::setw(13)
+                  << double(c.atlasBytes) / 1024.0 << std::setw(17) << double(cumulative) / 1024.0 << "\n";
+    }
+
+    const AtlasCost m = runMsdf(face, charset);
+    std::cout << "  msdf (RGBA8, baked at " << kMsdfBakePx << "px, range " << kMsdfPxRange << ", serves every size)\n";
+    std::cout << "          glyphs " << m.glyphs << ", generate " << m.ms << " ms (" << m.ms / std::max(1u, m.glyphs)
+              << " ms/glyph), atlas " << double(m.atlasBytes) / 1024.0 << " KiB\n";
+    std::cout << "  all sizes above: coverage " << double(cumulative) / 1024.0 << " KiB / " << cumulativeMs
+              << " ms vs msdf " << double(m.atlasBytes) / 1024.0 << " KiB / " << m.ms << " ms\n";
+
+    FT_Done_Face(face);
+    FT_Done_FreeType(library);
+    return 0;
+}
@@ -0,0 +1,166 @@
+// frame_cache.cpp
+#include "frame_cache.h"
+
+#include "decoder_vulkan.h"
+
+#include <stdexcept>
+
+FrameCache::FrameCache(size_t budgetBytes) : budgetBytes_(budgetBytes)
+{
+}
+
+FrameCache::~FrameCache()
+{
+    clear();
+}
+
+void FrameCache::setBudget(size_t bytes)
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    budgetBytes_ = bytes;
+    evictLocked_();
+}
+
+size_t FrameCache::budget() const
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    return budgetBytes_;
+}
+
+void FrameCache::insert(const DecodedFrame& frame, int64_t previousMicros, size_t bytes)
+{
+    if (!frame.avFrame)
+        return;
+
+    const int64_t micros = frame.ptsMicros();
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (budgetBytes_ == 0)
+        return;
+
+    auto it = entries_.find(micros);
+    if (it == entries_.end())
+    {
+        Entry entry;
+        entry.frame = std::make_unique<DecodedFrame>();
+        if (!entry.frame->ref(frame))
+            throw std::runtime_error("FrameCache: failed to reference decoded frame");
+        entry.bytes = bytes;
+        lru_.push_front(micros);
+        entry.lru = lru_.begin();
+        it = entries_.emplace(micros, std::move(entry)).first;
+        stats_.frames++;
+        stats_.bytes += bytes;
+    }
+    else
+    {
+        lru_.splice(lru_.begin(), lru_, it->second.lru);
+    }
+
+    if (previousMicros >= 0 && previousMicros < micros)
+    {
+        auto prev = entries_.find(previousMicros);
+        if (prev != entries_.end())
+        {
+            // A frame has one successor and one predecessor; drop whatever they were linked to
+            if (prev->second.next >= 0 && prev->second.next != micros)
+            {
+                auto stale = entries_.find(prev->second.next);
+                if (stale != entries_.end())
+                    stale->second.prev = -1;
+            }
+            if (it->second.prev >= 0 && it->second.prev != previousMicros)
+            {
+                auto stale = entries_.find(it->second.prev);
+                if (stale != entries_.end())
+                    stale->second.next = -1;
+            }
+            prev->second.next = micros;
+            it->second.prev = previousMicros;
+        }
+    }
+
+    evictLocked_();
+}
+
+bool FrameCache::get(int64_t micros, DecodedFrame& out)
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto it = entries_.find(micros);
+    if (it == entries_.end() || !out.ref(*it->second.frame))
+        return false;
+    lru_.splice(lru_.begin(), lru_, it->second.lru);
+    stats_.hits++;
+    return true;
+}
+
+int64_t FrameCache::find(int64_t micros, int64_t toleranceMicros)
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto it = entries_.upper_bound(micros + 1000);
+    if (it == entries_.begin())
+    {
+        stats_.misses++;
+        return -1;
+    }
+    --it;
+    // A linked successor means nothing uncached sits between this frame and `micros`
+    if (it->second.next < 0 && micros - it->first > toleranceMicros)
+    {
+        stats_.misses++;
+        return -1;
+    }
+    return it->first;
+}
+
+int64_t FrameCache::next(int64_t micros) const
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto it = entries_.find(micros);
+    return it != entries_.end() ? it->second.next : -1;
+}
+
+void FrameCache::clear()
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    entries_.clear();
+    lru_.clear();
+    stats_.frames = 0;
+    stats_.bytes = 0;
+}
+
+FrameCache::Stats FrameCache::stats() const
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    return stats_;
+}
+
+void FrameCache::evictLocked_()
+{
+    while (stats_.bytes > budgetBytes_ && !lru_.empty())
+    {
+        eraseLocked_(entries_.find(lru_.back()));
+        stats_.evictions++;
+    }
+}
+
+void FrameCache::eraseLocked_(std::map<int64_t, Entry>::iterator it)
+{
+    // Neighbours of an evicted frame stop being one run
+    if (it->second.prev >= 0)
+    {
+        auto prev = entries_.find(it->second.prev);
+        if (prev != entries_.end())
+            prev->second.next = -1;
+    }
+    if (it->second.next >= 0)
+    {
+        auto next = entries_.find(it->second.next);
+        if (next != entries_.end())
+            next->second.prev = -1;
+    }
+
+    stats_.frames--;
+    stats_.bytes -= it->second.bytes;
+    lru_.erase(it->second.lru);
+    entries_.erase(it);
+}
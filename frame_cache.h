@@ -0,0 +1,79 @@
+// frame_cache.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+
+struct DecodedFrame;
+
+// Decoded frames kept by reference (the FFmpeg Vulkan surfaces themselves, no copies), keyed by
+// pts in microseconds and evicted least-recently-used past a byte budget. Frames decoded back to
+// back are linked into runs, so a consumer can tell a cached range (every frame in it present)
+// from isolated frames. Seeks and frame steps that land in a run, and playback through it,
+// need no decode. Thread-safe: the decode thread inserts, the consumer looks up on seek.
+class FrameCache
+{
+public:
+    static constexpr size_t kDefaultBudgetBytes = size_t(768) << 20;
+
+    explicit FrameCache(size_t budgetBytes = kDefaultBudgetBytes);
+    ~FrameCache();
+
+    FrameCache(const FrameCache&) = delete;
+    FrameCache& operator=(const FrameCache&) = delete;
+
+    // Evicts down to the new budget at once.
+    void setBudget(size_t bytes);
+    size_t budget() const;
+
+    // Adds a reference to frame's surface, charged `bytes`. previousMicros >= 0 links it as the
+    // successor of that entry (decoded straight after it). Re-inserting a cached pts refreshes it
+    // and keeps its links.
+    void insert(const DecodedFrame& frame, int64_t previousMicros, size_t bytes);
+
+    // New reference to the entry at exactly `micros` in out; refreshes it in the LRU order.
+    bool get(int64_t micros, DecodedFrame& out);
+
+    // Key of the frame on screen at `micros`: the latest entry at or before it (1 ms tolerance),
+    // if its successor is cached too or it is within toleranceMicros of `micros`. -1 on a miss.
+    int64_t find(int64_t micros, int64_t toleranceMicros);
+
+    // Linked successor of the entry at `micros`, or -1.
+    int64_t next(int64_t micros) const;
+
+    void clear();
+
+    struct Stats
+    {
+        size_t frames = 0;
+        size_t bytes = 0;
+        uint64_t hits = 0;   // frames handed out by get()
+        uint64_t misses = 0; // find() without a usable entry
+        uint64_t evictions = 0;
+    };
+    Stats stats() const;
+
+private:
+    struct Entry
+    {
+        std::unique_ptr<DecodedFrame> frame;
+        size_t bytes = 0;
+        int64_t prev = -1;
+        int64_t next = -1;
+        std::list<int64_t>::iterator lru;
+    };
+
+    void evictLocked_();
+    void eraseLocked_(std::map<int64_t, Entry>::iterator it);
+
+private:
+    mutable std::mutex mutex_;
+    size_t budgetBytes_ = kDefaultBudgetBytes;
+    std::map<int64_t, Entry> entries_;
+    std::list<int64_t> lru_; // most recently used first
+    Stats stats_{};
+};
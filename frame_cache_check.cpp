@@ -0,0 +1,199 @@
+// frame_cache_check.cpp
+//
+// Behaviour check of FrameCache, the decoded-frame cache DecoderVulkan serves seeks, frame steps
+// and playback through: insert and get (the cached entry references the decoder's surface, no
+// copy), find inside and at the edge of a run of linked frames and past an isolated one, next
+// along a run, re-insertion, and least-recently-used eviction under a byte budget, including the
+// run being cut where a frame was evicted. Frames are tiny software AVFrames standing in for the
+// Vulkan surfaces, so no device is needed. Prints one line per case and exits non-zero when any
+// fails.
+
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "decoder_vulkan.h"
+#include "frame_cache.h"
+
+extern "C" {
+#include <libavutil/frame.h>
+}
+
+namespace
+{
+constexpr int64_t kFrameMicros = 33'333; // 30 fps
+constexpr size_t kFrameBytes = 1000;
+
+int failures = 0;
+
+void expect(const std::string& name, bool ok)
+{
+    std::cout << "  " << std::left << std::setw(52) << name << (ok ? "ok" : "FAILED") << "\n";
+    if (!ok)
+        ++failures;
+}
+
+// A 2x2 gray frame at index * kFrameMicros, its pixels tagged with the index
+bool makeFrame(int index, DecodedFrame& out)
+{
+    out.reset();
+    AVFrame* frame = av_frame_alloc();
+    if (!frame)
+        return false;
+    frame->format = AV_PIX_FMT_GRAY8;
+    frame->width = 2;
+    frame->height = 2;
+    if (av_frame_get_buffer(frame, 0) < 0)
+    {
+        av_frame_free(&frame);
+        return false;
+    }
+    std::memset(frame->data[0], index & 0xff, static_cast<size_t>(frame->linesize[0]) * 2);
+    out.avFrame = frame;
+    out.ptsSeconds = static_cast<double>(index * kFrameMicros) / 1'000'000.0;
+    return true;
+}
+
+int64_t micros(int index)
+{
+    DecodedFrame probe;
+    probe.ptsSeconds = static_cast<double>(index * kFrameMicros) / 1'000'000.0;
+    return probe.ptsMicros();
+}
+
+// Inserts frames [first, last] decoded back to back, each linked to the one before
+bool insertRun(FrameCache& cache, int first, int last)
+{
+    int64_t previous = -1;
+    for (int i = first; i <= last; ++i)
+    {
+        DecodedFrame frame;
+        if (!makeFrame(i, frame))
+            return false;
+        cache.insert(frame, previous, kFrameBytes);
+        previous = frame.ptsMicros();
+    }
+    return true;
+}
+
+void checkLookups()
+{
+    std::cout << "lookups:\n";
+    FrameCache cache;
+    if (!insertRun(cache, 0, 4))
+    {
+        expect("allocate frames", false);
+        return;
+    }
+
+    const FrameCache::Stats st = cache.stats();
+    expect("five frames cached", st.frames == 5 && st.bytes == 5 * kFrameBytes);
+
+    DecodedFrame source;
+    makeFrame(7, source);
+    cache.insert(source, -1, kFrameBytes);
+    DecodedFrame hit;
+    expect("get references the inserted surface",
+           cache.get(source.ptsMicros(), hit) && hit.avFrame && hit.avFrame->data[0] == source.avFrame->data[0]);
+    source.reset();
+    expect("cached frame outlives the decoder's reference",
+           cache.get(micros(7), hit) && hit.avFrame && hit.avFrame->data[0][0] == 7);
+    expect("get of an uncached pts fails", !cache.get(micros(5), hit));
+
+    // Half a frame into frame 2 is still frame 2 on screen, its successor is cached
+    expect("find inside a run", cache.find(micros(2) + kFrameMicros / 2, 0) == micros(2));
+    expect("find on an exact pts", cache.find(micros(3), 0) == micros(3));
+    expect("find before the first frame misses", cache.find(-kFrameMicros, kFrameMicros) == -1);
+    expect("find past the run end within tolerance", cache.find(micros(4) + 1000 * 10, kFrameMicros) == micros(4));
+    expect("find past the run end beyond tolerance", cache.find(micros(6), kFrameMicros / 2) == -1);
+    expect("find past an isolated frame misses", cache.find(micros(7) + 2 * kFrameMicros, kFrameMicros) == -1);
+
+    bool chained = true;
+    for (int i = 0; i < 4; ++i)
+        chained = chained && cache.next(micros(i)) == micros(i + 1);
+    expect("next walks the run", chained);
+    expect("next at the run end is -1", cache.next(micros(4)) == -1);
+    expect("isolated frame has no successor", cache.next(micros(7)) == -1);
+
+    // Decoding frame 2 again after a seek refreshes it without breaking the run
+    DecodedFrame again;
+    makeFrame(2, again);
+    cache.insert(again, -1, kFrameBytes);
+    expect("re-insert keeps the entry count", cache.stats().frames == 6);
+    expect("re-insert keeps the links", cache.next(micros(1)) == micros(2) && cache.next(micros(2)) == micros(3));
+
+    const FrameCache::Stats after = cache.stats();
+    expect("hits and misses counted", after.hits == 2 && after.misses == 3);
+}
+
+void checkEviction()
+{
+    std::cout << "eviction:\n";
+    FrameCache cache(4 * kFrameBytes);
+    if (!insertRun(cache, 0, 3))
+    {
+        expect("allocate frames", false);
+        return;
+    }
+    expect("run fits the budget", cache.stats().frames == 4 && cache.stats().evictions == 0);
+
+    // Touch frame 0, so frame 1 becomes the least recently used
+    DecodedFrame touched;
+    cache.get(micros(0), touched);
+
+    DecodedFrame extra;
+    makeFrame(4, extra);
+    cache.insert(extra, micros(3), kFrameBytes);
+
+    FrameCache::Stats st = cache.stats();
+    expect("over budget evicts one frame", st.frames == 4 && st.bytes == 4 * kFrameBytes && st.evictions == 1);
+    DecodedFrame probe;
+    expect("least recently used frame evicted", !cache.get(micros(1), probe));
+    expect("recently used frame kept", cache.get(micros(0), probe));
+    expect("run cut at the evicted frame", cache.next(micros(0)) == -1);
+    expect("rest of the run still linked", cache.next(micros(2)) == micros(3) && cache.next(micros(3)) == micros(4));
+    expect("find no longer bridges the gap", cache.find(micros(1), kFrameMicros / 2) == -1);
+
+    cache.setBudget(2 * kFrameBytes);
+    st = cache.stats();
+    expect("smaller budget evicts at once", st.frames == 2 && st.bytes == 2 * kFrameBytes && st.evictions == 3);
+
+    cache.setBudget(0);
+    st = cache.stats();
+    expect("zero budget empties the cache", st.frames == 0 && st.bytes == 0);
+    makeFrame(9, extra);
+    cache.insert(extra, -1, kFrameBytes);
+    expect("zero budget caches nothing", cache.stats().frames == 0);
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h")
+        {
+            std::cout << "Usage: frame_cache_check\n";
+            return 0;
+        }
+        std::cerr << "frame_cache_check: unknown argument " << arg << " (see --help)" << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        checkLookups();
+        checkEviction();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "frame_cache_check: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << (failures == 0 ? "all checks passed" : std::to_string(failures) + " check(s) failed") << "\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,455 @@
+// grading_scopes.cpp
+// Graded RGBA -> scope accumulation (one SSBO) -> overlay panel drawn back into the same image.
+
+#include "grading_scopes.h"
+
+#include "engine2d.h"
+#include "utils.h"
+#include "debug_logging.h"
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+constexpr uint32_t kAccumulateTile = 64; // pixels per workgroup side (16x16 threads, 4x4 pixels each)
+
+// Panel in scope pixels: histogram and waveform 256x128, vectorscope 128x128, 8 px gutters
+constexpr uint32_t kPanelWidth = 8 + 256 + 8 + 256 + 8 + 128 + 8;
+constexpr uint32_t kPanelHeight = 8 + 128 + 8;
+constexpr uint32_t kPanelMargin = 16;
+
+constexpr VkDeviceSize kScopeWords = kScopeHistogramBins * 4 + kScopeWaveformColumns * kScopeWaveformLevels +
+                                     kScopeVectorscopeSize * kScopeVectorscopeSize + 4;
+
+VkImageMemoryBarrier makeImageBarrier(VkImage image,
+                                      VkImageLayout oldLayout,
+                                      VkImageLayout newLayout,
+                                      VkAccessFlags srcAccess,
+                                      VkAccessFlags dstAccess)
+{
+    VkImageMemoryBarrier b{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+    b.oldLayout = oldLayout;
+    b.newLayout = newLayout;
+    b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    b.image = image;
+    b.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    b.subresourceRange.levelCount = 1;
+    b.subresourceRange.layerCount = 1;
+    b.srcAccessMask = srcAccess;
+    b.dstAccessMask = dstAccess;
+    return b;
+}
+
+VkBufferMemoryBarrier makeBufferBarrier(VkBuffer buffer, VkAccessFlags srcAccess, VkAccessFlags dstAccess)
+{
+    VkBufferMemoryBarrier b{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+    b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    b.buffer = buffer;
+    b.offset = 0;
+    b.size = VK_WHOLE_SIZE;
+    b.srcAccessMask = srcAccess;
+    b.dstAccessMask = dstAccess;
+    return b;
+}
+
+// scopes_accumulate.comp merges same-bin lanes with subgroupAllEqual / subgroupBallot
+bool computeSubgroupVoteAndBallot(VkPhysicalDevice physicalDevice)
+{
+    VkPhysicalDeviceSubgroupProperties subgroup{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES};
+    VkPhysicalDeviceProperties2 props{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2};
+    props.pNext = &subgroup;
+    vkGetPhysicalDeviceProperties2(physicalDevice, &props);
+    const VkSubgroupFeatureFlags required =
+        VK_SUBGROUP_FEATURE_BASIC_BIT | VK_SUBGROUP_FEATURE_VOTE_BIT | VK_SUBGROUP_FEATURE_BALLOT_BIT;
+    return (subgroup.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT) != 0 &&
+           (subgroup.supportedOperations & required) == required;
+}
+} // namespace
+
+GradingScopes::GradingScopes(Engine2D* eng, uint32_t framesInFlight)
+    : engine(eng), framesInFlight_(framesInFlight)
+{
+    if (!engine || engine->logicalDevice == VK_NULL_HANDLE)
+        throw std::runtime_error("GradingScopes requires a valid Engine2D");
+
+    if (framesInFlight_ == 0)
+        throw std::runtime_error("GradingScopes: framesInFlight must be > 0");
+
+    descriptorSets_.assign(framesInFlight_, VK_NULL_HANDLE);
+    boundViews_.assign(framesInFlight_, VK_NULL_HANDLE);
+    timestampsPending_.assign(framesInFlight_, false);
+
+    createPipelines_();
+    createResources_();
+    createTimestampQueries_();
+}
+
+GradingScopes::~GradingScopes()
+{
+    if (!engine || engine->logicalDevice == VK_NULL_HANDLE)
+        return;
+
+    vkDeviceWaitIdle(engine->logicalDevice);
+
+    destroyResources_();
+    if (timestampPool_ != VK_NULL_HANDLE)
+    {
+        vkDestroyQueryPool(engine->logicalDevice, timestampPool_, nullptr);
+        timestampPool_ = VK_NULL_HANDLE;
+    }
+    destroyPipelines_();
+}
+
+void GradingScopes::record(VkCommandBuffer cmd, uint32_t frameIndex, const ColorGrading::Output& output)
+{
+    if (!enabled || cmd == VK_NULL_HANDLE || framesInFlight_ == 0)
+        return;
+
+    if (output.image == VK_NULL_HANDLE || output.view == VK_NULL_HANDLE || output.extent.width == 0 ||
+        output.extent.height == 0 || output.layout != VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+        return;
+
+    if (accumulatePipeline_ == VK_NULL_HANDLE || renderPipeline_ == VK_NULL_HANDLE || scopeBuffer_ == VK_NULL_HANDLE)
+        return;
+
+    const uint32_t fi = frameIndex % framesInFlight_;
+
+    // This slot's previous submission has completed by the time it is recorded again.
+    readTimestamps_(fi);
+
+    if (boundViews_[fi] != output.view)
+        updateDescriptorSet_(fi, output.view);
+
+    // Scale the panel with the frame so it reads the same at 1080p and 4K
+    GradingScopesPush push{};
+    push.imageWidth = output.extent.width;
+    push.imageHeight = output.extent.height;
+    push.panelScale = std::max(1u, output.extent.height / 720u);
+    const uint32_t margin = kPanelMargin * push.panelScale;
+    const uint32_t panelHeight = kPanelHeight * push.panelScale;
+    push.panelX = std::min(margin, output.extent.width - 1);
+    push.panelY = output.extent.height > panelHeight + margin ? output.extent.height - panelHeight - margin : 0;
+
+    if (renderDebugEnabled())
+    {
+        std::cout << "[GradingScopes] record fi=" << fi
+                  << " extent=" << output.extent.width << "x" << output.extent.height
+                  << " scale=" << push.panelScale
+                  << " gpu=" << lastGpuMs_ << "ms"
+                  << std::endl;
+    }
+
+    if (timestampPool_ != VK_NULL_HANDLE)
+    {
+        vkCmdResetQueryPool(cmd, timestampPool_, fi * 2, 2);
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampPool_, fi * 2);
+    }
+
+    // The accumulation buffer is shared by all slots: the previous frame's draw must be done
+    // reading it before it is cleared.
+    VkBufferMemoryBarrier toClear = makeBufferBarrier(scopeBuffer_, VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+    vkCmdPipelineBarrier(cmd,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0,
+                         0, nullptr,
+                         1, &toClear,
+                         0, nullptr);
+    vkCmdFillBuffer(cmd, scopeBuffer_, 0, scopeBufferSize_, 0);
+
+    VkBufferMemoryBarrier toAccumulate = makeBufferBarrier(scopeBuffer_,
+                                                           VK_ACCESS_TRANSFER_WRITE_BIT,
+                                                           VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+    VkImageMemoryBarrier toGeneral = makeImageBarrier(output.image,
+                                                      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                                      VK_IMAGE_LAYOUT_GENERAL,
+                                                      VK_ACCESS_SHADER_WRITE_BIT,
+                                                      VK_ACCESS_SHADER_READ_BIT);
+    vkCmdPipelineBarrier(cmd,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0,
+                         0, nullptr,
+                         1, &toAccumulate,
+                         1, &toGeneral);
+
+    vkCmdBindDescriptorSets(cmd,
+                            VK_PIPELINE_BIND_POINT_COMPUTE,
+                            pipelineLayout_,
+                            0,
+                            1,
+                            &descriptorSets_[fi],
+                            0,
+                            nullptr);
+    vkCmdPushConstants(cmd, pipelineLayout_, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(GradingScopesPush), &push);
+
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, accumulatePipeline_);
+    vkCmdDispatch(cmd,
+                  (output.extent.width + kAccumulateTile - 1) / kAccumulateTile,
+                  (output.extent.height + kAccumulateTile - 1) / kAccumulateTile,
+                  1);
+
+    // Accumulation must finish reading the frame before the panel is drawn over it.
+    VkBufferMemoryBarrier toRender = makeBufferBarrier(scopeBuffer_, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+    VkImageMemoryBarrier toDraw = makeImageBarrier(output.image,
+                                                   VK_IMAGE_LAYOUT_GENERAL,
+                                                   VK_IMAGE_LAYOUT_GENERAL,
+                                                   VK_ACCESS_SHADER_READ_BIT,
+                                                   VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+    vkCmdPipelineBarrier(cmd,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0,
+                         0, nullptr,
+                         1, &toRender,
+                         1, &toDraw);
+
+    const uint32_t panelWidth = std::min(kPanelWidth * push.panelScale, output.extent.width - push.panelX);
+    const uint32_t drawHeight = std::min(panelHeight, output.extent.height - push.panelY);
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, renderPipeline_);
+    vkCmdDispatch(cmd, (panelWidth + 15u) / 16u, (drawHeight + 15u) / 16u, 1);
+
+    if (timestampPool_ != VK_NULL_HANDLE)
+    {
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, timestampPool_, fi * 2 + 1);
+        timestampsPending_[fi] = true;
+    }
+
+    // Back to where ColorGrading left it, for the presenter
+    VkImageMemoryBarrier toSample = makeImageBarrier(output.image,
+                                                     VK_IMAGE_LAYOUT_GENERAL,
+                                                     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                                     VK_ACCESS_SHADER_WRITE_BIT,
+                                                     VK_ACCESS_SHADER_READ_BIT);
+    vkCmdPipelineBarrier(cmd,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0,
+                         0, nullptr,
+                         0, nullptr,
+                         1, &toSample);
+}
+
+void GradingScopes::createPipelines_()
+{
+    if (!computeSubgroupVoteAndBallot(engine->physicalDevice))
+        throw std::runtime_error("GradingScopes: device lacks subgroup vote/ballot in compute shaders");
+    // Both shaders imageLoad the graded image, which has no format qualifier (RGBA8 or RGBA16F)
+    if (!engine->renderDevice.getEnabledFeatures2().features.shaderStorageImageReadWithoutFormat)
+        throw std::runtime_error("GradingScopes: device lacks shaderStorageImageReadWithoutFormat");
+
+    // 0 = graded image (storage, read by accumulate, drawn into by render)
+    // 1 = scope accumulation buffer
+    std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+
+    bindings[0].binding = 0;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    bindings[0].descriptorCount = 1;
+    bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    bindings[1].binding = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[1].descriptorCount = 1;
+    bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkDescriptorSetLayoutCreateInfo dsl{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
+    dsl.bindingCount = static_cast<uint32_t>(bindings.size());
+    dsl.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(engine->logicalDevice, &dsl, nullptr, &setLayout_) != VK_SUCCESS)
+        throw std::runtime_error("GradingScopes: failed to create descriptor set layout");
+
+    VkPushConstantRange pcRange{};
+    pcRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pcRange.offset = 0;
+    pcRange.size = sizeof(GradingScopesPush);
+
+    VkPipelineLayoutCreateInfo pli{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+    pli.setLayoutCount = 1;
+    pli.pSetLayouts = &setLayout_;
+    pli.pushConstantRangeCount = 1;
+    pli.pPushConstantRanges = &pcRange;
+
+    if (vkCreatePipelineLayout(engine->logicalDevice, &pli, nullptr, &pipelineLayout_) != VK_SUCCESS)
+        throw std::runtime_error("GradingScopes: failed to create pipeline layout");
+
+    auto createPipeline = [this](const char* path, VkPipeline& pipeline) {
+        auto shaderCode = readSPIRVFile(path);
+        VkShaderModule shaderModule = engine->createShaderModule(shaderCode);
+
+        VkPipelineShaderStageCreateInfo stage{VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO};
+        stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        stage.module = shaderModule;
+        stage.pName = "main";
+
+        VkComputePipelineCreateInfo cpi{VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO};
+        cpi.stage = stage;
+        cpi.layout = pipelineLayout_;
+
+        const VkResult result = vkCreateComputePipelines(engine->logicalDevice, VK_NULL_HANDLE, 1, &cpi, nullptr, &pipeline);
+        vkDestroyShaderModule(engine->logicalDevice, shaderModule, nullptr);
+        if (result != VK_SUCCESS)
+            throw std::runtime_error(std::string("GradingScopes: failed to create compute pipeline ") + path);
+    };
+
+    createPipeline("shaders/scopes_accumulate.spv", accumulatePipeline_);
+    createPipeline("shaders/scopes_render.spv", renderPipeline_);
+}
+
+void GradingScopes::destroyPipelines_()
+{
+    if (!engine || engine->logicalDevice == VK_NULL_HANDLE)
+        return;
+
+    for (VkPipeline* pipeline : {&accumulatePipeline_, &renderPipeline_})
+    {
+        if (*pipeline != VK_NULL_HANDLE)
+        {
+            vkDestroyPipeline(engine->logicalDevice, *pipeline, nullptr);
+            *pipeline = VK_NULL_HANDLE;
+        }
+    }
+    if (pipelineLayout_ != VK_NULL_HANDLE)
+    {
+        vkDestroyPipelineLayout(engine->logicalDevice, pipelineLayout_, nullptr);
+        pipelineLayout_ = VK_NULL_HANDLE;
+    }
+    if (setLayout_ != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorSetLayout(engine->logicalDevice, setLayout_, nullptr);
+        setLayout_ = VK_NULL_HANDLE;
+    }
+}
+
+void GradingScopes::createResources_()
+{
+    scopeBufferSize_ = kScopeWords * sizeof(uint32_t);
+    engine->createBuffer(scopeBufferSize_,
+                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                         scopeBuffer_,
+                         scopeMemory_);
+
+    std::array<VkDescriptorPoolSize, 2> sizes{};
+    sizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    sizes[0].descriptorCount = framesInFlight_;
+    sizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    sizes[1].descriptorCount = framesInFlight_;
+
+    VkDescriptorPoolCreateInfo pi{VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
+    pi.poolSizeCount = static_cast<uint32_t>(sizes.size());
+    pi.pPoolSizes = sizes.data();
+    pi.maxSets = framesInFlight_;
+
+    if (vkCreateDescriptorPool(engine->logicalDevice, &pi, nullptr, &descriptorPool_) != VK_SUCCESS)
+        throw std::runtime_error("GradingScopes: failed to create descriptor pool");
+
+    std::vector<VkDescriptorSetLayout> layouts(framesInFlight_, setLayout_);
+
+    VkDescriptorSetAllocateInfo ai{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+    ai.descriptorPool = descriptorPool_;
+    ai.descriptorSetCount = framesInFlight_;
+    ai.pSetLayouts = layouts.data();
+
+    if (vkAllocateDescriptorSets(engine->logicalDevice, &ai, descriptorSets_.data()) != VK_SUCCESS)
+        throw std::runtime_error("GradingScopes: failed to allocate descriptor sets");
+}
+
+void GradingScopes::destroyResources_()
+{
+    if (descriptorPool_ != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorPool(engine->logicalDevice, descriptorPool_, nullptr);
+        descriptorPool_ = VK_NULL_HANDLE;
+    }
+    descriptorSets_.assign(framesInFlight_, VK_NULL_HANDLE);
+    boundViews_.assign(framesInFlight_, VK_NULL_HANDLE);
+
+    if (scopeBuffer_ != VK_NULL_HANDLE)
+    {
+        vkDestroyBuffer(engine->logicalDevice, scopeBuffer_, nullptr);
+        scopeBuffer_ = VK_NULL_HANDLE;
+    }
+    if (scopeMemory_ != VK_NULL_HANDLE)
+    {
+        vkFreeMemory(engine->logicalDevice, scopeMemory_, nullptr);
+        scopeMemory_ = VK_NULL_HANDLE;
+    }
+}
+
+void GradingScopes::updateDescriptorSet_(uint32_t frameIndex, VkImageView view)
+{
+    // The slot's previous submission has completed, so its set can be rewritten in place
+    // (ColorGrading recreates its outputs on resize).
+    std::array<VkWriteDescriptorSet, 2> writes{};
+
+    VkDescriptorImageInfo imageInfo{};
+    imageInfo.imageView = view;
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+    writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[0].dstSet = descriptorSets_[frameIndex];
+    writes[0].dstBinding = 0;
+    writes[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    writes[0].descriptorCount = 1;
+    writes[0].pImageInfo = &imageInfo;
+
+    VkDescriptorBufferInfo bufferInfo{};
+    bufferInfo.buffer = scopeBuffer_;
+    bufferInfo.offset = 0;
+    bufferInfo.range = scopeBufferSize_;
+
+    writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[1].dstSet = descriptorSets_[frameIndex];
+    writes[1].dstBinding = 1;
+    writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    writes[1].descriptorCount = 1;
+    writes[1].pBufferInfo = &bufferInfo;
+
+    vkUpdateDescriptorSets(engine->logicalDevice, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    boundViews_[frameIndex] = view;
+}
+
+void GradingScopes::createTimestampQueries_()
+{
+    const VkPhysicalDeviceLimits& limits = engine->getDeviceProperties().limits;
+    if (!limits.timestampComputeAndGraphics || limits.timestampPeriod <= 0.0f)
+        return;
+
+    VkQueryPoolCreateInfo qi{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+    qi.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    qi.queryCount = framesInFlight_ * 2;
+    if (vkCreateQueryPool(engine->logicalDevice, &qi, nullptr, &timestampPool_) != VK_SUCCESS)
+    {
+        timestampPool_ = VK_NULL_HANDLE;
+        return;
+    }
+    timestampPeriodNs_ = static_cast<double>(limits.timestampPeriod);
+}
+
+void GradingScopes::readTimestamps_(uint32_t frameIndex)
+{
+    if (timestampPool_ == VK_NULL_HANDLE || !timestampsPending_[frameIndex])
+        return;
+
+    std::array<uint64_t, 2> ticks{};
+    if (vkGetQueryPoolResults(engine->logicalDevice,
+                              timestampPool_,
+                              frameIndex * 2,
+                              2,
+                              sizeof(ticks),
+                              ticks.data(),
+                              sizeof(uint64_t),
+                              VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+        return;
+
+    timestampsPending_[frameIndex] = false;
+    if (ticks[1] >= ticks[0])
+        lastGpuMs_ = static_cast<double>(ticks[1] - ticks[0]) * timestampPeriodNs_ * 1e-6;
+}
@@ -0,0 +1,85 @@
+// grading_scopes.h
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "color_grading_pass.h"
+
+class Engine2D;
+
+// Accumulation layout shared with scopes_accumulate.comp / scopes_render.comp
+constexpr uint32_t kScopeHistogramBins = 256;  // luma, R, G, B
+constexpr uint32_t kScopeWaveformColumns = 256;
+constexpr uint32_t kScopeWaveformLevels = 128;
+constexpr uint32_t kScopeVectorscopeSize = 128; // Cb x Cr
+
+// Push constants of scopes_accumulate.comp and scopes_render.comp
+struct GradingScopesPush
+{
+    uint32_t imageWidth = 0;
+    uint32_t imageHeight = 0;
+    uint32_t panelX = 0;  // top-left of the overlay panel in image pixels
+    uint32_t panelY = 0;
+    uint32_t panelScale = 1;
+    uint32_t padding[3] = {0, 0, 0};
+};
+static_assert(sizeof(GradingScopesPush) == 32, "Push constant size must match shader");
+
+// Histogram (luma + RGB), luma waveform and Cb/Cr vectorscope of the graded frame, built on
+// the GPU and drawn as an overlay panel into the bottom-left corner of ColorGrading's output,
+// so the grading window shows them without reading frames back.
+class GradingScopes
+{
+public:
+    GradingScopes(Engine2D* engine, uint32_t framesInFlight);
+    ~GradingScopes();
+
+    GradingScopes(const GradingScopes&) = delete;
+    GradingScopes& operator=(const GradingScopes&) = delete;
+
+    // Records accumulate + draw after ColorGrading::dispatch() in the same command buffer.
+    // The output must be an RGBA8 / RGBA16F storage image in SHADER_READ_ONLY_OPTIMAL; it is left there.
+    void record(VkCommandBuffer cmd, uint32_t frameIndex, const ColorGrading::Output& output);
+
+    // GPU time of the last completed record() in milliseconds (0 until one has finished).
+    double lastGpuMilliseconds() const { return lastGpuMs_; }
+
+    bool enabled = true;
+
+private:
+    void createPipelines_();
+    void destroyPipelines_();
+    void createResources_();
+    void destroyResources_();
+    void updateDescriptorSet_(uint32_t frameIndex, VkImageView view);
+
+    void createTimestampQueries_();
+    void readTimestamps_(uint32_t frameIndex);
+
+private:
+    Engine2D* engine = nullptr;
+    uint32_t framesInFlight_ = 0;
+
+    VkDescriptorSetLayout setLayout_ = VK_NULL_HANDLE;
+    VkPipelineLayout pipelineLayout_ = VK_NULL_HANDLE;
+    VkPipeline accumulatePipeline_ = VK_NULL_HANDLE;
+    VkPipeline renderPipeline_ = VK_NULL_HANDLE;
+
+    VkDescriptorPool descriptorPool_ = VK_NULL_HANDLE;
+    std::vector<VkDescriptorSet> descriptorSets_;
+    std::vector<VkImageView> boundViews_;
+
+    // Histogram, waveform, vectorscope and maxima, cleared at the start of every record()
+    VkBuffer scopeBuffer_ = VK_NULL_HANDLE;
+    VkDeviceMemory scopeMemory_ = VK_NULL_HANDLE;
+    VkDeviceSize scopeBufferSize_ = 0;
+
+    // Two timestamps per frame slot around the scope work
+    VkQueryPool timestampPool_ = VK_NULL_HANDLE;
+    std::vector<bool> timestampsPending_;
+    double timestampPeriodNs_ = 0.0;
+    double lastGpuMs_ = 0.0;
+};
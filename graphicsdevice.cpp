@@ -1,10 +1,12 @@
 #include "graphicsdevice.h"
+#include "queue_lock.h"
 #include <GLFW/glfw3.h>
 #include <algorithm>
 #include <array>
 #include <cstring>
 #include <cstdlib>
 #include <iostream>
+#include <mutex>
 #include <set>
 #include <stdexcept>
 #include <string>
@@ -159,8 +161,13 @@ void RenderDevice::endSingleTimeCommands(VkCommandBuffer commandBuffer)
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &commandBuffer;
 
-    vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(graphicsQueue);
+    {
+        // FFmpeg, the render loop and the thumbnail worker submit to this queue from their own
+        // threads; waiting for idle needs the queue to ourselves as well
+        std::lock_guard<std::mutex> queueLock(vulkanQueueMutex(graphicsQueueFamilyIndex));
+        vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+        vkQueueWaitIdle(graphicsQueue);
+    }
     vkFreeCommandBuffers(logicalDevice, commandPool, 1, &commandBuffer);
 }
 
@@ -207,8 +214,11 @@ void RenderDevice::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSi
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &commandBuffer;
 
-    vkQueueSubmit(inGraphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(inGraphicsQueue);
+    {
+        std::lock_guard<std::mutex> queueLock(vulkanQueueMutex(graphicsQueueFamilyIndex));
+        vkQueueSubmit(inGraphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+        vkQueueWaitIdle(inGraphicsQueue);
+    }
 
     vkFreeCommandBuffers(logicalDevice, inCommandPool, 1, &commandBuffer);
 }
@@ -891,6 +901,16 @@ void RenderDevice::createLogicalDevice()
     enabledFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
     enabledFeatures2.features.samplerAnisotropy = VK_TRUE;
     enabledFeatures2.features.sampleRateShading = VK_TRUE;
+    // Compute passes declare their RGBA intermediates without a format qualifier so the same
+    // SPIR-V writes RGBA8 and RGBA16F (IntermediatePrecision); there are no per-format variants
+    // to fall back to. Only the optional scopes read them back, and GradingScopes checks for
+    // that itself.
+    if (!features.shaderStorageImageWriteWithoutFormat)
+    {
+        throw std::runtime_error("Device lacks shaderStorageImageWriteWithoutFormat, required by the RGBA compute passes");
+    }
+    enabledFeatures2.features.shaderStorageImageWriteWithoutFormat = VK_TRUE;
+    enabledFeatures2.features.shaderStorageImageReadWithoutFormat = features.shaderStorageImageReadWithoutFormat;
     enabledFeatures2.pNext = &enabledTimelineFeatures;
 
     std::vector<const char *> enabledDevExt = getRequiredDeviceExtensions();
@@ -0,0 +1,315 @@
+// lut_bench.cpp
+//
+// .cube handling for the grading pass: text parse vs binary-cache load time for 33^3 and
+// 65^3 tables, and the error of trilinear vs tetrahedral lookups against the exact transform
+// the table was generated from (random colours, plus the neutral axis, where trilinear tends
+// to tint greys). Uses the CPU reference lookups in cube_lut.h that mirror
+// color_grading_pass.comp.
+//
+// A second table runs the real ColorGrading pass headless on a 3840x2160 frame of random
+// colours with each table loaded: trilinear vs tetrahedral, evaluated per pixel (direct) and
+// through the 65^3 bake, timed by the pass's own timestamp queries (median of --iterations
+// dispatches, after a warm-up that includes the bake). Run from the repository root so
+// shaders/*.spv resolve.
+
+#include "color_grading_pass.h"
+#include "cube_lut.h"
+#include "engine2d.h"
+#include "image_resource.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+// A contrasty film-style look with channel crosstalk, so interpolation error is visible
+glm::vec3 referenceLook(const glm::vec3& c)
+{
+    auto curve = [](float x) { return x * x * (3.0f - 2.0f * x); };
+    const float luma = 0.2126f * c.x + 0.7152f * c.y + 0.0722f * c.z;
+    glm::vec3 out(curve(c.x), curve(c.y), curve(c.z));
+    out = glm::vec3(luma) + (out - glm::vec3(luma)) * 1.3f;
+    out.x = std::pow(std::clamp(out.x * 0.95f + 0.03f, 0.0f, 1.0f), 0.9f);
+    out.z = std::pow(std::clamp(out.z * 0.9f + 0.06f * c.y, 0.0f, 1.0f), 1.1f);
+    return glm::vec3(std::clamp(out.x, 0.0f, 1.0f), std::clamp(out.y, 0.0f, 1.0f), std::clamp(out.z, 0.0f, 1.0f));
+}
+
+bool writeCube(const std::filesystem::path& path, uint32_t size)
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+    file << "TITLE \"lut_bench " << size << "\"\nLUT_3D_SIZE " << size << "\n" << std::fixed << std::setprecision(6);
+    const float last = static_cast<float>(size - 1);
+    for (uint32_t b = 0; b < size; ++b)
+    {
+        for (uint32_t g = 0; g < size; ++g)
+        {
+            for (uint32_t r = 0; r < size; ++r)
+            {
+                const glm::vec3 v = referenceLook(glm::vec3(r / last, g / last, b / last));
+                file << v.x << " " << v.y << " " << v.z << "\n";
+            }
+        }
+    }
+    return static_cast<bool>(file);
+}
+
+double loadMs(const std::filesystem::path& path, CubeLut& lut, bool& ok)
+{
+    const auto t0 = std::chrono::steady_clock::now();
+    ok = loadCubeLut(path, lut);
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+float maxChannelError(const glm::vec3& a, const glm::vec3& b)
+{
+    return std::max({std::abs(a.x - b.x), std::abs(a.y - b.y), std::abs(a.z - b.z)});
+}
+
+// Random RGBA8 texels, so LUT fetches are spread over the table as in real footage
+void fillRandom(Engine2D& engine, ImageResource& image)
+{
+    const VkDeviceSize size = VkDeviceSize(image.width) * image.height * 4u;
+    VkBuffer staging = VK_NULL_HANDLE;
+    VkDeviceMemory stagingMemory = VK_NULL_HANDLE;
+    engine.createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, staging,
+                        stagingMemory);
+    void* mapped = nullptr;
+    vkMapMemory(engine.logicalDevice, stagingMemory, 0, size, 0, &mapped);
+    std::mt19937 rng(7);
+    auto* texels = static_cast<uint32_t*>(mapped);
+    for (size_t i = 0; i < size / 4; ++i)
+        texels[i] = rng() | 0xff000000u;
+    vkUnmapMemory(engine.logicalDevice, stagingMemory);
+
+    VkCommandBuffer cmd = engine.beginSingleTimeCommands();
+    VkImageMemoryBarrier barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image.image;
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0,
+                         nullptr, 1, &barrier);
+    VkBufferImageCopy region{};
+    region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    region.imageExtent = VkExtent3D{image.width, image.height, 1};
+    vkCmdCopyBufferToImage(cmd, staging, image.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0,
+                         nullptr, 1, &barrier);
+    engine.endSingleTimeCommands(cmd);
+    image.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    vkDestroyBuffer(engine.logicalDevice, staging, nullptr);
+    vkFreeMemory(engine.logicalDevice, stagingMemory, nullptr);
+}
+
+// Median GPU time of ColorGrading::dispatch. Recording a slot reads the timestamps of that
+// slot's previous dispatch, so each sample is taken one dispatch later.
+double medianGradingMs(Engine2D& engine, ColorGrading& grading, int iterations)
+{
+    constexpr int kWarmupIterations = 3;
+    std::vector<double> samples;
+    for (int i = 0; i <= kWarmupIterations + iterations; ++i)
+    {
+        VkCommandBuffer cmd = engine.beginSingleTimeCommands();
+        grading.dispatch(cmd, 0);
+        engine.endSingleTimeCommands(cmd);
+        if (i > kWarmupIterations)
+            samples.push_back(grading.lastGpuMilliseconds());
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples.empty() ? 0.0 : samples[samples.size() / 2];
+}
+
+int runGpuTable(const std::filesystem::path& dir, int iterations)
+{
+    Engine2D engine;
+    if (!engine.initialize(false))
+    {
+        std::cerr << "[LutBench] Failed to initialise Vulkan\n";
+        return 1;
+    }
+    const VkPhysicalDeviceLimits& limits = engine.getDeviceProperties().limits;
+    if (!limits.timestampComputeAndGraphics || limits.timestampPeriod <= 0.0f)
+    {
+        std::cerr << "[LutBench] Device has no compute timestamps\n";
+        return 1;
+    }
+
+    constexpr VkExtent2D kExtent{3840, 2160};
+    int failures = 0;
+    try
+    {
+        bool recreated = false;
+        // The constructor takes a resource to adopt from but does not read it
+        ImageResource input(&engine, input, kExtent.width, kExtent.height, VK_FORMAT_R8G8B8A8_UNORM, recreated,
+                            VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+        if (input.view == VK_NULL_HANDLE)
+            throw std::runtime_error("failed to create the input frame");
+        fillRandom(engine, input);
+
+        VkSamplerCreateInfo si{VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
+        si.magFilter = VK_FILTER_LINEAR;
+        si.minFilter = VK_FILTER_LINEAR;
+        si.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        si.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        si.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        VkSampler sampler = VK_NULL_HANDLE;
+        if (vkCreateSampler(engine.logicalDevice, &si, nullptr, &sampler) != VK_SUCCESS)
+            throw std::runtime_error("failed to create the input sampler");
+
+        {
+            ColorAdjustments adjustments;
+            ColorGrading grading(&engine, 1);
+            grading.adjustments = &adjustments;
+            grading.resize(kExtent, VK_FORMAT_R8G8B8A8_UNORM);
+            grading.setInputRGBA(input.view, sampler);
+
+            std::cout << "\n[LutBench] ColorGrading at " << kExtent.width << "x" << kExtent.height << " on "
+                      << engine.getDeviceProperties().deviceName << ", median of " << iterations << " dispatches\n";
+            std::cout << "   lut    direct tri ms   direct tetra ms   baked tri ms   baked tetra ms\n";
+
+            auto row = [&](const char* label) {
+                double ms[4] = {0.0, 0.0, 0.0, 0.0};
+                int column = 0;
+                for (bool bake : {false, true})
+                {
+                    for (LutInterpolation mode : {LutInterpolation::Trilinear, LutInterpolation::Tetrahedral})
+                    {
+                        grading.bakeEnabled = bake;
+                        adjustments.lutInterpolation = mode;
+                        ms[column++] = medianGradingMs(engine, grading, iterations);
+                    }
+                }
+                std::cout << std::setw(6) << label << std::setprecision(3) << std::setw(16) << ms[0] << std::setw(18)
+                          << ms[1] << std::setw(15) << ms[2] << std::setw(17) << ms[3] << "\n";
+            };
+
+            row("none");
+            for (uint32_t size : {33u, 65u})
+            {
+                if (!grading.loadLut(dir / ("look_" + std::to_string(size) + ".cube")))
+                    throw std::runtime_error("failed to load the " + std::to_string(size) + "^3 table");
+                row(std::to_string(size).c_str());
+            }
+        }
+        vkDestroySampler(engine.logicalDevice, sampler, nullptr);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "[LutBench] " << e.what() << "\n";
+        ++failures;
+    }
+    return failures == 0 ? 0 : 1;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "lut_bench";
+    int iterations = 50;
+    bool gpu = true;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--dir" && i + 1 < argc)
+        {
+            dir = argv[++i];
+        }
+        else if (arg.rfind("--iterations=", 0) == 0)
+        {
+            iterations = std::max(1, std::atoi(arg.substr(std::string("--iterations=").size()).c_str()));
+        }
+        else if (arg == "--cpu-only")
+        {
+            gpu = false;
+        }
+        else if (arg == "--help" || arg == "-h")
+        {
+            std::cout << "Usage: lut_bench [--dir scratch_dir] [--iterations=N] [--cpu-only]\n";
+            return 0;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+
+    std::cout << "   size   parse ms   cached ms   tri mean   tri max   tetra mean   tetra max   grey tint tri   grey tint tetra\n";
+    std::cout << std::fixed;
+    for (uint32_t size : {33u, 65u})
+    {
+        const std::filesystem::path path = dir / ("look_" + std::to_string(size) + ".cube");
+        if (!writeCube(path, size))
+        {
+            std::cerr << "[LutBench] Failed to write " << path << "\n";
+            return 1;
+        }
+        std::filesystem::remove(cubeLutCachePath(path), ec);
+
+        CubeLut parsed, cached;
+        bool okParse = false, okCached = false;
+        const double parseMs = loadMs(path, parsed, okParse);
+        const double cachedMs = loadMs(path, cached, okCached);
+        if (!okParse || !okCached || parsed.rgb != cached.rgb)
+        {
+            std::cerr << "[LutBench] Cache round trip failed for " << path << "\n";
+            return 1;
+        }
+
+        std::mt19937 rng(99);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        constexpr int kSamples = 200000;
+        double triSum = 0.0, tetraSum = 0.0;
+        float triMax = 0.0f, tetraMax = 0.0f;
+        for (int i = 0; i < kSamples; ++i)
+        {
+            const glm::vec3 c(unit(rng), unit(rng), unit(rng));
+            const glm::vec3 exact = referenceLook(c);
+            const float tri = maxChannelError(sampleCubeLutTrilinear(parsed, c), exact);
+            const float tetra = maxChannelError(sampleCubeLutTetrahedral(parsed, c), exact);
+            triSum += tri;
+            tetraSum += tetra;
+            triMax = std::max(triMax, tri);
+            tetraMax = std::max(tetraMax, tetra);
+        }
+
+        // Channel spread of the error along the neutral axis shows up as a tint on greys
+        float triTint = 0.0f, tetraTint = 0.0f;
+        for (int i = 0; i <= 1000; ++i)
+        {
+            const glm::vec3 grey(i / 1000.0f);
+            const glm::vec3 t = sampleCubeLutTrilinear(parsed, grey) - referenceLook(grey);
+            const glm::vec3 q = sampleCubeLutTetrahedral(parsed, grey) - referenceLook(grey);
+            triTint = std::max(triTint, std::max({t.x, t.y, t.z}) - std::min({t.x, t.y, t.z}));
+            tetraTint = std::max(tetraTint, std::max({q.x, q.y, q.z}) - std::min({q.x, q.y, q.z}));
+        }
+
+        std::cout << std::setw(7) << size << std::setprecision(2) << std::setw(11) << parseMs << std::setw(12)
+                  << cachedMs << std::setprecision(5) << std::setw(11) << triSum / kSamples << std::setw(10) << triMax
+                  << std::setw(13) << tetraSum / kSamples << std::setw(12) << tetraMax << std::setw(16) << triTint
+                  << std::setw(18) << tetraTint << "\n";
+    }
+    return gpu ? runGpuTable(dir, iterations) : 0;
+}
@@ -1,4 +1,10 @@
 #include "motive2d.h"
+#include "decoder_vulkan.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
 
 int main(int argc, char **argv){
 
@@ -18,7 +24,7 @@ int main(int argc, char **argv){
         if (arg == "--video" && i + 1 < argc)
         {
             std::string nextArg(argv[i + 1] ? argv[i + 1] : "");
-            if (!nextArg.empty() && nextArg[0] != '-')
+            if (!nextArg.empty() && (nextArg == "-" || nextArg[0] != '-'))
             {
                 opts.videoPath = std::filesystem::path(nextArg);
                 ++i;
@@ -90,6 +96,130 @@ int main(int argc, char **argv){
             opts.subtitleBackground = false;
             continue;
         }
+        if (arg.rfind("--lut=", 0) == 0)
+        {
+            opts.gradingLut = std::filesystem::path(arg.substr(std::string("--lut=").size()));
+            continue;
+        }
+        if (arg == "--lut-tetrahedral")
+        {
+            opts.lutTetrahedral = true;
+            continue;
+        }
+        if (arg.rfind("--precision=", 0) == 0)
+        {
+            const std::string value = arg.substr(std::string("--precision=").size());
+            if (value == "8")
+            {
+                opts.intermediatePrecision = IntermediatePrecision::Unorm8;
+            }
+            else if (value == "16f" || value == "16")
+            {
+                opts.intermediatePrecision = IntermediatePrecision::Float16;
+            }
+            else if (value != "auto")
+            {
+                std::cerr << "Unknown --precision value " << value << " (expected 8, 16f or auto)\n";
+            }
+            continue;
+        }
+        if (arg.rfind("--nv12-kernel=", 0) == 0)
+        {
+            const std::string value = arg.substr(std::string("--nv12-kernel=").size());
+            if (value == "quad")
+            {
+                opts.nv12Kernel.kernel = Nv12Kernel::Quad2x2;
+            }
+            else if (value == "pixel")
+            {
+                opts.nv12Kernel.kernel = Nv12Kernel::PerPixel;
+            }
+            else
+            {
+                std::cerr << "Unknown --nv12-kernel value " << value << " (expected pixel or quad)\n";
+            }
+            continue;
+        }
+        if (arg.rfind("--nv12-workgroup=", 0) == 0)
+        {
+            // Quad workgroup shape in quads, e.g. 16x4
+            const std::string value = arg.substr(std::string("--nv12-workgroup=").size());
+            unsigned x = 0, y = 0;
+            if (std::sscanf(value.c_str(), "%ux%u", &x, &y) == 2 && x > 0 && y > 0)
+            {
+                opts.nv12Kernel.workgroupX = x;
+                opts.nv12Kernel.workgroupY = y;
+            }
+            else
+            {
+                std::cerr << "Invalid --nv12-workgroup value " << value << " (expected WxH)\n";
+            }
+            continue;
+        }
+        if (arg.rfind("--mosaic=", 0) == 0)
+        {
+            // Repeatable; two or more streams switch to the multi-camera mosaic
+            opts.mosaicPaths.emplace_back(arg.substr(std::string("--mosaic=").size()));
+            continue;
+        }
+        if (arg.rfind("--mosaic-size=", 0) == 0)
+        {
+            const std::string value = arg.substr(std::string("--mosaic-size=").size());
+            unsigned w = 0, h = 0;
+            if (std::sscanf(value.c_str(), "%ux%u", &w, &h) == 2 && w > 0 && h > 0)
+            {
+                opts.mosaicExtent = VkExtent2D{w, h};
+            }
+            else
+            {
+                std::cerr << "Invalid --mosaic-size value " << value << " (expected WxH)\n";
+            }
+            continue;
+        }
+        if (arg.rfind("--speed=", 0) == 0)
+        {
+            const std::string value = arg.substr(std::string("--speed=").size());
+            const double rate = std::atof(value.c_str());
+            const double speed = std::abs(rate);
+            if (speed >= DecoderVulkan::kMinPlaybackRate && speed <= DecoderVulkan::kMaxPlaybackRate)
+            {
+                opts.playbackRate = rate;
+            }
+            else
+            {
+                std::cerr << "Invalid --speed value " << value << " (expected 0.25..16, negative for reverse)\n";
+            }
+            continue;
+        }
+        if (arg.rfind("--frame-cache-mb=", 0) == 0)
+        {
+            const std::string value = arg.substr(std::string("--frame-cache-mb=").size());
+            const long mb = std::atol(value.c_str());
+            if (mb >= 0 && (mb > 0 || value == "0"))
+            {
+                opts.frameCacheBytes = static_cast<size_t>(mb) << 20;
+            }
+            else
+            {
+                std::cerr << "Invalid --frame-cache-mb value " << value << " (expected MiB, 0 disables)\n";
+            }
+            continue;
+        }
+        if (arg == "--no-thumbnails")
+        {
+            opts.scrubberThumbnails = false;
+            continue;
+        }
+        if (arg.rfind("--thumbnail-cache=", 0) == 0)
+        {
+            opts.thumbnailCacheDir = arg.substr(std::string("--thumbnail-cache=").size());
+            continue;
+        }
+        if (arg == "--no-scopes")
+        {
+            opts.gradingScopes = false;
+            continue;
+        }
         if (arg == "--debug")
         {
             opts.debugLogging = true;
@@ -100,6 +230,38 @@ int main(int argc, char **argv){
             opts.gpuDecode = true;
             continue;
         }
+        if (arg == "--stream")
+        {
+            opts.streamInput = true;
+            continue;
+        }
+        if (arg.rfind("--stream-chunk=", 0) == 0)
+        {
+            const std::string value = arg.substr(std::string("--stream-chunk=").size());
+            const long mb = std::atol(value.c_str());
+            if (mb > 0 && mb <= 1024)
+            {
+                opts.streamInput = true;
+                opts.streamOptions.chunkSize = static_cast<size_t>(mb) << 20;
+            }
+            else
+            {
+                std::cerr << "Invalid --stream-chunk value " << value << " (expected MiB, 1..1024)\n";
+            }
+            continue;
+        }
+        if (arg == "--direct-io")
+        {
+            opts.streamInput = true;
+            opts.streamOptions.directIO = true;
+            continue;
+        }
+        if (arg == "--follow")
+        {
+            opts.streamInput = true;
+            opts.streamOptions.follow = true;
+            continue;
+        }
         if (arg.rfind("--windows", 0) == 0)
         {
             std::string list;
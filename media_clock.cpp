@@ -0,0 +1,92 @@
+// media_clock.cpp
+#include "media_clock.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+void MediaClock::start(Clock::time_point now)
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (started_)
+        return;
+    started_ = true;
+    paused_ = false;
+    anchorWall_ = now;
+}
+
+bool MediaClock::started() const
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    return started_;
+}
+
+void MediaClock::pause(Clock::time_point now)
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (!started_ || paused_)
+        return;
+    anchorSeconds_ = secondsLocked_(now);
+    anchorWall_ = now;
+    paused_ = true;
+}
+
+void MediaClock::resume(Clock::time_point now)
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (!paused_)
+        return;
+    anchorWall_ = now;
+    paused_ = false;
+}
+
+bool MediaClock::paused() const
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    return paused_;
+}
+
+void MediaClock::seek(double seconds, Clock::time_point now)
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    anchorSeconds_ = seconds;
+    anchorWall_ = now;
+    ++seekEpoch_;
+}
+
+uint64_t MediaClock::seekEpoch() const
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    return seekEpoch_;
+}
+
+void MediaClock::setRate(double rate, Clock::time_point now)
+{
+    if (rate == 0.0 || !std::isfinite(rate))
+        throw std::runtime_error("MediaClock: rate must be finite and non-zero");
+
+    std::lock_guard<std::mutex> lk(mutex_);
+    anchorSeconds_ = secondsLocked_(now);
+    anchorWall_ = now;
+    rate_ = rate;
+}
+
+double MediaClock::rate() const
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    return rate_;
+}
+
+double MediaClock::seconds(Clock::time_point now) const
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    return secondsLocked_(now);
+}
+
+double MediaClock::secondsLocked_(Clock::time_point now) const
+{
+    if (!started_ || paused_)
+        return anchorSeconds_;
+    // Running backwards stops at the start of the media
+    return std::max(0.0, anchorSeconds_ + std::chrono::duration<double>(now - anchorWall_).count() * rate_);
+}
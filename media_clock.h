@@ -0,0 +1,51 @@
+// media_clock.h
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+// Master presentation clock. One instance (Engine2D::clock) is queried by every consumer of
+// "where is playback": the decoders pick the frame to show from it, the scrubber draws its
+// position and subtitle / overlay lookups use it, so windows and streams cannot drift apart.
+//
+// Time is presentation seconds from the start of the media (a frame's pts minus the stream's
+// start time). It stays at the seek position until start(), then advances at rate() times wall
+// time (backwards for a negative rate), frozen while paused. pause / resume / seek / setRate re-anchor at `now` without a jump.
+class MediaClock
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Starts running from the current position (0, or wherever seek() put it).
+    void start(Clock::time_point now = Clock::now());
+    bool started() const;
+
+    void pause(Clock::time_point now = Clock::now());
+    void resume(Clock::time_point now = Clock::now());
+    bool paused() const;
+
+    // Jumps to `seconds`; running / paused state and rate are kept. Bumps seekEpoch() so
+    // consumers holding frames from before the jump can tell.
+    void seek(double seconds, Clock::time_point now = Clock::now());
+    uint64_t seekEpoch() const;
+
+    // Playback speed; negative runs backwards (and stops at 0). Must be finite and non-zero.
+    void setRate(double rate, Clock::time_point now = Clock::now());
+    double rate() const;
+
+    // Presentation time in seconds.
+    double seconds(Clock::time_point now = Clock::now()) const;
+
+private:
+    double secondsLocked_(Clock::time_point now) const;
+
+private:
+    mutable std::mutex mutex_;
+    bool started_ = false;
+    bool paused_ = false;
+    double rate_ = 1.0;
+    uint64_t seekEpoch_ = 0;
+    Clock::time_point anchorWall_{};
+    double anchorSeconds_ = 0.0;
+};
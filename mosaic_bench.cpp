@@ -0,0 +1,219 @@
+// mosaic_bench.cpp
+//
+// Multi-camera throughput and sync: 4 and then 16 simultaneous streams decoded on one
+// DecodeThreadPool, presented against one MediaClock, converted at tile size and composed into
+// a 1920x1080 mosaic by MultiStreamMosaic, headless. Each run plays for --seconds of master
+// clock and reports decode / present rates, late drops, |drift| of latched frames against the
+// clock and the largest spread between the streams' displayed times. Sources are the paths
+// given on the command line, repeated round-robin up to the stream count (1080p clips are the
+// intended input). Run from the repository root so shaders/*.spv resolve.
+
+#include "engine2d.h"
+#include "multi_stream_mosaic.h"
+#include "queue_lock.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+constexpr uint32_t kFramesInFlight = 2;
+constexpr VkExtent2D kMosaicExtent{1920, 1080};
+// The clock starts once every stream has a frame; give slow openers this long
+constexpr double kStartTimeoutSeconds = 10.0;
+
+struct Slot
+{
+    VkCommandBuffer cmd = VK_NULL_HANDLE;
+    VkFence fence = VK_NULL_HANDLE;
+};
+
+bool runStreams(Engine2D& engine,
+                const std::vector<std::filesystem::path>& sources,
+                uint32_t streamCount,
+                double seconds,
+                uint32_t decodeThreads)
+{
+    std::vector<std::filesystem::path> paths;
+    for (uint32_t i = 0; i < streamCount; ++i)
+        paths.push_back(sources[i % sources.size()]);
+
+    MultiStreamMosaic mosaic(&engine, kFramesInFlight, paths, kMosaicExtent, IntermediatePrecision::Unorm8, decodeThreads);
+
+    std::vector<Slot> slots(kFramesInFlight);
+    for (Slot& slot : slots)
+    {
+        VkCommandBufferAllocateInfo ai{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+        ai.commandPool = engine.renderDevice.getCommandPool();
+        ai.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        ai.commandBufferCount = 1;
+        if (vkAllocateCommandBuffers(engine.logicalDevice, &ai, &slot.cmd) != VK_SUCCESS)
+            throw std::runtime_error("mosaic_bench: failed to allocate command buffer");
+
+        VkFenceCreateInfo fi{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+        fi.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+        if (vkCreateFence(engine.logicalDevice, &fi, nullptr, &slot.fence) != VK_SUCCESS)
+            throw std::runtime_error("mosaic_bench: failed to create fence");
+    }
+
+    const auto wallStart = std::chrono::steady_clock::now();
+    uint64_t composed = 0;
+    double convertMsSum = 0.0;
+    double mosaicMsSum = 0.0;
+    uint32_t slotIndex = 0;
+    bool timedOut = false;
+
+    while (true)
+    {
+        const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+        if (!mosaic.clock().started() && wall > kStartTimeoutSeconds)
+        {
+            timedOut = true;
+            break;
+        }
+        if (mosaic.clock().started() && (mosaic.clock().seconds() >= seconds || mosaic.finished()))
+            break;
+
+        if (!mosaic.advance())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+
+        Slot& slot = slots[slotIndex];
+        vkWaitForFences(engine.logicalDevice, 1, &slot.fence, VK_TRUE, UINT64_MAX);
+        vkResetFences(engine.logicalDevice, 1, &slot.fence);
+
+        // The slot's previous submission is done, so the passes have its timestamps now
+        if (composed >= kFramesInFlight)
+        {
+            convertMsSum += mosaic.conversionGpuMilliseconds();
+            mosaicMsSum += mosaic.mosaicGpuMilliseconds();
+        }
+
+        VkCommandBufferBeginInfo bi{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+        bi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(slot.cmd, &bi);
+        mosaic.record(slot.cmd, slotIndex);
+        vkEndCommandBuffer(slot.cmd);
+
+        VkSubmitInfo si{VK_STRUCTURE_TYPE_SUBMIT_INFO};
+        si.commandBufferCount = 1;
+        si.pCommandBuffers = &slot.cmd;
+        {
+            // The streams' FFmpeg decoders submit to this queue from the pool threads
+            std::lock_guard<std::mutex> queueLock(vulkanQueueMutex(engine.graphicsQueueFamilyIndex));
+            if (vkQueueSubmit(engine.graphicsQueue, 1, &si, slot.fence) != VK_SUCCESS)
+                throw std::runtime_error("mosaic_bench: queue submit failed");
+        }
+
+        ++composed;
+        slotIndex = (slotIndex + 1) % kFramesInFlight;
+    }
+
+    vkDeviceWaitIdle(engine.logicalDevice);
+    for (Slot& slot : slots)
+    {
+        vkFreeCommandBuffers(engine.logicalDevice, engine.renderDevice.getCommandPool(), 1, &slot.cmd);
+        vkDestroyFence(engine.logicalDevice, slot.fence, nullptr);
+    }
+
+    if (timedOut)
+    {
+        std::cerr << "mosaic_bench: " << streamCount << " streams never all produced a first frame" << std::endl;
+        return false;
+    }
+
+    const MosaicStats st = mosaic.stats();
+    const double clockSeconds = std::max(st.seconds, 1e-6);
+    const uint64_t timed = composed > kFramesInFlight ? composed - kFramesInFlight : 0;
+
+    std::cout << std::setw(4) << streamCount << " streams  " << std::setw(2) << mosaic.decodeThreadCount() << " threads  "
+              << std::setw(8) << st.framesDecoded / clockSeconds << " dec fps (" << std::setw(6)
+              << st.framesDecoded / clockSeconds / streamCount << "/stream)  " << std::setw(8)
+              << st.framesPresented / clockSeconds << " shown fps  " << std::setw(5) << st.framesDropped << " dropped  "
+              << std::setw(7) << composed / clockSeconds << " mosaic fps  gpu " << std::setw(6)
+              << (timed ? convertMsSum / timed : 0.0) << "+" << std::setw(5) << (timed ? mosaicMsSum / timed : 0.0)
+              << " ms  drift mean " << std::setw(6) << st.meanAbsDriftMs << " max " << std::setw(6) << st.maxAbsDriftMs
+              << " ms  spread max " << std::setw(6) << st.maxSpreadMs << " ms\n";
+    return true;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    double seconds = 10.0;
+    uint32_t decodeThreads = 0;
+    std::vector<uint32_t> streamCounts = {4, 16};
+    std::vector<std::filesystem::path> sources;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h")
+        {
+            std::cout << "Usage: mosaic_bench [--seconds=S] [--threads=N] [--streams=N] <video> [video...]\n";
+            return 0;
+        }
+        if (arg.rfind("--seconds=", 0) == 0)
+        {
+            seconds = std::max(1.0, std::atof(arg.substr(std::string("--seconds=").size()).c_str()));
+            continue;
+        }
+        if (arg.rfind("--threads=", 0) == 0)
+        {
+            decodeThreads = static_cast<uint32_t>(std::max(0, std::atoi(arg.substr(std::string("--threads=").size()).c_str())));
+            continue;
+        }
+        if (arg.rfind("--streams=", 0) == 0)
+        {
+            const int n = std::atoi(arg.substr(std::string("--streams=").size()).c_str());
+            if (n > 0)
+                streamCounts = {static_cast<uint32_t>(n)};
+            continue;
+        }
+        sources.emplace_back(arg);
+    }
+
+    if (sources.empty())
+    {
+        std::cerr << "mosaic_bench: no input videos (see --help)" << std::endl;
+        return 1;
+    }
+
+    Engine2D engine;
+    if (!engine.initialize(false))
+    {
+        std::cerr << "mosaic_bench: failed to initialise Vulkan" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Multi-stream mosaic " << kMosaicExtent.width << "x" << kMosaicExtent.height << " on "
+              << engine.getDeviceProperties().deviceName << ", " << seconds << " s of master clock per run:\n";
+    std::cout << std::fixed << std::setprecision(2);
+
+    int failures = 0;
+    for (uint32_t count : streamCounts)
+    {
+        try
+        {
+            if (!runStreams(engine, sources, count, seconds, decodeThreads))
+                ++failures;
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "mosaic_bench: " << count << " streams: " << e.what() << std::endl;
+            ++failures;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,549 @@
+// mosaic_pass.cpp
+// Tile-sized converted streams -> one RGBA mosaic (one dispatch per grid cell).
+
+#include "mosaic_pass.h"
+
+#include "engine2d.h"
+#include "utils.h"
+#include "debug_logging.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+namespace
+{
+VkImageMemoryBarrier makeImageBarrier(VkImage image,
+                                      VkImageLayout oldLayout,
+                                      VkImageLayout newLayout,
+                                      VkAccessFlags srcAccess,
+                                      VkAccessFlags dstAccess)
+{
+    VkImageMemoryBarrier b{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+    b.oldLayout = oldLayout;
+    b.newLayout = newLayout;
+    b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    b.image = image;
+    b.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    b.subresourceRange.levelCount = 1;
+    b.subresourceRange.layerCount = 1;
+    b.srcAccessMask = srcAccess;
+    b.dstAccessMask = dstAccess;
+    return b;
+}
+
+void destroyImageAndView(VkDevice device, VkImage& image, VkImageView& view, VkDeviceMemory& memory)
+{
+    if (view != VK_NULL_HANDLE)
+    {
+        vkDestroyImageView(device, view, nullptr);
+        view = VK_NULL_HANDLE;
+    }
+    if (image != VK_NULL_HANDLE)
+    {
+        vkDestroyImage(device, image, nullptr);
+        image = VK_NULL_HANDLE;
+    }
+    if (memory != VK_NULL_HANDLE)
+    {
+        vkFreeMemory(device, memory, nullptr);
+        memory = VK_NULL_HANDLE;
+    }
+}
+} // namespace
+
+std::vector<VkRect2D> mosaicGrid(uint32_t count, VkExtent2D extent)
+{
+    std::vector<VkRect2D> cells;
+    if (count == 0 || extent.width == 0 || extent.height == 0)
+        return cells;
+
+    const uint32_t cols = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+    const uint32_t rows = (count + cols - 1) / cols;
+
+    cells.reserve(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const uint32_t col = i % cols;
+        const uint32_t row = i / cols;
+        const uint32_t x0 = col * extent.width / cols;
+        const uint32_t x1 = (col + 1) * extent.width / cols;
+        const uint32_t y0 = row * extent.height / rows;
+        const uint32_t y1 = (row + 1) * extent.height / rows;
+
+        VkRect2D cell{};
+        cell.offset = VkOffset2D{static_cast<int32_t>(x0), static_cast<int32_t>(y0)};
+        cell.extent = VkExtent2D{x1 - x0, y1 - y0};
+        cells.push_back(cell);
+    }
+    return cells;
+}
+
+VkRect2D mosaicFitTile(const VkRect2D& cell, uint32_t sourceWidth, uint32_t sourceHeight)
+{
+    VkRect2D tile = cell;
+    if (sourceWidth == 0 || sourceHeight == 0 || cell.extent.width == 0 || cell.extent.height == 0)
+        return tile;
+
+    const double scale = std::min(static_cast<double>(cell.extent.width) / sourceWidth,
+                                  static_cast<double>(cell.extent.height) / sourceHeight);
+    tile.extent.width = std::clamp(static_cast<uint32_t>(std::lround(sourceWidth * scale)), 1u, cell.extent.width);
+    tile.extent.height = std::clamp(static_cast<uint32_t>(std::lround(sourceHeight * scale)), 1u, cell.extent.height);
+    tile.offset.x = cell.offset.x + static_cast<int32_t>((cell.extent.width - tile.extent.width) / 2);
+    tile.offset.y = cell.offset.y + static_cast<int32_t>((cell.extent.height - tile.extent.height) / 2);
+    return tile;
+}
+
+MosaicPass::MosaicPass(Engine2D* eng, uint32_t framesInFlight, uint32_t tileCount, VkExtent2D extent, VkFormat format)
+    : engine(eng), framesInFlight_(framesInFlight), tileCount_(tileCount), extent_(extent), format_(format)
+{
+    if (!engine || engine->logicalDevice == VK_NULL_HANDLE)
+        throw std::runtime_error("MosaicPass requires a valid Engine2D");
+
+    if (framesInFlight_ == 0 || tileCount_ == 0)
+        throw std::runtime_error("MosaicPass: framesInFlight and tileCount must be > 0");
+
+    if (extent_.width == 0 || extent_.height == 0)
+        throw std::runtime_error("MosaicPass: output extent must be non-zero");
+
+    cells_ = mosaicGrid(tileCount_, extent_);
+    tiles_.assign(static_cast<size_t>(framesInFlight_) * tileCount_, Tile{});
+    timestampsPending_.assign(framesInFlight_, false);
+
+    createPipeline_();
+    createOutputs_();
+    createDescriptors_();
+    createTimestampQueries_();
+}
+
+MosaicPass::~MosaicPass()
+{
+    if (!engine || engine->logicalDevice == VK_NULL_HANDLE)
+        return;
+
+    vkDeviceWaitIdle(engine->logicalDevice);
+
+    if (descriptorPool_ != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorPool(engine->logicalDevice, descriptorPool_, nullptr);
+        descriptorPool_ = VK_NULL_HANDLE;
+    }
+    destroyOutputs_();
+    if (timestampPool_ != VK_NULL_HANDLE)
+    {
+        vkDestroyQueryPool(engine->logicalDevice, timestampPool_, nullptr);
+        timestampPool_ = VK_NULL_HANDLE;
+    }
+    destroyPipeline_();
+}
+
+void MosaicPass::setTile(uint32_t frameIndex, uint32_t tile, VkImageView view, const VkRect2D& rect)
+{
+    if (tile >= tileCount_)
+        return;
+
+    Tile& t = tiles_[static_cast<size_t>(frameIndex % framesInFlight_) * tileCount_ + tile];
+    t.view = view;
+    t.rect = rect;
+}
+
+void MosaicPass::record(VkCommandBuffer cmd, uint32_t frameIndex)
+{
+    if (cmd == VK_NULL_HANDLE || pipeline_ == VK_NULL_HANDLE)
+        return;
+
+    const uint32_t fi = frameIndex % framesInFlight_;
+
+    // This slot's previous submission has completed by the time it is recorded again.
+    readTimestamps_(fi);
+
+    if (timestampPool_ != VK_NULL_HANDLE)
+    {
+        vkCmdResetQueryPool(cmd, timestampPool_, fi * 2, 2);
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampPool_, fi * 2);
+    }
+
+    // Every pixel is written below, so the previous contents are discarded
+    VkImageMemoryBarrier toGeneral = makeImageBarrier(outImages_[fi],
+                                                      VK_IMAGE_LAYOUT_UNDEFINED,
+                                                      VK_IMAGE_LAYOUT_GENERAL,
+                                                      0,
+                                                      VK_ACCESS_SHADER_WRITE_BIT);
+    vkCmdPipelineBarrier(cmd,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0,
+                         0, nullptr,
+                         0, nullptr,
+                         1, &toGeneral);
+
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_);
+
+    MosaicPushConstants push{};
+    push.background = background;
+    push.outputSize = glm::ivec2(static_cast<int>(extent_.width), static_cast<int>(extent_.height));
+
+    for (uint32_t i = 0; i < tileCount_; ++i)
+    {
+        Tile& t = tiles_[static_cast<size_t>(fi) * tileCount_ + i];
+        const VkImageView view = t.view != VK_NULL_HANDLE ? t.view : placeholderView_;
+        if (t.boundView != view)
+            updateDescriptorSet_(fi, i, view);
+
+        const VkRect2D& c = cells_[i];
+        push.cellOrigin = glm::ivec2(c.offset.x, c.offset.y);
+        push.cellSize = glm::ivec2(static_cast<int>(c.extent.width), static_cast<int>(c.extent.height));
+        push.tileOrigin = glm::ivec2(t.rect.offset.x, t.rect.offset.y);
+        push.tileSize = t.view != VK_NULL_HANDLE
+            ? glm::ivec2(static_cast<int>(t.rect.extent.width), static_cast<int>(t.rect.extent.height))
+            : glm::ivec2(0, 0);
+
+        vkCmdBindDescriptorSets(cmd,
+                                VK_PIPELINE_BIND_POINT_COMPUTE,
+                                pipelineLayout_,
+                                0,
+                                1,
+                                &t.set,
+                                0,
+                                nullptr);
+        vkCmdPushConstants(cmd, pipelineLayout_, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(MosaicPushConstants), &push);
+        vkCmdDispatch(cmd, (c.extent.width + 15u) / 16u, (c.extent.height + 15u) / 16u, 1);
+    }
+
+    if (timestampPool_ != VK_NULL_HANDLE)
+    {
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, timestampPool_, fi * 2 + 1);
+        timestampsPending_[fi] = true;
+    }
+
+    VkImageMemoryBarrier toSample = makeImageBarrier(outImages_[fi],
+                                                     VK_IMAGE_LAYOUT_GENERAL,
+                                                     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                                     VK_ACCESS_SHADER_WRITE_BIT,
+                                                     VK_ACCESS_SHADER_READ_BIT);
+    vkCmdPipelineBarrier(cmd,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0,
+                         0, nullptr,
+                         0, nullptr,
+                         1, &toSample);
+
+    if (renderDebugEnabled())
+    {
+        std::cout << "[MosaicPass] record fi=" << fi
+                  << " tiles=" << tileCount_
+                  << " extent=" << extent_.width << "x" << extent_.height
+                  << " gpu=" << lastGpuMs_ << "ms"
+                  << std::endl;
+    }
+}
+
+PresentInput MosaicPass::output(uint32_t frameIndex) const
+{
+    PresentInput out{};
+    const uint32_t fi = frameIndex % framesInFlight_;
+    if (fi < outImages_.size())
+    {
+        out.image = outImages_[fi];
+        out.view = outViews_[fi];
+        out.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        out.extent = extent_;
+        out.format = format_;
+    }
+    return out;
+}
+
+void MosaicPass::createPipeline_()
+{
+    // 0 = converted tile (sampled, texelFetch only)
+    // 1 = mosaic output (storage)
+    std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+
+    bindings[0].binding = 0;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    bindings[0].descriptorCount = 1;
+    bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    bindings[1].binding = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    bindings[1].descriptorCount = 1;
+    bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkDescriptorSetLayoutCreateInfo dsl{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
+    dsl.bindingCount = static_cast<uint32_t>(bindings.size());
+    dsl.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(engine->logicalDevice, &dsl, nullptr, &setLayout_) != VK_SUCCESS)
+        throw std::runtime_error("MosaicPass: failed to create descriptor set layout");
+
+    VkPushConstantRange pcRange{};
+    pcRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pcRange.offset = 0;
+    pcRange.size = sizeof(MosaicPushConstants);
+
+    VkPipelineLayoutCreateInfo pli{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+    pli.setLayoutCount = 1;
+    pli.pSetLayouts = &setLayout_;
+    pli.pushConstantRangeCount = 1;
+    pli.pPushConstantRanges = &pcRange;
+
+    if (vkCreatePipelineLayout(engine->logicalDevice, &pli, nullptr, &pipelineLayout_) != VK_SUCCESS)
+        throw std::runtime_error("MosaicPass: failed to create pipeline layout");
+
+    auto shaderCode = readSPIRVFile("shaders/mosaic.spv");
+    VkShaderModule shaderModule = engine->createShaderModule(shaderCode);
+
+    VkPipelineShaderStageCreateInfo stage{VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO};
+    stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    stage.module = shaderModule;
+    stage.pName = "main";
+
+    VkComputePipelineCreateInfo cpi{VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO};
+    cpi.stage = stage;
+    cpi.layout = pipelineLayout_;
+
+    const VkResult result = vkCreateComputePipelines(engine->logicalDevice, VK_NULL_HANDLE, 1, &cpi, nullptr, &pipeline_);
+    vkDestroyShaderModule(engine->logicalDevice, shaderModule, nullptr);
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("MosaicPass: failed to create compute pipeline");
+
+    VkSamplerCreateInfo si{VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
+    si.magFilter = VK_FILTER_LINEAR;
+    si.minFilter = VK_FILTER_LINEAR;
+    si.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    si.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    si.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    si.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    si.maxLod = 0.0f;
+
+    if (vkCreateSampler(engine->logicalDevice, &si, nullptr, &sampler_) != VK_SUCCESS)
+        throw std::runtime_error("MosaicPass: failed to create sampler");
+}
+
+void MosaicPass::destroyPipeline_()
+{
+    if (sampler_ != VK_NULL_HANDLE)
+    {
+        vkDestroySampler(engine->logicalDevice, sampler_, nullptr);
+        sampler_ = VK_NULL_HANDLE;
+    }
+    if (pipeline_ != VK_NULL_HANDLE)
+    {
+        vkDestroyPipeline(engine->logicalDevice, pipeline_, nullptr);
+        pipeline_ = VK_NULL_HANDLE;
+    }
+    if (pipelineLayout_ != VK_NULL_HANDLE)
+    {
+        vkDestroyPipelineLayout(engine->logicalDevice, pipelineLayout_, nullptr);
+        pipelineLayout_ = VK_NULL_HANDLE;
+    }
+    if (setLayout_ != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorSetLayout(engine->logicalDevice, setLayout_, nullptr);
+        setLayout_ = VK_NULL_HANDLE;
+    }
+}
+
+void MosaicPass::createImage_(VkExtent2D extent,
+                              VkImageUsageFlags usage,
+                              VkImage& image,
+                              VkDeviceMemory& memory,
+                              VkImageView& view)
+{
+    VkImageCreateInfo ii{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+    ii.imageType = VK_IMAGE_TYPE_2D;
+    ii.format = format_;
+    ii.extent = VkExtent3D{extent.width, extent.height, 1};
+    ii.mipLevels = 1;
+    ii.arrayLayers = 1;
+    ii.samples = VK_SAMPLE_COUNT_1_BIT;
+    ii.tiling = VK_IMAGE_TILING_OPTIMAL;
+    ii.usage = usage;
+    ii.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    ii.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    if (vkCreateImage(engine->logicalDevice, &ii, nullptr, &image) != VK_SUCCESS)
+        throw std::runtime_error("MosaicPass: failed to create image");
+
+    VkMemoryRequirements mr{};
+    vkGetImageMemoryRequirements(engine->logicalDevice, image, &mr);
+
+    VkMemoryAllocateInfo ai{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+    ai.allocationSize = mr.size;
+    ai.memoryTypeIndex = engine->findMemoryType(mr.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    if (vkAllocateMemory(engine->logicalDevice, &ai, nullptr, &memory) != VK_SUCCESS)
+        throw std::runtime_error("MosaicPass: failed to allocate image memory");
+
+    vkBindImageMemory(engine->logicalDevice, image, memory, 0);
+
+    VkImageViewCreateInfo vi{VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
+    vi.image = image;
+    vi.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    vi.format = format_;
+    vi.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    vi.subresourceRange.levelCount = 1;
+    vi.subresourceRange.layerCount = 1;
+
+    if (vkCreateImageView(engine->logicalDevice, &vi, nullptr, &view) != VK_SUCCESS)
+        throw std::runtime_error("MosaicPass: failed to create image view");
+}
+
+void MosaicPass::createOutputs_()
+{
+    outImages_.assign(framesInFlight_, VK_NULL_HANDLE);
+    outMem_.assign(framesInFlight_, VK_NULL_HANDLE);
+    outViews_.assign(framesInFlight_, VK_NULL_HANDLE);
+
+    // Written by compute, sampled by grading / presenters, copied out by mosaic_bench
+    for (uint32_t i = 0; i < framesInFlight_; ++i)
+    {
+        createImage_(extent_,
+                     VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                     outImages_[i],
+                     outMem_[i],
+                     outViews_[i]);
+    }
+
+    // Empty cells never read their tile, but binding 0 must still hold a valid image
+    createImage_(VkExtent2D{1, 1}, VK_IMAGE_USAGE_SAMPLED_BIT, placeholderImage_, placeholderMem_, placeholderView_);
+
+    VkCommandBuffer cmd = engine->beginSingleTimeCommands();
+    VkImageMemoryBarrier toSample = makeImageBarrier(placeholderImage_,
+                                                     VK_IMAGE_LAYOUT_UNDEFINED,
+                                                     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                                     0,
+                                                     VK_ACCESS_SHADER_READ_BIT);
+    vkCmdPipelineBarrier(cmd,
+                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0,
+                         0, nullptr,
+                         0, nullptr,
+                         1, &toSample);
+    engine->endSingleTimeCommands(cmd);
+}
+
+void MosaicPass::destroyOutputs_()
+{
+    for (uint32_t i = 0; i < outImages_.size(); ++i)
+        destroyImageAndView(engine->logicalDevice, outImages_[i], outViews_[i], outMem_[i]);
+    outImages_.clear();
+    outMem_.clear();
+    outViews_.clear();
+
+    destroyImageAndView(engine->logicalDevice, placeholderImage_, placeholderView_, placeholderMem_);
+}
+
+void MosaicPass::createDescriptors_()
+{
+    const uint32_t setCount = static_cast<uint32_t>(tiles_.size());
+
+    std::array<VkDescriptorPoolSize, 2> sizes{};
+    sizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    sizes[0].descriptorCount = setCount;
+    sizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    sizes[1].descriptorCount = setCount;
+
+    VkDescriptorPoolCreateInfo pi{VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
+    pi.poolSizeCount = static_cast<uint32_t>(sizes.size());
+    pi.pPoolSizes = sizes.data();
+    pi.maxSets = setCount;
+
+    if (vkCreateDescriptorPool(engine->logicalDevice, &pi, nullptr, &descriptorPool_) != VK_SUCCESS)
+        throw std::runtime_error("MosaicPass: failed to create descriptor pool");
+
+    std::vector<VkDescriptorSetLayout> layouts(setCount, setLayout_);
+    std::vector<VkDescriptorSet> sets(setCount, VK_NULL_HANDLE);
+
+    VkDescriptorSetAllocateInfo ai{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+    ai.descriptorPool = descriptorPool_;
+    ai.descriptorSetCount = setCount;
+    ai.pSetLayouts = layouts.data();
+
+    if (vkAllocateDescriptorSets(engine->logicalDevice, &ai, sets.data()) != VK_SUCCESS)
+        throw std::runtime_error("MosaicPass: failed to allocate descriptor sets");
+
+    for (uint32_t i = 0; i < setCount; ++i)
+    {
+        tiles_[i].set = sets[i];
+        updateDescriptorSet_(i / tileCount_, i % tileCount_, placeholderView_);
+    }
+}
+
+void MosaicPass::updateDescriptorSet_(uint32_t frameIndex, uint32_t tile, VkImageView view)
+{
+    // The slot's previous submission has completed, so its sets can be rewritten in place
+    // (decoders rebuild their plane views, converters their outputs on resize).
+    Tile& t = tiles_[static_cast<size_t>(frameIndex) * tileCount_ + tile];
+    std::array<VkWriteDescriptorSet, 2> writes{};
+
+    VkDescriptorImageInfo tileInfo{};
+    tileInfo.sampler = sampler_;
+    tileInfo.imageView = view;
+    tileInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[0].dstSet = t.set;
+    writes[0].dstBinding = 0;
+    writes[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    writes[0].descriptorCount = 1;
+    writes[0].pImageInfo = &tileInfo;
+
+    VkDescriptorImageInfo outInfo{};
+    outInfo.imageView = outViews_[frameIndex];
+    outInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+    writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[1].dstSet = t.set;
+    writes[1].dstBinding = 1;
+    writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    writes[1].descriptorCount = 1;
+    writes[1].pImageInfo = &outInfo;
+
+    vkUpdateDescriptorSets(engine->logicalDevice, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    t.boundView = view;
+}
+
+void MosaicPass::createTimestampQueries_()
+{
+    const VkPhysicalDeviceLimits& limits = engine->getDeviceProperties().limits;
+    if (!limits.timestampComputeAndGraphics || limits.timestampPeriod <= 0.0f)
+        return;
+
+    VkQueryPoolCreateInfo qi{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+    qi.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    qi.queryCount = framesInFlight_ * 2;
+    if (vkCreateQueryPool(engine->logicalDevice, &qi, nullptr, &timestampPool_) != VK_SUCCESS)
+    {
+        timestampPool_ = VK_NULL_HANDLE;
+        return;
+    }
+    timestampPeriodNs_ = static_cast<double>(limits.timestampPeriod);
+}
+
+void MosaicPass::readTimestamps_(uint32_t frameIndex)
+{
+    if (timestampPool_ == VK_NULL_HANDLE || !timestampsPending_[frameIndex])
+        return;
+
+    std::array<uint64_t, 2> ticks{};
+    if (vkGetQueryPoolResults(engine->logicalDevice,
+                              timestampPool_,
+                              frameIndex * 2,
+                              2,
+                              sizeof(ticks),
+                              ticks.data(),
+                              sizeof(uint64_t),
+                              VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+        return;
+
+    timestampsPending_[frameIndex] = false;
+    if (ticks[1] >= ticks[0])
+        lastGpuMs_ = static_cast<double>(ticks[1] - ticks[0]) * timestampPeriodNs_ * 1e-6;
+}
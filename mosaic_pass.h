@@ -0,0 +1,121 @@
+// mosaic_pass.h
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+
+#include "display2d.h"
+
+class Engine2D;
+
+// Push constants of mosaic.comp
+struct MosaicPushConstants
+{
+    glm::vec4 background{0.0f, 0.0f, 0.0f, 1.0f};
+    glm::ivec2 outputSize{0, 0};
+    glm::ivec2 cellOrigin{0, 0};
+    glm::ivec2 cellSize{0, 0};
+    glm::ivec2 tileOrigin{0, 0}; // in output pixels
+    glm::ivec2 tileSize{0, 0};   // (0,0) for a cell without a stream
+    glm::ivec2 padding{0, 0};
+};
+static_assert(sizeof(MosaicPushConstants) == 64, "Push constant size must match shader");
+
+// Near-square grid of `count` cells covering `extent`; the last column / row absorb the
+// rounding so the cells tile the output exactly.
+std::vector<VkRect2D> mosaicGrid(uint32_t count, VkExtent2D extent);
+
+// Largest rectangle with the source's aspect ratio that fits in `cell`, centred in it.
+VkRect2D mosaicFitTile(const VkRect2D& cell, uint32_t sourceWidth, uint32_t sourceHeight);
+
+// Composes up to `tileCount` converted streams into one RGBA image (multi-camera review).
+// Each stream's YUV->RGBA pass converts straight to its tile size (see mosaicFitTile), so
+// this pass only places the tiles and fills the letterbox; one dispatch per grid cell.
+class MosaicPass
+{
+public:
+    MosaicPass(Engine2D* engine,
+               uint32_t framesInFlight,
+               uint32_t tileCount,
+               VkExtent2D extent,
+               VkFormat format = VK_FORMAT_R8G8B8A8_UNORM);
+    ~MosaicPass();
+
+    MosaicPass(const MosaicPass&) = delete;
+    MosaicPass& operator=(const MosaicPass&) = delete;
+
+    uint32_t tileCount() const { return tileCount_; }
+    VkExtent2D extent() const { return extent_; }
+    const VkRect2D& cell(uint32_t tile) const { return cells_[tile]; }
+
+    // Tile `tile` for this slot: a converted RGBA view of exactly rect.extent, placed at
+    // rect.offset. A null view leaves the cell empty (background).
+    void setTile(uint32_t frameIndex, uint32_t tile, VkImageView view, const VkRect2D& rect);
+
+    // Records the mosaic. Tile images must be in SHADER_READ_ONLY_OPTIMAL and their writes made
+    // visible to compute; the output is left in SHADER_READ_ONLY_OPTIMAL.
+    void record(VkCommandBuffer cmd, uint32_t frameIndex);
+
+    PresentInput output(uint32_t frameIndex) const;
+    VkSampler outputSampler() const { return sampler_; } // linear clamp
+
+    // GPU time of the last completed record() in milliseconds (0 until one has finished).
+    double lastGpuMilliseconds() const { return lastGpuMs_; }
+
+    glm::vec4 background{0.04f, 0.04f, 0.04f, 1.0f};
+
+private:
+    struct Tile
+    {
+        VkImageView view = VK_NULL_HANDLE;
+        VkRect2D rect{};
+        VkImageView boundView = VK_NULL_HANDLE;
+        VkDescriptorSet set = VK_NULL_HANDLE;
+    };
+
+    void createPipeline_();
+    void destroyPipeline_();
+    void createImage_(VkExtent2D extent, VkImageUsageFlags usage, VkImage& image, VkDeviceMemory& memory, VkImageView& view);
+    void createOutputs_();
+    void destroyOutputs_();
+    void createDescriptors_();
+    void updateDescriptorSet_(uint32_t frameIndex, uint32_t tile, VkImageView view);
+
+    void createTimestampQueries_();
+    void readTimestamps_(uint32_t frameIndex);
+
+private:
+    Engine2D* engine = nullptr;
+    uint32_t framesInFlight_ = 0;
+    uint32_t tileCount_ = 0;
+    VkExtent2D extent_{0, 0};
+    VkFormat format_ = VK_FORMAT_R8G8B8A8_UNORM;
+    std::vector<VkRect2D> cells_;
+
+    VkDescriptorSetLayout setLayout_ = VK_NULL_HANDLE;
+    VkPipelineLayout pipelineLayout_ = VK_NULL_HANDLE;
+    VkPipeline pipeline_ = VK_NULL_HANDLE;
+    VkSampler sampler_ = VK_NULL_HANDLE;
+
+    // [frameIndex * tileCount + tile]; empty cells bind the 1x1 placeholder and are drawn
+    // with tileSize 0
+    VkDescriptorPool descriptorPool_ = VK_NULL_HANDLE;
+    std::vector<Tile> tiles_;
+    VkImage placeholderImage_ = VK_NULL_HANDLE;
+    VkDeviceMemory placeholderMem_ = VK_NULL_HANDLE;
+    VkImageView placeholderView_ = VK_NULL_HANDLE;
+
+    // Output per slot (owned); every pixel is rewritten, so it starts from UNDEFINED each frame
+    std::vector<VkImage> outImages_;
+    std::vector<VkDeviceMemory> outMem_;
+    std::vector<VkImageView> outViews_;
+
+    // Two timestamps per frame slot around the mosaic
+    VkQueryPool timestampPool_ = VK_NULL_HANDLE;
+    std::vector<bool> timestampsPending_;
+    double timestampPeriodNs_ = 0.0;
+    double lastGpuMs_ = 0.0;
+};
@@ -1,9 +1,10 @@
 // motive2d.cpp
 //
-// Consumer side for FFmpeg Vulkan zero-copy decode + NV12->RGBA + ColorGrading (optional).
+// Consumer side for FFmpeg Vulkan zero-copy decode + YUV->RGBA + ColorGrading (optional).
 // - NO CPU copies of decoded frames.
-// - Reads decoder-provided VkImageViews (Y + UV) directly.
-// - Dispatches NV12->RGBA compute into a device-local RGBA8 image (owned by the pass).
+// - Reads decoder-provided VkImageViews (Y + UV, or Y + U + V for 3-plane surfaces) directly.
+// - Dispatches NV12->RGBA or planar YUV->RGBA compute (picked by the decoder's YuvLayout) into a
+//   device-local RGBA8 / RGBA16F image (owned by the pass).
 // - Optionally dispatches ColorGrading (RGBA->RGBA) into another pass-owned output.
 // - Publishes per-window PresentInput via Display2D::setPresentInput().
 //
@@ -11,7 +12,7 @@
 // 1) DecoderVulkan exposes the *current* VulkanSurface metadata for the latched frame.
 //      bool getCurrentSurface(VulkanSurface& out) const;
 //    advancePlayback() latches:
-//      - externalLumaView / externalChromaView
+//      - externalLumaView / externalChromaView (/ externalChromaCrView for 3-plane surfaces)
 //      - matching VulkanSurface snapshot (images/layouts/queueFamily)
 // 2) Decoded VkImages must be usable as STORAGE_IMAGE (read-only) if your NV12 shader uses storage.
 // 3) If decode happens on a separate queue family, ownership transfer must occur (we do it here).
@@ -24,13 +25,17 @@
 #include "debug_logging.h"
 #include "engine2d.h"
 #include "fps.h"
+#include "multi_stream_mosaic.h"
 #include "pose_overlay.h"
+#include "queue_lock.h"
 #include "scrubber.h"
 #include "subtitle.h"
+#include "thumbnail_strip.h"
 #include "utils.h"
 
-// NV12->RGBA pass (pass-owned output)
+// NV12->RGBA and planar YUV->RGBA passes (pass-owned output)
 #include "nv12_to_rgba.h"
+#include "yuv420p_to_rgba.h"
 
 // RGBA->RGBA pass (pass-owned output)
 #include "color_grading_pass.h"
@@ -185,12 +190,64 @@ Motive2D::Motive2D(CliOptions cliOptions)
 
     std::cout << "[Motive2D] GPU decode requested (Vulkan/FFmpeg)\n";
 
-    decoder = new DecoderVulkan(cliOptions.videoPath, engine);
-    if (!decoder || !decoder->valid)
-        throw std::runtime_error("DecoderVulkan invalid: " + decoder->getHardwareInitFailureReason());
+    if (cliOptions.mosaicPaths.size() >= 2)
+    {
+        // Every stream converts straight to its tile, so the intermediates are mosaic-sized;
+        // 8-bit unless --precision asks otherwise
+        precision = options.intermediatePrecision.value_or(IntermediatePrecision::Unorm8);
+        mosaic = new MultiStreamMosaic(engine,
+                                       static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT),
+                                       cliOptions.mosaicPaths,
+                                       cliOptions.mosaicExtent,
+                                       precision,
+                                       /*decodeThreads=*/0,
+                                       &engine->clock);
+        if (cliOptions.frameCacheBytes)
+            mosaic->setFrameCacheBudget(*cliOptions.frameCacheBytes);
+        if (cliOptions.playbackRate != 1.0)
+        {
+            mosaic->setPlaybackRate(cliOptions.playbackRate);
+            // Backwards starts from the end
+            if (cliOptions.playbackRate < 0.0)
+                mosaic->seek(mosaic->durationSeconds());
+        }
+    }
+    else
+    {
+        std::optional<StreamReaderOptions> streamOptions;
+        if (cliOptions.streamInput || cliOptions.videoPath == "-")
+            streamOptions = cliOptions.streamOptions;
+        decoder = new DecoderVulkan(cliOptions.videoPath, engine, streamOptions);
+        if (!decoder || !decoder->valid)
+            throw std::runtime_error("DecoderVulkan invalid: " + decoder->getHardwareInitFailureReason());
+        decoder->setMasterClock(&engine->clock);
+        if (cliOptions.frameCacheBytes)
+            decoder->setFrameCacheBudget(*cliOptions.frameCacheBytes);
+        if (cliOptions.playbackRate != 1.0)
+        {
+            engine->setPlaybackRate(cliOptions.playbackRate);
+            decoder->setPlaybackRate(cliOptions.playbackRate);
+            // Backwards starts from the end
+            if (cliOptions.playbackRate < 0.0)
+            {
+                const float end = static_cast<float>(decoder->getDurationSeconds());
+                engine->seek(end);
+                decoder->seek(end);
+            }
+        }
+
+        // Start async decoding (producer). Decoder should internally cap (e.g. 10 frames).
+        decoder->startAsyncDecoding(/*ignored or fixed internally*/);
 
-    // Start async decoding (producer). Decoder should internally cap (e.g. 10 frames).
-    decoder->startAsyncDecoding(/*ignored or fixed internally*/);
+        // Scrubber filmstrip from a second decoder of the same file, so playback is never
+        // seeked for it; pipes and growing files have nothing to seek in
+        if (cliOptions.scrubberEnabled && cliOptions.scrubberThumbnails && !streamOptions)
+        {
+            ThumbnailStripOptions thumbnailOptions;
+            thumbnailOptions.cacheDirectory = cliOptions.thumbnailCacheDir;
+            thumbnails = new ThumbnailStrip(engine, cliOptions.videoPath, thumbnailOptions);
+        }
+    }
 
     // Create windows
     if (options.showInput)
@@ -211,6 +268,27 @@ Motive2D::Motive2D(CliOptions cliOptions)
         windows.emplace_back(gradingWindow);
         std::cout << "[Motive2D] Created grading window\n";
         colorGrading = new ColorGrading(engine, static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT));
+        colorGrading->adjustments = &gradingAdjustments;
+        if (!options.gradingLut.empty())
+        {
+            gradingAdjustments.lutInterpolation =
+                options.lutTetrahedral ? LutInterpolation::Tetrahedral : LutInterpolation::Trilinear;
+            if (!colorGrading->loadLut(options.gradingLut))
+            {
+                std::cerr << "[Motive2D] Failed to load LUT " << options.gradingLut << "\n";
+            }
+        }
+        if (options.gradingScopes)
+        {
+            try
+            {
+                gradingScopes = new GradingScopes(engine, static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT));
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << "[Motive2D] Scopes disabled: " << e.what() << "\n";
+            }
+        }
     }
 
     if (options.pipelineTest)
@@ -219,18 +297,57 @@ Motive2D::Motive2D(CliOptions cliOptions)
     // Create per-frame sync (cmd/fence/semaphore)
     createSynchronizationObjects();
 
-    // Create pass-owned NV12->RGBA pipeline/output
+    // Create the pass-owned YUV->RGBA pipeline/output matching the decoder's surface layout
+    if (mosaic)
+    {
+        std::cout << "[Motive2D] Mosaic: " << mosaic->streamCount() << " streams, "
+                  << mosaic->extent().width << "x" << mosaic->extent().height << " "
+                  << (precision == IntermediatePrecision::Float16 ? "RGBA16F" : "RGBA8") << "\n";
+        if (colorGrading)
+            colorGrading->resize(mosaic->extent(), intermediateFormat(precision));
+    }
+    else
     {
         const int w = decoder->getWidth();
         const int h = decoder->getHeight();
 
-        // If your decode images are STORAGE_IMAGE readable, keep STORAGE_IMAGE.
-        // Otherwise, switch this pass/shader to sampled inputs.
-        nv12Pass = new Nv12ToRgbaPass(engine,
-                                      static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT),
-                                      w, h,
-                                      VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
-        nv12Pass->initialize();
+        // 10-bit and deeper sources keep their precision through conversion and grading;
+        // an RGBA8 grading output is dithered instead.
+        precision = options.intermediatePrecision.value_or(
+            decoder->getBitDepth() > 8 ? IntermediatePrecision::Float16 : IntermediatePrecision::Unorm8);
+        std::cout << "[Motive2D] Intermediate precision: "
+                  << (precision == IntermediatePrecision::Float16 ? "RGBA16F" : "RGBA8")
+                  << " (source " << decoder->getBitDepth() << "-bit)\n";
+
+        // Decoded planes are sampled in place; 2-plane surfaces (any subsampling) go through
+        // the NV12 converter, 3-plane surfaces through the planar one.
+        if (decoder->getYuvLayout() == YuvLayout::NV12)
+        {
+            nv12Pass = new Nv12ToRgbaPass(engine,
+                                          static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT),
+                                          w, h,
+                                          VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                                          intermediateFormat(precision));
+            nv12Pass->configureKernel(options.nv12Kernel);
+            nv12Pass->initialize();
+        }
+        else
+        {
+            planarPass = new Yuv420pToRgbaPass(engine,
+                                               static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT),
+                                               w, h,
+                                               VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                                               intermediateFormat(precision));
+            planarPass->initialize();
+        }
+        std::cout << "[Motive2D] Converter: " << (nv12Pass ? "2-plane" : "3-plane")
+                  << " chroma shift " << decoder->getChromaShiftX() << "," << decoder->getChromaShiftY() << "\n";
+
+        if (colorGrading)
+        {
+            colorGrading->resize(VkExtent2D{static_cast<uint32_t>(w), static_cast<uint32_t>(h)},
+                                 intermediateFormat(precision));
+        }
     }
 }
 
@@ -238,18 +355,29 @@ Motive2D::~Motive2D()
 {
     destroySynchronizationObjects();
 
+    // Its worker submits to the engine's queue and converts on the engine's device
+    delete thumbnails;
+    thumbnails = nullptr;
+
+    delete gradingScopes;
+    gradingScopes = nullptr;
+
     delete colorGrading;
     colorGrading = nullptr;
 
     delete nv12Pass;
     nv12Pass = nullptr;
 
+    delete planarPass;
+    planarPass = nullptr;
+
     //delete subtitle;
     delete rectOverlay;
     delete poseOverlay;
     delete crop;
     delete scrubber;
     //delete fpsOverlay;
+    delete mosaic;
     delete decoder;
     delete engine;
 }
@@ -309,6 +437,27 @@ void Motive2D::destroySynchronizationObjects()
     frames.clear();
 }
 
+PresentInput Motive2D::convertedOutput(uint32_t frameIndex) const
+{
+    if (mosaic)
+        return mosaic->output(frameIndex);
+    return nv12Pass ? nv12Pass->output(frameIndex) : planarPass->output(frameIndex);
+}
+
+VkSampler Motive2D::convertedSampler() const
+{
+    if (mosaic)
+        return mosaic->outputSampler();
+    return nv12Pass ? nv12Pass->outputSampler() : planarPass->outputSampler();
+}
+
+double Motive2D::conversionGpuMilliseconds() const
+{
+    if (mosaic)
+        return mosaic->conversionGpuMilliseconds() + mosaic->mosaicGpuMilliseconds();
+    return nv12Pass ? nv12Pass->lastGpuMilliseconds() : planarPass->lastGpuMilliseconds();
+}
+
 void Motive2D::recordComputeCommands(VkCommandBuffer cmd, int frameIndex, const VulkanSurface& surf)
 {
     VkCommandBufferBeginInfo beginInfo{};
@@ -321,74 +470,117 @@ void Motive2D::recordComputeCommands(VkCommandBuffer cmd, int frameIndex, const
     const uint32_t gfxQF = engine->graphicsQueueFamilyIndex;
 
     // ---- Transition decode images to SHADER_READ_ONLY_OPTIMAL for sampled image reads (and queue-family transfer if needed) ----
-    if (surf.valid && surf.planes >= 1 && surf.images[0] != VK_NULL_HANDLE)
-        makeReadableForSamplingCompute(cmd, surf.images[0], surf.layouts[0], surf.queueFamily[0], gfxQF);
-
-    if (surf.valid && surf.planes >= 2 && surf.images[1] != VK_NULL_HANDLE)
-        makeReadableForSamplingCompute(cmd, surf.images[1], surf.layouts[1], surf.queueFamily[1], gfxQF);
+    for (uint32_t plane = 0; surf.valid && plane < surf.planes; ++plane)
+    {
+        if (surf.images[plane] != VK_NULL_HANDLE)
+            makeReadableForSamplingCompute(cmd, surf.images[plane], surf.layouts[plane], surf.queueFamily[plane], gfxQF);
+    }
 
-    // ---- NV12 -> RGBA (pass-owned output) ----
+    // ---- YUV -> RGBA (pass-owned output) ----
+    if (mosaic)
+    {
+        // Acquires / releases every stream's planes itself and leaves the mosaic in SHADER_READ
+        mosaic->record(cmd, static_cast<uint32_t>(frameIndex));
+    }
+    else
     {
         // Set inputs only if the view handles changed (avoid churn).
         static VkImageView lastY = VK_NULL_HANDLE;
-        static VkImageView lastUV = VK_NULL_HANDLE;
+        static VkImageView lastCb = VK_NULL_HANDLE;
+        static VkImageView lastCr = VK_NULL_HANDLE;
 
         VkImageView yView  = decoder->externalLumaView;
-        VkImageView uvView = decoder->externalChromaView;
-
-        if (yView != lastY || uvView != lastUV)
+        VkImageView cbView = decoder->externalChromaView;
+        VkImageView crView = decoder->externalChromaCrView;
+        VkSampler sampler  = decoder->sampler;
+        const bool inputsChanged = yView != lastY || cbView != lastCb || crView != lastCr;
+        lastY = yView;
+        lastCb = cbView;
+        lastCr = crView;
+
+        const glm::ivec2 rgbaSize(decoder->getWidth(), decoder->getHeight());
+        const glm::ivec2 uvSize(decoder->getChromaWidth(), decoder->getChromaHeight());
+        const glm::ivec2 chromaShift(static_cast<int>(decoder->getChromaShiftX()),
+                                     static_cast<int>(decoder->getChromaShiftY()));
+
+        // Stream metadata picks the specialised pipeline; the passes cache one per combination.
+        YuvConversion conversion{};
+        conversion.colorSpace = static_cast<uint32_t>(decoder->getColorSpace());
+        conversion.colorRange = static_cast<uint32_t>(decoder->getColorRange());
+        conversion.bitDepth = static_cast<uint32_t>(decoder->getBitDepth());
+        conversion.sampleShift = decoder->getSampleShift();
+        conversion.swapUV = nv12Pass && decoder->getSwapChromaUV();
+
+        if (nv12Pass)
         {
-            lastY = yView;
-            lastUV = uvView;
-            nv12Pass->setInputNV12(yView, uvView);
+            if (inputsChanged)
+                nv12Pass->setInputNV12(yView, cbView, sampler, sampler);
+
+            nv12Pass->pushConstants.rgbaSize = rgbaSize;
+            nv12Pass->pushConstants.uvSize = uvSize;
+            nv12Pass->pushConstants.chromaShift = chromaShift;
+            nv12Pass->pushConstants.srcSize = rgbaSize;
+            nv12Pass->conversion = conversion;
+
+            nv12Pass->dispatch(cmd, static_cast<uint32_t>(frameIndex));
         }
+        else
+        {
+            if (inputsChanged)
+                planarPass->setInputYUV420P(yView, cbView, crView, sampler, sampler, sampler);
 
-        nv12Pass->pushConstants.rgbaSize = glm::ivec2(decoder->getWidth(), decoder->getHeight());
-        nv12Pass->pushConstants.uvSize   = glm::ivec2(decoder->getWidth() / 2, decoder->getHeight() / 2);
-        nv12Pass->pushConstants.colorSpace = 0;
-        nv12Pass->pushConstants.colorRange = 1;
+            planarPass->pushConstants.rgbaSize = rgbaSize;
+            planarPass->pushConstants.uvSize = uvSize;
+            planarPass->pushConstants.chromaShift = chromaShift;
+            planarPass->pushConstants.srcSize = rgbaSize;
+            planarPass->conversion = conversion;
 
-        nv12Pass->dispatch(cmd, static_cast<uint32_t>(frameIndex));
+            planarPass->dispatch(cmd, static_cast<uint32_t>(frameIndex));
+        }
     }
 
-    // ---- Make NV12->RGBA output readable for sampling (ColorGrading + common presenters) ----
-    // Nv12ToRgbaPass leaves output in GENERAL; convert to SHADER_READ for downstream sampling.
-    makeReadableForSampling(cmd,
-                            nv12Pass->outputImage(static_cast<uint32_t>(frameIndex)),
-                            VK_IMAGE_LAYOUT_GENERAL);
+    // ---- Make the converted output readable for sampling (ColorGrading + common presenters) ----
+    // Both converters leave their output in GENERAL; convert to SHADER_READ for downstream sampling.
+    if (!mosaic)
+    {
+        makeReadableForSampling(cmd,
+                                convertedOutput(static_cast<uint32_t>(frameIndex)).image,
+                                VK_IMAGE_LAYOUT_GENERAL);
+    }
 
     // ---- Optional: Color grading (RGBA sampled in -> storage out) ----
     if (colorGrading)
     {
-        colorGrading->setInputRGBA(nv12Pass->outputView(static_cast<uint32_t>(frameIndex)),
-                                   nv12Pass->outputSampler());
+        colorGrading->setInputRGBA(convertedOutput(static_cast<uint32_t>(frameIndex)).view,
+                                   convertedSampler());
 
         // ColorGrading internally transitions its own output to GENERAL for writes.
         colorGrading->dispatch(cmd, static_cast<uint32_t>(frameIndex));
+
+        // Scopes read the graded frame and draw their panel into it for the grading window.
+        if (gradingScopes)
+        {
+            gradingScopes->record(cmd,
+                                  static_cast<uint32_t>(frameIndex),
+                                  colorGrading->output(static_cast<uint32_t>(frameIndex)));
+        }
     }
 
+    // ---- Scrubber hover thumbnail (input window), over the converted frame ----
+    recordScrubberHover(cmd, frameIndex);
+
     // ---- Transition decode images back to original layout (best-effort) ----
-    if (surf.valid && surf.planes >= 1 && surf.images[0] != VK_NULL_HANDLE)
-    {
-        imageBarrier(cmd,
-                     surf.images[0],
-                     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                     surf.layouts[0],
-                     gfxQF,
-                     surf.queueFamily[0],
-                     VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-                     VK_ACCESS_SHADER_READ_BIT,
-                     VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-                     VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT);
-    }
-    if (surf.valid && surf.planes >= 2 && surf.images[1] != VK_NULL_HANDLE)
+    for (uint32_t plane = 0; surf.valid && plane < surf.planes; ++plane)
     {
+        if (surf.images[plane] == VK_NULL_HANDLE)
+            continue;
+
         imageBarrier(cmd,
-                     surf.images[1],
+                     surf.images[plane],
                      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                     surf.layouts[1],
+                     surf.layouts[plane],
                      gfxQF,
-                     surf.queueFamily[1],
+                     surf.queueFamily[plane],
                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
                      VK_ACCESS_SHADER_READ_BIT,
                      VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
@@ -399,9 +591,108 @@ void Motive2D::recordComputeCommands(VkCommandBuffer cmd, int frameIndex, const
         throw std::runtime_error("Failed to end command buffer");
 }
 
+void Motive2D::recordScrubberHover(VkCommandBuffer cmd, int frameIndex)
+{
+    if (!thumbnails || !inputWindow || mosaic)
+        return;
+
+    GLFWwindow* window = inputWindow->window();
+    int windowWidth = 0;
+    int windowHeight = 0;
+    double cursorX = 0.0;
+    double cursorY = 0.0;
+    glfwGetWindowSize(window, &windowWidth, &windowHeight);
+    glfwGetCursorPos(window, &cursorX, &cursorY);
+
+    ScrubberHover hover;
+    if (windowWidth <= 0 || windowHeight <= 0 ||
+        !scrubberHoverThumbnail(*thumbnails, cursorX, cursorY, windowWidth, windowHeight, hover))
+        return;
+
+    // The input window shows the converted frame stretched over it: window pixels -> frame pixels
+    const PresentInput out = convertedOutput(static_cast<uint32_t>(frameIndex));
+    const double sx = static_cast<double>(out.extent.width) / windowWidth;
+    const double sy = static_cast<double>(out.extent.height) / windowHeight;
+    VkRect2D dst{};
+    dst.offset.x = static_cast<int32_t>(hover.rect.offset.x * sx);
+    dst.offset.y = static_cast<int32_t>(hover.rect.offset.y * sy);
+    dst.extent.width = std::min(std::max(1u, static_cast<uint32_t>(hover.rect.extent.width * sx)),
+                                out.extent.width - static_cast<uint32_t>(dst.offset.x));
+    dst.extent.height = std::min(std::max(1u, static_cast<uint32_t>(hover.rect.extent.height * sy)),
+                                 out.extent.height - static_cast<uint32_t>(dst.offset.y));
+
+    // Grading has sampled the frame already, so only the windows presenting it see the tile
+    imageBarrier(cmd,
+                 out.image,
+                 VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                 VK_QUEUE_FAMILY_IGNORED,
+                 VK_QUEUE_FAMILY_IGNORED,
+                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                 VK_ACCESS_SHADER_READ_BIT,
+                 VK_PIPELINE_STAGE_TRANSFER_BIT,
+                 VK_ACCESS_TRANSFER_WRITE_BIT);
+    thumbnails->recordBlit(cmd, hover.tile, out.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, dst);
+    imageBarrier(cmd,
+                 out.image,
+                 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                 VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                 VK_QUEUE_FAMILY_IGNORED,
+                 VK_QUEUE_FAMILY_IGNORED,
+                 VK_PIPELINE_STAGE_TRANSFER_BIT,
+                 VK_ACCESS_TRANSFER_WRITE_BIT,
+                 VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                 VK_ACCESS_MEMORY_READ_BIT);
+}
+
+void Motive2D::handlePlaybackKeys()
+{
+    bool pausePressed = false;
+    bool stepBackPressed = false;
+    bool stepForwardPressed = false;
+    for (auto& w : windows)
+    {
+        GLFWwindow* window = w->window();
+        pausePressed = pausePressed || glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS;
+        stepBackPressed = stepBackPressed || glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS;
+        stepForwardPressed = stepForwardPressed || glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS;
+    }
+
+    const bool togglePause = pausePressed && !pauseKeyDown;
+    int step = 0;
+    if (stepBackPressed && !stepBackKeyDown)
+        step = -1;
+    else if (stepForwardPressed && !stepForwardKeyDown)
+        step = 1;
+    pauseKeyDown = pausePressed;
+    stepBackKeyDown = stepBackPressed;
+    stepForwardKeyDown = stepForwardPressed;
+
+    if (togglePause)
+    {
+        if (engine->isPlaying())
+            engine->pause();
+        else
+            engine->play();
+    }
+
+    // Streams of a mosaic can run at different rates, so there is no common frame to step by
+    if (step == 0 || !decoder)
+        return;
+    if (engine->isPlaying())
+        engine->pause();
+    if (decoder->stepFrames(step))
+    {
+        // The decoder follows a master clock it does not move; keep the paused clock on the
+        // stepped frame so playing resumes from there
+        engine->seek(static_cast<float>(decoder->displayedSeconds()));
+    }
+}
+
 void Motive2D::run()
 {
     int iteration = 0;
+    uint64_t submittedFrames = 0;
     while (!windows.empty())
     {
         FrameResources& fr = frames[currentFrame];
@@ -410,14 +701,29 @@ void Motive2D::run()
         vkWaitForFences(engine->logicalDevice, 1, &fr.fence, VK_TRUE, UINT64_MAX);
 
         // Tick decoder: latch a frame + external views + current surface
-        decoder->advancePlayback();
+        // (mosaic: every stream against the shared clock)
+        bool frameReady = false;
+        if (mosaic)
+        {
+            frameReady = mosaic->advance();
+        }
+        else
+        {
+            // The engine clock starts with the first decoded frame, so open latency is not skipped
+            if (!engine->clock.started() && decoder->hasQueuedFrame())
+                engine->clock.start();
+            decoder->advancePlayback();
+            frameReady = decoder->externalLumaView != VK_NULL_HANDLE && decoder->externalChromaView != VK_NULL_HANDLE &&
+                         (!planarPass || decoder->externalChromaCrView != VK_NULL_HANDLE);
+        }
 
-        if (decoder->externalLumaView == VK_NULL_HANDLE || decoder->externalChromaView == VK_NULL_HANDLE)
+        if (!frameReady)
         {
             if (iteration % 100 == 0) {
                 std::cout << "[Motive2D] Waiting for decoder frames... (iteration " << iteration << ")\n";
             }
             glfwPollEvents();
+            handlePlaybackKeys();
             std::this_thread::sleep_for(std::chrono::milliseconds(1));
             iteration++;
             continue;
@@ -427,28 +733,28 @@ void Motive2D::run()
         vkResetFences(engine->logicalDevice, 1, &fr.fence);
 
         VulkanSurface surf{};
-        if (!decoder->getCurrentSurface(surf) || !surf.valid)
+        if (decoder && (!decoder->getCurrentSurface(surf) || !surf.valid))
         {
             throw std::runtime_error(
                 "Decoder has views but no current VulkanSurface metadata (need getCurrentSurface())");
         }
 
-        // Record compute (decode barriers + nv12->rgba + optional grading)
+        // Record compute (decode barriers + yuv->rgba + optional grading)
         recordComputeCommands(fr.commandBuffer, currentFrame, surf);
 
         // Decide what each window presents this frame.
-        // Input/Region show NV12->RGBA output (pre-grading).
+        // Input/Region show the YUV->RGBA output (pre-grading).
         // Grading window shows ColorGrading output if enabled, else same as input.
         if (inputWindow)
         {
-            PresentInput in = nv12Pass->output(static_cast<uint32_t>(currentFrame));
+            PresentInput in = convertedOutput(static_cast<uint32_t>(currentFrame));
             in.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL; // we transitioned it
             inputWindow->setPresentInput(in);
         }
 
         if (regionWindow)
         {
-            PresentInput in = nv12Pass->output(static_cast<uint32_t>(currentFrame));
+            PresentInput in = convertedOutput(static_cast<uint32_t>(currentFrame));
             in.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL; // we transitioned it
             regionWindow->setPresentInput(in);
         }
@@ -470,7 +776,7 @@ void Motive2D::run()
             }
             else
             {
-                PresentInput in = nv12Pass->output(static_cast<uint32_t>(currentFrame));
+                PresentInput in = convertedOutput(static_cast<uint32_t>(currentFrame));
                 in.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
                 gradingWindow->setPresentInput(in);
             }
@@ -484,8 +790,53 @@ void Motive2D::run()
         submitInfo.signalSemaphoreCount = 1;
         submitInfo.pSignalSemaphores = &fr.computeCompleteSemaphore;
 
-        if (vkQueueSubmit(engine->graphicsQueue, 1, &submitInfo, fr.fence) != VK_SUCCESS)
-            throw std::runtime_error("Failed to submit compute queue");
+        {
+            // FFmpeg and the thumbnail worker submit to this queue too
+            std::lock_guard<std::mutex> queueLock(vulkanQueueMutex(engine->graphicsQueueFamilyIndex));
+            if (vkQueueSubmit(engine->graphicsQueue, 1, &submitInfo, fr.fence) != VK_SUCCESS)
+                throw std::runtime_error("Failed to submit compute queue");
+        }
+
+        // Per-pass GPU time and intermediate traffic, to compare --precision=8 against 16f
+        if (renderDebugEnabled() && ++submittedFrames % 120 == 0)
+        {
+            const VkExtent2D extent = convertedOutput(static_cast<uint32_t>(currentFrame)).extent;
+            const double pixels = static_cast<double>(extent.width) * extent.height;
+            const double bytesPerPixel = intermediateBytesPerPixel(precision);
+            // YUV->RGBA writes the intermediate; grading reads it and writes its own
+            const double passes = colorGrading ? 3.0 : 1.0;
+            std::cout << "[Motive2D] precision=" << (precision == IntermediatePrecision::Float16 ? "rgba16f" : "rgba8")
+                      << (mosaic ? " mosaic=" : nv12Pass ? " nv12->rgba=" : " planar->rgba=")
+                      << conversionGpuMilliseconds() << "ms";
+            if (colorGrading)
+                std::cout << " grading=" << colorGrading->lastGpuMilliseconds() << "ms";
+            if (gradingScopes)
+                std::cout << " scopes=" << gradingScopes->lastGpuMilliseconds() << "ms";
+            std::cout << " intermediate traffic=" << pixels * bytesPerPixel * passes / (1024.0 * 1024.0)
+                      << "MiB/frame" << std::endl;
+            if (mosaic)
+            {
+                const MosaicStats st = mosaic->stats();
+                std::cout << "[Motive2D] mosaic clock=" << st.seconds << "s decoded=" << st.framesDecoded
+                          << " presented=" << st.framesPresented << " dropped=" << st.framesDropped
+                          << " drift mean=" << st.meanAbsDriftMs << "ms max=" << st.maxAbsDriftMs
+                          << "ms spread max=" << st.maxSpreadMs << "ms" << std::endl;
+            }
+            else
+            {
+                // Decode work per displayed frame: ~1 at 1x, and what skip_frame saves above it
+                const DecoderVulkan::SyncStats sync = decoder->getSyncStats();
+                std::cout << "[Motive2D] speed=" << decoder->getPlaybackRate() << "x skip="
+                          << frameSkipName(decoder->getFrameSkip()) << " decoded=" << decoder->getFramesDecoded()
+                          << " presented=" << sync.presented << " decoded/presented="
+                          << (sync.presented ? static_cast<double>(decoder->getFramesDecoded()) / sync.presented : 0.0)
+                          << " dropped=" << sync.dropped << std::endl;
+                const FrameCache::Stats cache = decoder->getFrameCacheStats();
+                std::cout << "[Motive2D] frame cache " << cache.frames << " frames "
+                          << cache.bytes / (1024.0 * 1024.0) << "MiB hits=" << cache.hits << " misses=" << cache.misses
+                          << " evictions=" << cache.evictions << std::endl;
+            }
+        }
 
         // Render all windows (each will acquire swapchain image + record presenter work)
         for (auto& w : windows)
@@ -493,6 +844,7 @@ void Motive2D::run()
 
 
         glfwPollEvents();
+        handlePlaybackKeys();
 
         bool anyOpen = false;
         for (auto& w : windows)
@@ -16,6 +16,7 @@
 #include "decoder_vulkan.h"
 #include "engine2d.h"
 #include "fps.h"
+#include "grading_scopes.h"
 #include "nv12_to_rgba.h"
 #include "pose_overlay.h"
 #include "rect_overlay.h"
@@ -60,6 +61,38 @@ struct CliOptions
     std::filesystem::path pipelineTestDir = "intermittant";
 
     bool gpuDecode = true;
+
+    // 3D LUT (.cube) applied by the grading pass after the primary corrections
+    std::filesystem::path gradingLut;
+    bool lutTetrahedral = false;
+    // RGBA intermediate precision; unset picks Float16 for sources deeper than 8 bits
+    std::optional<IntermediatePrecision> intermediatePrecision;
+
+    // Histogram / waveform / vectorscope panel over the grading window
+    bool gradingScopes = true;
+
+    // 2-plane conversion kernel (per-pixel or 2x2 quads) and the quad workgroup shape
+    Nv12KernelConfig nv12Kernel;
+
+    // Multi-camera review: two or more streams replace videoPath with a mosaic of all of them
+    std::vector<std::filesystem::path> mosaicPaths;
+    VkExtent2D mosaicExtent{1920, 1080};
+
+    // Playback speed, 0.25..16 either way; negative plays backwards from the end
+    double playbackRate = 1.0;
+
+    // Decoded-frame cache budget (mosaic: split between the streams); unset keeps
+    // FrameCache::kDefaultBudgetBytes
+    std::optional<size_t> frameCacheBytes;
+
+    // Scrubber hover thumbnails, generated in the background from keyframes and kept in a disk
+    // cache (empty thumbnailCacheDir: thumbnailCacheDirectory())
+    bool scrubberThumbnails = true;
+    std::filesystem::path thumbnailCacheDir;
+
+    // Read input through StreamReader (pipes, stdin "-", files still being written).
+    bool streamInput = false;
+    StreamReaderOptions streamOptions;
 };
 
 // Frame synchronization resources (one per in-flight slot).
@@ -104,9 +137,15 @@ public:
     // NV12->RGBA pass now owns its RGBA output per frame-in-flight.
     // (This type should exist in your codebase per the updated motive2d.cpp.)
     class Nv12ToRgbaPass* nv12Pass = nullptr;
+    // 3-plane sources (YuvLayout::Planar420/422/444) convert here instead; exactly one of the
+    // two passes exists, picked from the decoder's surface layout.
+    class Yuv420pToRgbaPass* planarPass = nullptr;
+    IntermediatePrecision precision = IntermediatePrecision::Unorm8;
 
     // RGBA->RGBA grading pass owns its output per frame-in-flight.
     ColorGrading* colorGrading = nullptr;
+    ColorAdjustments gradingAdjustments;
+    GradingScopes* gradingScopes = nullptr;
 
     // UI / overlays
     ColorGradingUi* colorGradingUi = nullptr;
@@ -116,9 +155,13 @@ public:
     Crop* crop = nullptr;
     Scrubber* scrubber = nullptr;
     FpsOverlay* fpsOverlay = nullptr;
+    // Filmstrip for the scrubber (single file input only)
+    class ThumbnailStrip* thumbnails = nullptr;
 
-    // Decode
+    // Decode (single stream), or decoders + per-stream conversion + composition (mosaic mode;
+    // decoder, nv12Pass and planarPass are then null)
     DecoderVulkan* decoder = nullptr;
+    class MultiStreamMosaic* mosaic = nullptr;
 
     CliOptions options;
 
@@ -131,6 +174,24 @@ private:
     void destroySynchronizationObjects();
 
     void recordComputeCommands(VkCommandBuffer commandBuffer, int frameIndex, const VulkanSurface& surf);
+    // Blits the thumbnail under a cursor hovering the input window's scrubber into the converted
+    // output, after grading has read it
+    void recordScrubberHover(VkCommandBuffer commandBuffer, int frameIndex);
+
+    // Space pauses / resumes the shared clock; Left / Right step one frame back / forward,
+    // pausing first (single stream only). Keys act once per press, in any window.
+    void handlePlaybackKeys();
+
+    // Output of whichever YUV->RGBA pass (or the mosaic) is active
+    PresentInput convertedOutput(uint32_t frameIndex) const;
+    VkSampler convertedSampler() const;
+    double conversionGpuMilliseconds() const;
+
+private:
+    // Key states at the previous poll, so a held key acts once
+    bool pauseKeyDown = false;
+    bool stepBackKeyDown = false;
+    bool stepForwardKeyDown = false;
 };
 
 static inline float intersection_area(const PoseObject& a, const PoseObject& b)
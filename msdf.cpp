@@ -0,0 +1,434 @@
+// msdf.cpp
+//
+// Multi-channel SDF generation for FreeType outlines, following the msdfgen approach:
+//   - decompose the outline into contours of line/conic/cubic edges
+//   - colour edges so every sharp corner sits between two edges that differ in two channels
+//   - per channel, take the nearest edge of that colour and store its signed pseudo-distance
+//     (distance to the edge's tangent line beyond its ends), so median(r,g,b) keeps corners
+//
+// Curves are flattened into short line segments before the distance pass; pseudo-distance is
+// only applied at the ends of the source edge, so the flattening joins stay smooth.
+// There is no clash-correction pass: alpha carries the true distance, and the shader uses
+// it away from the edge where channel clashes would otherwise show up.
+
+#include "msdf.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_OUTLINE_H
+
+namespace
+{
+struct Vec2
+{
+    float x = 0, y = 0;
+};
+
+Vec2 operator+(Vec2 a, Vec2 b) { return {a.x + b.x, a.y + b.y}; }
+Vec2 operator-(Vec2 a, Vec2 b) { return {a.x - b.x, a.y - b.y}; }
+Vec2 operator*(Vec2 a, float s) { return {a.x * s, a.y * s}; }
+float dot(Vec2 a, Vec2 b) { return a.x * b.x + a.y * b.y; }
+float cross(Vec2 a, Vec2 b) { return a.x * b.y - a.y * b.x; }
+float length(Vec2 a) { return std::sqrt(dot(a, a)); }
+Vec2 normalize(Vec2 a)
+{
+    const float len = length(a);
+    return len > 0.0f ? a * (1.0f / len) : Vec2{0, 0};
+}
+bool same(Vec2 a, Vec2 b) { return a.x == b.x && a.y == b.y; }
+
+// One source edge; degree 1 = line, 2 = conic (quadratic), 3 = cubic.
+struct Edge
+{
+    int degree = 1;
+    Vec2 p[4];
+
+    Vec2 point(float t) const
+    {
+        const float s = 1.0f - t;
+        if (degree == 1)
+            return p[0] * s + p[1] * t;
+        if (degree == 2)
+            return p[0] * (s * s) + p[1] * (2 * s * t) + p[2] * (t * t);
+        return p[0] * (s * s * s) + p[1] * (3 * s * s * t) + p[2] * (3 * s * t * t) + p[3] * (t * t * t);
+    }
+    Vec2 startDir() const
+    {
+        for (int i = 1; i <= degree; ++i)
+            if (!same(p[i], p[0]))
+                return p[i] - p[0];
+        return {0, 0};
+    }
+    Vec2 endDir() const
+    {
+        for (int i = degree - 1; i >= 0; --i)
+            if (!same(p[i], p[degree]))
+                return p[degree] - p[i];
+        return {0, 0};
+    }
+    bool degenerate() const
+    {
+        for (int i = 1; i <= degree; ++i)
+            if (!same(p[i], p[0]))
+                return false;
+        return true;
+    }
+    void reverse() { std::reverse(p, p + degree + 1); }
+};
+
+struct Contour
+{
+    std::vector<Edge> edges;
+};
+
+struct DecomposeState
+{
+    std::vector<Contour> contours;
+    Vec2 pen;
+    Vec2 start;
+};
+
+Vec2 toVec(const FT_Vector* v) { return {float(v->x) / 64.0f, float(v->y) / 64.0f}; }
+
+void closeContour(DecomposeState& s)
+{
+    if (!s.contours.empty() && !s.contours.back().edges.empty() && !same(s.pen, s.start))
+    {
+        Edge e;
+        e.p[0] = s.pen;
+        e.p[1] = s.start;
+        s.contours.back().edges.push_back(e);
+    }
+}
+
+int moveTo(const FT_Vector* to, void* user)
+{
+    auto& s = *static_cast<DecomposeState*>(user);
+    closeContour(s);
+    s.contours.emplace_back();
+    s.pen = s.start = toVec(to);
+    return 0;
+}
+
+int lineTo(const FT_Vector* to, void* user)
+{
+    auto& s = *static_cast<DecomposeState*>(user);
+    const Vec2 p = toVec(to);
+    if (!same(p, s.pen))
+    {
+        Edge e;
+        e.p[0] = s.pen;
+        e.p[1] = p;
+        s.contours.back().edges.push_back(e);
+    }
+    s.pen = p;
+    return 0;
+}
+
+int conicTo(const FT_Vector* control, const FT_Vector* to, void* user)
+{
+    auto& s = *static_cast<DecomposeState*>(user);
+    Edge e;
+    e.degree = 2;
+    e.p[0] = s.pen;
+    e.p[1] = toVec(control);
+    e.p[2] = toVec(to);
+    s.contours.back().edges.push_back(e);
+    s.pen = e.p[2];
+    return 0;
+}
+
+int cubicTo(const FT_Vector* control1, const FT_Vector* control2, const FT_Vector* to, void* user)
+{
+    auto& s = *static_cast<DecomposeState*>(user);
+    Edge e;
+    e.degree = 3;
+    e.p[0] = s.pen;
+    e.p[1] = toVec(control1);
+    e.p[2] = toVec(control2);
+    e.p[3] = toVec(to);
+    s.contours.back().edges.push_back(e);
+    s.pen = e.p[3];
+    return 0;
+}
+
+// Sharp corner between two unit-ish directions (msdfgen's angle threshold of 3 rad).
+bool isCorner(Vec2 a, Vec2 b)
+{
+    const float crossThreshold = std::sin(3.0f);
+    a = normalize(a);
+    b = normalize(b);
+    return dot(a, b) <= 0.0f || std::fabs(cross(a, b)) > crossThreshold;
+}
+
+// Cycles cyan -> magenta -> yellow, never landing on `banned`.
+uint8_t switchColor(uint8_t color, uint8_t banned = 0)
+{
+    const uint8_t combined = color & banned;
+    if (combined == MsdfShape::Red || combined == MsdfShape::Green || combined == MsdfShape::Blue)
+        return combined ^ MsdfShape::White;
+    return uint8_t(((color << 1) | (color >> 2)) & MsdfShape::White);
+}
+
+// Maps position k of n onto {-1, 0, 1} in roughly equal thirds.
+int symmetricalTrichotomy(size_t k, size_t n)
+{
+    if (n <= 1)
+        return 0;
+    return int(3.0 + 2.875 * double(k) / double(n - 1) - 1.4375 + 0.5) - 3;
+}
+
+uint32_t flattenCount(const Edge& e)
+{
+    if (e.degree == 1)
+        return 1;
+    float polyLen = 0.0f;
+    for (int i = 0; i < e.degree; ++i)
+        polyLen += length(e.p[i + 1] - e.p[i]);
+    // ~3 px per segment keeps the chord error well under a texel for glyph-sized curves
+    return std::clamp<uint32_t>(uint32_t(std::ceil(polyLen / 3.0f)), 2u, 16u);
+}
+
+void appendContour(const Contour& contour, MsdfShape& shape)
+{
+    const size_t m = contour.edges.size();
+    if (m == 0)
+        return;
+
+    std::vector<size_t> corners;
+    Vec2 prevDir = contour.edges.back().endDir();
+    for (size_t i = 0; i < m; ++i)
+    {
+        if (isCorner(prevDir, contour.edges[i].startDir()))
+            corners.push_back(i);
+        prevDir = contour.edges[i].endDir();
+    }
+
+    std::vector<uint8_t> edgeColor(m, MsdfShape::White);
+    const bool teardrop = corners.size() == 1;
+    if (corners.size() > 1)
+    {
+        uint8_t color = switchColor(MsdfShape::Yellow);
+        const uint8_t initial = color;
+        size_t spline = 0;
+        const size_t start = corners[0];
+        for (size_t i = 0; i < m; ++i)
+        {
+            const size_t index = (start + i) % m;
+            if (spline + 1 < corners.size() && corners[spline + 1] == index)
+            {
+                ++spline;
+                color = switchColor(color, spline == corners.size() - 1 ? initial : 0);
+            }
+            edgeColor[index] = color;
+        }
+    }
+
+    const size_t firstSegment = shape.segments.size();
+    for (size_t i = 0; i < m; ++i)
+    {
+        // Teardrops start at their single corner so the thirds split lands around it.
+        const size_t index = teardrop ? (corners[0] + i) % m : i;
+        const Edge& e = contour.edges[index];
+        const uint32_t n = flattenCount(e);
+        const size_t edgeFirst = shape.segments.size();
+        Vec2 a = e.p[0];
+        for (uint32_t k = 1; k <= n; ++k)
+        {
+            const Vec2 b = (k == n) ? e.p[e.degree] : e.point(float(k) / float(n));
+            if (same(a, b))
+                continue;
+            MsdfShape::Segment s;
+            s.ax = a.x;
+            s.ay = a.y;
+            s.bx = b.x;
+            s.by = b.y;
+            s.color = edgeColor[index];
+            shape.segments.push_back(s);
+            a = b;
+        }
+        if (shape.segments.size() > edgeFirst)
+        {
+            shape.segments[edgeFirst].flags |= MsdfShape::EdgeStart;
+            shape.segments.back().flags |= MsdfShape::EdgeEnd;
+        }
+    }
+
+    if (teardrop)
+    {
+        // One corner: split the contour into thirds around it so the corner still gets
+        // two channels crossing (the edges themselves may be too few to colour).
+        const uint8_t colors[3] = {MsdfShape::Magenta, MsdfShape::White, MsdfShape::Yellow};
+        const size_t n = shape.segments.size() - firstSegment;
+        for (size_t k = 0; k < n; ++k)
+            shape.segments[firstSegment + k].color = colors[1 + symmetricalTrichotomy(k, n)];
+    }
+}
+} // namespace
+
+bool msdfShapeFromOutline(const FT_Outline_* outline, MsdfShape& shape)
+{
+    shape = MsdfShape{};
+    if (!outline || outline->n_contours <= 0)
+        return false;
+
+    DecomposeState state;
+    FT_Outline_Funcs funcs{};
+    funcs.move_to = moveTo;
+    funcs.line_to = lineTo;
+    funcs.conic_to = conicTo;
+    funcs.cubic_to = cubicTo;
+    if (FT_Outline_Decompose(const_cast<FT_Outline*>(outline), &funcs, &state) != 0)
+        return false;
+    closeContour(state);
+
+    // Distances below assume fill on the left; TrueType contours run clockwise.
+    const bool reverse = FT_Outline_Get_Orientation(const_cast<FT_Outline*>(outline)) == FT_ORIENTATION_TRUETYPE;
+
+    for (auto& contour : state.contours)
+    {
+        contour.edges.erase(std::remove_if(contour.edges.begin(), contour.edges.end(),
+                                           [](const Edge& e) { return e.degenerate(); }),
+                            contour.edges.end());
+        if (reverse)
+        {
+            std::reverse(contour.edges.begin(), contour.edges.end());
+            for (auto& e : contour.edges)
+                e.reverse();
+        }
+        appendContour(contour, shape);
+    }
+
+    if (shape.segments.empty())
+        return false;
+
+    shape.minX = shape.maxX = shape.segments[0].ax;
+    shape.minY = shape.maxY = shape.segments[0].ay;
+    for (const auto& s : shape.segments)
+    {
+        shape.minX = std::min({shape.minX, s.ax, s.bx});
+        shape.maxX = std::max({shape.maxX, s.ax, s.bx});
+        shape.minY = std::min({shape.minY, s.ay, s.by});
+        shape.maxY = std::max({shape.maxY, s.ay, s.by});
+    }
+    return true;
+}
+
+void generateMsdf(const MsdfShape& shape,
+                  uint32_t width,
+                  uint32_t height,
+                  float left,
+                  float top,
+                  float pxRange,
+                  uint8_t* rgba)
+{
+    struct Nearest
+    {
+        float dist = std::numeric_limits<float>::max(); // unsigned
+        float ortho = 1.0f;                              // tie-break: prefer perpendicular approach
+        float signedDist = 0.0f;
+        float t = 0.0f;
+        int segment = -1;
+    };
+
+    auto encode = [&](float d) {
+        const float v = std::clamp(d / pxRange + 0.5f, 0.0f, 1.0f);
+        return uint8_t(std::lround(v * 255.0f));
+    };
+
+    // Per-segment terms hoisted out of the texel loop.
+    struct Prepared
+    {
+        Vec2 a, ab, dir;
+        float invLen2 = 0.0f;
+    };
+    const auto& segs = shape.segments;
+    std::vector<Prepared> prep(segs.size());
+    for (size_t i = 0; i < segs.size(); ++i)
+    {
+        const auto& s = segs[i];
+        prep[i].a = Vec2{s.ax, s.ay};
+        prep[i].ab = Vec2{s.bx - s.ax, s.by - s.ay};
+        prep[i].dir = normalize(prep[i].ab);
+        prep[i].invLen2 = 1.0f / dot(prep[i].ab, prep[i].ab);
+    }
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            const Vec2 p{left + float(x) + 0.5f, top - float(y) - 0.5f};
+            Nearest channel[3];
+            Nearest any;
+
+            for (int si = 0; si < int(segs.size()); ++si)
+            {
+                const uint8_t color = segs[size_t(si)].color;
+                const Prepared& sp = prep[size_t(si)];
+                const Vec2& ab = sp.ab;
+                const Vec2 ap = p - sp.a;
+                const float t = dot(ap, ab) * sp.invLen2;
+                const Vec2 dv = ap - ab * std::clamp(t, 0.0f, 1.0f);
+                const float d2 = dot(dv, dv);
+
+                // Cheap reject on squared distance before the sqrt and tie-break terms.
+                float worst = any.dist;
+                for (int c = 0; c < 3; ++c)
+                    if (color & (1u << c))
+                        worst = std::max(worst, channel[c].dist);
+                if (d2 > (worst + 1e-5f) * (worst + 1e-5f))
+                    continue;
+
+                const float d = std::sqrt(d2);
+                const float ortho = (t > 0.0f && t < 1.0f) || d == 0.0f ? 0.0f : std::fabs(dot(sp.dir, dv)) / d;
+
+                auto consider = [&](Nearest& n) {
+                    if (d < n.dist - 1e-5f || (d <= n.dist + 1e-5f && ortho < n.ortho))
+                    {
+                        n.dist = d;
+                        n.ortho = ortho;
+                        n.signedDist = cross(ab, ap) >= 0.0f ? d : -d;
+                        n.t = t;
+                        n.segment = si;
+                    }
+                };
+                consider(any);
+                for (int c = 0; c < 3; ++c)
+                    if (color & (1u << c))
+                        consider(channel[c]);
+            }
+
+            uint8_t* out = rgba + (size_t(y) * width + x) * 4;
+            for (int c = 0; c < 3; ++c)
+            {
+                const Nearest& n = channel[c];
+                float sd = n.segment >= 0 ? n.signedDist : -pxRange;
+                if (n.segment >= 0)
+                {
+                    // Beyond the ends of the source edge, use the distance to its tangent line.
+                    const auto& s = segs[size_t(n.segment)];
+                    const Vec2 a = prep[size_t(n.segment)].a;
+                    const Vec2 b{s.bx, s.by};
+                    const Vec2& dir = prep[size_t(n.segment)].dir;
+                    if ((s.flags & MsdfShape::EdgeStart) && n.t < 0.0f && dot(p - a, dir) < 0.0f)
+                    {
+                        const float perp = cross(dir, p - a);
+                        if (std::fabs(perp) <= std::fabs(sd))
+                            sd = perp;
+                    }
+                    else if ((s.flags & MsdfShape::EdgeEnd) && n.t > 1.0f && dot(p - b, dir) > 0.0f)
+                    {
+                        const float perp = cross(dir, p - b);
+                        if (std::fabs(perp) <= std::fabs(sd))
+                            sd = perp;
+                    }
+                }
+                out[c] = encode(sd);
+            }
+            out[3] = encode(any.segment >= 0 ? any.signedDist : -pxRange);
+        }
+    }
+}
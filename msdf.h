@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+struct FT_Outline_; // FT_Outline, from FreeType
+
+// Multi-channel signed distance fields for glyph outlines.
+//
+// A shape is the glyph outline flattened into line segments (y up, pixels), with every
+// source edge assigned a channel mask so that corners keep a sharp crossing of two
+// channels. Fill is always on the left of a segment; TrueType outlines are reversed
+// on load.
+struct MsdfShape
+{
+    enum : uint8_t
+    {
+        Red = 1,
+        Green = 2,
+        Blue = 4,
+        Cyan = Green | Blue,
+        Magenta = Red | Blue,
+        Yellow = Red | Green,
+        White = Red | Green | Blue,
+    };
+    enum : uint8_t
+    {
+        EdgeStart = 1, // first segment of a source edge: pseudo-distance before param 0
+        EdgeEnd = 2,   // last segment of a source edge: pseudo-distance after param 1
+    };
+
+    struct Segment
+    {
+        float ax = 0, ay = 0;
+        float bx = 0, by = 0;
+        uint8_t color = White;
+        uint8_t flags = 0;
+    };
+
+    std::vector<Segment> segments;
+    float minX = 0, minY = 0, maxX = 0, maxY = 0; // bounds of the outline
+    bool empty() const { return segments.empty(); }
+};
+
+// Builds a coloured shape from an outline in 26.6 pixels (FT_LOAD_NO_BITMAP at the bake size).
+bool msdfShapeFromOutline(const FT_Outline_* outline, MsdfShape& shape);
+
+// Writes width*height RGBA8 texels, top row first. Texel (x, y) samples the shape at
+// (left + x + 0.5, top - y - 0.5). RGB hold the per-channel pseudo-distances (median
+// reconstructs the edge), A the true signed distance. Distances map to
+// d / pxRange + 0.5, positive inside, so the band is +-pxRange/2 texels.
+void generateMsdf(const MsdfShape& shape,
+                  uint32_t width,
+                  uint32_t height,
+                  float left,
+                  float top,
+                  float pxRange,
+                  uint8_t* rgba);
@@ -0,0 +1,412 @@
+// multi_stream_mosaic.cpp
+// N zero-copy decoders (shared pool + clock) -> per-stream YUV->RGBA at tile size -> MosaicPass.
+
+#include "multi_stream_mosaic.h"
+
+#include "debug_logging.h"
+#include "engine2d.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+namespace
+{
+void imageBarrier(VkCommandBuffer cmd,
+                  VkImage image,
+                  VkImageLayout oldLayout,
+                  VkImageLayout newLayout,
+                  uint32_t srcQF,
+                  uint32_t dstQF,
+                  VkPipelineStageFlags srcStage,
+                  VkAccessFlags srcAccess,
+                  VkPipelineStageFlags dstStage,
+                  VkAccessFlags dstAccess)
+{
+    if (image == VK_NULL_HANDLE)
+        return;
+
+    VkImageMemoryBarrier b{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+    b.srcAccessMask = srcAccess;
+    b.dstAccessMask = dstAccess;
+    b.oldLayout = oldLayout;
+    b.newLayout = newLayout;
+    b.srcQueueFamilyIndex = srcQF == dstQF ? VK_QUEUE_FAMILY_IGNORED : srcQF;
+    b.dstQueueFamilyIndex = srcQF == dstQF ? VK_QUEUE_FAMILY_IGNORED : dstQF;
+    b.image = image;
+    b.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    b.subresourceRange.levelCount = 1;
+    b.subresourceRange.layerCount = 1;
+
+    vkCmdPipelineBarrier(cmd, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &b);
+}
+} // namespace
+
+MultiStreamMosaic::MultiStreamMosaic(Engine2D* eng,
+                                     uint32_t framesInFlight,
+                                     const std::vector<std::filesystem::path>& paths,
+                                     VkExtent2D extent,
+                                     IntermediatePrecision precision,
+                                     uint32_t decodeThreads,
+                                     MediaClock* clock)
+    : engine(eng), framesInFlight_(framesInFlight), pool_(decodeThreads), clock_(clock ? clock : &ownClock_)
+{
+    if (!engine || engine->logicalDevice == VK_NULL_HANDLE)
+        throw std::runtime_error("MultiStreamMosaic requires a valid Engine2D");
+
+    if (paths.empty())
+        throw std::runtime_error("MultiStreamMosaic: no streams");
+
+    mosaic_ = std::make_unique<MosaicPass>(engine,
+                                           framesInFlight_,
+                                           static_cast<uint32_t>(paths.size()),
+                                           extent,
+                                           intermediateFormat(precision));
+
+    streams_.reserve(paths.size());
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        Stream stream;
+        stream.decoder = std::make_unique<DecoderVulkan>(paths[i], engine);
+        if (!stream.decoder->valid)
+        {
+            throw std::runtime_error("MultiStreamMosaic: failed to open " + paths[i].string() + ": " +
+                                     stream.decoder->getHardwareInitFailureReason());
+        }
+        stream.decoder->setMasterClock(clock_);
+        // One default budget for the whole mosaic, not one per stream
+        stream.decoder->setFrameCacheBudget(FrameCache::kDefaultBudgetBytes / paths.size());
+
+        // The converter writes the tile directly: downscaling happens while converting, so no
+        // full-resolution RGBA copy of any stream exists
+        const DecoderVulkan& decoder = *stream.decoder;
+        stream.tile = mosaicFitTile(mosaic_->cell(static_cast<uint32_t>(i)),
+                                    static_cast<uint32_t>(decoder.getWidth()),
+                                    static_cast<uint32_t>(decoder.getHeight()));
+        const int tileW = static_cast<int>(stream.tile.extent.width);
+        const int tileH = static_cast<int>(stream.tile.extent.height);
+        if (decoder.getYuvLayout() == YuvLayout::NV12)
+        {
+            stream.nv12Pass = std::make_unique<Nv12ToRgbaPass>(engine,
+                                                               framesInFlight_,
+                                                               tileW, tileH,
+                                                               VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                                                               intermediateFormat(precision));
+            stream.nv12Pass->initialize();
+        }
+        else
+        {
+            stream.planarPass = std::make_unique<Yuv420pToRgbaPass>(engine,
+                                                                    framesInFlight_,
+                                                                    tileW, tileH,
+                                                                    VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                                                                    intermediateFormat(precision));
+            stream.planarPass->initialize();
+        }
+
+        std::cout << "[MultiStreamMosaic] stream " << i << ": " << paths[i].filename().string()
+                  << " " << decoder.getWidth() << "x" << decoder.getHeight()
+                  << " -> tile " << tileW << "x" << tileH
+                  << " at " << stream.tile.offset.x << "," << stream.tile.offset.y << "\n";
+
+        pool_.add(stream.decoder.get());
+        streams_.push_back(std::move(stream));
+    }
+
+    pool_.start();
+    std::cout << "[MultiStreamMosaic] " << streams_.size() << " streams on " << pool_.threadCount()
+              << " decode thread(s), mosaic " << extent.width << "x" << extent.height << "\n";
+}
+
+MultiStreamMosaic::~MultiStreamMosaic()
+{
+    // Workers call into the decoders, so they go first
+    pool_.stop();
+    if (engine && engine->logicalDevice != VK_NULL_HANDLE)
+        vkDeviceWaitIdle(engine->logicalDevice);
+    streams_.clear();
+    mosaic_.reset();
+}
+
+bool MultiStreamMosaic::advance()
+{
+    if (!clock_->started())
+    {
+        // Hold every stream at its first frame until all of them have one, so a slow opener
+        // does not start behind the others
+        const bool allQueued = std::all_of(streams_.begin(), streams_.end(), [](const Stream& s) {
+            return s.decoder->hasQueuedFrame();
+        });
+        if (!allQueued)
+            return false;
+        clock_->start();
+    }
+
+    double minShown = 0.0;
+    double maxShown = 0.0;
+    bool allShown = true;
+    for (size_t i = 0; i < streams_.size(); ++i)
+    {
+        Stream& s = streams_[i];
+        const uint64_t presentedBefore = s.decoder->getSyncStats().presented;
+        const double shown = s.decoder->advancePlayback();
+        if (s.decoder->getSyncStats().presented != presentedBefore)
+            s.shown = true;
+
+        allShown = allShown && s.shown;
+        minShown = i == 0 ? shown : std::min(minShown, shown);
+        maxShown = i == 0 ? shown : std::max(maxShown, shown);
+    }
+
+    // Latching freed queue space; idle workers can decode again
+    pool_.notify();
+
+    // Every stream has its first frame from the seek target up; the clock may run again
+    if (resumeAfterSeek_ && std::none_of(streams_.begin(), streams_.end(), [](const Stream& s) {
+            return s.decoder->awaitingFrame();
+        }))
+    {
+        clock_->resume();
+        resumeAfterSeek_ = false;
+    }
+
+    if (allShown)
+        maxSpreadMs_ = std::max(maxSpreadMs_, (maxShown - minShown) * 1000.0);
+    return allShown;
+}
+
+void MultiStreamMosaic::seek(double seconds)
+{
+    resumeAfterSeek_ = resumeAfterSeek_ || (clock_->started() && !clock_->paused());
+    if (clock_->started())
+        clock_->pause();
+    clock_->seek(std::max(0.0, seconds));
+
+    // Each decoder latches its first frame from the target regardless of the (paused) clock
+    for (Stream& s : streams_)
+    {
+        s.decoder->seek(static_cast<float>(seconds));
+        s.shown = false;
+    }
+    pool_.notify();
+}
+
+void MultiStreamMosaic::setPlaybackRate(double rate)
+{
+    // Streams validate the range first, so a bad rate leaves the clock alone
+    for (Stream& s : streams_)
+        s.decoder->setPlaybackRate(rate);
+    clock_->setRate(rate);
+    pool_.notify();
+}
+
+void MultiStreamMosaic::record(VkCommandBuffer cmd, uint32_t frameIndex)
+{
+    if (cmd == VK_NULL_HANDLE)
+        return;
+
+    const uint32_t fi = frameIndex % framesInFlight_;
+    const uint32_t gfxQF = engine->graphicsQueueFamilyIndex;
+
+    // ---- Acquire every stream's decoded planes for sampling (queue-family transfer if needed) ----
+    for (Stream& s : streams_)
+    {
+        s.surface = VulkanSurface{};
+        if (!s.decoder->getCurrentSurface(s.surface) || !s.surface.valid)
+            continue;
+
+        for (uint32_t plane = 0; plane < s.surface.planes; ++plane)
+        {
+            imageBarrier(cmd,
+                         s.surface.images[plane],
+                         s.surface.layouts[plane],
+                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                         s.surface.queueFamily[plane],
+                         gfxQF,
+                         VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                         VK_ACCESS_MEMORY_WRITE_BIT | VK_ACCESS_MEMORY_READ_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_ACCESS_SHADER_READ_BIT);
+        }
+    }
+
+    // ---- YUV -> RGBA per stream, downscaled to its tile ----
+    for (uint32_t i = 0; i < streams_.size(); ++i)
+    {
+        Stream& s = streams_[i];
+        DecoderVulkan& decoder = *s.decoder;
+        if (!s.surface.valid)
+        {
+            mosaic_->setTile(fi, i, VK_NULL_HANDLE, s.tile);
+            continue;
+        }
+
+        VkImageView yView = decoder.externalLumaView;
+        VkImageView cbView = decoder.externalChromaView;
+        VkImageView crView = decoder.externalChromaCrView;
+        const bool inputsChanged = yView != s.lastY || cbView != s.lastCb || crView != s.lastCr;
+        s.lastY = yView;
+        s.lastCb = cbView;
+        s.lastCr = crView;
+
+        const glm::ivec2 tileSize(static_cast<int>(s.tile.extent.width), static_cast<int>(s.tile.extent.height));
+        const glm::ivec2 srcSize(decoder.getWidth(), decoder.getHeight());
+        const glm::ivec2 uvSize(decoder.getChromaWidth(), decoder.getChromaHeight());
+        const glm::ivec2 chromaShift(static_cast<int>(decoder.getChromaShiftX()),
+                                     static_cast<int>(decoder.getChromaShiftY()));
+
+        YuvConversion conversion{};
+        conversion.colorSpace = static_cast<uint32_t>(decoder.getColorSpace());
+        conversion.colorRange = static_cast<uint32_t>(decoder.getColorRange());
+        conversion.bitDepth = static_cast<uint32_t>(decoder.getBitDepth());
+        conversion.sampleShift = decoder.getSampleShift();
+        conversion.swapUV = s.nv12Pass && decoder.getSwapChromaUV();
+
+        if (s.nv12Pass)
+        {
+            if (inputsChanged)
+                s.nv12Pass->setInputNV12(yView, cbView, decoder.sampler, decoder.sampler);
+
+            s.nv12Pass->pushConstants.rgbaSize = tileSize;
+            s.nv12Pass->pushConstants.uvSize = uvSize;
+            s.nv12Pass->pushConstants.chromaShift = chromaShift;
+            s.nv12Pass->pushConstants.srcSize = srcSize;
+            s.nv12Pass->conversion = conversion;
+            s.nv12Pass->dispatch(cmd, fi);
+        }
+        else
+        {
+            if (inputsChanged)
+                s.planarPass->setInputYUV420P(yView, cbView, crView, decoder.sampler, decoder.sampler, decoder.sampler);
+
+            s.planarPass->pushConstants.rgbaSize = tileSize;
+            s.planarPass->pushConstants.uvSize = uvSize;
+            s.planarPass->pushConstants.chromaShift = chromaShift;
+            s.planarPass->pushConstants.srcSize = srcSize;
+            s.planarPass->conversion = conversion;
+            s.planarPass->dispatch(cmd, fi);
+        }
+
+        mosaic_->setTile(fi, i, tileView_(s, fi), s.tile);
+
+        // The converters leave their output in GENERAL; the mosaic samples it
+        imageBarrier(cmd,
+                     tileImage_(s, fi),
+                     VK_IMAGE_LAYOUT_GENERAL,
+                     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                     VK_QUEUE_FAMILY_IGNORED,
+                     VK_QUEUE_FAMILY_IGNORED,
+                     VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                     VK_ACCESS_SHADER_WRITE_BIT,
+                     VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                     VK_ACCESS_SHADER_READ_BIT);
+    }
+
+    // ---- Compose ----
+    mosaic_->record(cmd, fi);
+
+    // ---- Tiles back to GENERAL (where the converters track them), planes back to the decoder ----
+    for (Stream& s : streams_)
+    {
+        if (!s.surface.valid)
+            continue;
+
+        imageBarrier(cmd,
+                     tileImage_(s, fi),
+                     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                     VK_IMAGE_LAYOUT_GENERAL,
+                     VK_QUEUE_FAMILY_IGNORED,
+                     VK_QUEUE_FAMILY_IGNORED,
+                     VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                     VK_ACCESS_SHADER_READ_BIT,
+                     VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                     VK_ACCESS_SHADER_WRITE_BIT);
+
+        for (uint32_t plane = 0; plane < s.surface.planes; ++plane)
+        {
+            imageBarrier(cmd,
+                         s.surface.images[plane],
+                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                         s.surface.layouts[plane],
+                         gfxQF,
+                         s.surface.queueFamily[plane],
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_ACCESS_SHADER_READ_BIT,
+                         VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                         VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT);
+        }
+    }
+
+    if (renderDebugEnabled())
+    {
+        std::cout << "[MultiStreamMosaic] record fi=" << fi
+                  << " clock=" << clock_->seconds() << "s"
+                  << " convert=" << conversionGpuMilliseconds() << "ms"
+                  << " mosaic=" << mosaicGpuMilliseconds() << "ms"
+                  << std::endl;
+    }
+}
+
+double MultiStreamMosaic::conversionGpuMilliseconds() const
+{
+    double total = 0.0;
+    for (const Stream& s : streams_)
+        total += s.nv12Pass ? s.nv12Pass->lastGpuMilliseconds() : s.planarPass->lastGpuMilliseconds();
+    return total;
+}
+
+void MultiStreamMosaic::setFrameCacheBudget(size_t bytes)
+{
+    for (Stream& s : streams_)
+        s.decoder->setFrameCacheBudget(bytes / streams_.size());
+}
+
+double MultiStreamMosaic::durationSeconds() const
+{
+    double shortest = 0.0;
+    for (size_t i = 0; i < streams_.size(); ++i)
+    {
+        const double d = streams_[i].decoder->getDurationSeconds();
+        shortest = i == 0 ? d : std::min(shortest, d);
+    }
+    return shortest;
+}
+
+bool MultiStreamMosaic::finished() const
+{
+    if (!pool_.allFinished())
+        return false;
+    return std::none_of(streams_.begin(), streams_.end(), [](const Stream& s) {
+        return s.decoder->hasQueuedFrame();
+    });
+}
+
+MosaicStats MultiStreamMosaic::stats() const
+{
+    MosaicStats st{};
+    st.streams = static_cast<uint32_t>(streams_.size());
+    st.seconds = clock_->seconds();
+    double driftWeighted = 0.0;
+    for (const Stream& s : streams_)
+    {
+        const DecoderVulkan::SyncStats sync = s.decoder->getSyncStats();
+        st.framesDecoded += s.decoder->getFramesDecoded();
+        st.framesPresented += sync.presented;
+        st.framesDropped += sync.dropped;
+        driftWeighted += sync.meanAbsDriftMs * static_cast<double>(sync.presented);
+        st.maxAbsDriftMs = std::max(st.maxAbsDriftMs, sync.maxAbsDriftMs);
+    }
+    st.meanAbsDriftMs = st.framesPresented > 0 ? driftWeighted / static_cast<double>(st.framesPresented) : 0.0;
+    st.maxSpreadMs = maxSpreadMs_;
+    return st;
+}
+
+VkImage MultiStreamMosaic::tileImage_(const Stream& stream, uint32_t frameIndex) const
+{
+    return stream.nv12Pass ? stream.nv12Pass->outputImage(frameIndex) : stream.planarPass->outputImage(frameIndex);
+}
+
+VkImageView MultiStreamMosaic::tileView_(const Stream& stream, uint32_t frameIndex) const
+{
+    return stream.nv12Pass ? stream.nv12Pass->outputView(frameIndex) : stream.planarPass->outputView(frameIndex);
+}
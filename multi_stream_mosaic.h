@@ -0,0 +1,127 @@
+// multi_stream_mosaic.h
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "decode_thread_pool.h"
+#include "decoder_vulkan.h"
+#include "media_clock.h"
+#include "mosaic_pass.h"
+#include "nv12_to_rgba.h"
+#include "yuv420p_to_rgba.h"
+
+class Engine2D;
+
+// Throughput and synchronisation of a MultiStreamMosaic since its clock started.
+struct MosaicStats
+{
+    uint32_t streams = 0;
+    double seconds = 0.0;         // master clock time
+    uint64_t framesDecoded = 0;   // all streams
+    uint64_t framesPresented = 0; // all streams
+    uint64_t framesDropped = 0;   // late frames skipped by the consumers
+    // |stream time - master clock| of each frame latched on schedule (frames forced up after a
+    // seek are not sampled); the clock is sampled on the render thread, so these include the
+    // latch loop's own jitter
+    double meanAbsDriftMs = 0.0;
+    double maxAbsDriftMs = 0.0;
+    // Largest difference between the streams' displayed times within one advance(); up to one
+    // frame interval of this is inherent when the streams' frame grids are not aligned
+    double maxSpreadMs = 0.0;
+};
+
+// Multi-camera review: N DecoderVulkan streams decoded on one DecodeThreadPool, presented
+// against one MediaClock (the caller's, typically Engine2D::clock, or an internal one), each
+// converted straight to its mosaic tile size (the converters
+// downscale while converting) and composed by a MosaicPass into a single RGBA image.
+class MultiStreamMosaic
+{
+public:
+    // Throws std::runtime_error if any stream fails to open. decodeThreads 0 lets the pool pick.
+    // A null clock uses an internal one; an external clock must outlive the mosaic.
+    MultiStreamMosaic(Engine2D* engine,
+                      uint32_t framesInFlight,
+                      const std::vector<std::filesystem::path>& paths,
+                      VkExtent2D extent,
+                      IntermediatePrecision precision = IntermediatePrecision::Unorm8,
+                      uint32_t decodeThreads = 0,
+                      MediaClock* clock = nullptr);
+    ~MultiStreamMosaic();
+
+    MultiStreamMosaic(const MultiStreamMosaic&) = delete;
+    MultiStreamMosaic& operator=(const MultiStreamMosaic&) = delete;
+
+    // Latches each stream's frame for the shared clock, starting the clock once every stream
+    // has a decoded frame. Returns true when every stream has a frame to show.
+    bool advance();
+
+    // Seeks the clock and every stream to presentation time `seconds`. The clock holds there
+    // until each stream has its first frame from the target up, then resumes if it was running.
+    void seek(double seconds);
+
+    // Sets the clock's rate and every stream's (see DecoderVulkan::setPlaybackRate).
+    void setPlaybackRate(double rate);
+
+    // Total decoded-frame cache budget, split evenly between the streams.
+    void setFrameCacheBudget(size_t bytes);
+
+    // Records plane acquire, the per-stream conversions and the mosaic into cmd. Does NOT
+    // begin/end the command buffer.
+    void record(VkCommandBuffer cmd, uint32_t frameIndex);
+
+    PresentInput output(uint32_t frameIndex) const { return mosaic_->output(frameIndex); }
+    VkSampler outputSampler() const { return mosaic_->outputSampler(); }
+    VkExtent2D extent() const { return mosaic_->extent(); }
+
+    // GPU time of the last completed conversions (summed over streams) and mosaic, in ms
+    double conversionGpuMilliseconds() const;
+    double mosaicGpuMilliseconds() const { return mosaic_->lastGpuMilliseconds(); }
+
+    // Shortest stream's duration
+    double durationSeconds() const;
+    uint32_t streamCount() const { return static_cast<uint32_t>(streams_.size()); }
+    uint32_t decodeThreadCount() const { return pool_.threadCount(); }
+    MediaClock& clock() { return *clock_; }
+
+    // Every stream is exhausted and has shown its last frame.
+    bool finished() const;
+    MosaicStats stats() const;
+
+private:
+    struct Stream
+    {
+        std::unique_ptr<DecoderVulkan> decoder;
+        std::unique_ptr<Nv12ToRgbaPass> nv12Pass;
+        std::unique_ptr<Yuv420pToRgbaPass> planarPass;
+        VkRect2D tile{};
+
+        VkImageView lastY = VK_NULL_HANDLE;
+        VkImageView lastCb = VK_NULL_HANDLE;
+        VkImageView lastCr = VK_NULL_HANDLE;
+
+        // Planes of the latched frame, snapshotted at record() for the release barriers
+        VulkanSurface surface{};
+        bool shown = false;
+    };
+
+    VkImage tileImage_(const Stream& stream, uint32_t frameIndex) const;
+    VkImageView tileView_(const Stream& stream, uint32_t frameIndex) const;
+
+private:
+    Engine2D* engine = nullptr;
+    uint32_t framesInFlight_ = 0;
+
+    std::vector<Stream> streams_;
+    DecodeThreadPool pool_;
+    MediaClock ownClock_;
+    MediaClock* clock_ = nullptr;
+    bool resumeAfterSeek_ = false;
+    std::unique_ptr<MosaicPass> mosaic_;
+
+    double maxSpreadMs_ = 0.0;
+};
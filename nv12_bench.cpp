@@ -0,0 +1,379 @@
+// nv12_bench.cpp
+//
+// A/B of the Nv12ToRgbaPass kernels at 1080p, 4K and 8K: the per-pixel kernel
+// (nv12_to_rgba.comp) against the 2x2-quad kernel (nv12_to_rgba_quad.comp) over a sweep of
+// workgroup shapes, plus the quad kernel with the packed RGBA8 readback buffer enabled. A
+// synthetic NV12 frame is uploaded once per size; every variant converts it repeatedly and the
+// median of the pass's own GPU timestamps is reported. Before timing, each quad variant's
+// output (image, and buffer where enabled) is compared against the per-pixel output, which
+// must agree to within 1 LSB. Run from the repository root so shaders/*.spv resolve.
+
+#include "engine2d.h"
+#include "nv12_to_rgba.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+constexpr int kWarmupIterations = 5;
+
+struct Size
+{
+    const char* name;
+    int width;
+    int height;
+};
+
+const Size kSizes[] = {
+    {"1920x1080", 1920, 1080},
+    {"3840x2160", 3840, 2160},
+    {"7680x4320", 7680, 4320},
+};
+
+struct Variant
+{
+    const char* name;
+    Nv12KernelConfig config;
+};
+
+std::vector<Variant> variants()
+{
+    std::vector<Variant> list;
+    list.push_back({"per-pixel 16x16", Nv12KernelConfig{}});
+    auto quad = [](uint32_t x, uint32_t y, bool buffer) {
+        Nv12KernelConfig c;
+        c.kernel = Nv12Kernel::Quad2x2;
+        c.workgroupX = x;
+        c.workgroupY = y;
+        c.bufferOutput = buffer;
+        return c;
+    };
+    list.push_back({"quad device default", quad(0, 0, false)});
+    list.push_back({"quad 8x8", quad(8, 8, false)});
+    list.push_back({"quad 16x4", quad(16, 4, false)});
+    list.push_back({"quad 32x2", quad(32, 2, false)});
+    list.push_back({"quad 16x16", quad(16, 16, false)});
+    list.push_back({"quad default + buffer", quad(0, 0, true)});
+    return list;
+}
+
+void imageBarrier(VkCommandBuffer cmd, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout,
+                  VkAccessFlags srcAccess, VkAccessFlags dstAccess, VkPipelineStageFlags srcStage,
+                  VkPipelineStageFlags dstStage)
+{
+    VkImageMemoryBarrier b{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+    b.oldLayout = oldLayout;
+    b.newLayout = newLayout;
+    b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    b.image = image;
+    b.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    b.subresourceRange.levelCount = 1;
+    b.subresourceRange.layerCount = 1;
+    b.srcAccessMask = srcAccess;
+    b.dstAccessMask = dstAccess;
+    vkCmdPipelineBarrier(cmd, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &b);
+}
+
+// Device-local plane image in SHADER_READ_ONLY_OPTIMAL, filled through a staging buffer
+struct Plane
+{
+    Engine2D* engine = nullptr;
+    VkImage image = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkImageView view = VK_NULL_HANDLE;
+
+    Plane(Engine2D* e, uint32_t width, uint32_t height, VkFormat format, const std::vector<uint8_t>& texels)
+        : engine(e)
+    {
+        VkDevice device = engine->logicalDevice;
+
+        VkImageCreateInfo ii{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+        ii.imageType = VK_IMAGE_TYPE_2D;
+        ii.format = format;
+        ii.extent = VkExtent3D{width, height, 1};
+        ii.mipLevels = 1;
+        ii.arrayLayers = 1;
+        ii.samples = VK_SAMPLE_COUNT_1_BIT;
+        ii.tiling = VK_IMAGE_TILING_OPTIMAL;
+        ii.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        ii.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        ii.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        if (vkCreateImage(device, &ii, nullptr, &image) != VK_SUCCESS)
+            throw std::runtime_error("nv12_bench: failed to create plane image");
+
+        VkMemoryRequirements mr{};
+        vkGetImageMemoryRequirements(device, image, &mr);
+        VkMemoryAllocateInfo ai{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+        ai.allocationSize = mr.size;
+        ai.memoryTypeIndex = engine->findMemoryType(mr.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        if (vkAllocateMemory(device, &ai, nullptr, &memory) != VK_SUCCESS)
+            throw std::runtime_error("nv12_bench: failed to allocate plane memory");
+        vkBindImageMemory(device, image, memory, 0);
+
+        VkImageViewCreateInfo vi{VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
+        vi.image = image;
+        vi.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        vi.format = format;
+        vi.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        vi.subresourceRange.levelCount = 1;
+        vi.subresourceRange.layerCount = 1;
+        if (vkCreateImageView(device, &vi, nullptr, &view) != VK_SUCCESS)
+            throw std::runtime_error("nv12_bench: failed to create plane view");
+
+        VkBuffer staging = VK_NULL_HANDLE;
+        VkDeviceMemory stagingMemory = VK_NULL_HANDLE;
+        engine->createBuffer(texels.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, staging,
+                             stagingMemory);
+        void* mapped = nullptr;
+        vkMapMemory(device, stagingMemory, 0, texels.size(), 0, &mapped);
+        std::memcpy(mapped, texels.data(), texels.size());
+        vkUnmapMemory(device, stagingMemory);
+
+        VkCommandBuffer cmd = engine->beginSingleTimeCommands();
+        imageBarrier(cmd, image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0,
+                     VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+        VkBufferImageCopy region{};
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = VkExtent3D{width, height, 1};
+        vkCmdCopyBufferToImage(cmd, staging, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+        imageBarrier(cmd, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                     VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                     VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+        engine->endSingleTimeCommands(cmd);
+
+        vkDestroyBuffer(device, staging, nullptr);
+        vkFreeMemory(device, stagingMemory, nullptr);
+    }
+
+    ~Plane()
+    {
+        VkDevice device = engine->logicalDevice;
+        vkDestroyImageView(device, view, nullptr);
+        vkDestroyImage(device, image, nullptr);
+        vkFreeMemory(device, memory, nullptr);
+    }
+
+    Plane(const Plane&) = delete;
+    Plane& operator=(const Plane&) = delete;
+};
+
+// Luma detail plus smooth chroma, like a graded camera frame rather than flat colour
+void makeFrame(int width, int height, std::vector<uint8_t>& y, std::vector<uint8_t>& uv)
+{
+    const int cw = width / 2;
+    const int ch = height / 2;
+    y.resize(static_cast<size_t>(width) * height);
+    uv.resize(static_cast<size_t>(cw) * ch * 2);
+    for (int row = 0; row < height; ++row)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            y[static_cast<size_t>(row) * width + x] = static_cast<uint8_t>(16 + (x * 219 / width + (x * 7 + row * 13) % 17) % 220);
+        }
+    }
+    for (int row = 0; row < ch; ++row)
+    {
+        for (int x = 0; x < cw; ++x)
+        {
+            uint8_t* p = &uv[(static_cast<size_t>(row) * cw + x) * 2];
+            p[0] = static_cast<uint8_t>(64 + x * 128 / cw);
+            p[1] = static_cast<uint8_t>(192 - row * 128 / ch);
+        }
+    }
+}
+
+// RGBA8 output image of the slot copied to host memory
+std::vector<uint8_t> readOutputImage(Engine2D* engine, Nv12ToRgbaPass& pass)
+{
+    const PresentInput out = pass.output(0);
+    const VkDeviceSize size = static_cast<VkDeviceSize>(out.extent.width) * out.extent.height * 4u;
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    engine->createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, buffer, memory);
+
+    VkCommandBuffer cmd = engine->beginSingleTimeCommands();
+    imageBarrier(cmd, out.image, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_SHADER_WRITE_BIT,
+                 VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    VkBufferImageCopy region{};
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent = VkExtent3D{out.extent.width, out.extent.height, 1};
+    vkCmdCopyImageToBuffer(cmd, out.image, VK_IMAGE_LAYOUT_GENERAL, buffer, 1, &region);
+    engine->endSingleTimeCommands(cmd);
+
+    std::vector<uint8_t> pixels(static_cast<size_t>(size));
+    void* mapped = nullptr;
+    vkMapMemory(engine->logicalDevice, memory, 0, size, 0, &mapped);
+    std::memcpy(pixels.data(), mapped, pixels.size());
+    vkUnmapMemory(engine->logicalDevice, memory);
+    vkDestroyBuffer(engine->logicalDevice, buffer, nullptr);
+    vkFreeMemory(engine->logicalDevice, memory, nullptr);
+    return pixels;
+}
+
+int maxDifference(const std::vector<uint8_t>& a, const uint8_t* b)
+{
+    int worst = 0;
+    for (size_t i = 0; i < a.size(); ++i)
+        worst = std::max(worst, std::abs(static_cast<int>(a[i]) - static_cast<int>(b[i])));
+    return worst;
+}
+
+struct Result
+{
+    double medianMs = 0.0;
+    int maxError = 0; // vs per-pixel, image and readback buffer
+};
+
+Result runVariant(Engine2D* engine, const Size& size, const Variant& variant, const Plane& yPlane,
+                  const Plane& uvPlane, VkSampler sampler, int iterations, const std::vector<uint8_t>* reference,
+                  std::vector<uint8_t>* referenceOut)
+{
+    Nv12ToRgbaPass pass(engine, 1, size.width, size.height);
+    pass.configureKernel(variant.config);
+    pass.initialize();
+    pass.setInputNV12(yPlane.view, uvPlane.view, sampler, sampler);
+    pass.pushConstants.rgbaSize = glm::ivec2(size.width, size.height);
+    pass.pushConstants.uvSize = glm::ivec2(size.width / 2, size.height / 2);
+    pass.pushConstants.chromaShift = glm::ivec2(1, 1);
+    pass.conversion.colorSpace = 1;
+
+    // One submit per dispatch; dispatch() reads the previous submit's timestamps
+    std::vector<double> samples;
+    for (int i = 0; i <= kWarmupIterations + iterations; ++i)
+    {
+        VkCommandBuffer cmd = engine->beginSingleTimeCommands();
+        pass.dispatch(cmd, 0);
+        engine->endSingleTimeCommands(cmd);
+        if (i > kWarmupIterations)
+            samples.push_back(pass.lastGpuMilliseconds());
+    }
+
+    Result result;
+    if (!samples.empty())
+    {
+        std::sort(samples.begin(), samples.end());
+        result.medianMs = samples[samples.size() / 2];
+    }
+
+    std::vector<uint8_t> pixels = readOutputImage(engine, pass);
+    if (reference)
+    {
+        result.maxError = maxDifference(*reference, pixels.data());
+        if (const uint8_t* mapped = pass.mappedOutput(0))
+            result.maxError = std::max(result.maxError, maxDifference(*reference, mapped));
+    }
+    if (referenceOut)
+        *referenceOut = std::move(pixels);
+    return result;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int iterations = 50;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h")
+        {
+            std::cout << "Usage: nv12_bench [--iterations=N]\n";
+            return 0;
+        }
+        if (arg.rfind("--iterations=", 0) == 0)
+        {
+            iterations = std::max(1, std::atoi(arg.substr(std::string("--iterations=").size()).c_str()));
+        }
+    }
+
+    Engine2D engine;
+    if (!engine.initialize(false))
+    {
+        std::cerr << "nv12_bench: failed to initialise Vulkan" << std::endl;
+        return 1;
+    }
+    if (!engine.getDeviceProperties().limits.timestampComputeAndGraphics)
+    {
+        std::cerr << "nv12_bench: device has no compute timestamps" << std::endl;
+        return 1;
+    }
+
+    VkSamplerCreateInfo si{VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
+    si.magFilter = VK_FILTER_NEAREST;
+    si.minFilter = VK_FILTER_NEAREST;
+    si.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    si.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    si.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    VkSampler sampler = VK_NULL_HANDLE;
+    if (vkCreateSampler(engine.logicalDevice, &si, nullptr, &sampler) != VK_SUCCESS)
+    {
+        std::cerr << "nv12_bench: failed to create sampler" << std::endl;
+        return 1;
+    }
+
+    std::cout << "NV12->RGBA8 kernels on " << engine.getDeviceProperties().deviceName << " (median of " << iterations
+              << " dispatches):\n";
+    std::cout << "   size        kernel                     ms     GPix/s   vs per-pixel   max err\n";
+    std::cout << std::fixed;
+
+    int failures = 0;
+    const std::vector<Variant> list = variants();
+    for (const Size& size : kSizes)
+    {
+        std::vector<uint8_t> yTexels, uvTexels;
+        makeFrame(size.width, size.height, yTexels, uvTexels);
+        const Plane yPlane(&engine, size.width, size.height, VK_FORMAT_R8_UNORM, yTexels);
+        const Plane uvPlane(&engine, size.width / 2, size.height / 2, VK_FORMAT_R8G8_UNORM, uvTexels);
+
+        std::vector<uint8_t> reference;
+        double baselineMs = 0.0;
+        for (const Variant& variant : list)
+        {
+            const bool baseline = variant.config.kernel == Nv12Kernel::PerPixel;
+            Result result;
+            try
+            {
+                result = runVariant(&engine, size, variant, yPlane, uvPlane, sampler, iterations,
+                                    baseline ? nullptr : &reference, baseline ? &reference : nullptr);
+            }
+            catch (const std::exception& e)
+            {
+                std::cout << "   " << std::left << std::setw(12) << size.name << std::setw(24) << variant.name
+                          << std::right << "   " << e.what() << "\n";
+                ++failures;
+                continue;
+            }
+            if (baseline)
+                baselineMs = result.medianMs;
+
+            const double gpix = result.medianMs > 0.0 ? size.width * static_cast<double>(size.height) / (result.medianMs * 1e6) : 0.0;
+            const bool pass = result.maxError <= 1;
+            failures += pass ? 0 : 1;
+            std::cout << "   " << std::left << std::setw(12) << size.name << std::setw(24) << variant.name << std::right
+                      << std::setprecision(3) << std::setw(8) << result.medianMs << std::setprecision(2) << std::setw(11)
+                      << gpix << std::setw(14) << (result.medianMs > 0.0 ? baselineMs / result.medianMs : 0.0) << "x"
+                      << std::setw(9) << result.maxError << (pass ? "" : "   FAIL") << "\n";
+        }
+    }
+
+    vkDestroySampler(engine.logicalDevice, sampler, nullptr);
+    if (failures)
+    {
+        std::cout << "FAILED: " << failures << " variant(s) differ from the per-pixel kernel or failed to run\n";
+        return 1;
+    }
+    return 0;
+}
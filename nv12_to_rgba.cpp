@@ -5,7 +5,9 @@
 #include "utils.h"
 #include "debug_logging.h"
 
+#include <algorithm>
 #include <array>
+#include <cstddef>
 #include <cstring>
 #include <iostream>
 #include <stdexcept>
@@ -47,18 +49,47 @@ static bool isSampledInputType(VkDescriptorType t)
 {
     return t == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 }
+
+static uint32_t deviceSubgroupSize(VkPhysicalDevice physicalDevice)
+{
+    VkPhysicalDeviceSubgroupProperties subgroup{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES};
+    VkPhysicalDeviceProperties2 props{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2};
+    props.pNext = &subgroup;
+    vkGetPhysicalDeviceProperties2(physicalDevice, &props);
+    return subgroup.subgroupSize;
+}
+
+// 64 quads per workgroup, the pixel count of the per-pixel kernel's 16x16. Wide subgroups
+// (32 on NVIDIA, 64 on AMD) get 16x4 so each subgroup covers whole 32-pixel rows of quads;
+// narrow ones (Intel, most mobile) 8x8, keeping a subgroup's footprint close to square.
+// Untimed starting points: nv12_bench sweeps the other shapes to check them per device.
+static void defaultQuadWorkgroup(uint32_t subgroupSize, uint32_t& x, uint32_t& y)
+{
+    if (subgroupSize >= 32)
+    {
+        x = 16;
+        y = 4;
+    }
+    else
+    {
+        x = 8;
+        y = 8;
+    }
+}
 } // namespace
 
 Nv12ToRgbaPass::Nv12ToRgbaPass(Engine2D* engine,
                                uint32_t framesInFlight,
                                int width,
                                int height,
-                               VkDescriptorType inputDescriptorType)
+                               VkDescriptorType inputDescriptorType,
+                               VkFormat outputFormat)
     : engine_(engine),
       framesInFlight_(framesInFlight),
       width_(width),
       height_(height),
-      inputDescriptorType_(inputDescriptorType)
+      inputDescriptorType_(inputDescriptorType),
+      outFormat_(outputFormat)
 {
     if (!engine_ || engine_->logicalDevice == VK_NULL_HANDLE)
         throw std::runtime_error("Nv12ToRgbaPass: invalid engine");
@@ -76,6 +107,10 @@ Nv12ToRgbaPass::Nv12ToRgbaPass(Engine2D* engine,
     // That requires COMBINED_IMAGE_SAMPLER descriptors.
     if (!isSampledInputType(inputDescriptorType_))
         throw std::runtime_error("Nv12ToRgbaPass: shader uses sampler2D, so inputDescriptorType must be VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER");
+
+    // The shader's output has no format qualifier; either intermediate format works.
+    if (outFormat_ != VK_FORMAT_R8G8B8A8_UNORM && outFormat_ != VK_FORMAT_R16G16B16A16_SFLOAT)
+        throw std::runtime_error("Nv12ToRgbaPass: output format must be R8G8B8A8_UNORM or R16G16B16A16_SFLOAT");
 }
 
 Nv12ToRgbaPass::~Nv12ToRgbaPass()
@@ -88,9 +123,49 @@ Nv12ToRgbaPass::~Nv12ToRgbaPass()
     destroyDescriptors_();
     destroyOutputs_();
     destroyOutputSampler_();
+    if (timestampPool_ != VK_NULL_HANDLE)
+    {
+        vkDestroyQueryPool(engine_->logicalDevice, timestampPool_, nullptr);
+        timestampPool_ = VK_NULL_HANDLE;
+    }
     destroyPipeline_();
 }
 
+void Nv12ToRgbaPass::configureKernel(const Nv12KernelConfig& config)
+{
+    if (initialized_)
+        throw std::runtime_error("Nv12ToRgbaPass: configureKernel must be called before initialize");
+
+    kernelConfig_ = config;
+    if (kernelConfig_.kernel != Nv12Kernel::Quad2x2)
+    {
+        kernelConfig_ = Nv12KernelConfig{};
+        return;
+    }
+
+    uint32_t subgroupSize = 0;
+    if (kernelConfig_.workgroupX == 0 || kernelConfig_.workgroupY == 0)
+    {
+        uint32_t x = 0, y = 0;
+        subgroupSize = deviceSubgroupSize(engine_->physicalDevice);
+        defaultQuadWorkgroup(subgroupSize, x, y);
+        if (kernelConfig_.workgroupX == 0)
+            kernelConfig_.workgroupX = x;
+        if (kernelConfig_.workgroupY == 0)
+            kernelConfig_.workgroupY = y;
+    }
+
+    const VkPhysicalDeviceLimits& limits = engine_->getDeviceProperties().limits;
+    kernelConfig_.workgroupX = std::min(kernelConfig_.workgroupX, limits.maxComputeWorkGroupSize[0]);
+    kernelConfig_.workgroupY = std::min(kernelConfig_.workgroupY, limits.maxComputeWorkGroupSize[1]);
+    if (kernelConfig_.workgroupX * kernelConfig_.workgroupY > limits.maxComputeWorkGroupInvocations)
+        throw std::runtime_error("Nv12ToRgbaPass: quad workgroup exceeds maxComputeWorkGroupInvocations");
+
+    if (renderDebugEnabled())
+        std::cout << "[Nv12ToRgbaPass] quad kernel workgroup=" << kernelConfig_.workgroupX << "x" << kernelConfig_.workgroupY
+                  << " subgroupSize=" << subgroupSize << " bufferOutput=" << kernelConfig_.bufferOutput << std::endl;
+}
+
 void Nv12ToRgbaPass::initialize()
 {
     if (initialized_) return;
@@ -99,12 +174,15 @@ void Nv12ToRgbaPass::initialize()
     createOutputs_();
     createDescriptors_();
     createOutputSampler_();
+    createTimestampQueries_();
 
     initialized_ = true;
 
     if (renderDebugEnabled())
         std::cout << "[Nv12ToRgbaPass] initialized framesInFlight=" << framesInFlight_
-                  << " size=" << width_ << "x" << height_ << std::endl;
+                  << " size=" << width_ << "x" << height_
+                  << " format=" << (outFormat_ == VK_FORMAT_R16G16B16A16_SFLOAT ? "rgba16f" : "rgba8")
+                  << " kernel=" << (kernelConfig_.kernel == Nv12Kernel::Quad2x2 ? "quad2x2" : "per-pixel") << std::endl;
 }
 
 void Nv12ToRgbaPass::resize(int width, int height)
@@ -152,7 +230,7 @@ void Nv12ToRgbaPass::dispatch(VkCommandBuffer cmd, uint32_t frameIndex)
     if (!initialized_ || cmd == VK_NULL_HANDLE)
         return;
 
-    if (pipeline_ == VK_NULL_HANDLE || pipelineLayout_ == VK_NULL_HANDLE)
+    if (shaderModule_ == VK_NULL_HANDLE || pipelineLayout_ == VK_NULL_HANDLE)
         return;
 
     // Require inputs (views + samplers) because shader uses sampler2D.
@@ -163,6 +241,9 @@ void Nv12ToRgbaPass::dispatch(VkCommandBuffer cmd, uint32_t frameIndex)
     if (fi >= outImages_.size() || fi >= descriptorSets_.size())
         return;
 
+    // This slot's previous submission has completed by the time it is recorded again.
+    readTimestamps_(fi);
+
     // Output must be GENERAL for imageStore()
     if (outLayouts_[fi] != VK_IMAGE_LAYOUT_GENERAL)
     {
@@ -183,7 +264,7 @@ void Nv12ToRgbaPass::dispatch(VkCommandBuffer cmd, uint32_t frameIndex)
         outLayouts_[fi] = VK_IMAGE_LAYOUT_GENERAL;
     }
 
-    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_);
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineFor_(conversion));
     vkCmdBindDescriptorSets(cmd,
                             VK_PIPELINE_BIND_POINT_COMPUTE,
                             pipelineLayout_,
@@ -200,9 +281,53 @@ void Nv12ToRgbaPass::dispatch(VkCommandBuffer cmd, uint32_t frameIndex)
                        sizeof(nv12toBGRPushConstants),
                        &pushConstants);
 
-    const uint32_t groupX = (static_cast<uint32_t>(width_) + 15u) / 16u;
-    const uint32_t groupY = (static_cast<uint32_t>(height_) + 15u) / 16u;
-    vkCmdDispatch(cmd, groupX, groupY, 1);
+    if (timestampPool_ != VK_NULL_HANDLE)
+    {
+        vkCmdResetQueryPool(cmd, timestampPool_, fi * 2, 2);
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampPool_, fi * 2);
+    }
+
+    if (kernelConfig_.kernel == Nv12Kernel::Quad2x2)
+    {
+        const uint32_t quadsX = (static_cast<uint32_t>(width_) + 1u) / 2u;
+        const uint32_t quadsY = (static_cast<uint32_t>(height_) + 1u) / 2u;
+        vkCmdDispatch(cmd,
+                      (quadsX + kernelConfig_.workgroupX - 1u) / kernelConfig_.workgroupX,
+                      (quadsY + kernelConfig_.workgroupY - 1u) / kernelConfig_.workgroupY,
+                      1);
+    }
+    else
+    {
+        const uint32_t groupX = (static_cast<uint32_t>(width_) + 15u) / 16u;
+        const uint32_t groupY = (static_cast<uint32_t>(height_) + 15u) / 16u;
+        vkCmdDispatch(cmd, groupX, groupY, 1);
+    }
+
+    if (timestampPool_ != VK_NULL_HANDLE)
+    {
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, timestampPool_, fi * 2 + 1);
+        timestampsPending_[fi] = true;
+    }
+
+    // Readback copy becomes visible to the host once the slot's fence signals
+    if (kernelConfig_.bufferOutput)
+    {
+        VkBufferMemoryBarrier bb{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+        bb.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        bb.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        bb.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        bb.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        bb.buffer = outBuffers_[fi];
+        bb.offset = 0;
+        bb.size = VK_WHOLE_SIZE;
+        vkCmdPipelineBarrier(cmd,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_HOST_BIT,
+                             0,
+                             0, nullptr,
+                             1, &bb,
+                             0, nullptr);
+    }
 }
 
 PresentInput Nv12ToRgbaPass::output(uint32_t frameIndex) const
@@ -231,13 +356,28 @@ VkImage Nv12ToRgbaPass::outputImage(uint32_t frameIndex) const
     return outImages_[frameIndex % framesInFlight_];
 }
 
+VkBuffer Nv12ToRgbaPass::outputBuffer(uint32_t frameIndex) const
+{
+    if (!kernelConfig_.bufferOutput)
+        return VK_NULL_HANDLE;
+    return outBuffers_[frameIndex % framesInFlight_];
+}
+
+const uint8_t* Nv12ToRgbaPass::mappedOutput(uint32_t frameIndex) const
+{
+    if (!kernelConfig_.bufferOutput)
+        return nullptr;
+    return static_cast<const uint8_t*>(outBufferMapped_[frameIndex % framesInFlight_]);
+}
+
 void Nv12ToRgbaPass::createPipeline_()
 {
     // bindings 0,1,2 must match SPIR-V compiled from the GLSL:
     // 0 = yTex (sampler2D)  -> COMBINED_IMAGE_SAMPLER
     // 1 = uvTex (sampler2D) -> COMBINED_IMAGE_SAMPLER
     // 2 = rgbaOutput (storage image)
-    std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+    // 3 = packedOutput (storage buffer, quad kernel only)
+    std::array<VkDescriptorSetLayoutBinding, 4> bindings{};
 
     bindings[0].binding = 0;
     bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
@@ -254,8 +394,14 @@ void Nv12ToRgbaPass::createPipeline_()
     bindings[2].descriptorCount = 1;
     bindings[2].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
 
+    bindings[3].binding = 3;
+    bindings[3].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[3].descriptorCount = 1;
+    bindings[3].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    const bool quad = kernelConfig_.kernel == Nv12Kernel::Quad2x2;
     VkDescriptorSetLayoutCreateInfo dsl{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
-    dsl.bindingCount = static_cast<uint32_t>(bindings.size());
+    dsl.bindingCount = quad ? 4u : 3u;
     dsl.pBindings = bindings.data();
 
     if (vkCreateDescriptorSetLayout(engine_->logicalDevice, &dsl, nullptr, &descriptorSetLayout_) != VK_SUCCESS)
@@ -276,25 +422,73 @@ void Nv12ToRgbaPass::createPipeline_()
         throw std::runtime_error("Nv12ToRgbaPass: failed to create pipeline layout");
 
     // Make sure this SPIR-V is compiled from the sampler2D version of the shader.
-    auto shaderCode = readSPIRVFile("shaders/nv12_to_rgba.spv");
-    VkShaderModule shaderModule = engine_->createShaderModule(shaderCode);
+    // The module stays alive so specialised variants can be created as streams need them.
+    auto shaderCode = readSPIRVFile(quad ? "shaders/nv12_to_rgba_quad.spv" : "shaders/nv12_to_rgba.spv");
+    shaderModule_ = engine_->createShaderModule(shaderCode);
+
+    // Build the variant for the default conversion up front so a bad module fails here.
+    pipelineFor_(conversion);
+}
+
+VkPipeline Nv12ToRgbaPass::pipelineFor_(const YuvConversion& c)
+{
+    for (const auto& entry : pipelines_)
+    {
+        if (entry.first == c)
+            return entry.second;
+    }
+
+    // constant_id 0..3 in both shaders, 4..6 (workgroup shape, buffer output) in the quad kernel
+    struct SpecializationData
+    {
+        int32_t colorSpace;
+        int32_t colorRange;
+        float sampleScale;
+        VkBool32 swapUV;
+        uint32_t workgroupX;
+        uint32_t workgroupY;
+        VkBool32 writeBuffer;
+    } data{static_cast<int32_t>(c.colorSpace), static_cast<int32_t>(c.colorRange), yuvSampleScale(c),
+           c.swapUV ? VK_TRUE : VK_FALSE, kernelConfig_.workgroupX, kernelConfig_.workgroupY,
+           kernelConfig_.bufferOutput ? VK_TRUE : VK_FALSE};
+
+    const std::array<VkSpecializationMapEntry, 7> entries{{
+        {0, offsetof(SpecializationData, colorSpace), sizeof(int32_t)},
+        {1, offsetof(SpecializationData, colorRange), sizeof(int32_t)},
+        {2, offsetof(SpecializationData, sampleScale), sizeof(float)},
+        {3, offsetof(SpecializationData, swapUV), sizeof(VkBool32)},
+        {4, offsetof(SpecializationData, workgroupX), sizeof(uint32_t)},
+        {5, offsetof(SpecializationData, workgroupY), sizeof(uint32_t)},
+        {6, offsetof(SpecializationData, writeBuffer), sizeof(VkBool32)},
+    }};
+
+    VkSpecializationInfo specialization{};
+    specialization.mapEntryCount = kernelConfig_.kernel == Nv12Kernel::Quad2x2 ? 7u : 4u;
+    specialization.pMapEntries = entries.data();
+    specialization.dataSize = sizeof(data);
+    specialization.pData = &data;
 
     VkPipelineShaderStageCreateInfo stage{VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO};
     stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
-    stage.module = shaderModule;
+    stage.module = shaderModule_;
     stage.pName = "main";
+    stage.pSpecializationInfo = &specialization;
 
     VkComputePipelineCreateInfo cpi{VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO};
     cpi.stage = stage;
     cpi.layout = pipelineLayout_;
 
-    if (vkCreateComputePipelines(engine_->logicalDevice, VK_NULL_HANDLE, 1, &cpi, nullptr, &pipeline_) != VK_SUCCESS)
-    {
-        vkDestroyShaderModule(engine_->logicalDevice, shaderModule, nullptr);
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    if (vkCreateComputePipelines(engine_->logicalDevice, VK_NULL_HANDLE, 1, &cpi, nullptr, &pipeline) != VK_SUCCESS)
         throw std::runtime_error("Nv12ToRgbaPass: failed to create compute pipeline");
-    }
 
-    vkDestroyShaderModule(engine_->logicalDevice, shaderModule, nullptr);
+    pipelines_.emplace_back(c, pipeline);
+
+    if (renderDebugEnabled())
+        std::cout << "[Nv12ToRgbaPass] specialised pipeline colorSpace=" << c.colorSpace << " colorRange=" << c.colorRange
+                  << " bitDepth=" << c.bitDepth << " sampleShift=" << c.sampleShift << " swapUV=" << c.swapUV
+                  << " (" << pipelines_.size() << " cached)" << std::endl;
+    return pipeline;
 }
 
 void Nv12ToRgbaPass::destroyPipeline_()
@@ -302,10 +496,13 @@ void Nv12ToRgbaPass::destroyPipeline_()
     if (!engine_ || engine_->logicalDevice == VK_NULL_HANDLE)
         return;
 
-    if (pipeline_ != VK_NULL_HANDLE)
+    for (auto& entry : pipelines_)
+        vkDestroyPipeline(engine_->logicalDevice, entry.second, nullptr);
+    pipelines_.clear();
+    if (shaderModule_ != VK_NULL_HANDLE)
     {
-        vkDestroyPipeline(engine_->logicalDevice, pipeline_, nullptr);
-        pipeline_ = VK_NULL_HANDLE;
+        vkDestroyShaderModule(engine_->logicalDevice, shaderModule_, nullptr);
+        shaderModule_ = VK_NULL_HANDLE;
     }
     if (pipelineLayout_ != VK_NULL_HANDLE)
     {
@@ -338,7 +535,10 @@ void Nv12ToRgbaPass::createOutputs_()
         ii.arrayLayers = 1;
         ii.samples = VK_SAMPLE_COUNT_1_BIT;
         ii.tiling = VK_IMAGE_TILING_OPTIMAL;
-        ii.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT; // written by compute, can be sampled downstream
+        // written by compute, sampled downstream, copied out by nv12_bench's comparison and
+        // ThumbnailStrip, scrubber hover thumbnails blitted in by Motive2D
+        ii.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                   VK_IMAGE_USAGE_TRANSFER_DST_BIT;
         ii.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
         ii.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 
@@ -371,6 +571,8 @@ void Nv12ToRgbaPass::createOutputs_()
             throw std::runtime_error("Nv12ToRgbaPass: failed to create output image view");
     }
 
+    createOutputBuffers_();
+
     // Default push constants
     pushConstants.rgbaSize = glm::ivec2(width_, height_);
     pushConstants.uvSize   = glm::ivec2(width_ / 2, height_ / 2);
@@ -388,6 +590,48 @@ void Nv12ToRgbaPass::destroyOutputs_()
     outViews_.clear();
     outMem_.clear();
     outLayouts_.clear();
+
+    destroyOutputBuffers_();
+}
+
+void Nv12ToRgbaPass::createOutputBuffers_()
+{
+    if (kernelConfig_.kernel != Nv12Kernel::Quad2x2)
+        return;
+
+    // Binding 3 is part of the quad kernel's interface either way; without buffer output the
+    // shader never writes it, so a device-local word stands in.
+    const bool readback = kernelConfig_.bufferOutput;
+    const VkDeviceSize size = readback ? static_cast<VkDeviceSize>(width_) * static_cast<VkDeviceSize>(height_) * 4u : 4u;
+    const VkMemoryPropertyFlags props = readback
+        ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+        : VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+    outBuffers_.assign(framesInFlight_, VK_NULL_HANDLE);
+    outBufferMem_.assign(framesInFlight_, VK_NULL_HANDLE);
+    outBufferMapped_.assign(framesInFlight_, nullptr);
+    for (uint32_t i = 0; i < framesInFlight_; ++i)
+    {
+        engine_->createBuffer(size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, props, outBuffers_[i], outBufferMem_[i]);
+        if (readback && vkMapMemory(engine_->logicalDevice, outBufferMem_[i], 0, size, 0, &outBufferMapped_[i]) != VK_SUCCESS)
+            throw std::runtime_error("Nv12ToRgbaPass: failed to map output buffer");
+    }
+}
+
+void Nv12ToRgbaPass::destroyOutputBuffers_()
+{
+    for (uint32_t i = 0; i < outBuffers_.size(); ++i)
+    {
+        if (outBufferMapped_[i])
+            vkUnmapMemory(engine_->logicalDevice, outBufferMem_[i]);
+        if (outBuffers_[i] != VK_NULL_HANDLE)
+            vkDestroyBuffer(engine_->logicalDevice, outBuffers_[i], nullptr);
+        if (outBufferMem_[i] != VK_NULL_HANDLE)
+            vkFreeMemory(engine_->logicalDevice, outBufferMem_[i], nullptr);
+    }
+    outBuffers_.clear();
+    outBufferMem_.clear();
+    outBufferMapped_.clear();
 }
 
 void Nv12ToRgbaPass::createDescriptors_()
@@ -398,7 +642,7 @@ void Nv12ToRgbaPass::createDescriptors_()
         return;
 
     // One set per in-flight slot.
-    std::array<VkDescriptorPoolSize, 2> sizes{};
+    std::array<VkDescriptorPoolSize, 3> sizes{};
 
     // yTex + uvTex are COMBINED_IMAGE_SAMPLER (2 per set)
     sizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
@@ -408,8 +652,12 @@ void Nv12ToRgbaPass::createDescriptors_()
     sizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
     sizes[1].descriptorCount = framesInFlight_;
 
+    // packedOutput is STORAGE_BUFFER (1 per set, quad kernel only)
+    sizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    sizes[2].descriptorCount = framesInFlight_;
+
     VkDescriptorPoolCreateInfo pi{VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
-    pi.poolSizeCount = static_cast<uint32_t>(sizes.size());
+    pi.poolSizeCount = kernelConfig_.kernel == Nv12Kernel::Quad2x2 ? 3u : 2u;
     pi.pPoolSizes = sizes.data();
     pi.maxSets = framesInFlight_;
 
@@ -455,7 +703,7 @@ void Nv12ToRgbaPass::rebuildDescriptorSets_()
 
     for (uint32_t i = 0; i < framesInFlight_; ++i)
     {
-        std::array<VkWriteDescriptorSet, 3> writes{};
+        std::array<VkWriteDescriptorSet, 4> writes{};
 
         // Binding 0: yTex (combined sampler)
         VkDescriptorImageInfo yInfo{};
@@ -498,8 +746,27 @@ void Nv12ToRgbaPass::rebuildDescriptorSets_()
         writes[2].descriptorCount = 1;
         writes[2].pImageInfo = &outInfo;
 
+        // Binding 3: packedOutput (storage buffer, quad kernel only)
+        VkDescriptorBufferInfo bufferInfo{};
+        uint32_t writeCount = 3;
+        if (i < outBuffers_.size())
+        {
+            bufferInfo.buffer = outBuffers_[i];
+            bufferInfo.offset = 0;
+            bufferInfo.range = VK_WHOLE_SIZE;
+
+            writes[3].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[3].dstSet = descriptorSets_[i];
+            writes[3].dstBinding = 3;
+            writes[3].dstArrayElement = 0;
+            writes[3].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[3].descriptorCount = 1;
+            writes[3].pBufferInfo = &bufferInfo;
+            writeCount = 4;
+        }
+
         vkUpdateDescriptorSets(engine_->logicalDevice,
-                               static_cast<uint32_t>(writes.size()),
+                               writeCount,
                                writes.data(),
                                0,
                                nullptr);
@@ -533,3 +800,43 @@ void Nv12ToRgbaPass::destroyOutputSampler_()
         outputSampler_ = VK_NULL_HANDLE;
     }
 }
+
+void Nv12ToRgbaPass::createTimestampQueries_()
+{
+    timestampsPending_.assign(framesInFlight_, false);
+
+    const VkPhysicalDeviceLimits& limits = engine_->getDeviceProperties().limits;
+    if (!limits.timestampComputeAndGraphics || limits.timestampPeriod <= 0.0f)
+        return;
+
+    VkQueryPoolCreateInfo qi{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+    qi.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    qi.queryCount = framesInFlight_ * 2;
+    if (vkCreateQueryPool(engine_->logicalDevice, &qi, nullptr, &timestampPool_) != VK_SUCCESS)
+    {
+        timestampPool_ = VK_NULL_HANDLE;
+        return;
+    }
+    timestampPeriodNs_ = static_cast<double>(limits.timestampPeriod);
+}
+
+void Nv12ToRgbaPass::readTimestamps_(uint32_t frameIndex)
+{
+    if (timestampPool_ == VK_NULL_HANDLE || !timestampsPending_[frameIndex])
+        return;
+
+    std::array<uint64_t, 2> ticks{};
+    if (vkGetQueryPoolResults(engine_->logicalDevice,
+                              timestampPool_,
+                              frameIndex * 2,
+                              2,
+                              sizeof(ticks),
+                              ticks.data(),
+                              sizeof(uint64_t),
+                              VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+        return;
+
+    timestampsPending_[frameIndex] = false;
+    if (ticks[1] >= ticks[0])
+        lastGpuMs_ = static_cast<double>(ticks[1] - ticks[0]) * timestampPeriodNs_ * 1e-6;
+}
@@ -6,17 +6,87 @@
 #include <glm/glm.hpp>
 
 #include <cstdint>
+#include <utility>
 #include <vector>
 
 class Engine2D;
 
+// Storage precision of the RGBA intermediates between conversion and grading. Float16 carries
+// 10-bit sources and post-curve gradients without an 8-bit round trip; with Unorm8, grading
+// dithers its 8-bit output instead.
+enum class IntermediatePrecision : uint32_t
+{
+    Unorm8 = 0,  // R8G8B8A8_UNORM, 4 bytes per pixel
+    Float16 = 1, // R16G16B16A16_SFLOAT, 8 bytes per pixel
+};
+
+inline VkFormat intermediateFormat(IntermediatePrecision precision)
+{
+    return precision == IntermediatePrecision::Float16 ? VK_FORMAT_R16G16B16A16_SFLOAT : VK_FORMAT_R8G8B8A8_UNORM;
+}
+
+inline uint32_t intermediateBytesPerPixel(IntermediatePrecision precision)
+{
+    return precision == IntermediatePrecision::Float16 ? 8u : 4u;
+}
+
+// Stream properties the YUV->RGBA kernels are specialised on (VkSpecializationInfo, constant_id
+// 0..3 in nv12_to_rgba.comp / yuv420p_to_rgba.comp). Each distinct value gets its own cached
+// pipeline, so the per-pixel matrix / range branches fold away at pipeline creation.
+struct YuvConversion
+{
+    uint32_t colorSpace = 0;  // 0=BT.601, 1=BT.709, 2=BT.2020
+    uint32_t colorRange = 0;  // 0=limited, 1=full
+    uint32_t bitDepth = 8;    // 8, 10 or 12
+    uint32_t sampleShift = 0; // bit position of >8-bit samples in their 16-bit words (6 for P010, 0 for yuv420p10)
+    bool swapUV = false;      // NV21-style CrCb chroma plane (2-plane kernel only)
+
+    bool operator==(const YuvConversion& o) const
+    {
+        return colorSpace == o.colorSpace && colorRange == o.colorRange && bitDepth == o.bitDepth &&
+               sampleShift == o.sampleShift && swapUV == o.swapUV;
+    }
+};
+
+// Factor taking a sampled UNORM plane value to [0,1] at the source bit depth: 8-bit planes read
+// back exactly, 16-bit planes as stored / 65535 whether the samples sit LSB- or MSB-aligned.
+inline float yuvSampleScale(const YuvConversion& c)
+{
+    if (c.bitDepth <= 8 || c.bitDepth >= 16)
+        return 1.0f;
+    return 65535.0f / static_cast<float>(((1u << c.bitDepth) - 1u) << c.sampleShift);
+}
+
 // Push constants must match your compute shader push constant block.
 struct nv12toBGRPushConstants
 {
     glm::ivec2 rgbaSize{0, 0};
     glm::ivec2 uvSize{0, 0};
-    uint32_t colorSpace = 0; // 0=BT.601, 1=BT.709, 2=BT.2020 (match your convention)
-    uint32_t colorRange = 1; // 1=full, 0=limited (match your convention)
+    glm::ivec2 chromaShift{1, 1}; // log2 chroma subsampling: (1,1) 4:2:0, (1,0) 4:2:2, (0,0) 4:4:4
+    glm::ivec2 srcSize{0, 0};     // luma plane size; when it differs from rgbaSize the output is a filtered downscale
+};
+static_assert(sizeof(nv12toBGRPushConstants) == 32, "Push constant size must match shader");
+
+// Conversion kernel of Nv12ToRgbaPass. PerPixel (nv12_to_rgba.comp) converts one pixel per
+// invocation; Quad2x2 (nv12_to_rgba_quad.comp) converts a 2x2 luma quad per invocation and
+// fetches the 4:2:0 chroma texel once for all four. Quad2x2 converts 1:1 only and ignores
+// pushConstants.srcSize.
+enum class Nv12Kernel : uint32_t
+{
+    PerPixel = 0,
+    Quad2x2 = 1,
+};
+
+struct Nv12KernelConfig
+{
+    // PerPixel stays the default until nv12_bench has A/B numbers for Quad2x2 on the target
+    // devices; --nv12-kernel=quad opts in
+    Nv12Kernel kernel = Nv12Kernel::PerPixel;
+    // Quad2x2 workgroup shape in quads; 0 picks one from the device's subgroup size
+    uint32_t workgroupX = 0;
+    uint32_t workgroupY = 0;
+    // Quad2x2 only: also write packed RGBA8 rows into a host-visible buffer per slot for readback
+    bool bufferOutput = false;
 };
 
 class Nv12ToRgbaPass
@@ -31,13 +101,19 @@ public:
                    uint32_t framesInFlight,
                    int width,
                    int height,
-                   VkDescriptorType inputDescriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+                   VkDescriptorType inputDescriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                   VkFormat outputFormat = VK_FORMAT_R8G8B8A8_UNORM);
 
     ~Nv12ToRgbaPass();
 
     Nv12ToRgbaPass(const Nv12ToRgbaPass&) = delete;
     Nv12ToRgbaPass& operator=(const Nv12ToRgbaPass&) = delete;
 
+    // Selects the conversion kernel; must be called before initialize(). Unset workgroup
+    // dimensions are resolved against the device here.
+    void configureKernel(const Nv12KernelConfig& config);
+    const Nv12KernelConfig& kernelConfig() const { return kernelConfig_; }
+
     // Build pipeline + outputs + descriptors.
     void initialize();
 
@@ -63,9 +139,22 @@ public:
     VkImage outputImage(uint32_t frameIndex) const;
     VkSampler outputSampler() const { return outputSampler_; } // linear clamp sampler created by pass
 
+    // Packed RGBA8 copy of the slot's output (Nv12KernelConfig::bufferOutput), width * 4 bytes
+    // per row. Host-coherent and mapped; valid once the slot's submission has completed.
+    VkBuffer outputBuffer(uint32_t frameIndex) const;
+    const uint8_t* mappedOutput(uint32_t frameIndex) const;
+
     // Push constants (set per frame)
     nv12toBGRPushConstants pushConstants{};
 
+    // Matrix / range / depth / swap of the current stream (set per frame); dispatch() binds the
+    // pipeline specialised for it, creating and caching it on first use.
+    YuvConversion conversion{};
+
+    // GPU time of the last completed dispatch in milliseconds (0 until one has finished).
+    double lastGpuMilliseconds() const { return lastGpuMs_; }
+    VkFormat outputFormat() const { return outFormat_; }
+
     uint32_t framesInFlight() const { return framesInFlight_; }
     int width() const { return width_; }
     int height() const { return height_; }
@@ -73,9 +162,12 @@ public:
 private:
     void createPipeline_();
     void destroyPipeline_();
+    VkPipeline pipelineFor_(const YuvConversion& conversion);
 
     void createOutputs_();
     void destroyOutputs_();
+    void createOutputBuffers_();
+    void destroyOutputBuffers_();
 
     void createDescriptors_();
     void destroyDescriptors_();
@@ -84,6 +176,9 @@ private:
     void createOutputSampler_();
     void destroyOutputSampler_();
 
+    void createTimestampQueries_();
+    void readTimestamps_(uint32_t frameIndex);
+
 private:
     Engine2D* engine_ = nullptr;
 
@@ -107,17 +202,30 @@ private:
     std::vector<VkImageView> outViews_;
     std::vector<VkImageLayout> outLayouts_;
 
+    // Quad2x2 binding 3: packed RGBA8 readback buffers, or a 4-byte placeholder per slot
+    Nv12KernelConfig kernelConfig_{};
+    std::vector<VkBuffer> outBuffers_;
+    std::vector<VkDeviceMemory> outBufferMem_;
+    std::vector<void*> outBufferMapped_;
+
     // Descriptor infra (owned)
     VkDescriptorSetLayout descriptorSetLayout_ = VK_NULL_HANDLE;
     VkDescriptorPool descriptorPool_ = VK_NULL_HANDLE;
     std::vector<VkDescriptorSet> descriptorSets_;
 
-    // Pipeline
+    // Pipelines, one per YuvConversion seen so far
     VkPipelineLayout pipelineLayout_ = VK_NULL_HANDLE;
-    VkPipeline pipeline_ = VK_NULL_HANDLE;
+    VkShaderModule shaderModule_ = VK_NULL_HANDLE;
+    std::vector<std::pair<YuvConversion, VkPipeline>> pipelines_;
 
     // Sampler used when *downstream* wants to sample our RGBA output (ColorGrading)
     VkSampler outputSampler_ = VK_NULL_HANDLE;
 
+    // Two timestamps per frame slot around the dispatch
+    VkQueryPool timestampPool_ = VK_NULL_HANDLE;
+    std::vector<bool> timestampsPending_;
+    double timestampPeriodNs_ = 0.0;
+    double lastGpuMs_ = 0.0;
+
     bool initialized_ = false;
 };
@@ -20,6 +20,7 @@
 #include <glm/glm.hpp>
 
 #include "engine2d.h"
+#include "queue_lock.h"
 #include "utils.h"
 
 constexpr std::array<glm::vec4, 4> kLabelPalette = {
@@ -287,6 +288,53 @@ glm::vec4 PoseOverlay::colorForLabel(const std::string& label)
     return color;
 }
 
+PoseOverlay::FrameSlot& PoseOverlay::waitForSlot(uint32_t index)
+{
+    FrameSlot& slot = slots_[index % kFrameSlots];
+    if (slot.fence != VK_NULL_HANDLE)
+    {
+        vkWaitForFences(device, 1, &slot.fence, VK_TRUE, UINT64_MAX);
+    }
+    return slot;
+}
+
+DetectionEntry* PoseOverlay::acquireDetections(uint32_t count)
+{
+    if (!engine_ || device == VK_NULL_HANDLE)
+    {
+        return nullptr;
+    }
+    FrameSlot& slot = waitForSlot(nextSlot_);
+    const VkDeviceSize required = sizeof(DetectionEntry) * std::max<VkDeviceSize>(1, count);
+    // ensureBuffer is about to free and reallocate the memory; drop the old mapping so the new
+    // allocation is mapped below (a recycled handle value must not look like the old one)
+    if (slot.detectionsMapped && slot.detectionSize < required)
+    {
+        vkUnmapMemory(device, slot.detectionMemory);
+        slot.detectionsMapped = nullptr;
+    }
+    if (!ensureBuffer(slot.detectionBuffer,
+                      slot.detectionMemory,
+                      slot.detectionSize,
+                      required,
+                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+    {
+        return nullptr;
+    }
+    if (!slot.detectionsMapped)
+    {
+        void* mapped = nullptr;
+        if (vkMapMemory(device, slot.detectionMemory, 0, VK_WHOLE_SIZE, 0, &mapped) != VK_SUCCESS)
+        {
+            return nullptr;
+        }
+        slot.detectionsMapped = static_cast<DetectionEntry*>(mapped);
+        slot.descriptorsDirty = true;
+    }
+    return slot.detectionsMapped;
+}
+
 void PoseOverlay::run(ImageResource& target,
                      uint32_t width,
                      uint32_t height,
@@ -304,11 +352,15 @@ void PoseOverlay::run(ImageResource& target,
     LOG_DEBUG(std::cout << "[PoseOverlay] Detection count: " << detectionCount 
               << ", detection enabled: " << detectionEnabled << std::endl);
     
-    if (!engine_)
+    if (!engine_ || pipeline == VK_NULL_HANDLE || binPipeline == VK_NULL_HANDLE)
     {
         LOG_DEBUG(std::cout << "[PoseOverlay] Engine not initialized" << std::endl);
         return;
     }
+    if (!detections)
+    {
+        detectionCount = 0;
+    }
     
     bool recreated = false;
     if (!target.ensure(width, height, VK_FORMAT_R8G8B8A8_UNORM, recreated,
@@ -318,73 +370,128 @@ void PoseOverlay::run(ImageResource& target,
         return;
     }
 
-    VkDescriptorImageInfo storageInfo{};
-    storageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-    storageInfo.imageView = target.view;
-
-    const VkDeviceSize entrySize = sizeof(DetectionEntry);
-    VkDeviceSize desiredBufferSize = entrySize;
-    if (detectionCount > 0)
+    // Detections land in this slot's mapped buffer; callers using acquireDetections() are already there.
+    DetectionEntry* mapped = acquireDetections(detectionCount);
+    if (!mapped)
+    {
+        return;
+    }
+    FrameSlot& slot = slots_[nextSlot_];
+    nextSlot_ = (nextSlot_ + 1) % kFrameSlots;
+    if (detectionCount > 0 && detections != mapped)
     {
-        desiredBufferSize = entrySize * static_cast<VkDeviceSize>(detectionCount);
+        std::memcpy(mapped, detections, sizeof(DetectionEntry) * detectionCount);
     }
-    if (!ensureDetectionBuffer(desiredBufferSize))
+
+    const uint32_t tilesX = (width + 15) / 16;
+    const uint32_t tilesY = (height + 15) / 16;
+    const uint32_t tileCount = tilesX * tilesY;
+    if (!ensureSlotBuffers(slot, detectionCount, tileCount))
     {
         return;
     }
 
-    VkDeviceSize copySize = std::max(entrySize, desiredBufferSize);
-    if (detectionBuffer != VK_NULL_HANDLE && detectionBufferMemory != VK_NULL_HANDLE)
+    if (slot.descriptorsDirty || slot.boundView != target.view)
     {
-        void* mapped = nullptr;
-        vkMapMemory(device, detectionBufferMemory, 0, copySize, 0, &mapped);
-        if (mapped)
+        VkDescriptorImageInfo storageInfo{};
+        storageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        storageInfo.imageView = target.view;
+
+        std::array<VkDescriptorBufferInfo, 3> bufferInfos{};
+        bufferInfos[0] = {slot.detectionBuffer, 0, VK_WHOLE_SIZE};
+        bufferInfos[1] = {slot.primitiveBuffer, 0, VK_WHOLE_SIZE};
+        bufferInfos[2] = {slot.binBuffer, 0, VK_WHOLE_SIZE};
+
+        std::array<VkWriteDescriptorSet, 4> writes{};
+        for (uint32_t b = 0; b < writes.size(); ++b)
         {
-            if (detectionCount > 0 && detections)
+            writes[b].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[b].dstSet = slot.descriptorSet;
+            writes[b].dstBinding = b;
+            writes[b].descriptorCount = 1;
+            if (b == 0)
             {
-                std::memcpy(mapped, detections, entrySize * detectionCount);
+                writes[b].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+                writes[b].pImageInfo = &storageInfo;
             }
             else
             {
-                std::memset(mapped, 0, static_cast<size_t>(entrySize));
+                writes[b].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                writes[b].pBufferInfo = &bufferInfos[b - 1];
             }
-            vkUnmapMemory(device, detectionBufferMemory);
         }
+        vkUpdateDescriptorSets(device,
+                               static_cast<uint32_t>(writes.size()),
+                               writes.data(),
+                               0,
+                               nullptr);
+        slot.boundView = target.view;
+        slot.descriptorsDirty = false;
     }
 
-    VkDescriptorBufferInfo bufferInfo{};
-    bufferInfo.buffer = detectionBuffer;
-    bufferInfo.offset = 0;
-    bufferInfo.range = copySize;
-
-    VkWriteDescriptorSet imageWrite{};
-    imageWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    imageWrite.dstSet = descriptorSet;
-    imageWrite.dstBinding = 0;
-    imageWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-    imageWrite.descriptorCount = 1;
-    imageWrite.pImageInfo = &storageInfo;
-
-    VkWriteDescriptorSet bufferWrite{};
-    bufferWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    bufferWrite.dstSet = descriptorSet;
-    bufferWrite.dstBinding = 1;
-    bufferWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    bufferWrite.descriptorCount = 1;
-    bufferWrite.pBufferInfo = &bufferInfo;
-
-    std::array<VkWriteDescriptorSet, 2> writes = {imageWrite, bufferWrite};
-    vkUpdateDescriptorSets(device,
-                           static_cast<uint32_t>(writes.size()),
-                           writes.data(),
-                           0,
-                           nullptr);
-
+    VkCommandBuffer commandBuffer = slot.commandBuffer;
     vkResetCommandBuffer(commandBuffer, 0);
     VkCommandBufferBeginInfo beginInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
     beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
     vkBeginCommandBuffer(commandBuffer, &beginInfo);
 
+    vkCmdBindDescriptorSets(commandBuffer,
+                            VK_PIPELINE_BIND_POINT_COMPUTE,
+                            pipelineLayout,
+                            0,
+                            1,
+                            &slot.descriptorSet,
+                            0,
+                            nullptr);
+
+    // Tile counts start at zero every frame
+    vkCmdFillBuffer(commandBuffer, slot.binBuffer, 0, sizeof(uint32_t) * tileCount, 0);
+
+    VkMemoryBarrier binBarrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    binBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    binBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0,
+                         1, &binBarrier,
+                         0, nullptr,
+                         0, nullptr);
+
+    if (detectionCount > 0)
+    {
+        PoseBinPush binPush{};
+        binPush.outputSize = glm::vec2(static_cast<float>(width), static_cast<float>(height));
+        binPush.detectionCount = detectionCount;
+        binPush.tilesX = tilesX;
+        binPush.tilesY = tilesY;
+        binPush.listCapacity = static_cast<uint32_t>(slot.binSize / sizeof(uint32_t)) - 3 * tileCount;
+
+        const uint32_t primitiveCount = detectionCount * (1 + kLimbsPerDetection);
+        const std::array<uint32_t, 3> groups = {(detectionCount + 255) / 256, 1, (primitiveCount + 255) / 256};
+
+        binBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, binPipeline);
+        for (uint32_t stage = 0; stage < groups.size(); ++stage)
+        {
+            binPush.stage = stage;
+            vkCmdPushConstants(commandBuffer,
+                               pipelineLayout,
+                               VK_SHADER_STAGE_COMPUTE_BIT,
+                               0,
+                               sizeof(PoseBinPush),
+                               &binPush);
+            vkCmdDispatch(commandBuffer, groups[stage], 1, 1);
+            vkCmdPipelineBarrier(commandBuffer,
+                                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                 0,
+                                 1, &binBarrier,
+                                 0, nullptr,
+                                 0, nullptr);
+        }
+    }
+
     PoseOverlayPush push{glm::vec2(static_cast<float>(width), static_cast<float>(height)),
                          rectCenter,
                          rectSize,
@@ -410,8 +517,9 @@ void PoseOverlay::run(ImageResource& target,
                                          : 0;
     toGeneralBarrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
 
+    // The previous frame's overlay may still be sampled by a later submission's fragment stage
     VkPipelineStageFlags srcStage = (initialLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
-                                        ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
+                                        ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT
                                         : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
 
     vkCmdPipelineBarrier(commandBuffer,
@@ -423,14 +531,6 @@ void PoseOverlay::run(ImageResource& target,
                          1, &toGeneralBarrier);
 
     vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
-    vkCmdBindDescriptorSets(commandBuffer,
-                            VK_PIPELINE_BIND_POINT_COMPUTE,
-                            pipelineLayout,
-                            0,
-                            1,
-                            &descriptorSet,
-                            0,
-                            nullptr);
     vkCmdPushConstants(commandBuffer,
                        pipelineLayout,
                        VK_SHADER_STAGE_COMPUTE_BIT,
@@ -438,9 +538,7 @@ void PoseOverlay::run(ImageResource& target,
                        sizeof(PoseOverlayPush),
                        &push);
 
-    const uint32_t groupX = (width + 15) / 16;
-    const uint32_t groupY = (height + 15) / 16;
-    vkCmdDispatch(commandBuffer, groupX, groupY, 1);
+    vkCmdDispatch(commandBuffer, tilesX, tilesY, 1);
 
     VkImageMemoryBarrier toReadBarrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
     toReadBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
@@ -454,7 +552,7 @@ void PoseOverlay::run(ImageResource& target,
 
     vkCmdPipelineBarrier(commandBuffer,
                          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
                          0,
                          0, nullptr,
                          0, nullptr,
@@ -462,12 +560,16 @@ void PoseOverlay::run(ImageResource& target,
 
     vkEndCommandBuffer(commandBuffer);
 
-    vkResetFences(device, 1, &fence);
+    // No wait here: the slot's fence is waited on when the slot comes around again.
+    vkResetFences(device, 1, &slot.fence);
     VkSubmitInfo submitInfo{VK_STRUCTURE_TYPE_SUBMIT_INFO};
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &commandBuffer;
-    vkQueueSubmit(queue, 1, &submitInfo, fence);
-    vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
+    {
+        // Shared with the decoders and the render loop
+        std::lock_guard<std::mutex> queueLock(vulkanQueueMutex(engine_->graphicsQueueFamilyIndex));
+        vkQueueSubmit(queue, 1, &submitInfo, slot.fence);
+    }
 }
 
 PoseOverlay::PoseOverlay(Engine2D* engine) : engine_(engine)
@@ -481,19 +583,18 @@ PoseOverlay::PoseOverlay(Engine2D* engine) : engine_(engine)
     device = engine->logicalDevice;
     queue = engine->graphicsQueue;
 
-    VkDescriptorSetLayoutBinding bindings[2]{};
-    bindings[0].binding = 0;
-    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-    bindings[0].descriptorCount = 1;
-    bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-
-    bindings[1].binding = 1;
-    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    bindings[1].descriptorCount = 1;
-    bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    // 0: overlay image, 1: detections, 2: expanded primitives, 3: tile bins
+    VkDescriptorSetLayoutBinding bindings[4]{};
+    for (uint32_t b = 0; b < 4; ++b)
+    {
+        bindings[b].binding = b;
+        bindings[b].descriptorType = b == 0 ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[b].descriptorCount = 1;
+        bindings[b].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
 
     VkDescriptorSetLayoutCreateInfo layoutInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
-    layoutInfo.bindingCount = 2;
+    layoutInfo.bindingCount = 4;
     layoutInfo.pBindings = bindings;
     if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS)
     {
@@ -502,9 +603,11 @@ PoseOverlay::PoseOverlay(Engine2D* engine) : engine_(engine)
     }
 
     std::vector<char> shaderCode;
+    std::vector<char> binShaderCode;
     try
     {
         shaderCode = readSPIRVFile("shaders/overlay_pose.spv");
+        binShaderCode = readSPIRVFile("shaders/overlay_bin.spv");
     }
     catch (const std::exception& ex)
     {
@@ -513,11 +616,13 @@ PoseOverlay::PoseOverlay(Engine2D* engine) : engine_(engine)
     }
 
     VkShaderModule shaderModule = engine->createShaderModule(shaderCode);
+    VkShaderModule binShaderModule = engine->createShaderModule(binShaderCode);
 
+    // Shared by the draw and bin pipelines; each shader reads its own push block.
     VkPushConstantRange pushRange{};
     pushRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
     pushRange.offset = 0;
-    pushRange.size = sizeof(PoseOverlayPush);
+    pushRange.size = static_cast<uint32_t>(std::max(sizeof(PoseOverlayPush), sizeof(PoseBinPush)));
 
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
     pipelineLayoutInfo.setLayoutCount = 1;
@@ -529,6 +634,7 @@ PoseOverlay::PoseOverlay(Engine2D* engine) : engine_(engine)
     {
         std::cerr << "[PoseOverlay] Failed to create pipeline layout" << std::endl;
         vkDestroyShaderModule(device, shaderModule, nullptr);
+        vkDestroyShaderModule(device, binShaderModule, nullptr);
         return;
     }
 
@@ -541,23 +647,29 @@ PoseOverlay::PoseOverlay(Engine2D* engine) : engine_(engine)
     pipelineInfo.stage = stageInfo;
     pipelineInfo.layout = pipelineLayout;
 
-    if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
+    VkComputePipelineCreateInfo binPipelineInfo = pipelineInfo;
+    binPipelineInfo.stage.module = binShaderModule;
+
+    if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS ||
+        vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &binPipelineInfo, nullptr, &binPipeline) != VK_SUCCESS)
     {
         std::cerr << "[PoseOverlay] Failed to create compute pipeline" << std::endl;
         vkDestroyShaderModule(device, shaderModule, nullptr);
+        vkDestroyShaderModule(device, binShaderModule, nullptr);
         return;
     }
 
     vkDestroyShaderModule(device, shaderModule, nullptr);
+    vkDestroyShaderModule(device, binShaderModule, nullptr);
 
     std::array<VkDescriptorPoolSize, 2> poolSizes{};
     poolSizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-    poolSizes[0].descriptorCount = 1;
+    poolSizes[0].descriptorCount = kFrameSlots;
     poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    poolSizes[1].descriptorCount = 1;
+    poolSizes[1].descriptorCount = 3 * kFrameSlots;
 
     VkDescriptorPoolCreateInfo poolInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
-    poolInfo.maxSets = 1;
+    poolInfo.maxSets = kFrameSlots;
     poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
     poolInfo.pPoolSizes = poolSizes.data();
 
@@ -567,12 +679,14 @@ PoseOverlay::PoseOverlay(Engine2D* engine) : engine_(engine)
         return;
     }
 
+    const std::array<VkDescriptorSetLayout, kFrameSlots> setLayouts = {descriptorSetLayout, descriptorSetLayout, descriptorSetLayout};
+    std::array<VkDescriptorSet, kFrameSlots> sets{};
     VkDescriptorSetAllocateInfo allocInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
     allocInfo.descriptorPool = descriptorPool;
-    allocInfo.descriptorSetCount = 1;
-    allocInfo.pSetLayouts = &descriptorSetLayout;
+    allocInfo.descriptorSetCount = kFrameSlots;
+    allocInfo.pSetLayouts = setLayouts.data();
 
-    if (vkAllocateDescriptorSets(device, &allocInfo, &descriptorSet) != VK_SUCCESS)
+    if (vkAllocateDescriptorSets(device, &allocInfo, sets.data()) != VK_SUCCESS)
     {
         std::cerr << "[PoseOverlay] Failed to allocate descriptor set" << std::endl;
         return;
@@ -587,21 +701,29 @@ PoseOverlay::PoseOverlay(Engine2D* engine) : engine_(engine)
         return;
     }
 
+    std::array<VkCommandBuffer, kFrameSlots> commandBuffers{};
     VkCommandBufferAllocateInfo cmdAllocInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
     cmdAllocInfo.commandPool = commandPool;
     cmdAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    cmdAllocInfo.commandBufferCount = 1;
-    if (vkAllocateCommandBuffers(device, &cmdAllocInfo, &commandBuffer) != VK_SUCCESS)
+    cmdAllocInfo.commandBufferCount = kFrameSlots;
+    if (vkAllocateCommandBuffers(device, &cmdAllocInfo, commandBuffers.data()) != VK_SUCCESS)
     {
         std::cerr << "[PoseOverlay] Failed to allocate command buffer" << std::endl;
         return;
     }
 
+    // Signaled so the first use of every slot does not wait
     VkFenceCreateInfo fenceInfo{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
-    if (vkCreateFence(device, &fenceInfo, nullptr, &fence) != VK_SUCCESS)
+    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+    for (uint32_t i = 0; i < kFrameSlots; ++i)
     {
-        std::cerr << "[PoseOverlay] Failed to create fence" << std::endl;
-        return;
+        slots_[i].descriptorSet = sets[i];
+        slots_[i].commandBuffer = commandBuffers[i];
+        if (vkCreateFence(device, &fenceInfo, nullptr, &slots_[i].fence) != VK_SUCCESS)
+        {
+            std::cerr << "[PoseOverlay] Failed to create fence" << std::endl;
+            return;
+        }
     }
 }
 
@@ -612,10 +734,9 @@ PoseOverlay::~PoseOverlay()
         
     vkDeviceWaitIdle(device);
 
-    if (fence != VK_NULL_HANDLE)
+    for (auto& slot : slots_)
     {
-        vkDestroyFence(device, fence, nullptr);
-        fence = VK_NULL_HANDLE;
+        destroySlot(slot);
     }
     if (commandPool != VK_NULL_HANDLE)
     {
@@ -632,6 +753,11 @@ PoseOverlay::~PoseOverlay()
         vkDestroyPipeline(device, pipeline, nullptr);
         pipeline = VK_NULL_HANDLE;
     }
+    if (binPipeline != VK_NULL_HANDLE)
+    {
+        vkDestroyPipeline(device, binPipeline, nullptr);
+        binPipeline = VK_NULL_HANDLE;
+    }
     if (pipelineLayout != VK_NULL_HANDLE)
     {
         vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
@@ -642,17 +768,6 @@ PoseOverlay::~PoseOverlay()
         vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
         descriptorSetLayout = VK_NULL_HANDLE;
     }
-    if (detectionBuffer != VK_NULL_HANDLE)
-    {
-        vkDestroyBuffer(device, detectionBuffer, nullptr);
-        detectionBuffer = VK_NULL_HANDLE;
-    }
-    if (detectionBufferMemory != VK_NULL_HANDLE)
-    {
-        vkFreeMemory(device, detectionBufferMemory, nullptr);
-        detectionBufferMemory = VK_NULL_HANDLE;
-    }
-    detectionBufferSize = 0;
 }
 
 bool PoseOverlay::parseTxt(std::istream& input) {
@@ -677,57 +792,125 @@ bool PoseOverlay::parseTxt(std::istream& input) {
     return !frameData_.empty();
 }
 
-bool PoseOverlay::ensureDetectionBuffer(VkDeviceSize requiredSize) {
-    if (requiredSize == 0) requiredSize = sizeof(DetectionEntry);
-    if (detectionBufferSize >= requiredSize) return true;
+void PoseOverlay::destroySlot(FrameSlot& slot)
+{
+    if (slot.fence != VK_NULL_HANDLE)
+    {
+        vkDestroyFence(device, slot.fence, nullptr);
+        slot.fence = VK_NULL_HANDLE;
+    }
+    if (slot.detectionsMapped)
+    {
+        vkUnmapMemory(device, slot.detectionMemory);
+        slot.detectionsMapped = nullptr;
+    }
+    const std::array<std::pair<VkBuffer*, VkDeviceMemory*>, 3> buffers = {{
+        {&slot.detectionBuffer, &slot.detectionMemory},
+        {&slot.primitiveBuffer, &slot.primitiveMemory},
+        {&slot.binBuffer, &slot.binMemory},
+    }};
+    for (const auto& [buffer, memory] : buffers)
+    {
+        if (*buffer != VK_NULL_HANDLE)
+        {
+            vkDestroyBuffer(device, *buffer, nullptr);
+            *buffer = VK_NULL_HANDLE;
+        }
+        if (*memory != VK_NULL_HANDLE)
+        {
+            vkFreeMemory(device, *memory, nullptr);
+            *memory = VK_NULL_HANDLE;
+        }
+    }
+    slot.detectionSize = 0;
+    slot.primitiveSize = 0;
+    slot.binSize = 0;
+}
+
+bool PoseOverlay::ensureSlotBuffers(FrameSlot& slot, uint32_t detectionCount, uint32_t tileCount)
+{
+    const VkDeviceSize primitiveBytes =
+        VkDeviceSize(kPrimitiveBytes) * (1 + kLimbsPerDetection) * std::max<uint32_t>(1, detectionCount);
+    const VkDeviceSize binBytes = sizeof(uint32_t) * VkDeviceSize(tileCount) * (3 + kTileListsPerTile);
+
+    const VkBuffer oldPrimitives = slot.primitiveBuffer;
+    const VkBuffer oldBins = slot.binBuffer;
+    if (!ensureBuffer(slot.primitiveBuffer,
+                      slot.primitiveMemory,
+                      slot.primitiveSize,
+                      primitiveBytes,
+                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) ||
+        !ensureBuffer(slot.binBuffer,
+                      slot.binMemory,
+                      slot.binSize,
+                      binBytes,
+                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT))
+    {
+        return false;
+    }
+    if (slot.primitiveBuffer != oldPrimitives || slot.binBuffer != oldBins)
+    {
+        slot.descriptorsDirty = true;
+    }
+    return true;
+}
+
+bool PoseOverlay::ensureBuffer(VkBuffer& buffer,
+                               VkDeviceMemory& memory,
+                               VkDeviceSize& currentSize,
+                               VkDeviceSize requiredSize,
+                               VkBufferUsageFlags usage,
+                               VkMemoryPropertyFlags properties)
+{
+    if (buffer != VK_NULL_HANDLE && currentSize >= requiredSize) return true;
     
-    // Destroy old buffer if exists
-    if (detectionBuffer != VK_NULL_HANDLE) {
-        vkDestroyBuffer(device, detectionBuffer, nullptr);
-        detectionBuffer = VK_NULL_HANDLE;
+    // Destroy old buffer if exists; callers only resize slots whose fence has signaled
+    if (buffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(device, buffer, nullptr);
+        buffer = VK_NULL_HANDLE;
     }
-    if (detectionBufferMemory != VK_NULL_HANDLE) {
-        vkFreeMemory(device, detectionBufferMemory, nullptr);
-        detectionBufferMemory = VK_NULL_HANDLE;
+    if (memory != VK_NULL_HANDLE) {
+        vkFreeMemory(device, memory, nullptr);
+        memory = VK_NULL_HANDLE;
     }
+    currentSize = 0;
     
     // Create new buffer
     VkBufferCreateInfo bufferInfo{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
     bufferInfo.size = requiredSize;
-    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    bufferInfo.usage = usage;
     bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
     
-    if (vkCreateBuffer(device, &bufferInfo, nullptr, &detectionBuffer) != VK_SUCCESS) {
-        std::cerr << "[PoseOverlay] Failed to create detection buffer" << std::endl;
+    if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
+        std::cerr << "[PoseOverlay] Failed to create buffer" << std::endl;
         return false;
     }
     
     VkMemoryRequirements memReq;
-    vkGetBufferMemoryRequirements(device, detectionBuffer, &memReq);
+    vkGetBufferMemoryRequirements(device, buffer, &memReq);
     
     VkMemoryAllocateInfo allocInfo{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
     allocInfo.allocationSize = memReq.size;
-    allocInfo.memoryTypeIndex = engine_->findMemoryType(memReq.memoryTypeBits, 
-                                                       VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | 
-                                                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | 
-                                                       VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    allocInfo.memoryTypeIndex = engine_->findMemoryType(memReq.memoryTypeBits, properties);
     
-    if (vkAllocateMemory(device, &allocInfo, nullptr, &detectionBufferMemory) != VK_SUCCESS) {
-        std::cerr << "[PoseOverlay] Failed to allocate detection buffer memory" << std::endl;
-        vkDestroyBuffer(device, detectionBuffer, nullptr);
-        detectionBuffer = VK_NULL_HANDLE;
+    if (vkAllocateMemory(device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+        std::cerr << "[PoseOverlay] Failed to allocate buffer memory" << std::endl;
+        vkDestroyBuffer(device, buffer, nullptr);
+        buffer = VK_NULL_HANDLE;
         return false;
     }
     
-    if (vkBindBufferMemory(device, detectionBuffer, detectionBufferMemory, 0) != VK_SUCCESS) {
-        std::cerr << "[PoseOverlay] Failed to bind detection buffer memory" << std::endl;
-        vkDestroyBuffer(device, detectionBuffer, nullptr);
-        vkFreeMemory(device, detectionBufferMemory, nullptr);
-        detectionBuffer = VK_NULL_HANDLE;
-        detectionBufferMemory = VK_NULL_HANDLE;
+    if (vkBindBufferMemory(device, buffer, memory, 0) != VK_SUCCESS) {
+        std::cerr << "[PoseOverlay] Failed to bind buffer memory" << std::endl;
+        vkDestroyBuffer(device, buffer, nullptr);
+        vkFreeMemory(device, memory, nullptr);
+        buffer = VK_NULL_HANDLE;
+        memory = VK_NULL_HANDLE;
         return false;
     }
     
-    detectionBufferSize = requiredSize;
+    currentSize = requiredSize;
     return true;
 }
@@ -38,6 +38,18 @@ struct PoseOverlayPush
     uint32_t detectionCount;
 };
 
+// overlay_bin.comp: expands detections into primitives and bins them into 16x16 tiles.
+struct PoseBinPush
+{
+    glm::vec2 outputSize;
+    uint32_t detectionCount = 0;
+    uint32_t stage = 0; // 0 expand + count, 1 prefix sum, 2 scatter
+    uint32_t tilesX = 0;
+    uint32_t tilesY = 0;
+    uint32_t listCapacity = 0;
+    uint32_t padding = 0;
+};
+
 struct KeyPoint
 {
     float x = 0.0f;
@@ -63,6 +75,15 @@ public:
     
     static std::filesystem::path poseCoordsPath(const std::filesystem::path &videoPath);
     bool loadCoordsFile(const std::filesystem::path &coordsPath);
+
+    // Writable detection storage in the frame slot the next run() uses (persistently mapped).
+    // Filling it and passing the pointer back to run() skips the copy. Valid until that run().
+    DetectionEntry* acquireDetections(uint32_t count);
+
+    // Boxes, keypoints and skeleton limbs are binned into 16x16 tiles on the GPU first, so the
+    // draw costs the tiles they cover rather than pixels x detections. Keypoints (class_id >= 100)
+    // form one skeleton per run of increasing ids. Frame slots rotate, so run() only waits for
+    // the submission that last used the slot it is about to reuse.
     void run(ImageResource& target,
              uint32_t width,
              uint32_t height,
@@ -82,18 +103,37 @@ public:
     VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
     VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
     VkPipeline pipeline = VK_NULL_HANDLE;
+    VkPipeline binPipeline = VK_NULL_HANDLE;
     VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
-    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
     VkCommandPool commandPool = VK_NULL_HANDLE;
-    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
-    VkFence fence = VK_NULL_HANDLE;
-    VkDeviceSize detectionBufferSize = 0;
-    VkBuffer detectionBuffer = VK_NULL_HANDLE;
-    VkDeviceMemory detectionBufferMemory = VK_NULL_HANDLE;
 
 private:
     static constexpr size_t kKeypointCount = 17;
     static constexpr float kKeypointBoxSize = 0.018f;
+    static constexpr uint32_t kFrameSlots = 3;
+    static constexpr uint32_t kLimbsPerDetection = 15; // primitive slots per detection after its own
+    static constexpr uint32_t kTileListsPerTile = 64;  // average list capacity per tile
+    static constexpr uint32_t kPrimitiveBytes = 48;    // Primitive in overlay_bin.comp (std430)
+
+    // Per-slot GPU state; a slot is reused only after its fence signals.
+    struct FrameSlot
+    {
+        VkBuffer detectionBuffer = VK_NULL_HANDLE;      // host visible, persistently mapped
+        VkDeviceMemory detectionMemory = VK_NULL_HANDLE;
+        VkDeviceSize detectionSize = 0;
+        DetectionEntry* detectionsMapped = nullptr;
+        VkBuffer primitiveBuffer = VK_NULL_HANDLE;      // device local, written by overlay_bin.comp
+        VkDeviceMemory primitiveMemory = VK_NULL_HANDLE;
+        VkDeviceSize primitiveSize = 0;
+        VkBuffer binBuffer = VK_NULL_HANDLE;            // tile counts, starts, cursors, lists
+        VkDeviceMemory binMemory = VK_NULL_HANDLE;
+        VkDeviceSize binSize = 0;
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        VkImageView boundView = VK_NULL_HANDLE;         // descriptors are rewritten only on change
+        bool descriptorsDirty = true;
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+    };
 
     struct FramePose
     {
@@ -112,7 +152,15 @@ private:
     bool parseTxt(std::istream &lines);
     void storeFrame(int frame, const std::vector<float> &coords);
     glm::vec4 colorForLabel(const std::string &label);
-    bool ensureDetectionBuffer(VkDeviceSize requestedSize);
+    bool ensureSlotBuffers(FrameSlot& slot, uint32_t detectionCount, uint32_t tileCount);
+    bool ensureBuffer(VkBuffer& buffer,
+                      VkDeviceMemory& memory,
+                      VkDeviceSize& currentSize,
+                      VkDeviceSize requiredSize,
+                      VkBufferUsageFlags usage,
+                      VkMemoryPropertyFlags properties);
+    void destroySlot(FrameSlot& slot);
+    FrameSlot& waitForSlot(uint32_t index);
     
     std::unordered_map<int, std::vector<FramePose>> frameData_;
     std::unordered_map<int, std::vector<DetectionEntry>> detectionData_;
@@ -122,4 +170,6 @@ private:
     glm::vec4 keypointColor_{0.9f, 0.4f, 0.7f, 1.0f};
     bool valid_ = false;
     Engine2D* engine_ = nullptr;
+    std::array<FrameSlot, kFrameSlots> slots_{};
+    uint32_t nextSlot_ = 0;
 };
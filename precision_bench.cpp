@@ -0,0 +1,160 @@
+// precision_bench.cpp
+//
+// Banding and bandwidth of the RGBA intermediates (IntermediatePrecision). A 10-bit shadow ramp
+// is pushed through a shadow-lifting grade three ways: RGBA8 intermediates, RGBA8 with the TPDF
+// dither color_grading_pass.comp applies to an 8-bit output, and RGBA16F intermediates measured
+// as an 8-bit display would show them. Banding is reported as the largest step between
+// neighbouring pixels (a skipped code is a visible contour; with dither the step is noise) and
+// as the error of the locally averaged output, which is what the eye sees once the noise is
+// filtered out. The second table is the intermediate traffic of NV12->RGBA + grading
+// per frame. Per-pass GPU times are logged by motive2d --debug
+// --precision=8|16f.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+constexpr int kWidth = 3840;
+constexpr int kBoxRadius = 8; // local average over 17 px
+
+// Strong shadow lift, the kind of curve that exposes 8-bit intermediates
+float grade(float x)
+{
+    return std::pow(std::clamp(x, 0.0f, 1.0f), 0.45f);
+}
+
+float quantize8(float x)
+{
+    return std::round(std::clamp(x, 0.0f, 1.0f) * 255.0f) / 255.0f;
+}
+
+// Nearest half-float value (round to nearest even), including subnormals
+float quantizeHalf(float x)
+{
+    if (x == 0.0f)
+    {
+        return 0.0f;
+    }
+    int exponent = 0;
+    std::frexp(x, &exponent);
+    const float ulp = std::ldexp(1.0f, std::max(exponent, -13) - 11);
+    return std::nearbyint(x / ulp) * ulp;
+}
+
+// Mirrors hashPixel() / ditherNoise() in color_grading_pass.comp
+uint32_t hashPixel(uint32_t x, uint32_t y, uint32_t z)
+{
+    uint32_t h = (x * 0x8da6b343u) ^ (y * 0xd8163841u) ^ (z * 0xcb1ab31fu);
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    h *= 0x846ca68bu;
+    h ^= h >> 16;
+    return h;
+}
+
+float ditherNoise(uint32_t x, uint32_t y, uint32_t channel)
+{
+    const float a = static_cast<float>(hashPixel(x, y, channel * 2u) >> 8) * (1.0f / 16777216.0f);
+    const float b = static_cast<float>(hashPixel(x, y, channel * 2u + 1u) >> 8) * (1.0f / 16777216.0f);
+    return (a + b - 1.0f) / 255.0f;
+}
+
+struct BandingStats
+{
+    int levels = 0;
+    double largestStep = 0.0;      // 8-bit LSBs between neighbouring pixels
+    double averagedMaxError = 0.0; // 8-bit LSBs
+};
+
+BandingStats measure(const std::vector<float>& output, const std::vector<float>& exact)
+{
+    BandingStats stats;
+    std::vector<float> codes = output;
+    std::sort(codes.begin(), codes.end());
+    stats.levels = static_cast<int>(std::unique(codes.begin(), codes.end()) - codes.begin());
+    for (size_t i = 1; i < output.size(); ++i)
+    {
+        stats.largestStep = std::max(stats.largestStep, std::abs(static_cast<double>(output[i] - output[i - 1])) * 255.0);
+    }
+
+    for (int i = kBoxRadius; i + kBoxRadius < static_cast<int>(output.size()); ++i)
+    {
+        double sum = 0.0, sumExact = 0.0;
+        for (int k = -kBoxRadius; k <= kBoxRadius; ++k)
+        {
+            sum += output[i + k];
+            sumExact += exact[i + k];
+        }
+        const double error = std::abs(sum - sumExact) / (2 * kBoxRadius + 1) * 255.0;
+        stats.averagedMaxError = std::max(stats.averagedMaxError, error);
+    }
+    return stats;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h")
+        {
+            std::cout << "Usage: precision_bench\n";
+            return 0;
+        }
+    }
+
+    // 10-bit codes 64..255 (the bottom quarter of the range) stretched over one 4K row
+    std::vector<float> exact(kWidth), rgba8(kWidth), rgba8Dither(kWidth), half(kWidth);
+    for (int x = 0; x < kWidth; ++x)
+    {
+        const float code = std::round(64.0f + 191.0f * x / (kWidth - 1));
+        const float source = code / 1023.0f;
+        exact[x] = grade(source);
+        const float graded8 = grade(quantize8(source));
+        rgba8[x] = quantize8(graded8);
+        rgba8Dither[x] = quantize8(graded8 + ditherNoise(static_cast<uint32_t>(x), 0u, 0u));
+        half[x] = quantize8(quantizeHalf(grade(quantizeHalf(source))));
+    }
+
+    std::cout << "Banding after a shadow lift (10-bit ramp, " << kWidth << " px):\n";
+    std::cout << "   intermediate          levels   largest step (LSB)   averaged max err (LSB)\n";
+    std::cout << std::fixed << std::setprecision(3);
+    const struct
+    {
+        const char* name;
+        const std::vector<float>* output;
+    } rows[] = {{"rgba8", &rgba8}, {"rgba8 + dither", &rgba8Dither}, {"rgba16f", &half}};
+    for (const auto& row : rows)
+    {
+        const BandingStats stats = measure(*row.output, exact);
+        std::cout << "   " << std::left << std::setw(20) << row.name << std::right << std::setw(8) << stats.levels
+                  << std::setw(21) << stats.largestStep << std::setw(25) << stats.averagedMaxError << "\n";
+    }
+
+    // NV12->RGBA writes the intermediate once; grading reads it and writes its output
+    std::cout << "\nIntermediate traffic, NV12->RGBA + grading:\n";
+    std::cout << "   size        rgba8 MiB/frame   rgba16f MiB/frame   rgba8 GB/s@60   rgba16f GB/s@60\n";
+    std::cout << std::setprecision(1);
+    const struct
+    {
+        const char* name;
+        double pixels;
+    } sizes[] = {{"1920x1080", 1920.0 * 1080.0}, {"3840x2160", 3840.0 * 2160.0}};
+    for (const auto& size : sizes)
+    {
+        const double bytes8 = size.pixels * 4.0 * 3.0;
+        const double bytes16 = size.pixels * 8.0 * 3.0;
+        std::cout << "   " << std::left << std::setw(12) << size.name << std::right << std::setw(15)
+                  << bytes8 / (1024.0 * 1024.0) << std::setw(20) << bytes16 / (1024.0 * 1024.0) << std::setw(16)
+                  << bytes8 * 60.0 / 1e9 << std::setw(18) << bytes16 * 60.0 / 1e9 << "\n";
+    }
+    return 0;
+}
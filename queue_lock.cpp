@@ -0,0 +1,18 @@
+// queue_lock.cpp
+#include "queue_lock.h"
+
+#include <map>
+#include <memory>
+#include <utility>
+
+std::mutex& vulkanQueueMutex(uint32_t queueFamily, uint32_t queueIndex)
+{
+    static std::mutex tableMutex;
+    static std::map<std::pair<uint32_t, uint32_t>, std::unique_ptr<std::mutex>> table;
+
+    std::lock_guard<std::mutex> lk(tableMutex);
+    std::unique_ptr<std::mutex>& m = table[{queueFamily, queueIndex}];
+    if (!m)
+        m = std::make_unique<std::mutex>();
+    return *m;
+}
@@ -0,0 +1,11 @@
+// queue_lock.h
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+
+// One mutex per (queue family, queue index) of the engine's device. vkQueueSubmit and
+// vkQueuePresentKHR need their queue externally synchronised, and several threads submit to the
+// graphics queue: FFmpeg's decode contexts (AVVulkanDeviceContext::lock_queue), the render loop
+// and background workers such as ThumbnailStrip.
+std::mutex& vulkanQueueMutex(uint32_t queueFamily, uint32_t queueIndex = 0);
@@ -0,0 +1,191 @@
+// scopes_bench.cpp
+//
+// GPU cost of the grading scopes (GradingScopes: histogram, waveform and vectorscope
+// accumulation plus the overlay panel draw) against their per-frame budget of 0.5 ms. A frame of
+// random colours is graded headless by ColorGrading at 1920x1080 and 3840x2160, into RGBA8 and
+// RGBA16F outputs, and the scopes are recorded after it in the same command buffer. Each row is
+// the median of --iterations records, timed by the pass's own timestamp queries. Random colours
+// spread the accumulation over every bin, which is the worst case for the subgroup-merged
+// atomics. Exits non-zero when a row is over budget. Run from the repository root so
+// shaders/*.spv resolve.
+
+#include "color_grading_pass.h"
+#include "engine2d.h"
+#include "grading_scopes.h"
+#include "image_resource.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+constexpr double kScopeBudgetMs = 0.5;
+
+const VkExtent2D kExtents[] = {{1920, 1080}, {3840, 2160}};
+
+// Random RGBA8 texels, so every histogram bin and vectorscope cell is hit
+void fillRandom(Engine2D& engine, ImageResource& image)
+{
+    const VkDeviceSize size = VkDeviceSize(image.width) * image.height * 4u;
+    VkBuffer staging = VK_NULL_HANDLE;
+    VkDeviceMemory stagingMemory = VK_NULL_HANDLE;
+    engine.createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, staging,
+                        stagingMemory);
+    void* mapped = nullptr;
+    vkMapMemory(engine.logicalDevice, stagingMemory, 0, size, 0, &mapped);
+    std::mt19937 rng(41);
+    auto* texels = static_cast<uint32_t*>(mapped);
+    for (size_t i = 0; i < size / 4; ++i)
+        texels[i] = rng() | 0xff000000u;
+    vkUnmapMemory(engine.logicalDevice, stagingMemory);
+
+    VkCommandBuffer cmd = engine.beginSingleTimeCommands();
+    VkImageMemoryBarrier barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image.image;
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0,
+                         nullptr, 1, &barrier);
+    VkBufferImageCopy region{};
+    region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    region.imageExtent = VkExtent3D{image.width, image.height, 1};
+    vkCmdCopyBufferToImage(cmd, staging, image.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0,
+                         nullptr, 1, &barrier);
+    engine.endSingleTimeCommands(cmd);
+    image.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    vkDestroyBuffer(engine.logicalDevice, staging, nullptr);
+    vkFreeMemory(engine.logicalDevice, stagingMemory, nullptr);
+}
+
+// Median GPU time of GradingScopes::record over the graded frame. Recording a slot reads the
+// timestamps of that slot's previous record, so each sample is taken one record later.
+double medianScopesMs(Engine2D& engine, ColorGrading& grading, GradingScopes& scopes, int iterations)
+{
+    constexpr int kWarmupIterations = 3;
+    std::vector<double> samples;
+    for (int i = 0; i <= kWarmupIterations + iterations; ++i)
+    {
+        VkCommandBuffer cmd = engine.beginSingleTimeCommands();
+        grading.dispatch(cmd, 0);
+        scopes.record(cmd, 0, grading.output(0));
+        engine.endSingleTimeCommands(cmd);
+        if (i > kWarmupIterations)
+            samples.push_back(scopes.lastGpuMilliseconds());
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples.empty() ? 0.0 : samples[samples.size() / 2];
+}
+
+// Rows over budget for one frame size
+int runExtent(Engine2D& engine, VkSampler sampler, GradingScopes& scopes, VkExtent2D extent, int iterations)
+{
+    bool recreated = false;
+    // The constructor takes a resource to adopt from but does not read it
+    ImageResource input(&engine, input, extent.width, extent.height, VK_FORMAT_R8G8B8A8_UNORM, recreated,
+                        VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+    if (input.view == VK_NULL_HANDLE)
+        throw std::runtime_error("failed to create the input frame");
+    fillRandom(engine, input);
+
+    ColorAdjustments adjustments;
+    ColorGrading grading(&engine, 1);
+    grading.adjustments = &adjustments;
+    grading.setInputRGBA(input.view, sampler);
+
+    int over = 0;
+    for (VkFormat format : {VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_R16G16B16A16_SFLOAT})
+    {
+        grading.resize(extent, format);
+        const double ms = medianScopesMs(engine, grading, scopes, iterations);
+        if (ms > kScopeBudgetMs)
+            ++over;
+        std::cout << std::setw(11) << (std::to_string(extent.width) + "x" + std::to_string(extent.height))
+                  << std::setw(10) << (format == VK_FORMAT_R8G8B8A8_UNORM ? "RGBA8" : "RGBA16F") << std::setw(10)
+                  << ms << "   " << (ms <= kScopeBudgetMs ? "within" : "OVER") << "\n";
+    }
+    return over;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int iterations = 50;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h")
+        {
+            std::cout << "Usage: scopes_bench [--iterations=N]\n";
+            return 0;
+        }
+        if (arg.rfind("--iterations=", 0) == 0)
+        {
+            iterations = std::max(1, std::atoi(arg.substr(std::string("--iterations=").size()).c_str()));
+            continue;
+        }
+        std::cerr << "scopes_bench: unknown argument " << arg << " (see --help)" << std::endl;
+        return 1;
+    }
+
+    Engine2D engine;
+    if (!engine.initialize(false))
+    {
+        std::cerr << "scopes_bench: failed to initialise Vulkan" << std::endl;
+        return 1;
+    }
+    const VkPhysicalDeviceLimits& limits = engine.getDeviceProperties().limits;
+    if (!limits.timestampComputeAndGraphics || limits.timestampPeriod <= 0.0f)
+    {
+        std::cerr << "scopes_bench: device has no compute timestamps" << std::endl;
+        return 1;
+    }
+
+    int failures = 0;
+    VkSampler sampler = VK_NULL_HANDLE;
+    try
+    {
+        VkSamplerCreateInfo si{VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
+        si.magFilter = VK_FILTER_LINEAR;
+        si.minFilter = VK_FILTER_LINEAR;
+        si.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        si.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        si.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        if (vkCreateSampler(engine.logicalDevice, &si, nullptr, &sampler) != VK_SUCCESS)
+            throw std::runtime_error("failed to create the input sampler");
+
+        // Throws when the device lacks subgroup vote/ballot or format-less storage reads
+        GradingScopes scopes(&engine, 1);
+
+        std::cout << "Grading scopes on " << engine.getDeviceProperties().deviceName << ", median of " << iterations
+                  << " records, budget " << kScopeBudgetMs << " ms:\n";
+        std::cout << "      frame    output    GPU ms\n" << std::fixed << std::setprecision(3);
+        for (const VkExtent2D& extent : kExtents)
+            failures += runExtent(engine, sampler, scopes, extent, iterations);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "scopes_bench: " << e.what() << std::endl;
+        ++failures;
+    }
+    if (sampler != VK_NULL_HANDLE)
+        vkDestroySampler(engine.logicalDevice, sampler, nullptr);
+    return failures == 0 ? 0 : 1;
+}
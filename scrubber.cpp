@@ -1,8 +1,10 @@
 #include "scrubber.h"
 
 #include "engine2d.h"
+#include "thumbnail_strip.h"
 #include "utils.h"
 
+#include <algorithm>
 #include <stdexcept>
 
 static ScrubberPushConstants dummyPushConstants{};
@@ -82,3 +84,43 @@ bool cursorInPlayButton(double x, double y, int windowWidth, int windowHeight)
     const ScrubberUi ui = computeScrubberUi(windowWidth, windowHeight);
     return x >= ui.iconLeft && x <= ui.iconRight && y >= ui.iconTop && y <= ui.iconBottom;
 }
+
+double scrubberSeekSeconds(double x, int windowWidth, int windowHeight, double durationSeconds)
+{
+    const ScrubberUi ui = computeScrubberUi(windowWidth, windowHeight);
+    const double width = ui.right - ui.left;
+    if (width <= 0.0 || durationSeconds <= 0.0)
+        return 0.0;
+    return std::clamp((x - ui.left) / width, 0.0, 1.0) * durationSeconds;
+}
+
+bool scrubberHoverThumbnail(const ThumbnailStrip& thumbnails,
+                            double x,
+                            double y,
+                            int windowWidth,
+                            int windowHeight,
+                            ScrubberHover& out)
+{
+    const double kThumbnailGap = 8.0;
+
+    if (!cursorInScrubber(x, y, windowWidth, windowHeight))
+        return false;
+
+    const double seconds = scrubberSeekSeconds(x, windowWidth, windowHeight, thumbnails.durationSeconds());
+    uint32_t tile = 0;
+    if (!thumbnails.tileFor(seconds, tile))
+        return false;
+
+    const ScrubberUi ui = computeScrubberUi(windowWidth, windowHeight);
+    const VkExtent2D extent = thumbnails.tileExtent();
+    const double width = static_cast<double>(extent.width);
+    const double height = static_cast<double>(extent.height);
+    const double left = std::clamp(x - width * 0.5, 0.0, std::max(0.0, windowWidth - width));
+    const double top = std::max(0.0, ui.top - kThumbnailGap - height);
+
+    out.seconds = seconds;
+    out.tile = tile;
+    out.rect.offset = VkOffset2D{static_cast<int32_t>(left), static_cast<int32_t>(top)};
+    out.rect.extent = extent;
+    return true;
+}
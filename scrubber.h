@@ -6,6 +6,7 @@
 #include <glm/vec4.hpp>
 
 class Engine2D;
+class ThumbnailStrip;
 
 struct ScrubberPushConstants
 {
@@ -15,6 +16,25 @@ struct ScrubberPushConstants
     float _pad = 0.0f;
 };
 
+// Presentation time under cursor x on the scrubber bar, clamped to [0, durationSeconds].
+double scrubberSeekSeconds(double x, int windowWidth, int windowHeight, double durationSeconds);
+
+// Thumbnail for a cursor hovering the scrubber bar: the strip's tile for the time under the
+// cursor and where to draw it, centred over the cursor just above the bar and kept inside the
+// window (window pixels). False off the bar or while that tile is still being generated.
+struct ScrubberHover
+{
+    double seconds = 0.0;
+    uint32_t tile = 0;
+    VkRect2D rect{};
+};
+bool scrubberHoverThumbnail(const ThumbnailStrip& thumbnails,
+                            double x,
+                            double y,
+                            int windowWidth,
+                            int windowHeight,
+                            ScrubberHover& out);
+
 class Scrubber
 {
 public:
@@ -0,0 +1,157 @@
+// speed_bench.cpp
+//
+// Variable-speed and reverse playback: one DecoderVulkan played headless at each rate
+// (0.25x..16x forwards, then backwards) against its own clock, latched at a steady 60 Hz like
+// a display would. Each run reports the frame skip the decoder chose, decoded and shown frames
+// per second of wall time, decode work per displayed frame and frames dropped as superseded.
+// Forward runs start at 0, reverse runs at the end of the clip. Run from the repository root.
+
+#include "decoder_vulkan.h"
+#include "engine2d.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+constexpr double kTickHz = 60.0;
+// A seek's first frame must be up within this long
+constexpr double kLatchTimeoutSeconds = 5.0;
+
+bool runRate(DecoderVulkan& decoder, double rate, double seconds)
+{
+    decoder.setPlaybackRate(rate);
+    decoder.seek(rate < 0.0 ? static_cast<float>(decoder.getDurationSeconds()) : 0.0f);
+
+    // Wait for the seek's first frame so each run measures steady-state playback only
+    const auto latchStart = std::chrono::steady_clock::now();
+    while (decoder.awaitingFrame())
+    {
+        decoder.advancePlayback();
+        if (std::chrono::duration<double>(std::chrono::steady_clock::now() - latchStart).count() > kLatchTimeoutSeconds)
+        {
+            std::cerr << "speed_bench: " << rate << "x: no frame after seek" << std::endl;
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    const uint64_t decodedStart = decoder.getFramesDecoded();
+    const DecoderVulkan::SyncStats syncStart = decoder.getSyncStats();
+    const double mediaStart = decoder.presentationClock().seconds();
+
+    const auto tick = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(1.0 / kTickHz));
+    const auto wallStart = std::chrono::steady_clock::now();
+    auto next = wallStart;
+    double wall = 0.0;
+    while (wall < seconds)
+    {
+        decoder.advancePlayback();
+        if (decoder.isFinished() && !decoder.hasQueuedFrame())
+            break;
+
+        next += tick;
+        std::this_thread::sleep_until(next);
+        wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    }
+
+    const DecoderVulkan::SyncStats sync = decoder.getSyncStats();
+    const uint64_t decoded = decoder.getFramesDecoded() - decodedStart;
+    const uint64_t presented = sync.presented - syncStart.presented;
+    const uint64_t dropped = sync.dropped - syncStart.dropped;
+    const double media = std::abs(decoder.presentationClock().seconds() - mediaStart);
+    wall = std::max(wall, 1e-6);
+
+    std::ostringstream label;
+    label << std::showpos << rate << "x";
+    std::cout << std::setw(7) << label.str() << "  skip " << std::setw(14) << frameSkipName(decoder.getFrameSkip())
+              << "  media " << std::setw(6) << media << " s  decoded " << std::setw(7) << decoded / wall
+              << " fps  shown " << std::setw(6) << presented / wall << " fps  decoded/shown " << std::setw(6)
+              << (presented ? static_cast<double>(decoded) / presented : 0.0) << "  dropped " << std::setw(5)
+              << dropped << "\n";
+    return true;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    double seconds = 5.0;
+    std::vector<double> rates = {0.25, 0.5, 1.0, 2.0, 4.0, 8.0, 16.0, -1.0, -4.0, -16.0};
+    std::filesystem::path source;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h")
+        {
+            std::cout << "Usage: speed_bench [--seconds=S] [--speed=R] <video>\n";
+            return 0;
+        }
+        if (arg.rfind("--seconds=", 0) == 0)
+        {
+            seconds = std::max(1.0, std::atof(arg.substr(std::string("--seconds=").size()).c_str()));
+            continue;
+        }
+        if (arg.rfind("--speed=", 0) == 0)
+        {
+            rates = {std::atof(arg.substr(std::string("--speed=").size()).c_str())};
+            continue;
+        }
+        source = arg;
+    }
+
+    if (source.empty())
+    {
+        std::cerr << "speed_bench: no input video (see --help)" << std::endl;
+        return 1;
+    }
+
+    Engine2D engine;
+    if (!engine.initialize(false))
+    {
+        std::cerr << "speed_bench: failed to initialise Vulkan" << std::endl;
+        return 1;
+    }
+
+    DecoderVulkan decoder(source, &engine);
+    if (!decoder.valid)
+    {
+        std::cerr << "speed_bench: failed to open " << source << ": " << decoder.getHardwareInitFailureReason()
+                  << std::endl;
+        return 1;
+    }
+    decoder.startAsyncDecoding();
+
+    std::cout << source.filename().string() << " " << decoder.getWidth() << "x" << decoder.getHeight() << " @ "
+              << decoder.getFps() << " fps on " << engine.getDeviceProperties().deviceName << ", " << seconds
+              << " s per rate, latched at " << kTickHz << " Hz:\n";
+    std::cout << std::fixed << std::setprecision(2);
+
+    int failures = 0;
+    for (double rate : rates)
+    {
+        try
+        {
+            if (!runRate(decoder, rate, seconds))
+                ++failures;
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "speed_bench: " << rate << "x: " << e.what() << std::endl;
+            ++failures;
+        }
+    }
+
+    decoder.stopAsyncDecoding();
+    return failures == 0 ? 0 : 1;
+}
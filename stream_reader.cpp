@@ -0,0 +1,359 @@
+#include "stream_reader.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+extern "C" {
+#include <libavformat/avio.h>
+#include <libavutil/mem.h>
+}
+
+namespace
+{
+constexpr size_t kDirectIOAlignment = 4096;
+constexpr size_t kAvioBufferSize = 256 * 1024;
+
+int avioRead(void* opaque, uint8_t* buf, int size)
+{
+    auto* reader = static_cast<StreamReader*>(opaque);
+    const size_t n = reader->read(buf, static_cast<size_t>(size));
+    return n > 0 ? static_cast<int>(n) : AVERROR_EOF;
+}
+
+int64_t avioSeek(void* opaque, int64_t offset, int whence)
+{
+    auto* reader = static_cast<StreamReader*>(opaque);
+    if (whence & AVSEEK_SIZE)
+    {
+        return reader->size();
+    }
+    return reader->seek(offset, whence & ~AVSEEK_FORCE);
+}
+} // namespace
+
+StreamReader::StreamReader(const std::filesystem::path& path, const StreamReaderOptions& options)
+    : opts(options)
+{
+    opts.chunkSize = std::max<size_t>(opts.chunkSize, 64 * 1024);
+    if (path == "-")
+    {
+        fd = STDIN_FILENO;
+    }
+    else
+    {
+        int flags = O_RDONLY;
+#ifdef O_DIRECT
+        if (opts.directIO)
+        {
+            fd = open(path.c_str(), flags | O_DIRECT);
+            usingDirectIO = fd >= 0;
+        }
+#endif
+        if (fd < 0)
+        {
+            fd = open(path.c_str(), flags);
+        }
+        if (fd < 0)
+        {
+            std::cerr << "[StreamReader] Failed to open " << path << ": " << std::strerror(errno) << "\n";
+            return;
+        }
+        ownsFd = true;
+    }
+
+    struct stat st;
+    regularFile = (fstat(fd, &st) == 0) && S_ISREG(st.st_mode);
+    if (opts.directIO && !usingDirectIO)
+    {
+        std::cerr << "[StreamReader] O_DIRECT unavailable for " << path << ", using buffered reads\n";
+    }
+    if (usingDirectIO)
+    {
+        opts.chunkSize = (opts.chunkSize + kDirectIOAlignment - 1) & ~(kDirectIOAlignment - 1);
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    if (regularFile && opts.sequentialHint)
+    {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+#endif
+
+    for (auto& c : chunks)
+    {
+        void* mem = nullptr;
+        if (posix_memalign(&mem, kDirectIOAlignment, opts.chunkSize) != 0)
+        {
+            std::cerr << "[StreamReader] Failed to allocate read-ahead buffers\n";
+            if (ownsFd) close(fd);
+            fd = -1;
+            return;
+        }
+        c.data = static_cast<uint8_t*>(mem);
+    }
+
+    std::cout << "[StreamReader] Streaming " << path << " (" << (opts.chunkSize >> 10) << " KiB x2"
+              << (usingDirectIO ? ", O_DIRECT" : "") << (opts.follow ? ", follow" : "") << ")\n";
+    thread = std::thread(&StreamReader::readLoop, this);
+}
+
+StreamReader::~StreamReader()
+{
+    {
+        std::lock_guard<std::mutex> lk(m);
+        stopping = true;
+    }
+    cv.notify_all();
+    if (thread.joinable())
+    {
+        thread.join();
+    }
+    if (avio)
+    {
+        av_freep(&avio->buffer);
+        avio_context_free(&avio);
+    }
+    for (auto& c : chunks)
+    {
+        std::free(c.data);
+        c.data = nullptr;
+    }
+    if (ownsFd && fd >= 0)
+    {
+        close(fd);
+    }
+}
+
+size_t StreamReader::fillChunk(uint8_t* dst, int64_t offset, bool& hitEof)
+{
+    hitEof = false;
+    size_t filled = 0;
+    auto lastGrowth = std::chrono::steady_clock::now();
+    while (filled < opts.chunkSize)
+    {
+        ssize_t n = regularFile ? pread(fd, dst + filled, opts.chunkSize - filled, offset + static_cast<int64_t>(filled))
+                                : ::read(fd, dst + filled, opts.chunkSize - filled);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n < 0 && errno == EINVAL && usingDirectIO)
+        {
+            // The tail of a growing file may not satisfy O_DIRECT alignment; finish buffered.
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+            usingDirectIO = false;
+            continue;
+        }
+        if (n < 0)
+        {
+            std::cerr << "[StreamReader] read failed: " << std::strerror(errno) << "\n";
+            hitEof = true;
+            break;
+        }
+        if (n > 0)
+        {
+            filled += static_cast<size_t>(n);
+            lastGrowth = std::chrono::steady_clock::now();
+            // Pipes hand over whatever arrived so live input is not held back a whole chunk.
+            if (!regularFile)
+            {
+                break;
+            }
+            continue;
+        }
+        // n == 0: end of what has been written so far.
+        if (!opts.follow)
+        {
+            hitEof = true;
+            break;
+        }
+        if (filled > 0)
+        {
+            break;
+        }
+        const auto idle = std::chrono::steady_clock::now() - lastGrowth;
+        if (idle > std::chrono::milliseconds(opts.followTimeoutMs))
+        {
+            hitEof = true;
+            break;
+        }
+        {
+            std::unique_lock<std::mutex> lk(m);
+            if (cv.wait_for(lk, std::chrono::milliseconds(5), [&] { return stopping; }))
+            {
+                hitEof = true;
+                break;
+            }
+        }
+    }
+    return filled;
+}
+
+void StreamReader::readLoop()
+{
+    std::unique_lock<std::mutex> lk(m);
+    while (!stopping)
+    {
+        cv.wait(lk, [&] { return stopping || (!chunks[producerIndex].ready && !producerEof); });
+        if (stopping)
+        {
+            break;
+        }
+        const uint64_t gen = generation;
+        const int64_t offset = producerOffset;
+        // O_DIRECT needs block-aligned file offsets; skip the lead-in after the read.
+        const int64_t alignedOffset =
+            usingDirectIO ? (offset & ~static_cast<int64_t>(kDirectIOAlignment - 1)) : offset;
+        Chunk& chunk = chunks[producerIndex];
+        lk.unlock();
+
+        bool hitEof = false;
+        const size_t got = fillChunk(chunk.data, alignedOffset, hitEof);
+        const size_t skip = static_cast<size_t>(offset - alignedOffset);
+#ifdef POSIX_FADV_DONTNEED
+        if (regularFile && opts.dropCache && got > 0)
+        {
+            posix_fadvise(fd, alignedOffset, static_cast<off_t>(got), POSIX_FADV_DONTNEED);
+        }
+#endif
+
+        lk.lock();
+        if (gen != generation)
+        {
+            continue; // a seek landed while reading; this data is stale
+        }
+        if (got > skip)
+        {
+            chunk.size = got;
+            chunk.consumed = skip;
+            chunk.ready = true;
+            producerOffset = alignedOffset + static_cast<int64_t>(got);
+            totalBytesRead += got - skip;
+            producerIndex ^= 1;
+        }
+        producerEof = hitEof;
+        cv.notify_all();
+    }
+}
+
+size_t StreamReader::read(uint8_t* dst, size_t size)
+{
+    size_t total = 0;
+    std::unique_lock<std::mutex> lk(m);
+    while (total < size)
+    {
+        cv.wait(lk, [&] { return stopping || chunks[consumerIndex].ready || producerEof; });
+        Chunk& chunk = chunks[consumerIndex];
+        if (!chunk.ready)
+        {
+            break; // end of stream
+        }
+        const size_t take = std::min(size - total, chunk.size - chunk.consumed);
+        std::memcpy(dst + total, chunk.data + chunk.consumed, take);
+        chunk.consumed += take;
+        total += take;
+        consumerOffset += static_cast<int64_t>(take);
+        if (chunk.consumed == chunk.size)
+        {
+            chunk.ready = false;
+            consumerIndex ^= 1;
+            cv.notify_all();
+            // Return what we have rather than stall on the next read-ahead.
+            if (!chunks[consumerIndex].ready)
+            {
+                break;
+            }
+        }
+    }
+    return total;
+}
+
+int64_t StreamReader::seek(int64_t offset, int whence)
+{
+    if (!regularFile)
+    {
+        return -1;
+    }
+    int64_t target = offset;
+    if (whence == SEEK_CUR)
+    {
+        target = consumerOffset + offset;
+    }
+    else if (whence == SEEK_END)
+    {
+        target = size() + offset;
+    }
+    else if (whence != SEEK_SET)
+    {
+        return -1;
+    }
+    if (target < 0)
+    {
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> lk(m);
+    if (target == consumerOffset)
+    {
+        return target;
+    }
+    // Serve short forward seeks from the buffer that is already loaded.
+    Chunk& current = chunks[consumerIndex];
+    const int64_t ahead = target - consumerOffset;
+    if (current.ready && ahead > 0 && static_cast<size_t>(ahead) < current.size - current.consumed)
+    {
+        current.consumed += static_cast<size_t>(ahead);
+        consumerOffset = target;
+        return target;
+    }
+    ++generation;
+    for (auto& c : chunks)
+    {
+        c.ready = false;
+        c.size = c.consumed = 0;
+    }
+    producerIndex = consumerIndex = 0;
+    producerOffset = consumerOffset = target;
+    producerEof = false;
+    cv.notify_all();
+    return target;
+}
+
+int64_t StreamReader::size() const
+{
+    if (!regularFile)
+    {
+        return -1;
+    }
+    struct stat st;
+    return (fstat(fd, &st) == 0) ? static_cast<int64_t>(st.st_size) : -1;
+}
+
+AVIOContext* StreamReader::avioContext()
+{
+    if (avio || !valid())
+    {
+        return avio;
+    }
+    auto* buffer = static_cast<unsigned char*>(av_malloc(kAvioBufferSize));
+    if (!buffer)
+    {
+        return nullptr;
+    }
+    avio = avio_alloc_context(buffer, static_cast<int>(kAvioBufferSize), 0, this, avioRead, nullptr,
+                              regularFile ? avioSeek : nullptr);
+    if (!avio)
+    {
+        av_free(buffer);
+        return nullptr;
+    }
+    avio->seekable = regularFile ? AVIO_SEEKABLE_NORMAL : 0;
+    return avio;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+
+extern "C" {
+    struct AVIOContext;
+}
+
+struct StreamReaderOptions
+{
+    size_t chunkSize = 4u << 20;  // bytes per read-ahead buffer (two are kept)
+    bool directIO = false;        // O_DIRECT; falls back to buffered IO when unsupported
+    bool sequentialHint = true;   // posix_fadvise(POSIX_FADV_SEQUENTIAL)
+    bool dropCache = false;       // POSIX_FADV_DONTNEED on chunks already consumed
+    bool follow = false;          // keep waiting for data on a file that is still being written
+    int followTimeoutMs = 2000;   // stop following after this long without growth
+};
+
+// Sequential reader with a double-buffered read-ahead thread. Works on regular files,
+// pipes and stdin ("-"), including files that are still growing (follow mode).
+// Also exposes an AVIOContext so FFmpeg demuxers read through the same engine.
+class StreamReader
+{
+public:
+    explicit StreamReader(const std::filesystem::path& path, const StreamReaderOptions& options = {});
+    ~StreamReader();
+
+    StreamReader(const StreamReader&) = delete;
+    StreamReader& operator=(const StreamReader&) = delete;
+
+    bool valid() const { return fd >= 0; }
+    bool seekable() const { return regularFile; }
+
+    // Blocks until at least one byte is available; returns 0 only at end of stream.
+    size_t read(uint8_t* dst, size_t size);
+    // lseek semantics (SEEK_SET/SEEK_CUR/SEEK_END); -1 when the input is not seekable.
+    int64_t seek(int64_t offset, int whence);
+    int64_t position() const { return consumerOffset; }
+    // Current file size, or -1 for pipes.
+    int64_t size() const;
+
+    uint64_t bytesRead() const { return totalBytesRead.load(); }
+    const StreamReaderOptions& options() const { return opts; }
+
+    // Lazily created; owned by the reader.
+    AVIOContext* avioContext();
+
+private:
+    struct Chunk
+    {
+        uint8_t* data = nullptr;
+        size_t size = 0;      // valid bytes
+        size_t consumed = 0;  // bytes already handed to the consumer
+        bool ready = false;
+    };
+
+    void readLoop();
+    size_t fillChunk(uint8_t* dst, int64_t offset, bool& hitEof);
+
+    StreamReaderOptions opts;
+    int fd = -1;
+    bool ownsFd = false;
+    bool regularFile = false;
+    bool usingDirectIO = false;
+
+    std::array<Chunk, 2> chunks{};
+    size_t producerIndex = 0;
+    size_t consumerIndex = 0;
+    int64_t producerOffset = 0;
+    int64_t consumerOffset = 0;
+    uint64_t generation = 0; // bumped by seek(); stale reads are discarded
+    bool producerEof = false;
+    bool stopping = false;
+
+    mutable std::mutex m;
+    std::condition_variable cv;
+    std::thread thread;
+    std::atomic<uint64_t> totalBytesRead{0};
+
+    AVIOContext* avio = nullptr;
+};
@@ -0,0 +1,118 @@
+#include "subtitle.h"
+
+#include "font.h"
+
+Subtitle::Subtitle(const std::filesystem::path &path, Engine2D *engine)
+    : engine(engine)
+{
+    load(path); // SubtitleTimeline reports failures; an empty Subtitle draws nothing
+}
+
+bool Subtitle::run(VkCommandBuffer cmd, uint32_t frameIndex, Font &font, double currentTime, size_t maxLines)
+{
+    if (cmd == VK_NULL_HANDLE || !hasData())
+    {
+        return false;
+    }
+    present(font, currentTime, maxLines);
+    prefetch(font, currentTime);
+    font.update(frameIndex);
+    font.dispatch(cmd, frameIndex);
+    return !presented_.empty();
+}
+
+bool Subtitle::load(const std::filesystem::path &path)
+{
+    lines_.clear();
+    prefetchedFirst_ = UINT32_MAX;
+    presented_.clear();
+    if (!timeline_.loadJson(path))
+    {
+        return false;
+    }
+
+    const auto &segments = timeline_.segments();
+    lines_.reserve(segments.size());
+    for (const auto &segment : segments)
+    {
+        lines_.push_back(Line{segment.start, segment.end, segment.text});
+    }
+    return !lines_.empty();
+}
+
+std::vector<const Line *> Subtitle::activeLines(double currentTime, size_t maxLines) const
+{
+    std::vector<uint32_t> indices;
+    timeline_.activeSegments(currentTime, indices, maxLines);
+
+    std::vector<const Line *> active;
+    active.reserve(indices.size());
+    for (uint32_t i : indices)
+    {
+        active.push_back(&lines_[i]);
+    }
+    return active;
+}
+
+void Subtitle::prefetch(Font &font, double currentTime, size_t lineCount)
+{
+    std::vector<uint32_t> upcoming;
+    timeline_.upcomingSegments(currentTime, lineCount, upcoming);
+    if (upcoming.empty() || upcoming.front() == prefetchedFirst_)
+    {
+        return;
+    }
+    prefetchedFirst_ = upcoming.front();
+
+    std::vector<std::string> texts;
+    texts.reserve(upcoming.size());
+    for (uint32_t i : upcoming)
+    {
+        texts.push_back(lines_[i].text);
+    }
+    font.prefetchLines(texts);
+}
+
+void Subtitle::present(Font &font, double currentTime, size_t maxLines)
+{
+    font.setTime(currentTime);
+
+    timeline_.activeSegments(currentTime, activeScratch_, maxLines);
+    if (activeScratch_ == presented_)
+    {
+        return;
+    }
+    presented_ = activeScratch_;
+
+    std::vector<std::string> texts;
+    std::vector<Font::LineTiming> timings;
+    texts.reserve(presented_.size());
+    timings.reserve(presented_.size());
+    for (uint32_t i : presented_)
+    {
+        const SubtitleSegment &segment = timeline_.segments()[i];
+        texts.push_back(segment.text);
+
+        Font::LineTiming timing;
+        timing.start = segment.start;
+        timing.end = segment.end;
+        timing.words.reserve(segment.words.size());
+        double previousEnd = segment.start;
+        for (const SubtitleWord &word : segment.words)
+        {
+            // Untimed words light up together with the end of the word before them.
+            if (word.end > word.start)
+            {
+                timing.words.push_back(Font::WordTiming{word.start, word.end});
+                previousEnd = word.end;
+            }
+            else
+            {
+                timing.words.push_back(Font::WordTiming{previousEnd, previousEnd});
+            }
+        }
+        timings.push_back(std::move(timing));
+    }
+    font.setLines(std::move(texts));
+    font.setLineTimings(std::move(timings));
+}
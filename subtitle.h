@@ -11,9 +11,11 @@
 #include "display2d.h"
 #include "engine2d.h"
 #include "fps.h"
+#include "subtitle_timeline.h"
 #include "text.h"
 
 class Engine2D;
+class Font;
 
 struct SubtitleLineResource
 {
@@ -53,62 +55,38 @@ struct Line
 };
 
 
-struct SubtitleWord
-{
-    double start = 0.0;
-    double end = 0.0;
-    std::string text;
-};
-
-struct SubtitleSegment
-{
-    double start = 0.0;
-    double end = 0.0;
-    std::string text;
-    std::vector<SubtitleWord> words;
-};
-
-
 class Subtitle
 {
 public:
     Subtitle(const std::filesystem::path &path, Engine2D* engine);
-    ~Subtitle();
-    bool run(Engine2D *engine,
-             SubtitleOverlayResources &resources,
-             const Subtitle &overlay,
-             double currentTime,
-             uint32_t fbWidth,
-             uint32_t fbHeight,
-             glm::vec2 overlayCenter,
-             glm::vec2 overlaySize,
-             ImageResource &overlayTarget,
-             VkSampler overlaySampler,
-             VkSampler fallbackSampler,
-             size_t maxLines = 2,
-             bool enableBackground = true);
+    ~Subtitle() = default;
+
+    // Records the overlay for currentTime into the caller's command buffer: present() and
+    // prefetch() into font, then font's atlas uploads and text dispatch. Nothing is submitted
+    // or waited on here; call it once the frame slot's fence has signalled, like Font::update().
+    // Returns false when there is nothing to draw.
+    bool run(VkCommandBuffer cmd, uint32_t frameIndex, Font &font, double currentTime, size_t maxLines = 2);
     Engine2D* engine = nullptr;
 
     bool load(const std::filesystem::path &path);
     bool hasData() const { return !lines_.empty(); }
+    // O(log n) via the timeline index; safe for seeks and backward scrubbing.
     std::vector<const Line *> activeLines(double currentTime, size_t maxLines = 2) const;
-
-    std::vector<Line> lines_;
-    mutable size_t lastIndex_ = 0;
-
-    VkDevice device = VK_NULL_HANDLE;
-    VkQueue queue = VK_NULL_HANDLE;
-    uint32_t queueFamily = 0;
-    VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
-    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
-    VkPipeline pipeline = VK_NULL_HANDLE;
-    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
-    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
-    VkCommandPool commandPool = VK_NULL_HANDLE;
-    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
-    VkFence fence = VK_NULL_HANDLE;
-
-
-    void destroySubtitleOverlayResources(Engine2D *engine, SubtitleOverlayResources &resources);
+    const SubtitleTimeline &timeline() const { return timeline_; }
+
+    // Lays out the next `lineCount` segments into font's glyph/line caches before they show.
+    // Cheap to call every frame; does nothing until the upcoming set changes.
+    void prefetch(Font &font, double currentTime, size_t lineCount = 3);
+
+    // Karaoke display through Font: hands the active segments and their word timings to
+    // font only when the active set changes; otherwise just advances font's clock, so a
+    // steady frame costs a push constant and no glyph upload.
+    void present(Font &font, double currentTime, size_t maxLines = 2);
+
+    std::vector<Line> lines_; // parallel to timeline_.segments()
+    SubtitleTimeline timeline_;
+    uint32_t prefetchedFirst_ = UINT32_MAX; // first upcoming segment at the last prefetch()
+    std::vector<uint32_t> presented_;       // segments last handed to present()'s font
+    std::vector<uint32_t> activeScratch_;
 };
 class Engine2D;
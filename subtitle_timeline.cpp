@@ -0,0 +1,217 @@
+#include "subtitle_timeline.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <nlohmann/json.hpp>
+
+namespace
+{
+bool readTime(const nlohmann::json& node, const char* key, double& out)
+{
+    auto it = node.find(key);
+    if (it == node.end() || !it->is_number())
+    {
+        return false;
+    }
+    out = it->get<double>();
+    return true;
+}
+
+std::string readText(const nlohmann::json& node, const char* key)
+{
+    auto it = node.find(key);
+    return (it != node.end() && it->is_string()) ? it->get<std::string>() : std::string();
+}
+} // namespace
+
+bool SubtitleTimeline::loadJson(const std::filesystem::path& path)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cerr << "[SubtitleTimeline] Failed to open " << path << "\n";
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+
+    std::vector<SubtitleSegment> segments;
+    try
+    {
+        const auto document = nlohmann::json::parse(buffer.str());
+        const nlohmann::json* list = &document;
+        if (document.is_object())
+        {
+            auto it = document.find("segments");
+            if (it == document.end())
+            {
+                std::cerr << "[SubtitleTimeline] No \"segments\" in " << path << "\n";
+                return false;
+            }
+            list = &*it;
+        }
+        if (!list->is_array())
+        {
+            return false;
+        }
+
+        segments.reserve(list->size());
+        for (const auto& entry : *list)
+        {
+            SubtitleSegment segment;
+            if (!readTime(entry, "start", segment.start) || !readTime(entry, "end", segment.end))
+            {
+                continue;
+            }
+            segment.text = readText(entry, "text");
+            auto words = entry.find("words");
+            if (words != entry.end() && words->is_array())
+            {
+                segment.words.reserve(words->size());
+                for (const auto& w : *words)
+                {
+                    SubtitleWord word;
+                    word.text = readText(w, "word");
+                    // Untimed words (WhisperX leaves numerals unaligned) get an empty interval.
+                    if (!readTime(w, "start", word.start) || !readTime(w, "end", word.end))
+                    {
+                        word.start = word.end = -1.0;
+                    }
+                    segment.words.push_back(std::move(word));
+                }
+            }
+            segments.push_back(std::move(segment));
+        }
+    }
+    catch (const nlohmann::json::exception& e)
+    {
+        std::cerr << "[SubtitleTimeline] Failed to parse " << path << ": " << e.what() << "\n";
+        return false;
+    }
+
+    setSegments(std::move(segments));
+    std::cout << "[SubtitleTimeline] Loaded " << segments_.size() << " segments, " << words_.size()
+              << " timed words from " << path << "\n";
+    return !segments_.empty();
+}
+
+void SubtitleTimeline::setSegments(std::vector<SubtitleSegment> segments)
+{
+    segments_ = std::move(segments);
+    std::stable_sort(segments_.begin(), segments_.end(),
+                     [](const SubtitleSegment& a, const SubtitleSegment& b) { return a.start < b.start; });
+
+    segmentIndex_ = IntervalIndex{};
+    segmentIndex_.starts.reserve(segments_.size());
+    segmentIndex_.ends.reserve(segments_.size());
+    words_.clear();
+    for (uint32_t s = 0; s < segments_.size(); ++s)
+    {
+        const auto& segment = segments_[s];
+        segmentIndex_.starts.push_back(segment.start);
+        segmentIndex_.ends.push_back(segment.end);
+        for (uint32_t w = 0; w < segment.words.size(); ++w)
+        {
+            if (segment.words[w].end > segment.words[w].start)
+            {
+                words_.push_back(WordRef{s, w});
+            }
+        }
+    }
+    segmentIndex_.build();
+
+    std::stable_sort(words_.begin(), words_.end(),
+                     [&](const WordRef& a, const WordRef& b) { return word(a).start < word(b).start; });
+    wordIndex_ = IntervalIndex{};
+    wordIndex_.starts.reserve(words_.size());
+    wordIndex_.ends.reserve(words_.size());
+    for (const auto& ref : words_)
+    {
+        wordIndex_.starts.push_back(word(ref).start);
+        wordIndex_.ends.push_back(word(ref).end);
+    }
+    wordIndex_.build();
+}
+
+void SubtitleTimeline::IntervalIndex::build()
+{
+    subtreeMaxEnd.assign(starts.size(), 0.0);
+    buildRange(0, starts.size());
+}
+
+double SubtitleTimeline::IntervalIndex::buildRange(size_t lo, size_t hi)
+{
+    if (lo >= hi)
+    {
+        return -std::numeric_limits<double>::infinity();
+    }
+    const size_t mid = lo + (hi - lo) / 2;
+    const double maxEnd = std::max({ends[mid], buildRange(lo, mid), buildRange(mid + 1, hi)});
+    subtreeMaxEnd[mid] = maxEnd;
+    return maxEnd;
+}
+
+template <typename Emit>
+bool SubtitleTimeline::IntervalIndex::query(size_t lo, size_t hi, double t, Emit& emit) const
+{
+    if (lo >= hi)
+    {
+        return true;
+    }
+    const size_t mid = lo + (hi - lo) / 2;
+    if (subtreeMaxEnd[mid] <= t)
+    {
+        return true; // everything in [lo, hi) has ended
+    }
+    if (!query(lo, mid, t, emit))
+    {
+        return false;
+    }
+    if (starts[mid] > t)
+    {
+        return true; // mid and everything right of it start later
+    }
+    if (ends[mid] > t && !emit(mid))
+    {
+        return false;
+    }
+    return query(mid + 1, hi, t, emit);
+}
+
+void SubtitleTimeline::activeSegments(double t, std::vector<uint32_t>& out, size_t maxCount) const
+{
+    out.clear();
+    if (maxCount == 0)
+    {
+        return;
+    }
+    auto emit = [&](size_t i) {
+        out.push_back(uint32_t(i));
+        return out.size() < maxCount;
+    };
+    segmentIndex_.query(0, segmentIndex_.starts.size(), t, emit);
+}
+
+void SubtitleTimeline::activeWords(double t, std::vector<WordRef>& out) const
+{
+    out.clear();
+    auto emit = [&](size_t i) {
+        out.push_back(words_[i]);
+        return true;
+    };
+    wordIndex_.query(0, wordIndex_.starts.size(), t, emit);
+}
+
+void SubtitleTimeline::upcomingSegments(double t, size_t count, std::vector<uint32_t>& out) const
+{
+    out.clear();
+    const auto& starts = segmentIndex_.starts;
+    const size_t first = size_t(std::upper_bound(starts.begin(), starts.end(), t) - starts.begin());
+    for (size_t i = first; i < starts.size() && out.size() < count; ++i)
+    {
+        out.push_back(uint32_t(i));
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <string>
+#include <vector>
+
+struct SubtitleWord
+{
+    double start = 0.0;
+    double end = 0.0;
+    std::string text;
+};
+
+struct SubtitleSegment
+{
+    double start = 0.0;
+    double end = 0.0;
+    std::string text;
+    std::vector<SubtitleWord> words;
+};
+
+// Time-sorted subtitle segments and words with interval indexes, so "what is on screen at t"
+// costs O(log n + hits) wherever t lands (seeks and backward scrubbing included).
+//
+// Each index is an implicit balanced tree over intervals sorted by start: node `mid` of the
+// range [lo, hi) stores the max end in that range, and the query skips subtrees whose max end
+// is <= t or whose starts are > t.
+class SubtitleTimeline
+{
+public:
+    struct WordRef
+    {
+        uint32_t segment = 0;
+        uint32_t word = 0;
+    };
+
+    // WhisperX-style JSON: {"segments": [{"start", "end", "text", "words": [{"word", "start", "end"}]}]}
+    // (a bare array of segments is accepted too). Words without timestamps stay in the
+    // segment text but are left out of the word index.
+    bool loadJson(const std::filesystem::path& path);
+    void setSegments(std::vector<SubtitleSegment> segments);
+
+    bool empty() const { return segments_.empty(); }
+    const std::vector<SubtitleSegment>& segments() const { return segments_; }
+    const SubtitleWord& word(const WordRef& ref) const { return segments_[ref.segment].words[ref.word]; }
+
+    // Segments with start <= t < end, in start order, at most maxCount.
+    void activeSegments(double t, std::vector<uint32_t>& out,
+                        size_t maxCount = std::numeric_limits<size_t>::max()) const;
+    // Timed words with start <= t < end, in start order.
+    void activeWords(double t, std::vector<WordRef>& out) const;
+    // The next `count` segments that start after t, nearest first (for prefetching).
+    void upcomingSegments(double t, size_t count, std::vector<uint32_t>& out) const;
+
+private:
+    struct IntervalIndex
+    {
+        std::vector<double> starts;        // sorted
+        std::vector<double> ends;
+        std::vector<double> subtreeMaxEnd; // at each range's midpoint
+
+        void build();
+        double buildRange(size_t lo, size_t hi);
+        // Calls emit(i) for active intervals in start order; stops when emit returns false.
+        template <typename Emit>
+        bool query(size_t lo, size_t hi, double t, Emit& emit) const;
+    };
+
+    std::vector<SubtitleSegment> segments_;
+    IntervalIndex segmentIndex_;
+    std::vector<WordRef> words_; // sorted by start, parallel to wordIndex_
+    IntervalIndex wordIndex_;
+};
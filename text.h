@@ -29,6 +29,9 @@ class Engine2D;
 //   ivec2 imageSize
 //   ivec2 tileGridSize
 //   float sdfPxRange
+//   float time               (seconds; karaoke glyphs, flag bit2)
+//   float fadeSeconds
+//   vec4  highlightColor
 
 class Text
 {
@@ -49,8 +52,11 @@ public:
         float u0 = 0, v0 = 0, u1 = 0, v1 = 0;   // atlas UV rect
         glm::vec4 textColor{1, 1, 1, 1};        // rgba
         glm::vec4 bgColor{0, 0, 0, 0};          // rgba (optional)
-        uint32_t flags = 0;                     // bit0: bg enable, etc.
+        uint32_t flags = 0;                     // bit0: bg enable, bit1: MSDF atlas entry, bit2: timed
         uint32_t _pad0 = 0, _pad1 = 0, _pad2 = 0;
+        // Timed glyphs (bit2), in seconds: x..y is when the highlight sweeps left to right
+        // across the quad, z..w is when the glyph is visible (faded in/out over fadeSeconds).
+        glm::vec4 timing{0, 0, 0, 0};
     };
 
     struct TileSpan
@@ -78,10 +84,18 @@ public:
     // Input atlas (borrowed).
     // Atlas should be in SHADER_READ_ONLY_OPTIMAL when sampled.
     void setAtlas(VkImageView atlasView, VkSampler atlasSampler);
+    // Rebinds the atlas for one frame slot only, so the other slots' sets are not rewritten
+    // while their command buffers may still be pending. Call after the slot's fence.
+    void setAtlas(uint32_t frameIndex, VkImageView atlasView, VkSampler atlasSampler);
 
     // Optional tuning constant for your SDF bake.
     void setSdfPxRange(float pxRange);
 
+    // Per-frame clock for timed glyphs; only a push constant, the uploaded glyphs stay valid.
+    void setTime(float seconds);
+    // Colour timed glyphs take once the sweep passes them, and their fade in/out duration.
+    void setHighlight(const glm::vec4& color, float fadeSeconds);
+
     // Upload per-frame data for the shader.
     // spans.size() MUST equal tileGridSize.x * tileGridSize.y for current output extent.
     // glyphs.size() must be <= maxGlyphs, tileGlyphs.size() <= maxTileGlyphRefs.
@@ -169,4 +183,7 @@ private:
     // Dispatch metadata
     glm::ivec2 tileGridSize_{0, 0};
     float sdfPxRange_ = 8.0f;
+    float time_ = 0.0f;
+    float fadeSeconds_ = 0.0f;
+    glm::vec4 highlightColor_{1, 1, 1, 1};
 };
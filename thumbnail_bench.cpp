@@ -0,0 +1,147 @@
+// thumbnail_bench.cpp
+//
+// Scrubber thumbnail generation: a ThumbnailStrip built for one video, headless, first cold
+// (keyframe seeks + decodes, GPU downscale into the atlas, then the disk cache write) and then
+// warm (the same strip loaded back from the disk cache). Each run reports wall time to the last
+// tile, per-tile cost, keyframes decoded against tiles copied from a shared keyframe, and the
+// open / decode / convert split; the cold run is also given per hour of video, for comparing
+// clips of other lengths. An hour of 4K HEVC is the intended input. The cache goes to a fresh
+// directory under the temp directory unless --cache-dir is given. Run from the repository root
+// so shaders/*.spv resolve.
+
+#include "engine2d.h"
+#include "thumbnail_strip.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace
+{
+bool runStrip(Engine2D& engine, const std::filesystem::path& source, const ThumbnailStripOptions& options, const char* label)
+{
+    const auto start = std::chrono::steady_clock::now();
+    ThumbnailStrip strip(&engine, source, options);
+
+    uint32_t reported = 0;
+    while (!strip.finished())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        const uint32_t ready = strip.ready();
+        if (strip.count() > 0 && ready >= reported + std::max(1u, strip.count() / 8))
+        {
+            reported = ready;
+            std::cout << "  " << label << ": " << ready << "/" << strip.count() << " tiles after "
+                      << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s\n";
+        }
+    }
+
+    if (!strip.error().empty())
+    {
+        std::cerr << "thumbnail_bench: " << label << ": " << strip.error() << std::endl;
+        return false;
+    }
+
+    const ThumbnailStripStats st = strip.stats();
+    const VkExtent2D tile = strip.tileExtent();
+    const VkExtent2D atlas = strip.atlasExtent();
+    const double perTileMs = st.tiles ? st.totalSeconds * 1000.0 / st.tiles : 0.0;
+    std::cout << std::setw(5) << label << "  " << st.tiles << " tiles " << tile.width << "x" << tile.height << " (atlas "
+              << atlas.width << "x" << atlas.height << ")" << (st.fromDiskCache ? " from disk cache" : "") << "  total "
+              << std::setw(7) << st.totalSeconds << " s  " << std::setw(7) << perTileMs << " ms/tile";
+    if (!st.fromDiskCache)
+    {
+        const double hours = strip.durationSeconds() / 3600.0;
+        std::cout << "  decoded " << st.decoded << " reused " << st.reused << "  open " << st.openSeconds << " s decode "
+                  << st.decodeSeconds << " s convert " << st.convertSeconds << " s  "
+                  << (hours > 0.0 ? st.totalSeconds / hours : 0.0) << " s per hour of video";
+    }
+    std::cout << "\n";
+    return true;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    ThumbnailStripOptions options;
+    std::filesystem::path source;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h")
+        {
+            std::cout << "Usage: thumbnail_bench [--tiles=N] [--tile-width=W] [--cache-dir=DIR] <video>\n";
+            return 0;
+        }
+        if (arg.rfind("--tiles=", 0) == 0)
+        {
+            options.tiles = static_cast<uint32_t>(std::max(0, std::atoi(arg.substr(std::string("--tiles=").size()).c_str())));
+            continue;
+        }
+        if (arg.rfind("--tile-width=", 0) == 0)
+        {
+            options.tileWidth = static_cast<uint32_t>(std::max(2, std::atoi(arg.substr(std::string("--tile-width=").size()).c_str())));
+            continue;
+        }
+        if (arg.rfind("--cache-dir=", 0) == 0)
+        {
+            options.cacheDirectory = arg.substr(std::string("--cache-dir=").size());
+            continue;
+        }
+        source = arg;
+    }
+
+    if (source.empty())
+    {
+        std::cerr << "thumbnail_bench: no input video (see --help)" << std::endl;
+        return 1;
+    }
+
+    // A fresh cache directory, so the first run really generates
+    bool ownCacheDirectory = false;
+    if (options.cacheDirectory.empty())
+    {
+        std::error_code ec;
+        options.cacheDirectory = std::filesystem::temp_directory_path(ec) /
+                                 ("thumbnail_bench_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+        ownCacheDirectory = true;
+    }
+
+    Engine2D engine;
+    if (!engine.initialize(false))
+    {
+        std::cerr << "thumbnail_bench: failed to initialise Vulkan" << std::endl;
+        return 1;
+    }
+
+    std::cout << source.filename().string() << " on " << engine.getDeviceProperties().deviceName << ", cache in "
+              << options.cacheDirectory << ":\n";
+    std::cout << std::fixed << std::setprecision(2);
+
+    int failures = 0;
+    try
+    {
+        if (!runStrip(engine, source, options, "cold"))
+            ++failures;
+        else if (!runStrip(engine, source, options, "warm"))
+            ++failures;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "thumbnail_bench: " << e.what() << std::endl;
+        ++failures;
+    }
+
+    if (ownCacheDirectory)
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(options.cacheDirectory, ec);
+    }
+    return failures == 0 ? 0 : 1;
+}
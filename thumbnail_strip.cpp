@@ -0,0 +1,868 @@
+// thumbnail_strip.cpp
+// Background keyframe decode -> YUV->RGBA downscale at tile size -> copy into one atlas image.
+
+#include "thumbnail_strip.h"
+
+#include "decoder_vulkan.h"
+#include "engine2d.h"
+#include "nv12_to_rgba.h"
+#include "queue_lock.h"
+#include "yuv420p_to_rgba.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+constexpr char kCacheMagic[8] = {'M', '2', 'D', 'T', 'H', 'U', 'M', 'B'};
+constexpr uint32_t kCacheVersion = 1;
+constexpr VkFormat kAtlasFormat = VK_FORMAT_R8G8B8A8_UNORM;
+
+// Disk cache file: this header, one double per tile (the time it shows), then the atlas as
+// tightly packed RGBA8 rows.
+struct CacheHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t tiles;
+    uint32_t tileWidth;
+    uint32_t tileHeight;
+    uint32_t columns;
+    uint32_t rows;
+    uint64_t sourceBytes;
+    int64_t sourceWriteTime;
+    double durationSeconds;
+};
+
+// Size and modification time of the video; a cached atlas is only used while both match.
+bool sourceStamp(const std::filesystem::path& path, uint64_t& bytes, int64_t& writeTime)
+{
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(path, ec);
+    if (ec)
+        return false;
+    const auto time = std::filesystem::last_write_time(path, ec);
+    if (ec)
+        return false;
+    bytes = static_cast<uint64_t>(size);
+    writeTime = static_cast<int64_t>(time.time_since_epoch().count());
+    return true;
+}
+
+// FNV-1a, so cache file names stay the same across builds
+uint64_t stableHash(const std::string& text)
+{
+    uint64_t hash = 1469598103934665603ull;
+    for (unsigned char c : text)
+    {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+void imageBarrier(VkCommandBuffer cmd,
+                  VkImage image,
+                  VkImageLayout oldLayout,
+                  VkImageLayout newLayout,
+                  uint32_t srcQF,
+                  uint32_t dstQF,
+                  VkPipelineStageFlags srcStage,
+                  VkAccessFlags srcAccess,
+                  VkPipelineStageFlags dstStage,
+                  VkAccessFlags dstAccess)
+{
+    if (image == VK_NULL_HANDLE)
+        return;
+
+    VkImageMemoryBarrier b{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+    b.srcAccessMask = srcAccess;
+    b.dstAccessMask = dstAccess;
+    b.oldLayout = oldLayout;
+    b.newLayout = newLayout;
+    b.srcQueueFamilyIndex = srcQF == dstQF ? VK_QUEUE_FAMILY_IGNORED : srcQF;
+    b.dstQueueFamilyIndex = srcQF == dstQF ? VK_QUEUE_FAMILY_IGNORED : dstQF;
+    b.image = image;
+    b.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    b.subresourceRange.levelCount = 1;
+    b.subresourceRange.layerCount = 1;
+
+    vkCmdPipelineBarrier(cmd, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &b);
+}
+
+// Atlas writes visible to whatever reads it next, on this or a later submission (render-thread
+// blits, the next tile copy, the disk cache readback)
+void publishAtlasWrites(VkCommandBuffer cmd, VkImage atlas)
+{
+    imageBarrier(cmd,
+                 atlas,
+                 VK_IMAGE_LAYOUT_GENERAL,
+                 VK_IMAGE_LAYOUT_GENERAL,
+                 VK_QUEUE_FAMILY_IGNORED,
+                 VK_QUEUE_FAMILY_IGNORED,
+                 VK_PIPELINE_STAGE_TRANSFER_BIT,
+                 VK_ACCESS_TRANSFER_WRITE_BIT,
+                 VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                 VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT);
+}
+
+VkImageSubresourceLayers colorLayers()
+{
+    VkImageSubresourceLayers layers{};
+    layers.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    layers.layerCount = 1;
+    return layers;
+}
+
+// Views of one decoded frame's planes, destroyed once its tile has been converted
+struct PlaneViews
+{
+    VkDevice device = VK_NULL_HANDLE;
+    std::array<VkImageView, 3> views{VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE};
+
+    ~PlaneViews()
+    {
+        for (VkImageView view : views)
+            if (view != VK_NULL_HANDLE)
+                vkDestroyImageView(device, view, nullptr);
+    }
+};
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+} // namespace
+
+std::filesystem::path thumbnailCacheDirectory()
+{
+    const char* xdg = std::getenv("XDG_CACHE_HOME");
+    if (xdg && *xdg)
+        return std::filesystem::path(xdg) / "motive2d" / "thumbnails";
+
+    const char* home = std::getenv("HOME");
+    if (home && *home)
+        return std::filesystem::path(home) / ".cache" / "motive2d" / "thumbnails";
+
+    std::error_code ec;
+    const std::filesystem::path temp = std::filesystem::temp_directory_path(ec);
+    return (ec ? std::filesystem::path(".") : temp) / "motive2d-thumbnails";
+}
+
+ThumbnailStrip::ThumbnailStrip(Engine2D* engine, const std::filesystem::path& videoPath, const ThumbnailStripOptions& options)
+    : engine_(engine), videoPath_(videoPath), options_(options)
+{
+    if (!engine_ || engine_->logicalDevice == VK_NULL_HANDLE)
+        throw std::runtime_error("ThumbnailStrip requires a valid Engine2D");
+
+    worker_ = std::thread(&ThumbnailStrip::run_, this);
+}
+
+ThumbnailStrip::~ThumbnailStrip()
+{
+    stopRequested_.store(true);
+    if (worker_.joinable())
+        worker_.join();
+
+    if (!engine_ || engine_->logicalDevice == VK_NULL_HANDLE)
+        return;
+
+    // Render-thread blits may still be reading the atlas
+    vkDeviceWaitIdle(engine_->logicalDevice);
+    if (atlasView_ != VK_NULL_HANDLE)
+        vkDestroyImageView(engine_->logicalDevice, atlasView_, nullptr);
+    if (atlasImage_ != VK_NULL_HANDLE)
+        vkDestroyImage(engine_->logicalDevice, atlasImage_, nullptr);
+    if (atlasMemory_ != VK_NULL_HANDLE)
+        vkFreeMemory(engine_->logicalDevice, atlasMemory_, nullptr);
+}
+
+VkExtent2D ThumbnailStrip::tileExtent() const
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    return VkExtent2D{tileWidth_, tileHeight_};
+}
+
+VkExtent2D ThumbnailStrip::atlasExtent() const
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    return VkExtent2D{tileWidth_ * columns_, tileHeight_ * rows_};
+}
+
+double ThumbnailStrip::durationSeconds() const
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    return durationSeconds_;
+}
+
+std::string ThumbnailStrip::error() const
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    return error_;
+}
+
+ThumbnailStripStats ThumbnailStrip::stats() const
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    return stats_;
+}
+
+bool ThumbnailStrip::tileFor(double seconds, uint32_t& tile) const
+{
+    const uint32_t tiles = count();
+    const double duration = durationSeconds();
+    if (tiles == 0 || !(duration > 0.0))
+        return false;
+
+    const double position = std::clamp(seconds / duration, 0.0, 1.0) * static_cast<double>(tiles);
+    tile = std::min(tiles - 1, static_cast<uint32_t>(position));
+    return tile < ready();
+}
+
+double ThumbnailStrip::tileSeconds(uint32_t tile) const
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    return tile < tileSeconds_.size() ? tileSeconds_[tile] : 0.0;
+}
+
+VkRect2D ThumbnailStrip::tileRect(uint32_t tile) const
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    VkRect2D rect{};
+    if (columns_ == 0)
+        return rect;
+    rect.offset.x = static_cast<int32_t>((tile % columns_) * tileWidth_);
+    rect.offset.y = static_cast<int32_t>((tile / columns_) * tileHeight_);
+    rect.extent = VkExtent2D{tileWidth_, tileHeight_};
+    return rect;
+}
+
+void ThumbnailStrip::recordBlit(VkCommandBuffer cmd,
+                                uint32_t tile,
+                                VkImage dstImage,
+                                VkImageLayout dstLayout,
+                                const VkRect2D& dstRect) const
+{
+    if (cmd == VK_NULL_HANDLE || dstImage == VK_NULL_HANDLE || tile >= ready())
+        return;
+
+    const VkRect2D src = tileRect(tile);
+    VkImageBlit blit{};
+    blit.srcSubresource = colorLayers();
+    blit.srcOffsets[0] = VkOffset3D{src.offset.x, src.offset.y, 0};
+    blit.srcOffsets[1] = VkOffset3D{src.offset.x + static_cast<int32_t>(src.extent.width),
+                                    src.offset.y + static_cast<int32_t>(src.extent.height),
+                                    1};
+    blit.dstSubresource = colorLayers();
+    blit.dstOffsets[0] = VkOffset3D{dstRect.offset.x, dstRect.offset.y, 0};
+    blit.dstOffsets[1] = VkOffset3D{dstRect.offset.x + static_cast<int32_t>(dstRect.extent.width),
+                                    dstRect.offset.y + static_cast<int32_t>(dstRect.extent.height),
+                                    1};
+
+    vkCmdBlitImage(cmd, atlasImage_, VK_IMAGE_LAYOUT_GENERAL, dstImage, dstLayout, 1, &blit, VK_FILTER_LINEAR);
+}
+
+// ------------------------------
+// Worker
+// ------------------------------
+void ThumbnailStrip::run_()
+{
+    const auto start = std::chrono::steady_clock::now();
+    try
+    {
+        createWorkResources_();
+
+        const std::filesystem::path cacheFile = options_.diskCache ? cacheFile_() : std::filesystem::path();
+        if (!cacheFile.empty() && loadCache_(cacheFile))
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            stats_.fromDiskCache = true;
+        }
+        else
+        {
+            DecoderVulkan decoder(videoPath_, engine_);
+            if (!decoder.valid)
+                throw std::runtime_error("failed to open " + videoPath_.string() + ": " +
+                                         decoder.getHardwareInitFailureReason());
+            // Thumbnails are decoded once each; nothing to keep
+            decoder.setFrameCacheBudget(0);
+            {
+                std::lock_guard<std::mutex> lk(mutex_);
+                stats_.openSeconds = secondsSince(start);
+            }
+
+            generate_(decoder);
+            // The converters sampled this decoder's frames; release them before it goes
+            nv12Pass_.reset();
+            planarPass_.reset();
+
+            if (!cacheFile.empty() && !stopRequested_.load() && ready() == count())
+                saveCache_(cacheFile);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "[ThumbnailStrip] " << videoPath_.filename().string() << ": " << e.what() << std::endl;
+        std::lock_guard<std::mutex> lk(mutex_);
+        error_ = e.what();
+    }
+
+    destroyWorkResources_();
+
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        stats_.tiles = ready();
+        stats_.totalSeconds = secondsSince(start);
+        std::cout << "[ThumbnailStrip] " << videoPath_.filename().string() << ": " << stats_.tiles << "/" << count()
+                  << " tiles " << tileWidth_ << "x" << tileHeight_
+                  << (stats_.fromDiskCache ? " from disk cache" : "") << " in " << stats_.totalSeconds << "s ("
+                  << stats_.decoded << " keyframes decoded, " << stats_.reused << " reused)\n";
+    }
+    finished_.store(true);
+}
+
+void ThumbnailStrip::generate_(DecoderVulkan& decoder)
+{
+    const double duration = decoder.getDurationSeconds();
+    if (!(duration > 0.0) || decoder.getWidth() <= 0 || decoder.getHeight() <= 0)
+        throw std::runtime_error("video has no duration or size");
+
+    uint32_t tiles = options_.tiles;
+    if (tiles == 0)
+    {
+        tiles = static_cast<uint32_t>(std::ceil(duration / kDefaultSpacingSeconds));
+        tiles = std::clamp(tiles, kMinTiles, kMaxTiles);
+    }
+    const uint32_t tileWidth = std::max(2u, options_.tileWidth & ~1u);
+    const double aspect = static_cast<double>(decoder.getHeight()) / static_cast<double>(decoder.getWidth());
+    const uint32_t tileHeight = std::max(2u, static_cast<uint32_t>(std::lround(tileWidth * aspect * 0.5)) * 2u);
+
+    setLayout_(tiles, tileWidth, tileHeight, duration);
+    createAtlas_();
+
+    // Black tiles until they are generated
+    VkCommandBuffer cmd = beginCommands_();
+    initializeAtlas_(cmd);
+    VkClearColorValue black{};
+    black.float32[3] = 1.0f;
+    VkImageSubresourceRange range{};
+    range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    range.levelCount = 1;
+    range.layerCount = 1;
+    vkCmdClearColorImage(cmd, atlasImage_, VK_IMAGE_LAYOUT_GENERAL, &black, 1, &range);
+    publishAtlasWrites(cmd, atlasImage_);
+    submitAndWait_(cmd);
+
+    // The converter writes the tile directly: the downscale happens while converting
+    const int w = static_cast<int>(tileWidth);
+    const int h = static_cast<int>(tileHeight);
+    if (decoder.getYuvLayout() == YuvLayout::NV12)
+    {
+        nv12Pass_ = std::make_unique<Nv12ToRgbaPass>(engine_, 1, w, h, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, kAtlasFormat);
+        nv12Pass_->initialize();
+    }
+    else
+    {
+        planarPass_ = std::make_unique<Yuv420pToRgbaPass>(engine_, 1, w, h, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, kAtlasFormat);
+        planarPass_->initialize();
+    }
+
+    double previousKeyframe = -1.0;
+    for (uint32_t i = 0; i < tiles && !stopRequested_.load(); ++i)
+    {
+        const double seconds = (static_cast<double>(i) + 0.5) * duration / static_cast<double>(tiles);
+        double shownSeconds = seconds;
+
+        // A keyframes-only decode shows the same picture for every time up to the next keyframe
+        const double keyframe = decoder.indexedKeyframeAt(seconds);
+        const bool sameKeyframe = i > 0 && keyframe >= 0.0 && keyframe == previousKeyframe;
+        previousKeyframe = keyframe;
+
+        DecodedFrame frame;
+        bool decoded = false;
+        if (!sameKeyframe)
+        {
+            const auto decodeStart = std::chrono::steady_clock::now();
+            decoded = decoder.decodeKeyframeAt(seconds, frame);
+            std::lock_guard<std::mutex> lk(mutex_);
+            stats_.decodeSeconds += secondsSince(decodeStart);
+        }
+
+        const auto convertStart = std::chrono::steady_clock::now();
+        if (decoded)
+        {
+            convertTile_(decoder, frame, i);
+            shownSeconds = std::max(0.0, frame.ptsSeconds - decoder.getStreamStartSeconds());
+        }
+        else if (i > 0)
+        {
+            // Shared keyframe, or nothing decodable this late: the previous picture stands
+            copyTile_(i - 1, i);
+            shownSeconds = tileSeconds(i - 1);
+        }
+
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            stats_.convertSeconds += secondsSince(convertStart);
+            stats_.decoded += decoded ? 1 : 0;
+            stats_.reused += !decoded && i > 0 ? 1 : 0;
+            tileSeconds_[i] = shownSeconds;
+        }
+        ready_.store(i + 1);
+    }
+}
+
+void ThumbnailStrip::setLayout_(uint32_t tiles, uint32_t tileWidth, uint32_t tileHeight, double durationSeconds)
+{
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        tileWidth_ = tileWidth;
+        tileHeight_ = tileHeight;
+        columns_ = std::min(tiles, kColumns);
+        rows_ = (tiles + columns_ - 1) / columns_;
+        durationSeconds_ = durationSeconds;
+        tileSeconds_.assign(tiles, 0.0);
+    }
+    count_.store(tiles);
+}
+
+void ThumbnailStrip::createAtlas_()
+{
+    const VkExtent2D extent = atlasExtent();
+
+    VkImageCreateInfo ii{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+    ii.imageType = VK_IMAGE_TYPE_2D;
+    ii.format = kAtlasFormat;
+    ii.extent = VkExtent3D{extent.width, extent.height, 1};
+    ii.mipLevels = 1;
+    ii.arrayLayers = 1;
+    ii.samples = VK_SAMPLE_COUNT_1_BIT;
+    ii.tiling = VK_IMAGE_TILING_OPTIMAL;
+    // written by tile copies and the cache upload, sampled or blitted by the scrubber, read back
+    // for the cache
+    ii.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    ii.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    ii.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    if (vkCreateImage(engine_->logicalDevice, &ii, nullptr, &atlasImage_) != VK_SUCCESS)
+        throw std::runtime_error("failed to create atlas image");
+
+    VkMemoryRequirements mr{};
+    vkGetImageMemoryRequirements(engine_->logicalDevice, atlasImage_, &mr);
+
+    VkMemoryAllocateInfo ai{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+    ai.allocationSize = mr.size;
+    ai.memoryTypeIndex = engine_->findMemoryType(mr.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (vkAllocateMemory(engine_->logicalDevice, &ai, nullptr, &atlasMemory_) != VK_SUCCESS)
+        throw std::runtime_error("failed to allocate atlas memory");
+    vkBindImageMemory(engine_->logicalDevice, atlasImage_, atlasMemory_, 0);
+
+    atlasView_ = engine_->createImageView(atlasImage_, kAtlasFormat);
+}
+
+void ThumbnailStrip::initializeAtlas_(VkCommandBuffer cmd)
+{
+    imageBarrier(cmd,
+                 atlasImage_,
+                 VK_IMAGE_LAYOUT_UNDEFINED,
+                 VK_IMAGE_LAYOUT_GENERAL,
+                 VK_QUEUE_FAMILY_IGNORED,
+                 VK_QUEUE_FAMILY_IGNORED,
+                 VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                 0,
+                 VK_PIPELINE_STAGE_TRANSFER_BIT,
+                 VK_ACCESS_TRANSFER_WRITE_BIT);
+}
+
+void ThumbnailStrip::createWorkResources_()
+{
+    VkCommandPoolCreateInfo pi{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+    pi.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    pi.queueFamilyIndex = engine_->graphicsQueueFamilyIndex;
+    if (vkCreateCommandPool(engine_->logicalDevice, &pi, nullptr, &commandPool_) != VK_SUCCESS)
+        throw std::runtime_error("failed to create command pool");
+
+    VkCommandBufferAllocateInfo ai{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+    ai.commandPool = commandPool_;
+    ai.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    ai.commandBufferCount = 1;
+    if (vkAllocateCommandBuffers(engine_->logicalDevice, &ai, &commandBuffer_) != VK_SUCCESS)
+        throw std::runtime_error("failed to allocate command buffer");
+
+    VkFenceCreateInfo fi{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+    if (vkCreateFence(engine_->logicalDevice, &fi, nullptr, &fence_) != VK_SUCCESS)
+        throw std::runtime_error("failed to create fence");
+}
+
+void ThumbnailStrip::destroyWorkResources_()
+{
+    nv12Pass_.reset();
+    planarPass_.reset();
+
+    // Every submission is waited for in submitAndWait_(), so nothing is pending here
+    if (fence_ != VK_NULL_HANDLE)
+        vkDestroyFence(engine_->logicalDevice, fence_, nullptr);
+    if (commandPool_ != VK_NULL_HANDLE)
+        vkDestroyCommandPool(engine_->logicalDevice, commandPool_, nullptr);
+    fence_ = VK_NULL_HANDLE;
+    commandPool_ = VK_NULL_HANDLE;
+    commandBuffer_ = VK_NULL_HANDLE;
+}
+
+VkCommandBuffer ThumbnailStrip::beginCommands_()
+{
+    vkResetCommandBuffer(commandBuffer_, 0);
+
+    VkCommandBufferBeginInfo bi{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    bi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    if (vkBeginCommandBuffer(commandBuffer_, &bi) != VK_SUCCESS)
+        throw std::runtime_error("failed to begin command buffer");
+    return commandBuffer_;
+}
+
+void ThumbnailStrip::submitAndWait_(VkCommandBuffer cmd)
+{
+    if (vkEndCommandBuffer(cmd) != VK_SUCCESS)
+        throw std::runtime_error("failed to end command buffer");
+
+    VkSubmitInfo si{VK_STRUCTURE_TYPE_SUBMIT_INFO};
+    si.commandBufferCount = 1;
+    si.pCommandBuffers = &cmd;
+    {
+        // The render loop and FFmpeg submit to this queue from their own threads
+        std::lock_guard<std::mutex> lk(vulkanQueueMutex(engine_->graphicsQueueFamilyIndex));
+        if (vkQueueSubmit(engine_->graphicsQueue, 1, &si, fence_) != VK_SUCCESS)
+            throw std::runtime_error("queue submit failed");
+    }
+
+    vkWaitForFences(engine_->logicalDevice, 1, &fence_, VK_TRUE, UINT64_MAX);
+    vkResetFences(engine_->logicalDevice, 1, &fence_);
+}
+
+void ThumbnailStrip::convertTile_(DecoderVulkan& decoder, const DecodedFrame& frame, uint32_t tile)
+{
+    const VulkanSurface& s = frame.vk;
+    if (!s.validate())
+        throw std::runtime_error("decoded keyframe has no valid Vulkan surface");
+
+    PlaneViews planeViews;
+    planeViews.device = engine_->logicalDevice;
+    std::array<VkImageView, 3>& views = planeViews.views;
+    for (uint32_t plane = 0; plane < s.planes; ++plane)
+    {
+        const VkFormat format = s.planeFormats[plane] != VK_FORMAT_UNDEFINED ? s.planeFormats[plane] : VK_FORMAT_R8_UNORM;
+        views[plane] = engine_->createImageView(s.images[plane], format);
+    }
+
+    const uint32_t gfxQF = engine_->graphicsQueueFamilyIndex;
+    VkCommandBuffer cmd = beginCommands_();
+
+    for (uint32_t plane = 0; plane < s.planes; ++plane)
+    {
+        imageBarrier(cmd,
+                     s.images[plane],
+                     s.layouts[plane],
+                     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                     s.queueFamily[plane],
+                     gfxQF,
+                     VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                     VK_ACCESS_MEMORY_WRITE_BIT | VK_ACCESS_MEMORY_READ_BIT,
+                     VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                     VK_ACCESS_SHADER_READ_BIT);
+    }
+
+    const VkExtent2D tileSize = tileExtent();
+    const glm::ivec2 rgbaSize(static_cast<int>(tileSize.width), static_cast<int>(tileSize.height));
+    const glm::ivec2 srcSize(decoder.getWidth(), decoder.getHeight());
+    const glm::ivec2 uvSize(decoder.getChromaWidth(), decoder.getChromaHeight());
+    const glm::ivec2 chromaShift(static_cast<int>(decoder.getChromaShiftX()), static_cast<int>(decoder.getChromaShiftY()));
+
+    YuvConversion conversion{};
+    conversion.colorSpace = static_cast<uint32_t>(decoder.getColorSpace());
+    conversion.colorRange = static_cast<uint32_t>(decoder.getColorRange());
+    conversion.bitDepth = static_cast<uint32_t>(decoder.getBitDepth());
+    conversion.sampleShift = decoder.getSampleShift();
+    conversion.swapUV = nv12Pass_ && decoder.getSwapChromaUV();
+
+    VkImage output = VK_NULL_HANDLE;
+    if (nv12Pass_)
+    {
+        nv12Pass_->setInputNV12(views[0], views[1], decoder.sampler, decoder.sampler);
+        nv12Pass_->pushConstants.rgbaSize = rgbaSize;
+        nv12Pass_->pushConstants.uvSize = uvSize;
+        nv12Pass_->pushConstants.chromaShift = chromaShift;
+        nv12Pass_->pushConstants.srcSize = srcSize;
+        nv12Pass_->conversion = conversion;
+        nv12Pass_->dispatch(cmd, 0);
+        output = nv12Pass_->outputImage(0);
+    }
+    else
+    {
+        planarPass_->setInputYUV420P(views[0], views[1], views[2], decoder.sampler, decoder.sampler, decoder.sampler);
+        planarPass_->pushConstants.rgbaSize = rgbaSize;
+        planarPass_->pushConstants.uvSize = uvSize;
+        planarPass_->pushConstants.chromaShift = chromaShift;
+        planarPass_->pushConstants.srcSize = srcSize;
+        planarPass_->conversion = conversion;
+        planarPass_->dispatch(cmd, 0);
+        output = planarPass_->outputImage(0);
+    }
+
+    // The converters leave their output in GENERAL, which copies can read as it is
+    imageBarrier(cmd,
+                 output,
+                 VK_IMAGE_LAYOUT_GENERAL,
+                 VK_IMAGE_LAYOUT_GENERAL,
+                 VK_QUEUE_FAMILY_IGNORED,
+                 VK_QUEUE_FAMILY_IGNORED,
+                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                 VK_ACCESS_SHADER_WRITE_BIT,
+                 VK_PIPELINE_STAGE_TRANSFER_BIT,
+                 VK_ACCESS_TRANSFER_READ_BIT);
+
+    const VkRect2D rect = tileRect(tile);
+    VkImageCopy region{};
+    region.srcSubresource = colorLayers();
+    region.dstSubresource = colorLayers();
+    region.dstOffset = VkOffset3D{rect.offset.x, rect.offset.y, 0};
+    region.extent = VkExtent3D{rect.extent.width, rect.extent.height, 1};
+    vkCmdCopyImage(cmd, output, VK_IMAGE_LAYOUT_GENERAL, atlasImage_, VK_IMAGE_LAYOUT_GENERAL, 1, &region);
+    publishAtlasWrites(cmd, atlasImage_);
+
+    // The next tile's dispatch overwrites the output only once this copy has read it
+    imageBarrier(cmd,
+                 output,
+                 VK_IMAGE_LAYOUT_GENERAL,
+                 VK_IMAGE_LAYOUT_GENERAL,
+                 VK_QUEUE_FAMILY_IGNORED,
+                 VK_QUEUE_FAMILY_IGNORED,
+                 VK_PIPELINE_STAGE_TRANSFER_BIT,
+                 VK_ACCESS_TRANSFER_READ_BIT,
+                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                 VK_ACCESS_SHADER_WRITE_BIT);
+
+    // Planes back to the layout / queue family FFmpeg tracks for them
+    for (uint32_t plane = 0; plane < s.planes; ++plane)
+    {
+        imageBarrier(cmd,
+                     s.images[plane],
+                     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                     s.layouts[plane],
+                     gfxQF,
+                     s.queueFamily[plane],
+                     VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                     VK_ACCESS_SHADER_READ_BIT,
+                     VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                     VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT);
+    }
+
+    submitAndWait_(cmd);
+}
+
+void ThumbnailStrip::copyTile_(uint32_t fromTile, uint32_t tile)
+{
+    const VkRect2D from = tileRect(fromTile);
+    const VkRect2D to = tileRect(tile);
+
+    VkImageCopy region{};
+    region.srcSubresource = colorLayers();
+    region.srcOffset = VkOffset3D{from.offset.x, from.offset.y, 0};
+    region.dstSubresource = colorLayers();
+    region.dstOffset = VkOffset3D{to.offset.x, to.offset.y, 0};
+    region.extent = VkExtent3D{to.extent.width, to.extent.height, 1};
+
+    VkCommandBuffer cmd = beginCommands_();
+    vkCmdCopyImage(cmd, atlasImage_, VK_IMAGE_LAYOUT_GENERAL, atlasImage_, VK_IMAGE_LAYOUT_GENERAL, 1, &region);
+    publishAtlasWrites(cmd, atlasImage_);
+    submitAndWait_(cmd);
+}
+
+// ------------------------------
+// Disk cache
+// ------------------------------
+std::filesystem::path ThumbnailStrip::cacheFile_() const
+{
+    std::error_code ec;
+    const std::filesystem::path absolute = std::filesystem::absolute(videoPath_, ec);
+    const std::string key = (ec ? videoPath_ : absolute).lexically_normal().string() + "|" +
+                            std::to_string(options_.tiles) + "|" + std::to_string(options_.tileWidth);
+
+    std::ostringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0') << stableHash(key) << ".thumbs";
+    const std::filesystem::path dir = options_.cacheDirectory.empty() ? thumbnailCacheDirectory() : options_.cacheDirectory;
+    return dir / name.str();
+}
+
+bool ThumbnailStrip::loadCache_(const std::filesystem::path& file)
+{
+    std::ifstream in(file, std::ios::binary);
+    if (!in)
+        return false;
+
+    CacheHeader header{};
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!in || std::memcmp(header.magic, kCacheMagic, sizeof(kCacheMagic)) != 0 || header.version != kCacheVersion)
+        return false;
+
+    // A video rewritten in place, or a cache made with other options, is generated again
+    uint64_t sourceBytes = 0;
+    int64_t sourceWriteTime = 0;
+    if (!sourceStamp(videoPath_, sourceBytes, sourceWriteTime) || header.sourceBytes != sourceBytes ||
+        header.sourceWriteTime != sourceWriteTime)
+        return false;
+    if (header.tileWidth != std::max(2u, options_.tileWidth & ~1u) || (options_.tiles != 0 && header.tiles != options_.tiles))
+        return false;
+    if (header.tiles == 0 || header.tileHeight == 0 || header.tileHeight > 4096 ||
+        header.columns != std::min(header.tiles, kColumns) ||
+        header.rows != (header.tiles + header.columns - 1) / header.columns || !(header.durationSeconds > 0.0))
+        return false;
+
+    std::vector<double> seconds(header.tiles);
+    in.read(reinterpret_cast<char*>(seconds.data()), static_cast<std::streamsize>(seconds.size() * sizeof(double)));
+    if (!in)
+        return false;
+
+    const VkDeviceSize bytes =
+        VkDeviceSize(header.tileWidth) * header.columns * header.tileHeight * header.rows * 4;
+    VkBuffer staging = VK_NULL_HANDLE;
+    VkDeviceMemory stagingMemory = VK_NULL_HANDLE;
+    engine_->createBuffer(bytes,
+                          VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                          staging,
+                          stagingMemory);
+    auto destroyStaging = [&]() {
+        vkDestroyBuffer(engine_->logicalDevice, staging, nullptr);
+        vkFreeMemory(engine_->logicalDevice, stagingMemory, nullptr);
+    };
+
+    void* mapped = nullptr;
+    if (vkMapMemory(engine_->logicalDevice, stagingMemory, 0, bytes, 0, &mapped) != VK_SUCCESS)
+    {
+        destroyStaging();
+        return false;
+    }
+    in.read(static_cast<char*>(mapped), static_cast<std::streamsize>(bytes));
+    vkUnmapMemory(engine_->logicalDevice, stagingMemory);
+    if (!in)
+    {
+        destroyStaging();
+        return false;
+    }
+
+    try
+    {
+        setLayout_(header.tiles, header.tileWidth, header.tileHeight, header.durationSeconds);
+        createAtlas_();
+
+        VkCommandBuffer cmd = beginCommands_();
+        initializeAtlas_(cmd);
+        VkBufferImageCopy region{};
+        region.imageSubresource = colorLayers();
+        region.imageExtent = VkExtent3D{header.tileWidth * header.columns, header.tileHeight * header.rows, 1};
+        vkCmdCopyBufferToImage(cmd, staging, atlasImage_, VK_IMAGE_LAYOUT_GENERAL, 1, &region);
+        publishAtlasWrites(cmd, atlasImage_);
+        submitAndWait_(cmd);
+    }
+    catch (...)
+    {
+        destroyStaging();
+        throw;
+    }
+    destroyStaging();
+
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        tileSeconds_ = std::move(seconds);
+    }
+    ready_.store(header.tiles);
+    return true;
+}
+
+void ThumbnailStrip::saveCache_(const std::filesystem::path& file)
+{
+    CacheHeader header{};
+    std::memcpy(header.magic, kCacheMagic, sizeof(kCacheMagic));
+    header.version = kCacheVersion;
+    if (!sourceStamp(videoPath_, header.sourceBytes, header.sourceWriteTime))
+        return;
+
+    std::vector<double> seconds;
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        header.tiles = static_cast<uint32_t>(tileSeconds_.size());
+        header.tileWidth = tileWidth_;
+        header.tileHeight = tileHeight_;
+        header.columns = columns_;
+        header.rows = rows_;
+        header.durationSeconds = durationSeconds_;
+        seconds = tileSeconds_;
+    }
+
+    const VkExtent2D extent = atlasExtent();
+    const VkDeviceSize bytes = VkDeviceSize(extent.width) * extent.height * 4;
+    VkBuffer staging = VK_NULL_HANDLE;
+    VkDeviceMemory stagingMemory = VK_NULL_HANDLE;
+    engine_->createBuffer(bytes,
+                          VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                          staging,
+                          stagingMemory);
+
+    bool written = false;
+    const std::filesystem::path partial = file.string() + ".partial";
+    try
+    {
+        VkCommandBuffer cmd = beginCommands_();
+        VkBufferImageCopy region{};
+        region.imageSubresource = colorLayers();
+        region.imageExtent = VkExtent3D{extent.width, extent.height, 1};
+        vkCmdCopyImageToBuffer(cmd, atlasImage_, VK_IMAGE_LAYOUT_GENERAL, staging, 1, &region);
+        submitAndWait_(cmd);
+
+        std::error_code ec;
+        std::filesystem::create_directories(file.parent_path(), ec);
+
+        void* mapped = nullptr;
+        std::ofstream out(partial, std::ios::binary | std::ios::trunc);
+        if (out && vkMapMemory(engine_->logicalDevice, stagingMemory, 0, bytes, 0, &mapped) == VK_SUCCESS)
+        {
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(reinterpret_cast<const char*>(seconds.data()),
+                      static_cast<std::streamsize>(seconds.size() * sizeof(double)));
+            out.write(static_cast<const char*>(mapped), static_cast<std::streamsize>(bytes));
+            vkUnmapMemory(engine_->logicalDevice, stagingMemory);
+            out.close();
+            written = static_cast<bool>(out);
+        }
+
+        // Readers never see a half-written file
+        if (written)
+        {
+            std::filesystem::rename(partial, file, ec);
+            written = !ec;
+        }
+        if (!written)
+            std::filesystem::remove(partial, ec);
+    }
+    catch (...)
+    {
+        vkDestroyBuffer(engine_->logicalDevice, staging, nullptr);
+        vkFreeMemory(engine_->logicalDevice, stagingMemory, nullptr);
+        throw;
+    }
+    vkDestroyBuffer(engine_->logicalDevice, staging, nullptr);
+    vkFreeMemory(engine_->logicalDevice, stagingMemory, nullptr);
+
+    if (!written)
+        std::cerr << "[ThumbnailStrip] could not write disk cache " << file << std::endl;
+}
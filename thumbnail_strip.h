@@ -0,0 +1,165 @@
+// thumbnail_strip.h
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+class DecoderVulkan;
+class Engine2D;
+class Nv12ToRgbaPass;
+class Yuv420pToRgbaPass;
+struct DecodedFrame;
+
+struct ThumbnailStripOptions
+{
+    // 0: one tile per kDefaultSpacingSeconds of video, kept within [kMinTiles, kMaxTiles]
+    uint32_t tiles = 0;
+    // Tile height follows the video's aspect ratio
+    uint32_t tileWidth = 160;
+    // Where finished atlases are kept; empty uses thumbnailCacheDirectory()
+    std::filesystem::path cacheDirectory;
+    bool diskCache = true;
+};
+
+// How the last generate went; times are wall clock on the worker thread.
+struct ThumbnailStripStats
+{
+    uint32_t tiles = 0;
+    uint32_t decoded = 0; // keyframes decoded
+    uint32_t reused = 0;  // tiles sharing the previous tile's keyframe (copied, not decoded)
+    bool fromDiskCache = false;
+    double openSeconds = 0.0;
+    double decodeSeconds = 0.0; // seek + keyframe decode
+    double convertSeconds = 0.0; // YUV->RGBA downscale + copy into the atlas, submit to fence
+    double totalSeconds = 0.0;
+};
+
+// $XDG_CACHE_HOME/motive2d/thumbnails, ~/.cache/motive2d/thumbnails, or under the temp directory.
+std::filesystem::path thumbnailCacheDirectory();
+
+// Scrubber filmstrip: evenly spaced thumbnails of a video in one RGBA8 atlas image, a row-major
+// grid of tiles. A worker thread with its own DecoderVulkan (so the playback decoder is never
+// seeked) decodes only the keyframe at or before each tile's time, has the YUV->RGBA converter
+// downscale it to tile size on the GPU and copies it into the atlas. Tiles whose time falls on
+// the same keyframe as the previous one are copied from it instead of decoded again. Finished
+// atlases are written to a disk cache keyed by the video's path and validated against its size
+// and modification time, so the next open loads them without decoding anything.
+//
+// Tiles fill in order; the render thread may copy or sample tiles below ready() at any time.
+// The atlas stays in VK_IMAGE_LAYOUT_GENERAL throughout.
+class ThumbnailStrip
+{
+public:
+    static constexpr uint32_t kColumns = 16;
+    // Spacing and tile limits are starting values; thumbnail_bench has not been run on an hour of
+    // 4K footage yet
+    static constexpr double kDefaultSpacingSeconds = 10.0;
+    static constexpr uint32_t kMinTiles = 16;
+    static constexpr uint32_t kMaxTiles = 512;
+
+    // Starts the worker; throws std::runtime_error without a valid engine. Open and decode
+    // failures end the worker with error() set.
+    ThumbnailStrip(Engine2D* engine, const std::filesystem::path& videoPath, const ThumbnailStripOptions& options = {});
+    // Stops the worker after its current tile and waits for the device before freeing the atlas.
+    ~ThumbnailStrip();
+
+    ThumbnailStrip(const ThumbnailStrip&) = delete;
+    ThumbnailStrip& operator=(const ThumbnailStrip&) = delete;
+
+    // Layout, 0 / empty until the worker has opened the video or the cached atlas
+    uint32_t count() const { return count_.load(); }
+    VkExtent2D tileExtent() const;
+    double durationSeconds() const;
+
+    // Tiles [0, ready()) are in the atlas
+    uint32_t ready() const { return ready_.load(); }
+    // The worker has exited: every tile is ready, it was stopped, or it failed
+    bool finished() const { return finished_.load(); }
+    std::string error() const;
+
+    // Tile covering presentation time `seconds`; false while that tile is not ready yet.
+    bool tileFor(double seconds, uint32_t& tile) const;
+    // Presentation time the tile shows (its keyframe's, when known)
+    double tileSeconds(uint32_t tile) const;
+    // Tile's pixels in the atlas
+    VkRect2D tileRect(uint32_t tile) const;
+
+    VkImage atlasImage() const { return atlasImage_; }
+    VkImageView atlasView() const { return atlasView_; }
+    VkExtent2D atlasExtent() const;
+
+    // Records a linear-filtered blit of a ready tile to dstRect of dstImage (in dstLayout, which
+    // must allow transfer writes). Does NOT begin/end the command buffer.
+    void recordBlit(VkCommandBuffer cmd,
+                    uint32_t tile,
+                    VkImage dstImage,
+                    VkImageLayout dstLayout,
+                    const VkRect2D& dstRect) const;
+
+    ThumbnailStripStats stats() const;
+
+private:
+    void run_();
+    void generate_(DecoderVulkan& decoder);
+
+    void setLayout_(uint32_t tiles, uint32_t tileWidth, uint32_t tileHeight, double durationSeconds);
+    void createAtlas_();
+    // UNDEFINED -> GENERAL, recorded before the atlas is first written
+    void initializeAtlas_(VkCommandBuffer cmd);
+    void createWorkResources_();
+    void destroyWorkResources_();
+
+    // Decoded keyframe -> tile, and tile -> tile for a shared keyframe
+    void convertTile_(DecoderVulkan& decoder, const DecodedFrame& frame, uint32_t tile);
+    void copyTile_(uint32_t fromTile, uint32_t tile);
+
+    VkCommandBuffer beginCommands_();
+    void submitAndWait_(VkCommandBuffer cmd);
+
+    std::filesystem::path cacheFile_() const;
+    bool loadCache_(const std::filesystem::path& file);
+    void saveCache_(const std::filesystem::path& file);
+
+private:
+    Engine2D* engine_ = nullptr;
+    std::filesystem::path videoPath_;
+    ThumbnailStripOptions options_;
+
+    // Layout (set once by the worker, before count_), tile times, error and stats
+    mutable std::mutex mutex_;
+    uint32_t tileWidth_ = 0;
+    uint32_t tileHeight_ = 0;
+    uint32_t columns_ = 0;
+    uint32_t rows_ = 0;
+    double durationSeconds_ = 0.0;
+    std::vector<double> tileSeconds_;
+    std::string error_;
+    ThumbnailStripStats stats_{};
+
+    std::atomic<uint32_t> count_{0};
+    std::atomic<uint32_t> ready_{0};
+    std::atomic<bool> finished_{false};
+    std::atomic<bool> stopRequested_{false};
+
+    // Atlas (RGBA8, GENERAL)
+    VkImage atlasImage_ = VK_NULL_HANDLE;
+    VkDeviceMemory atlasMemory_ = VK_NULL_HANDLE;
+    VkImageView atlasView_ = VK_NULL_HANDLE;
+
+    // Worker-only GPU resources
+    VkCommandPool commandPool_ = VK_NULL_HANDLE;
+    VkCommandBuffer commandBuffer_ = VK_NULL_HANDLE;
+    VkFence fence_ = VK_NULL_HANDLE;
+    std::unique_ptr<Nv12ToRgbaPass> nv12Pass_;
+    std::unique_ptr<Yuv420pToRgbaPass> planarPass_;
+
+    std::thread worker_;
+};
@@ -0,0 +1,627 @@
+// video_editor_orchestrator.cpp
+//
+// Segment-parallel transcoding for raw Annex-B (H.264/H.265) streams.
+// - Splits the input at IDR (and H.265 BLA) access units into segment_<start>_<end>.<ext>
+//   pieces (parameter sets are repeated at the head of every segment so each one decodes
+//   alone). H.265 CRA pictures are not split points: the RASL pictures after a CRA reference
+//   pictures before it, which a segment starting at the CRA would not have.
+// - Runs N local worker processes (default: the `encode` tool, a straight decode -> encode
+//   transcode with no grading), one per segment, each with its own decoder and encoder. A
+//   custom worker template can run any per-segment processing. Worker stdout/stderr come back
+//   over pipes.
+// - Concatenates the per-segment encoded bitstreams and merges per-segment pose coordinate
+//   files (segment_<start>_<end>*_coords.txt) with frame-offset correction, matching
+//   combine_coords.py.
+// - Optionally sweeps worker counts and reports wall-clock scaling.
+//
+// Worker command template placeholders: {input} {output} {start} {end} {index}
+
+#include "annexb_demuxer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <csignal>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+struct OrchestratorOptions
+{
+    std::filesystem::path inputPath;
+    std::filesystem::path workDir = "segments";
+    std::filesystem::path outputPath;
+    std::string workerTemplate = "./encode --video {input} --output {output}";
+    std::string encodedSuffix = ".encoded";
+    size_t workers = 4;
+    bool scaling = false;
+};
+
+struct NalInfo
+{
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    bool isIdr = false; // IDR or BLA: nothing after it references anything before it
+    bool isVcl = false;
+    bool startsPicture = false; // first slice of a coded picture
+    bool isParameterSet = false;
+};
+
+struct Segment
+{
+    size_t index = 0;
+    size_t startFrame = 0; // inclusive
+    size_t endFrame = 0;   // exclusive
+    size_t firstNal = 0;
+    size_t lastNal = 0;    // exclusive
+    std::filesystem::path inputPath;
+    std::filesystem::path encodedPath;
+};
+
+struct Worker
+{
+    pid_t pid = -1;
+    int outFd = -1;
+    size_t segment = 0;
+    std::string pending;
+    int exitStatus = 0;
+    bool running = false;
+};
+
+// Picks segment boundaries at the IDR frames closest to an even split.
+std::vector<Segment> planSegments(const std::vector<NalInfo>& nals, size_t workerCount)
+{
+    std::vector<size_t> frameNal;    // NAL index of the first slice of every picture
+    std::vector<size_t> idrFrames;   // frame numbers that start on an IDR
+    for (size_t i = 0; i < nals.size(); ++i)
+    {
+        if (!nals[i].startsPicture) continue;
+        if (nals[i].isIdr) idrFrames.push_back(frameNal.size());
+        frameNal.push_back(i);
+    }
+    std::vector<Segment> segments;
+    const size_t totalFrames = frameNal.size();
+    if (totalFrames == 0 || idrFrames.empty())
+    {
+        return segments;
+    }
+
+    std::vector<size_t> cuts{idrFrames.front()};
+    for (size_t w = 1; w < workerCount; ++w)
+    {
+        const size_t ideal = totalFrames * w / workerCount;
+        auto it = std::lower_bound(idrFrames.begin(), idrFrames.end(), ideal);
+        size_t best = (it == idrFrames.end()) ? idrFrames.back() : *it;
+        if (it != idrFrames.begin() && (it == idrFrames.end() || ideal - *(it - 1) < *it - ideal))
+        {
+            best = *(it - 1);
+        }
+        if (best > cuts.back())
+        {
+            cuts.push_back(best);
+        }
+    }
+    cuts.push_back(totalFrames);
+
+    for (size_t s = 0; s + 1 < cuts.size(); ++s)
+    {
+        Segment seg{};
+        seg.index = s;
+        seg.startFrame = cuts[s];
+        seg.endFrame = cuts[s + 1];
+        seg.firstNal = frameNal[seg.startFrame];
+        // Parameter sets / SEI immediately preceding the IDR belong to this segment.
+        while (seg.firstNal > 0 && !nals[seg.firstNal - 1].isVcl)
+        {
+            --seg.firstNal;
+        }
+        segments.push_back(seg);
+    }
+    for (size_t s = 0; s < segments.size(); ++s)
+    {
+        segments[s].lastNal = (s + 1 < segments.size()) ? segments[s + 1].firstNal : nals.size();
+    }
+    // Frames before the first IDR are undecodable on their own; fold them into segment 0.
+    if (!segments.empty())
+    {
+        segments.front().firstNal = 0;
+        segments.front().startFrame = 0;
+    }
+    return segments;
+}
+
+bool writeSegment(const std::vector<NalInfo>& nals, Segment& seg, const std::filesystem::path& path)
+{
+    static const uint8_t kStartCode[4] = {0, 0, 0, 1};
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+    {
+        std::cerr << "[Orchestrator] Failed to open " << path << "\n";
+        return false;
+    }
+    // Repeat the most recent parameter sets so the segment decodes standalone.
+    std::vector<size_t> params;
+    for (size_t i = 0; i < seg.firstNal; ++i)
+    {
+        if (nals[i].isParameterSet) params.push_back(i);
+    }
+    bool hasOwnParams = false;
+    for (size_t i = seg.firstNal; i < seg.lastNal && !nals[i].isVcl; ++i)
+    {
+        hasOwnParams = hasOwnParams || nals[i].isParameterSet;
+    }
+    if (!hasOwnParams)
+    {
+        for (size_t i : params)
+        {
+            out.write(reinterpret_cast<const char*>(kStartCode), sizeof(kStartCode));
+            out.write(reinterpret_cast<const char*>(nals[i].data), nals[i].size);
+        }
+    }
+    for (size_t i = seg.firstNal; i < seg.lastNal; ++i)
+    {
+        out.write(reinterpret_cast<const char*>(kStartCode), sizeof(kStartCode));
+        out.write(reinterpret_cast<const char*>(nals[i].data), nals[i].size);
+    }
+    seg.inputPath = path;
+    return static_cast<bool>(out);
+}
+
+std::string expandTemplate(std::string text, const Segment& seg)
+{
+    const std::pair<std::string, std::string> vars[] = {
+        {"{input}", seg.inputPath.string()},
+        {"{output}", seg.encodedPath.string()},
+        {"{start}", std::to_string(seg.startFrame)},
+        {"{end}", std::to_string(seg.endFrame)},
+        {"{index}", std::to_string(seg.index)},
+    };
+    for (const auto& [key, value] : vars)
+    {
+        for (size_t pos = text.find(key); pos != std::string::npos; pos = text.find(key, pos + value.size()))
+        {
+            text.replace(pos, key.size(), value);
+        }
+    }
+    return text;
+}
+
+std::vector<std::string> splitArgs(const std::string& command)
+{
+    std::vector<std::string> args;
+    std::istringstream ss(command);
+    std::string token;
+    while (ss >> token)
+    {
+        args.push_back(token);
+    }
+    return args;
+}
+
+bool spawnWorker(Worker& worker, const std::string& command)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        std::cerr << "[Orchestrator] pipe() failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    std::vector<std::string> args = splitArgs(command);
+    if (args.empty())
+    {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        std::cerr << "[Orchestrator] fork() failed: " << std::strerror(errno) << "\n";
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (pid == 0)
+    {
+        dup2(fds[1], STDOUT_FILENO);
+        dup2(fds[1], STDERR_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        std::vector<char*> argv;
+        for (auto& a : args) argv.push_back(a.data());
+        argv.push_back(nullptr);
+        execvp(argv[0], argv.data());
+        std::fprintf(stderr, "exec %s failed: %s\n", argv[0], std::strerror(errno));
+        _exit(127);
+    }
+    close(fds[1]);
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    worker.pid = pid;
+    worker.outFd = fds[0];
+    worker.running = true;
+    return true;
+}
+
+// Error path: no worker outlives the run, and none is left unreaped.
+void stopWorkers(std::vector<Worker>& workers)
+{
+    for (Worker& w : workers)
+    {
+        if (!w.running) continue;
+        kill(w.pid, SIGKILL);
+    }
+    for (Worker& w : workers)
+    {
+        if (!w.running) continue;
+        close(w.outFd);
+        waitpid(w.pid, &w.exitStatus, 0);
+        w.running = false;
+    }
+    workers.clear();
+}
+
+// Runs every segment with at most `parallel` workers alive; relays worker output line by line.
+// The first failure (spawn or worker exit status) stops the remaining workers.
+bool runWorkers(std::vector<Segment>& segments, size_t parallel, const OrchestratorOptions& opts)
+{
+    std::vector<Worker> active;
+    size_t next = 0;
+    bool ok = true;
+    while (next < segments.size() || !active.empty())
+    {
+        while (ok && active.size() < parallel && next < segments.size())
+        {
+            Worker w{};
+            w.segment = next;
+            const std::string cmd = expandTemplate(opts.workerTemplate, segments[next]);
+            std::cout << "[Orchestrator] Worker " << next << ": " << cmd << "\n";
+            if (!spawnWorker(w, cmd))
+            {
+                stopWorkers(active);
+                return false;
+            }
+            active.push_back(std::move(w));
+            ++next;
+        }
+
+        if (active.empty())
+        {
+            break;
+        }
+        std::vector<pollfd> pfds;
+        for (auto& w : active)
+        {
+            pfds.push_back({w.outFd, POLLIN, 0});
+        }
+        if (poll(pfds.data(), pfds.size(), 100) < 0 && errno != EINTR)
+        {
+            std::cerr << "[Orchestrator] poll() failed: " << std::strerror(errno) << "\n";
+            stopWorkers(active);
+            return false;
+        }
+
+        for (size_t i = 0; i < active.size(); ++i)
+        {
+            Worker& w = active[i];
+            char buf[4096];
+            ssize_t n = 0;
+            while ((n = read(w.outFd, buf, sizeof(buf))) > 0)
+            {
+                w.pending.append(buf, static_cast<size_t>(n));
+                size_t nl;
+                while ((nl = w.pending.find('\n')) != std::string::npos)
+                {
+                    std::cout << "[Worker " << w.segment << "] " << w.pending.substr(0, nl) << "\n";
+                    w.pending.erase(0, nl + 1);
+                }
+            }
+            if (n == 0)
+            {
+                // EOF: child closed its end; reap it.
+                if (!w.pending.empty())
+                {
+                    std::cout << "[Worker " << w.segment << "] " << w.pending << "\n";
+                }
+                close(w.outFd);
+                waitpid(w.pid, &w.exitStatus, 0);
+                w.running = false;
+                const bool success = WIFEXITED(w.exitStatus) && WEXITSTATUS(w.exitStatus) == 0;
+                if (!success)
+                {
+                    std::cerr << "[Orchestrator] Worker " << w.segment << " failed (status " << w.exitStatus << ")\n";
+                    ok = false;
+                }
+            }
+        }
+        active.erase(std::remove_if(active.begin(), active.end(), [](const Worker& w) { return !w.running; }),
+                     active.end());
+        if (!ok)
+        {
+            stopWorkers(active);
+        }
+    }
+    return ok;
+}
+
+bool concatenateOutputs(const std::vector<Segment>& segments, const std::filesystem::path& outputPath)
+{
+    std::ofstream out(outputPath, std::ios::binary);
+    if (!out)
+    {
+        std::cerr << "[Orchestrator] Failed to open " << outputPath << "\n";
+        return false;
+    }
+    for (const auto& seg : segments)
+    {
+        std::ifstream in(seg.encodedPath, std::ios::binary);
+        if (!in)
+        {
+            std::cerr << "[Orchestrator] Missing worker output " << seg.encodedPath << "\n";
+            return false;
+        }
+        out << in.rdbuf();
+    }
+    std::cout << "[Orchestrator] Wrote " << outputPath << "\n";
+    return static_cast<bool>(out);
+}
+
+// Same format and offset rule as combine_coords.py: tab-separated, 7 columns, frame in column 0.
+void mergePoseCoordinates(const std::vector<Segment>& segments, const std::filesystem::path& outputPath)
+{
+    std::vector<std::string> merged;
+    bool headerWritten = false;
+    size_t files = 0;
+    for (const auto& seg : segments)
+    {
+        const std::string prefix = seg.inputPath.stem().string();
+        for (const auto& entry : std::filesystem::directory_iterator(seg.inputPath.parent_path()))
+        {
+            const std::string name = entry.path().filename().string();
+            if (name.rfind(prefix, 0) != 0 || name.find("_coords.txt") == std::string::npos)
+            {
+                continue;
+            }
+            std::ifstream in(entry.path());
+            std::string line;
+            while (std::getline(in, line))
+            {
+                if (line.empty()) continue;
+                if (line[0] == '#')
+                {
+                    if (!headerWritten)
+                    {
+                        merged.push_back(line);
+                        headerWritten = true;
+                    }
+                    continue;
+                }
+                const size_t tab = line.find('\t');
+                if (tab == std::string::npos || std::count(line.begin(), line.end(), '\t') != 6)
+                {
+                    std::cerr << "[Orchestrator] Malformed pose line in " << name << ": " << line << "\n";
+                    continue;
+                }
+                try
+                {
+                    const size_t frame = std::stoul(line.substr(0, tab)) + seg.startFrame;
+                    merged.push_back(std::to_string(frame) + line.substr(tab));
+                }
+                catch (const std::exception&)
+                {
+                    std::cerr << "[Orchestrator] Invalid frame number in " << name << ": " << line << "\n";
+                }
+            }
+            ++files;
+        }
+    }
+    if (files == 0)
+    {
+        return;
+    }
+    std::ofstream out(outputPath);
+    for (size_t i = 0; i < merged.size(); ++i)
+    {
+        out << merged[i] << (i + 1 < merged.size() ? "\n" : "");
+    }
+    std::cout << "[Orchestrator] Merged " << files << " pose coordinate files into " << outputPath << "\n";
+}
+
+bool transcode(const std::vector<NalInfo>& nals, size_t workerCount, const OrchestratorOptions& opts, double& seconds)
+{
+    std::vector<Segment> segments = planSegments(nals, workerCount);
+    if (segments.empty())
+    {
+        std::cerr << "[Orchestrator] No IDR frames found; cannot split input.\n";
+        return false;
+    }
+    const std::filesystem::path dir = opts.workDir / ("workers_" + std::to_string(workerCount));
+    std::filesystem::create_directories(dir);
+    const std::string ext = opts.inputPath.extension().string();
+    for (auto& seg : segments)
+    {
+        const std::string stem = "segment_" + std::to_string(seg.startFrame) + "_" + std::to_string(seg.endFrame);
+        if (!writeSegment(nals, seg, dir / (stem + ext)))
+        {
+            return false;
+        }
+        seg.encodedPath = dir / (stem + opts.encodedSuffix + ext);
+    }
+    std::cout << "[Orchestrator] " << segments.size() << " segments for " << workerCount << " workers\n";
+
+    const auto start = std::chrono::steady_clock::now();
+    const bool ok = runWorkers(segments, workerCount, opts);
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!ok)
+    {
+        return false;
+    }
+
+    std::filesystem::path outputPath = opts.outputPath;
+    if (outputPath.empty())
+    {
+        outputPath = opts.inputPath;
+        outputPath.replace_extension("transcoded" + ext);
+    }
+    if (!concatenateOutputs(segments, outputPath))
+    {
+        return false;
+    }
+    std::filesystem::path posePath = outputPath;
+    posePath.replace_extension("").concat("_coords.txt");
+    mergePoseCoordinates(segments, posePath);
+    return true;
+}
+
+void printUsage()
+{
+    std::cout << "Usage: video_editor_orchestrator [OPTIONS] INPUT.h264|INPUT.h265\n";
+    std::cout << "Splits a raw Annex-B stream at IDR frames and transcodes the segments in parallel.\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  -j, --workers N       Number of worker processes (default: 4)\n";
+    std::cout << "  -o, --output FILE     Concatenated output (default: INPUT.transcoded.<ext>)\n";
+    std::cout << "      --workdir DIR     Directory for segments and worker outputs (default: segments)\n";
+    std::cout << "      --worker CMD      Worker command template (default: \"./encode --video {input} --output {output}\")\n";
+    std::cout << "                        Placeholders: {input} {output} {start} {end} {index}\n";
+    std::cout << "      --encoded-suffix S  Output name suffix, {output} = <segment stem>S<ext> (default: .encoded)\n";
+    std::cout << "      --scaling         Run with 1, 2, 4, ... N workers and report wall-clock scaling\n";
+    std::cout << "  -h, --help            Show this help message\n";
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    OrchestratorOptions opts{};
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        auto needValue = [&](const char* name) -> const char* {
+            if (i + 1 >= argc)
+            {
+                std::cerr << "[Orchestrator] Error: " << name << " requires a value\n";
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+        if (arg == "--workers" || arg == "-j")
+        {
+            try
+            {
+                opts.workers = std::max<size_t>(1, std::stoul(needValue("--workers")));
+            }
+            catch (const std::exception&)
+            {
+                std::cerr << "[Orchestrator] Error: --workers requires a positive integer\n";
+                return 1;
+            }
+        }
+        else if (arg == "--output" || arg == "-o")
+        {
+            opts.outputPath = needValue("--output");
+        }
+        else if (arg == "--workdir")
+        {
+            opts.workDir = needValue("--workdir");
+        }
+        else if (arg == "--worker")
+        {
+            opts.workerTemplate = needValue("--worker");
+        }
+        else if (arg == "--encoded-suffix")
+        {
+            opts.encodedSuffix = needValue("--encoded-suffix");
+        }
+        else if (arg == "--scaling")
+        {
+            opts.scaling = true;
+        }
+        else if (arg == "--help" || arg == "-h")
+        {
+            printUsage();
+            return 0;
+        }
+        else if (arg[0] != '-')
+        {
+            opts.inputPath = arg;
+        }
+        else
+        {
+            std::cerr << "[Orchestrator] Unknown option: " << arg << "\n";
+            std::cerr << "Use --help for usage information\n";
+            return 1;
+        }
+    }
+    if (opts.inputPath.empty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    AnnexBDemuxer demux(opts.inputPath);
+    if (!demux.valid())
+    {
+        std::cerr << "[Orchestrator] Failed to open Annex-B input " << opts.inputPath << "\n";
+        return 1;
+    }
+    if (!demux.buildIndex())
+    {
+        return 1;
+    }
+    std::vector<NalInfo> nals;
+    for (const AnnexBNalEntry& entry : demux.index())
+    {
+        NalInfo nal{};
+        nal.data = demux.data() + entry.offset;
+        nal.size = entry.size;
+        // The index marks every random access point; only IDR/BLA pictures cut cleanly
+        nal.isIdr = demux.codec() == AnnexBCodec::H265 ? (entry.type >= 16 && entry.type <= 20) : entry.isIdr != 0;
+        nal.isVcl = AnnexBDemuxer::isVclType(demux.codec(), entry.type);
+        nal.startsPicture = nal.isVcl && entry.firstSliceInPic;
+        nal.isParameterSet = AnnexBDemuxer::isParameterSetType(demux.codec(), entry.type);
+        nals.push_back(nal);
+    }
+    std::cout << "[Orchestrator] Indexed " << nals.size() << " NAL units\n";
+
+    std::vector<size_t> counts;
+    if (opts.scaling)
+    {
+        for (size_t n = 1; n < opts.workers; n *= 2) counts.push_back(n);
+    }
+    counts.push_back(opts.workers);
+
+    std::vector<double> times;
+    for (size_t n : counts)
+    {
+        double seconds = 0.0;
+        if (!transcode(nals, n, opts, seconds))
+        {
+            return 1;
+        }
+        times.push_back(seconds);
+    }
+
+    std::cout << "[Orchestrator] Wall-clock scaling:\n";
+    std::cout << "  workers    seconds   speedup  efficiency\n";
+    for (size_t i = 0; i < counts.size(); ++i)
+    {
+        const double speedup = times[i] > 0.0 ? times.front() / times[i] : 0.0;
+        std::cout << "  " << std::setw(7) << counts[i] << std::setw(11) << std::fixed << std::setprecision(2) << times[i]
+                  << std::setw(10) << speedup << std::setw(12)
+                  << speedup / static_cast<double>(counts[i]) * static_cast<double>(counts.front()) << "\n";
+    }
+    return 0;
+}
@@ -1,13 +1,16 @@
 #include "widgets.hpp"
 
 #include "engine2d.h"
+#include "queue_lock.h"
 #include "utils.h"
 
 #include <algorithm>
 #include <array>
+#include <cmath>
 #include <cstring>
 #include <iostream>
 #include <limits>
+#include <mutex>
 #include <vector>
 
 namespace widgets
@@ -24,23 +27,28 @@ static_assert(sizeof(DrawCommandHeader) == 16, "Draw command header must match s
 
 inline DrawCommand makeRectCommand(const glm::vec2& center,
                                    const glm::vec2& size,
-                                   const glm::vec4& color)
+                                   const glm::vec4& color,
+                                   float cornerRadius = 0.0f,
+                                   float stroke = 0.0f)
 {
     DrawCommand cmd{};
     cmd.type = CMD_RECT;
     cmd.color = color;
     cmd.params = glm::vec4(center.x, center.y, size.x, size.y);
+    cmd.params2 = glm::vec4(cornerRadius, stroke, 0.0f, 0.0f);
     return cmd;
 }
 
 inline DrawCommand makeCircleCommand(const glm::vec2& center,
                                      float radius,
-                                     const glm::vec4& color)
+                                     const glm::vec4& color,
+                                     float stroke = 0.0f)
 {
     DrawCommand cmd{};
     cmd.type = CMD_CIRCLE;
     cmd.color = color;
     cmd.params = glm::vec4(center.x, center.y, radius, 0.0f);
+    cmd.params2.y = stroke;
     return cmd;
 }
 
@@ -56,6 +64,56 @@ inline DrawCommand makeLineCommand(const glm::vec2& start,
     cmd.params2.x = thickness;
     return cmd;
 }
+
+bool ensureHostBuffer(Engine2D* engine,
+                      VkDevice device,
+                      VkBuffer& buffer,
+                      VkDeviceMemory& memory,
+                      VkDeviceSize& currentSize,
+                      VkDeviceSize size)
+{
+    if (buffer != VK_NULL_HANDLE && currentSize >= size)
+    {
+        return true;
+    }
+
+    if (buffer != VK_NULL_HANDLE)
+    {
+        vkDestroyBuffer(device, buffer, nullptr);
+        buffer = VK_NULL_HANDLE;
+    }
+    if (memory != VK_NULL_HANDLE)
+    {
+        vkFreeMemory(device, memory, nullptr);
+        memory = VK_NULL_HANDLE;
+    }
+    currentSize = 0;
+
+    engine->createBuffer(size,
+                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         buffer,
+                         memory);
+    if (buffer == VK_NULL_HANDLE || memory == VK_NULL_HANDLE)
+    {
+        return false;
+    }
+
+    currentSize = size;
+    return true;
+}
+
+bool uploadHostBuffer(VkDevice device, VkDeviceMemory memory, const void* data, VkDeviceSize size)
+{
+    void* mapped = nullptr;
+    if (vkMapMemory(device, memory, 0, size, 0, &mapped) != VK_SUCCESS || !mapped)
+    {
+        return false;
+    }
+    std::memcpy(mapped, data, static_cast<size_t>(size));
+    vkUnmapMemory(device, memory);
+    return true;
+}
 } // namespace
 
 bool initializeWidgetRenderer(Engine2D* engine, WidgetRenderer& renderer)
@@ -68,7 +126,7 @@ bool initializeWidgetRenderer(Engine2D* engine, WidgetRenderer& renderer)
     renderer.device = engine->logicalDevice;
     renderer.queue = engine->graphicsQueue;
 
-    std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+    std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
     bindings[0].binding = 0;
     bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
     bindings[0].descriptorCount = 1;
@@ -79,6 +137,11 @@ bool initializeWidgetRenderer(Engine2D* engine, WidgetRenderer& renderer)
     bindings[1].descriptorCount = 1;
     bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
 
+    bindings[2].binding = 2;
+    bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[2].descriptorCount = 1;
+    bindings[2].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
     VkDescriptorSetLayoutCreateInfo layoutInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
     layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
     layoutInfo.pBindings = bindings.data();
@@ -146,7 +209,7 @@ bool initializeWidgetRenderer(Engine2D* engine, WidgetRenderer& renderer)
     poolSizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
     poolSizes[0].descriptorCount = 1;
     poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    poolSizes[1].descriptorCount = 1;
+    poolSizes[1].descriptorCount = 2;
 
     VkDescriptorPoolCreateInfo poolInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
     poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
@@ -249,6 +312,17 @@ void destroyWidgetRenderer(WidgetRenderer& renderer)
         renderer.commandBufferMemory = VK_NULL_HANDLE;
     }
     renderer.commandBufferSize = 0;
+    if (renderer.tileBinStorage != VK_NULL_HANDLE)
+    {
+        vkDestroyBuffer(renderer.device, renderer.tileBinStorage, nullptr);
+        renderer.tileBinStorage = VK_NULL_HANDLE;
+    }
+    if (renderer.tileBinMemory != VK_NULL_HANDLE)
+    {
+        vkFreeMemory(renderer.device, renderer.tileBinMemory, nullptr);
+        renderer.tileBinMemory = VK_NULL_HANDLE;
+    }
+    renderer.tileBinSize = 0;
     renderer.queue = VK_NULL_HANDLE;
     renderer.device = VK_NULL_HANDLE;
 }
@@ -265,48 +339,170 @@ bool ensureWidgetCommandStorage(Engine2D* engine, WidgetRenderer& renderer, VkDe
         return false;
     }
 
-    if (renderer.commandBufferStorage != VK_NULL_HANDLE && renderer.commandBufferSize >= size)
+    return ensureHostBuffer(engine,
+                            renderer.device,
+                            renderer.commandBufferStorage,
+                            renderer.commandBufferMemory,
+                            renderer.commandBufferSize,
+                            size);
+}
+
+bool commandBounds(const DrawCommand& command, glm::vec4& bounds)
+{
+    float x0 = 0.0f, y0 = 0.0f, x1 = 0.0f, y1 = 0.0f;
+    switch (command.type)
     {
-        return true;
+    case CMD_RECT:
+    {
+        // Strokes are centred on the outline
+        const float halfStroke = std::max(command.params2.y, 0.0f) * 0.5f;
+        x0 = command.params.x - command.params.z * 0.5f - halfStroke;
+        y0 = command.params.y - command.params.w * 0.5f - halfStroke;
+        x1 = command.params.x + command.params.z * 0.5f + halfStroke;
+        y1 = command.params.y + command.params.w * 0.5f + halfStroke;
+        break;
     }
-
-    if (renderer.commandBufferStorage != VK_NULL_HANDLE)
+    case CMD_CIRCLE:
     {
-        vkDestroyBuffer(renderer.device, renderer.commandBufferStorage, nullptr);
-        renderer.commandBufferStorage = VK_NULL_HANDLE;
+        const float extent = command.params.z + std::max(command.params2.y, 0.0f) * 0.5f;
+        x0 = command.params.x - extent;
+        y0 = command.params.y - extent;
+        x1 = command.params.x + extent;
+        y1 = command.params.y + extent;
+        break;
     }
-    if (renderer.commandBufferMemory != VK_NULL_HANDLE)
+    case CMD_LINE:
     {
-        vkFreeMemory(renderer.device, renderer.commandBufferMemory, nullptr);
-        renderer.commandBufferMemory = VK_NULL_HANDLE;
+        const float halfThickness = command.params2.x * 0.5f;
+        x0 = std::min(command.params.x, command.params.z) - halfThickness;
+        y0 = std::min(command.params.y, command.params.w) - halfThickness;
+        x1 = std::max(command.params.x, command.params.z) + halfThickness;
+        y1 = std::max(command.params.y, command.params.w) + halfThickness;
+        break;
     }
-
-    engine->createBuffer(size,
-                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                         renderer.commandBufferStorage,
-                         renderer.commandBufferMemory);
-    if (renderer.commandBufferStorage == VK_NULL_HANDLE || renderer.commandBufferMemory == VK_NULL_HANDLE)
+    case CMD_GRID:
     {
+        const float halfThickness = command.params2.z * 0.5f;
+        x0 = command.params.x - halfThickness;
+        y0 = command.params.y - halfThickness;
+        x1 = command.params.x + command.params.z + halfThickness;
+        y1 = command.params.y + command.params.w + halfThickness;
+        break;
+    }
+    default:
         return false;
     }
 
-    renderer.commandBufferSize = size;
+    if (command.color.a <= 0.0f || !(x1 > x0) || !(y1 > y0))
+    {
+        return false;
+    }
+    // Anti-aliased edges reach half a pixel past the shape (and sub-pixel lines are widened
+    // to one pixel), so padding by one pixel keeps the bins conservative.
+    bounds = glm::vec4(std::floor(x0) - 1.0f, std::floor(y0) - 1.0f, std::ceil(x1) + 1.0f, std::ceil(y1) + 1.0f);
     return true;
 }
 
-void appendButtonCommands(std::vector<DrawCommand>& commands, const ButtonDescriptor& descriptor)
+void binCommands(const std::vector<DrawCommand>& commands, uint32_t width, uint32_t height, TileBins& bins)
 {
-    const glm::vec2 padding(descriptor.borderThickness * 2.0f);
-    const glm::vec2 outerSize = descriptor.size + padding;
-    commands.push_back(makeRectCommand(descriptor.center, outerSize, descriptor.borderColor));
+    bins.tilesX = (width + kWidgetTileSize - 1) / kWidgetTileSize;
+    bins.tilesY = (height + kWidgetTileSize - 1) / kWidgetTileSize;
+    const uint32_t tileCount = bins.tilesX * bins.tilesY;
+    const uint32_t header = tileCount * 2;
+
+    // Tile rectangle of every command that can draw something on screen
+    auto tileRange = [&](const DrawCommand& command, uint32_t& tx0, uint32_t& ty0, uint32_t& tx1, uint32_t& ty1)
+    {
+        glm::vec4 b(0.0f);
+        if (!commandBounds(command, b) || b.z <= 0.0f || b.w <= 0.0f ||
+            b.x >= static_cast<float>(width) || b.y >= static_cast<float>(height))
+        {
+            return false;
+        }
+        tx0 = static_cast<uint32_t>(std::max(b.x, 0.0f)) / kWidgetTileSize;
+        ty0 = static_cast<uint32_t>(std::max(b.y, 0.0f)) / kWidgetTileSize;
+        tx1 = static_cast<uint32_t>(std::min(b.z, static_cast<float>(width - 1))) / kWidgetTileSize;
+        ty1 = static_cast<uint32_t>(std::min(b.w, static_cast<float>(height - 1))) / kWidgetTileSize;
+        return true;
+    };
+
+    // Pass 1: per-tile counts
+    bins.data.assign(header, 0u);
+    for (const auto& command : commands)
+    {
+        uint32_t tx0, ty0, tx1, ty1;
+        if (!tileRange(command, tx0, ty0, tx1, ty1))
+        {
+            continue;
+        }
+        for (uint32_t ty = ty0; ty <= ty1; ++ty)
+        {
+            for (uint32_t tx = tx0; tx <= tx1; ++tx)
+            {
+                ++bins.data[(ty * bins.tilesX + tx) * 2 + 1];
+            }
+        }
+    }
+
+    // Prefix sum into absolute starts
+    uint32_t total = header;
+    bins.cursor.resize(tileCount);
+    for (uint32_t t = 0; t < tileCount; ++t)
+    {
+        bins.data[t * 2] = total;
+        bins.cursor[t] = total;
+        total += bins.data[t * 2 + 1];
+    }
+    bins.data.resize(total);
+
+    // Pass 2: scatter indices; walking commands in order keeps each tile in draw order
+    for (uint32_t i = 0; i < static_cast<uint32_t>(commands.size()); ++i)
+    {
+        uint32_t tx0, ty0, tx1, ty1;
+        if (!tileRange(commands[i], tx0, ty0, tx1, ty1))
+        {
+            continue;
+        }
+        for (uint32_t ty = ty0; ty <= ty1; ++ty)
+        {
+            for (uint32_t tx = tx0; tx <= tx1; ++tx)
+            {
+                bins.data[bins.cursor[ty * bins.tilesX + tx]++] = i;
+            }
+        }
+    }
+}
 
-    glm::vec2 innerSize = descriptor.size - padding;
-    innerSize.x = std::max(innerSize.x, 0.0f);
-    innerSize.y = std::max(innerSize.y, 0.0f);
-    if (innerSize.x > 0.0f && innerSize.y > 0.0f)
+void binAllCommands(size_t commandCount, uint32_t width, uint32_t height, TileBins& bins)
+{
+    bins.tilesX = (width + kWidgetTileSize - 1) / kWidgetTileSize;
+    bins.tilesY = (height + kWidgetTileSize - 1) / kWidgetTileSize;
+    const uint32_t tileCount = bins.tilesX * bins.tilesY;
+    const uint32_t header = tileCount * 2;
+    const uint32_t count = static_cast<uint32_t>(commandCount);
+
+    bins.data.resize(header + count);
+    for (uint32_t t = 0; t < tileCount; ++t)
+    {
+        bins.data[t * 2] = header;
+        bins.data[t * 2 + 1] = count;
+    }
+    for (uint32_t i = 0; i < count; ++i)
     {
-        commands.push_back(makeRectCommand(descriptor.center, innerSize, descriptor.backgroundColor));
+        bins.data[header + i] = i;
+    }
+}
+
+void appendButtonCommands(std::vector<DrawCommand>& commands, const ButtonDescriptor& descriptor)
+{
+    // Fill, then the border as a stroke centred on the edge; it spans the same band the
+    // old stacked outer/inner rectangles covered.
+    commands.push_back(makeRectCommand(descriptor.center, descriptor.size, descriptor.backgroundColor,
+                                       descriptor.cornerRadius));
+    if (descriptor.borderThickness > 0.0f)
+    {
+        commands.push_back(makeRectCommand(descriptor.center, descriptor.size, descriptor.borderColor,
+                                           descriptor.cornerRadius, descriptor.borderThickness * 2.0f));
     }
 }
 
@@ -326,7 +522,10 @@ void appendSliderCommands(std::vector<DrawCommand>& commands, const SliderDescri
     commands.push_back(makeCircleCommand(handlePos, descriptor.handleRadius, descriptor.handleColor));
     if (descriptor.handleBorderColor.a > 0.0f)
     {
-        commands.push_back(makeCircleCommand(handlePos, descriptor.handleRadius + thickness * 0.25f, descriptor.handleBorderColor));
+        // Ring from handleRadius outwards, so the border no longer covers the handle
+        const float ring = thickness * 0.25f;
+        commands.push_back(makeCircleCommand(handlePos, descriptor.handleRadius + ring * 0.5f,
+                                             descriptor.handleBorderColor, ring));
     }
 }
 
@@ -379,6 +578,26 @@ bool runWidgetRenderer(Engine2D* engine,
 
     vkUnmapMemory(renderer.device, renderer.commandBufferMemory);
 
+    if (renderer.binning)
+    {
+        binCommands(commands, width, height, renderer.bins);
+    }
+    else
+    {
+        binAllCommands(commands.size(), width, height, renderer.bins);
+    }
+    const VkDeviceSize binBytes = static_cast<VkDeviceSize>(renderer.bins.data.size()) * sizeof(uint32_t);
+    if (!ensureHostBuffer(engine,
+                          renderer.device,
+                          renderer.tileBinStorage,
+                          renderer.tileBinMemory,
+                          renderer.tileBinSize,
+                          binBytes) ||
+        !uploadHostBuffer(renderer.device, renderer.tileBinMemory, renderer.bins.data.data(), binBytes))
+    {
+        return false;
+    }
+
     VkDescriptorImageInfo imageInfo{};
     imageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
     imageInfo.imageView = target.view;
@@ -388,7 +607,12 @@ bool runWidgetRenderer(Engine2D* engine,
     bufferInfo.offset = 0;
     bufferInfo.range = requiredSize;
 
-    VkWriteDescriptorSet writes[2]{};
+    VkDescriptorBufferInfo binInfo{};
+    binInfo.buffer = renderer.tileBinStorage;
+    binInfo.offset = 0;
+    binInfo.range = binBytes;
+
+    VkWriteDescriptorSet writes[3]{};
     writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
     writes[0].dstSet = renderer.descriptorSet;
     writes[0].dstBinding = 0;
@@ -403,7 +627,14 @@ bool runWidgetRenderer(Engine2D* engine,
     writes[1].descriptorCount = 1;
     writes[1].pBufferInfo = &bufferInfo;
 
-    vkUpdateDescriptorSets(renderer.device, 2, writes, 0, nullptr);
+    writes[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[2].dstSet = renderer.descriptorSet;
+    writes[2].dstBinding = 2;
+    writes[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    writes[2].descriptorCount = 1;
+    writes[2].pBufferInfo = &binInfo;
+
+    vkUpdateDescriptorSets(renderer.device, 3, writes, 0, nullptr);
 
     vkResetCommandBuffer(renderer.commandBuffer, 0);
 
@@ -456,6 +687,12 @@ bool runWidgetRenderer(Engine2D* engine,
                          1,
                          &toGeneral);
 
+    if (renderer.timestampPool != VK_NULL_HANDLE)
+    {
+        vkCmdResetQueryPool(renderer.commandBuffer, renderer.timestampPool, 0, 2);
+        vkCmdWriteTimestamp(renderer.commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, renderer.timestampPool, 0);
+    }
+
     vkCmdBindPipeline(renderer.commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, renderer.pipeline);
     vkCmdBindDescriptorSets(renderer.commandBuffer,
                             VK_PIPELINE_BIND_POINT_COMPUTE,
@@ -480,6 +717,11 @@ bool runWidgetRenderer(Engine2D* engine,
     const uint32_t groupY = (height + 15) / 16;
     vkCmdDispatch(renderer.commandBuffer, groupX, groupY, 1);
 
+    if (renderer.timestampPool != VK_NULL_HANDLE)
+    {
+        vkCmdWriteTimestamp(renderer.commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, renderer.timestampPool, 1);
+    }
+
     VkImageMemoryBarrier toRead{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
     toRead.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
     toRead.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
@@ -509,7 +751,11 @@ bool runWidgetRenderer(Engine2D* engine,
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &renderer.commandBuffer;
 
-    vkQueueSubmit(renderer.queue, 1, &submitInfo, renderer.fence);
+    {
+        // Shared with the decoders and the render loop
+        std::lock_guard<std::mutex> queueLock(vulkanQueueMutex(engine->graphicsQueueFamilyIndex));
+        vkQueueSubmit(renderer.queue, 1, &submitInfo, renderer.fence);
+    }
     vkWaitForFences(renderer.device, 1, &renderer.fence, VK_TRUE, UINT64_MAX);
 
     target.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
@@ -27,6 +27,8 @@ struct DrawCommand
     uint32_t padding[3] = {0, 0, 0};
     glm::vec4 color = glm::vec4(0.0f);
     glm::vec4 params = glm::vec4(0.0f);
+    // rect: x = corner radius, y = stroke width; circle: y = stroke width (0 = filled);
+    // line: x = thickness; grid: xy = cell count, z = line thickness
     glm::vec4 params2 = glm::vec4(0.0f);
 };
 
@@ -37,6 +39,7 @@ struct ButtonDescriptor
     glm::vec4 backgroundColor{0.2f, 0.2f, 0.2f, 1.0f};
     glm::vec4 borderColor{0.05f, 0.05f, 0.05f, 1.0f};
     float borderThickness = 2.0f;
+    float cornerRadius = 0.0f;
 };
 
 struct SliderDescriptor
@@ -52,6 +55,26 @@ struct SliderDescriptor
     glm::vec4 handleBorderColor{0.0f, 0.0f, 0.0f, 0.85f};
 };
 
+// Commands binned into 16x16 tiles by bounding box (the same scheme as Text's TileSpans),
+// so widgets.comp only evaluates the commands that can touch a pixel's tile.
+constexpr uint32_t kWidgetTileSize = 16;
+
+struct TileBins
+{
+    uint32_t tilesX = 0;
+    uint32_t tilesY = 0;
+    // (start, count) per tile, row-major, then the command indices of every tile in draw
+    // order; start is an absolute offset into data. Uploaded as-is to binding 2.
+    std::vector<uint32_t> data;
+    std::vector<uint32_t> cursor; // scratch reused between calls
+};
+
+// Conservative pixel bounds of a command, [x0, x1) x [y0, y1); false if it draws nothing.
+bool commandBounds(const DrawCommand& command, glm::vec4& bounds);
+void binCommands(const std::vector<DrawCommand>& commands, uint32_t width, uint32_t height, TileBins& bins);
+// Every tile lists every command (one shared list): the unbinned loop, for comparisons.
+void binAllCommands(size_t commandCount, uint32_t width, uint32_t height, TileBins& bins);
+
 struct WidgetPushConstants
 {
     glm::vec2 outputSize;
@@ -75,6 +98,13 @@ struct WidgetRenderer
     VkBuffer commandBufferStorage = VK_NULL_HANDLE;
     VkDeviceMemory commandBufferMemory = VK_NULL_HANDLE;
     VkDeviceSize commandBufferSize = 0;
+    VkBuffer tileBinStorage = VK_NULL_HANDLE;
+    VkDeviceMemory tileBinMemory = VK_NULL_HANDLE;
+    VkDeviceSize tileBinSize = 0;
+    TileBins bins;
+    bool binning = true; // false: binAllCommands, every pixel walks every command
+    // Optional (benchmarks): when set, the dispatch is bracketed by timestamps 0 and 1.
+    VkQueryPool timestampPool = VK_NULL_HANDLE;
 };
 
 bool initializeWidgetRenderer(Engine2D* engine, WidgetRenderer& renderer);
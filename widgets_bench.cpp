@@ -0,0 +1,519 @@
+// widgets_bench.cpp
+//
+// GPU cost of widgets.comp with and without the 16x16 tile bins built by
+// widgets::binCommands, for 10 / 100 / 1000 grading-UI style primitives (slider tracks,
+// handles, buttons, grids). Each variant is the real WidgetRenderer dispatch, timed with
+// timestamp queries around it (median of --iterations runs); the binned and unbinned outputs
+// are read back and compared.
+//
+// A second table compares the analytic-coverage edges against supersampling: the same
+// commands rendered by widgets.comp at 1x, 2x2 and 4x4 the panel size (scaled up, then box
+// filtered on the host), each measured against a CPU 16x16 supersampled hard-edged reference:
+// GPU dispatch cost and mean / max per-channel error of the premultiplied result. The
+// downscale itself is not timed. Run from the repository root so shaders/*.spv resolve.
+
+#include "engine2d.h"
+#include "image_resource.h"
+#include "widgets.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+struct Rgba
+{
+    float r = 0.0f, g = 0.0f, b = 0.0f, a = 0.0f;
+};
+
+// Premultiplied "over", as widgets.comp blends while walking the commands
+void blend(Rgba& dst, const glm::vec4& c, float coverage)
+{
+    const float a = c.a * coverage;
+    dst.r = c.r * a + dst.r * (1.0f - a);
+    dst.g = c.g * a + dst.g * (1.0f - a);
+    dst.b = c.b * a + dst.b * (1.0f - a);
+    dst.a = a + dst.a * (1.0f - a);
+}
+
+float segmentDistance(float px, float py, float ax, float ay, float bx, float by)
+{
+    const float pax = px - ax, pay = py - ay;
+    const float bax = bx - ax, bay = by - ay;
+    const float len2 = bax * bax + bay * bay;
+    const float h = len2 > 0.0f ? std::clamp((pax * bax + pay * bay) / len2, 0.0f, 1.0f) : 0.0f;
+    return std::hypot(pax - bax * h, pay - bay * h);
+}
+
+float boxDistance(float px, float py, float hx, float hy)
+{
+    const float dx = std::abs(px) - hx, dy = std::abs(py) - hy;
+    return std::hypot(std::max(dx, 0.0f), std::max(dy, 0.0f)) + std::min(std::max(dx, dy), 0.0f);
+}
+
+float coverage(float d)
+{
+    return std::clamp(0.5f - d, 0.0f, 1.0f);
+}
+
+float bandCoverage(float d, float width)
+{
+    const float drawn = std::max(width, 1.0f);
+    return coverage(std::abs(d) - drawn * 0.5f) * std::min(width, 1.0f);
+}
+
+// Signed distance of a command at (fx, fy) and the width of its band (0 = filled). Grids
+// resolve to their nearest vertical or horizontal line; see shade().
+float commandDistance(const widgets::DrawCommand& cmd, float fx, float fy, float& band)
+{
+    const glm::vec4& p = cmd.params;
+    switch (cmd.type)
+    {
+    case widgets::CMD_RECT:
+    {
+        const float hx = p.z * 0.5f, hy = p.w * 0.5f;
+        const float r = std::clamp(cmd.params2.x, 0.0f, std::min(hx, hy));
+        band = std::max(cmd.params2.y, 0.0f);
+        return boxDistance(fx - p.x, fy - p.y, hx - r, hy - r) - r;
+    }
+    case widgets::CMD_CIRCLE:
+        band = std::max(cmd.params2.y, 0.0f);
+        return std::hypot(fx - p.x, fy - p.y) - p.z;
+    case widgets::CMD_LINE:
+        band = cmd.params2.x;
+        return segmentDistance(fx, fy, p.x, p.y, p.z, p.w);
+    default:
+        band = 0.0f;
+        return 1e9f;
+    }
+}
+
+// Mirrors the per-command branches of shaders/widgets.comp. With hard set, edges use the
+// previous inside/outside test instead of analytic coverage.
+void shade(const widgets::DrawCommand& cmd, float fx, float fy, Rgba& color, bool hard = false)
+{
+    auto apply = [&](const widgets::DrawCommand& shape)
+    {
+        float band = 0.0f;
+        const float d = commandDistance(shape, fx, fy, band);
+        float cov = 0.0f;
+        if (hard)
+        {
+            cov = (band > 0.0f ? std::abs(d) - band * 0.5f : d) <= 0.0f ? 1.0f : 0.0f;
+        }
+        else
+        {
+            cov = band > 0.0f ? bandCoverage(d, band) : coverage(d);
+        }
+        if (cov > 0.0f)
+            blend(color, shape.color, cov);
+    };
+
+    if (cmd.type != widgets::CMD_GRID)
+    {
+        apply(cmd);
+        return;
+    }
+    const glm::vec4& p = cmd.params;
+    const float cellsX = std::max(std::floor(cmd.params2.x), 1.0f);
+    const float cellsY = std::max(std::floor(cmd.params2.y), 1.0f);
+    const float cellW = p.z / cellsX, cellH = p.w / cellsY;
+    widgets::DrawCommand line{};
+    line.type = widgets::CMD_LINE;
+    line.color = cmd.color;
+    line.params2.x = cmd.params2.z;
+    const float x = p.x + std::clamp(std::round((fx - p.x) / cellW), 0.0f, cellsX) * cellW;
+    line.params = glm::vec4(x, p.y, x, p.y + p.w);
+    apply(line);
+    const float y = p.y + std::clamp(std::round((fy - p.y) / cellH), 0.0f, cellsY) * cellH;
+    line.params = glm::vec4(p.x, y, p.x + p.z, y);
+    apply(line);
+}
+
+// Slider rows, buttons and the occasional curve grid, scattered like a busy grading panel.
+std::vector<widgets::DrawCommand> makeCommands(size_t count, uint32_t width, uint32_t height)
+{
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> ux(16.0f, float(width) - 16.0f);
+    std::uniform_real_distribution<float> uy(16.0f, float(height) - 16.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    std::vector<widgets::DrawCommand> commands;
+    commands.reserve(count + 4);
+    while (commands.size() < count)
+    {
+        const float pick = unit(rng);
+        if (pick < 0.6f)
+        {
+            widgets::SliderDescriptor slider{};
+            slider.start = glm::vec2(ux(rng), uy(rng));
+            slider.end = glm::vec2(std::min(slider.start.x + 80.0f + 200.0f * unit(rng), float(width) - 8.0f),
+                                   slider.start.y);
+            slider.value = unit(rng);
+            widgets::appendSliderCommands(commands, slider);
+        }
+        else if (pick < 0.95f)
+        {
+            widgets::ButtonDescriptor button{};
+            button.center = glm::vec2(ux(rng), uy(rng));
+            button.size = glm::vec2(60.0f + 80.0f * unit(rng), 24.0f + 12.0f * unit(rng));
+            button.cornerRadius = 6.0f;
+            widgets::appendButtonCommands(commands, button);
+        }
+        else
+        {
+            widgets::DrawCommand grid{};
+            grid.type = widgets::CMD_GRID;
+            grid.color = glm::vec4(0.22f, 0.22f, 0.22f, 1.0f);
+            grid.params = glm::vec4(ux(rng) * 0.5f, uy(rng) * 0.5f, 160.0f, 120.0f);
+            grid.params2 = glm::vec4(4.0f, 4.0f, 1.0f, 0.0f);
+            commands.push_back(grid);
+        }
+    }
+    commands.resize(count);
+    return commands;
+}
+
+// Reference: the binned loop evaluated on a samples x samples grid per pixel with hard edges
+// and box-filtered; premultiplied, like the shader's accumulator.
+void renderReference(const std::vector<widgets::DrawCommand>& commands, const widgets::TileBins& bins, uint32_t width,
+                     uint32_t height, uint32_t samples, std::vector<Rgba>& image)
+{
+    const float step = 1.0f / float(samples);
+    const float weight = 1.0f / float(samples * samples);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            const uint32_t tile = (y / widgets::kWidgetTileSize) * bins.tilesX + x / widgets::kWidgetTileSize;
+            const uint32_t start = bins.data[tile * 2];
+            const uint32_t count = bins.data[tile * 2 + 1];
+            Rgba sum{};
+            for (uint32_t sy = 0; sy < samples; ++sy)
+            {
+                for (uint32_t sx = 0; sx < samples; ++sx)
+                {
+                    const float fx = float(x) + (float(sx) + 0.5f) * step;
+                    const float fy = float(y) + (float(sy) + 0.5f) * step;
+                    Rgba color{};
+                    for (uint32_t j = 0; j < count; ++j)
+                        shade(commands[bins.data[start + j]], fx, fy, color, true);
+                    sum.r += color.r * weight;
+                    sum.g += color.g * weight;
+                    sum.b += color.b * weight;
+                    sum.a += color.a * weight;
+                }
+            }
+            image[size_t(y) * width + x] = sum;
+        }
+    }
+}
+
+// The same panel drawn `scale` times larger, for rendering supersampled
+std::vector<widgets::DrawCommand> scaleCommands(const std::vector<widgets::DrawCommand>& commands, float scale)
+{
+    std::vector<widgets::DrawCommand> scaled = commands;
+    for (auto& cmd : scaled)
+    {
+        cmd.params.x *= scale;
+        cmd.params.y *= scale;
+        cmd.params.z *= scale;
+        cmd.params.w *= scale;
+        switch (cmd.type)
+        {
+        case widgets::CMD_RECT:
+            cmd.params2.x *= scale;
+            cmd.params2.y *= scale;
+            break;
+        case widgets::CMD_CIRCLE:
+            cmd.params2.y *= scale;
+            break;
+        case widgets::CMD_LINE:
+            cmd.params2.x *= scale;
+            break;
+        case widgets::CMD_GRID:
+            cmd.params2.z *= scale;
+            break;
+        default:
+            break;
+        }
+    }
+    return scaled;
+}
+
+void imageBarrier(VkCommandBuffer cmd, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout,
+                  VkAccessFlags srcAccess, VkAccessFlags dstAccess, VkPipelineStageFlags srcStage,
+                  VkPipelineStageFlags dstStage)
+{
+    VkImageMemoryBarrier b{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+    b.oldLayout = oldLayout;
+    b.newLayout = newLayout;
+    b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    b.image = image;
+    b.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    b.subresourceRange.levelCount = 1;
+    b.subresourceRange.layerCount = 1;
+    b.srcAccessMask = srcAccess;
+    b.dstAccessMask = dstAccess;
+    vkCmdPipelineBarrier(cmd, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &b);
+}
+
+// The renderer's RGBA8 output (straight alpha) as premultiplied floats, box-filtered down by
+// `scale` in each direction.
+std::vector<Rgba> readTarget(Engine2D& engine, ImageResource& target, uint32_t scale)
+{
+    const VkDeviceSize size = VkDeviceSize(target.width) * target.height * 4u;
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    engine.createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, buffer, memory);
+
+    VkCommandBuffer cmd = engine.beginSingleTimeCommands();
+    imageBarrier(cmd, target.image, target.layout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT,
+                 VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    VkBufferImageCopy region{};
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent = VkExtent3D{target.width, target.height, 1};
+    vkCmdCopyImageToBuffer(cmd, target.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, buffer, 1, &region);
+    imageBarrier(cmd, target.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                 VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    engine.endSingleTimeCommands(cmd);
+    target.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    std::vector<uint8_t> texels(static_cast<size_t>(size));
+    void* mapped = nullptr;
+    vkMapMemory(engine.logicalDevice, memory, 0, size, 0, &mapped);
+    std::memcpy(texels.data(), mapped, texels.size());
+    vkUnmapMemory(engine.logicalDevice, memory);
+    vkDestroyBuffer(engine.logicalDevice, buffer, nullptr);
+    vkFreeMemory(engine.logicalDevice, memory, nullptr);
+
+    const uint32_t width = target.width / scale;
+    const uint32_t height = target.height / scale;
+    const float weight = 1.0f / float(scale * scale);
+    std::vector<Rgba> image(size_t(width) * height);
+    for (uint32_t y = 0; y < height * scale; ++y)
+    {
+        for (uint32_t x = 0; x < width * scale; ++x)
+        {
+            const uint8_t* t = &texels[(size_t(y) * target.width + x) * 4];
+            const float a = float(t[3]) / 255.0f;
+            Rgba& dst = image[size_t(y / scale) * width + x / scale];
+            dst.r += float(t[0]) / 255.0f * a * weight;
+            dst.g += float(t[1]) / 255.0f * a * weight;
+            dst.b += float(t[2]) / 255.0f * a * weight;
+            dst.a += a * weight;
+        }
+    }
+    return image;
+}
+
+// Median of the renderer's own dispatch timestamps over `iterations` cleared redraws
+double medianGpuMs(Engine2D& engine, widgets::WidgetRenderer& renderer, ImageResource& target,
+                   const std::vector<widgets::DrawCommand>& commands, int iterations)
+{
+    constexpr int kWarmupIterations = 3;
+    const double periodNs = double(engine.getDeviceProperties().limits.timestampPeriod);
+    std::vector<double> samples;
+    for (int i = 0; i < kWarmupIterations + iterations; ++i)
+    {
+        if (!widgets::runWidgetRenderer(&engine, renderer, target, target.width, target.height, commands, true))
+            throw std::runtime_error("widgets_bench: runWidgetRenderer failed");
+
+        uint64_t ticks[2] = {0, 0};
+        if (vkGetQueryPoolResults(engine.logicalDevice, renderer.timestampPool, 0, 2, sizeof(ticks), ticks,
+                                  sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT) != VK_SUCCESS)
+            throw std::runtime_error("widgets_bench: timestamp readback failed");
+        if (i >= kWarmupIterations && ticks[1] >= ticks[0])
+            samples.push_back(double(ticks[1] - ticks[0]) * periodNs * 1e-6);
+    }
+    if (samples.empty())
+        return 0.0;
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+void compareImages(const std::vector<Rgba>& a, const std::vector<Rgba>& b, double& meanDiff, float& maxDiff)
+{
+    double sum = 0.0;
+    maxDiff = 0.0f;
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        const float d[4] = {std::abs(a[i].r - b[i].r), std::abs(a[i].g - b[i].g), std::abs(a[i].b - b[i].b),
+                            std::abs(a[i].a - b[i].a)};
+        for (float v : d)
+        {
+            sum += v;
+            maxDiff = std::max(maxDiff, v);
+        }
+    }
+    meanDiff = a.empty() ? 0.0 : sum / (double(a.size()) * 4.0);
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    // Grading panel size at scale 1 (ColorGradingUi's kBaseWidth x kBaseHeight)
+    uint32_t width = 420;
+    uint32_t height = 880;
+    int iterations = 50;
+    std::vector<size_t> counts{10, 100, 1000};
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--size" && i + 2 < argc)
+        {
+            width = uint32_t(std::stoul(argv[++i]));
+            height = uint32_t(std::stoul(argv[++i]));
+        }
+        else if (arg.rfind("--iterations=", 0) == 0)
+        {
+            iterations = std::max(1, std::atoi(arg.substr(std::string("--iterations=").size()).c_str()));
+        }
+        else if (arg == "--help" || arg == "-h")
+        {
+            std::cout << "Usage: widgets_bench [--size W H] [--iterations=N]\n";
+            return 0;
+        }
+    }
+    if (width == 0 || height == 0)
+    {
+        std::cerr << "[WidgetsBench] Invalid size\n";
+        return 1;
+    }
+
+    Engine2D engine;
+    if (!engine.initialize(false))
+    {
+        std::cerr << "[WidgetsBench] Failed to initialise Vulkan\n";
+        return 1;
+    }
+    const VkPhysicalDeviceLimits& limits = engine.getDeviceProperties().limits;
+    if (!limits.timestampComputeAndGraphics || limits.timestampPeriod <= 0.0f)
+    {
+        std::cerr << "[WidgetsBench] Device has no compute timestamps\n";
+        return 1;
+    }
+
+    widgets::WidgetRenderer renderer{};
+    if (!widgets::initializeWidgetRenderer(&engine, renderer))
+    {
+        std::cerr << "[WidgetsBench] Failed to create the widget renderer\n";
+        return 1;
+    }
+    VkQueryPoolCreateInfo qi{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+    qi.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    qi.queryCount = 2;
+    if (vkCreateQueryPool(engine.logicalDevice, &qi, nullptr, &renderer.timestampPool) != VK_SUCCESS)
+    {
+        std::cerr << "[WidgetsBench] Failed to create the timestamp query pool\n";
+        widgets::destroyWidgetRenderer(renderer);
+        return 1;
+    }
+
+    const VkImageUsageFlags usage =
+        VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    int failures = 0;
+    try
+    {
+        std::cout << "[WidgetsBench] " << engine.getDeviceProperties().deviceName << ", " << width << "x" << height
+                  << ", " << widgets::kWidgetTileSize << "px tiles, median of " << iterations << " dispatches\n";
+        std::cout << "   commands   bin ms   tested/px flat   tested/px binned   flat GPU ms   binned GPU ms   speedup   max diff\n";
+        std::cout << std::fixed;
+
+        bool recreated = false;
+        ImageResource target(&engine, target, width, height, VK_FORMAT_R8G8B8A8_UNORM, recreated, usage);
+        if (target.view == VK_NULL_HANDLE)
+            throw std::runtime_error("widgets_bench: failed to create the target image");
+
+        widgets::TileBins bins;
+        for (size_t count : counts)
+        {
+            const auto commands = makeCommands(count, width, height);
+
+            constexpr int kBinIterations = 50;
+            const auto b0 = std::chrono::steady_clock::now();
+            for (int it = 0; it < kBinIterations; ++it)
+                widgets::binCommands(commands, width, height, bins);
+            const double binMs =
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - b0).count() / kBinIterations;
+
+            // Every pixel of a tile walks that tile's list
+            const uint32_t tileCount = bins.tilesX * bins.tilesY;
+            double tested = 0.0;
+            for (uint32_t t = 0; t < tileCount; ++t)
+            {
+                const uint32_t tx = t % bins.tilesX, ty = t / bins.tilesX;
+                const uint32_t pw = std::min(widgets::kWidgetTileSize, width - tx * widgets::kWidgetTileSize);
+                const uint32_t ph = std::min(widgets::kWidgetTileSize, height - ty * widgets::kWidgetTileSize);
+                tested += double(bins.data[t * 2 + 1]) * pw * ph;
+            }
+            tested /= double(width) * height;
+
+            renderer.binning = false;
+            const double flatMs = medianGpuMs(engine, renderer, target, commands, iterations);
+            const std::vector<Rgba> flat = readTarget(engine, target, 1);
+            renderer.binning = true;
+            const double binnedMs = medianGpuMs(engine, renderer, target, commands, iterations);
+            const std::vector<Rgba> binned = readTarget(engine, target, 1);
+            double meanDiff = 0.0;
+            float maxDiff = 0.0f;
+            compareImages(flat, binned, meanDiff, maxDiff);
+
+            std::cout << std::setw(11) << count << std::setprecision(3) << std::setw(9) << binMs << std::setprecision(1)
+                      << std::setw(17) << double(count) << std::setw(19) << tested << std::setprecision(4)
+                      << std::setw(14) << flatMs << std::setw(16) << binnedMs << std::setprecision(1) << std::setw(9)
+                      << flatMs / std::max(binnedMs, 1e-6) << "x" << std::setprecision(4) << std::setw(11) << maxDiff
+                      << "\n";
+        }
+
+        // Edge quality against a 16x16 supersampled reference (100 commands)
+        const auto commands = makeCommands(100, width, height);
+        widgets::binCommands(commands, width, height, bins);
+        std::vector<Rgba> reference(size_t(width) * height);
+        renderReference(commands, bins, width, height, 16, reference);
+
+        std::cout << "\n[WidgetsBench] edge quality, 100 commands, vs 16x16 supersampled\n";
+        std::cout << "   mode                GPU ms     mean err    max err\n";
+        for (uint32_t scale : {1u, 2u, 4u})
+        {
+            ImageResource scaled(&engine, scaled, width * scale, height * scale, VK_FORMAT_R8G8B8A8_UNORM, recreated,
+                                 usage);
+            if (scaled.view == VK_NULL_HANDLE)
+                throw std::runtime_error("widgets_bench: failed to create the supersampled target");
+            const double ms = medianGpuMs(engine, renderer, scaled, scaleCommands(commands, float(scale)), iterations);
+            const std::vector<Rgba> image = readTarget(engine, scaled, scale);
+            double meanDiff = 0.0;
+            float maxDiff = 0.0f;
+            compareImages(reference, image, meanDiff, maxDiff);
+            const std::string name =
+                scale == 1 ? std::string("analytic 1x") : "analytic " + std::to_string(scale) + "x" + std::to_string(scale);
+            std::cout << "   " << std::left << std::setw(14) << name << std::right << std::setprecision(4)
+                      << std::setw(12) << ms << std::setprecision(5) << std::setw(13) << meanDiff << std::setprecision(4)
+                      << std::setw(11) << maxDiff << "\n";
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "[WidgetsBench] " << e.what() << "\n";
+        ++failures;
+    }
+
+    vkDestroyQueryPool(engine.logicalDevice, renderer.timestampPool, nullptr);
+    renderer.timestampPool = VK_NULL_HANDLE;
+    widgets::destroyWidgetRenderer(renderer);
+    return failures == 0 ? 0 : 1;
+}
@@ -1,4 +1,4 @@
-// yuv420p_to_rgba.cpp  (YUV420P -> RGBA, pass owns output)
+// yuv420p_to_rgba.cpp  (3-plane YUV 4:2:0 / 4:2:2 / 4:4:4 -> RGBA, pass owns output)
 #include "yuv420p_to_rgba.h"
 
 #include "engine2d.h"
@@ -6,6 +6,7 @@
 #include "debug_logging.h"
 
 #include <array>
+#include <cstddef>
 #include <cstring>
 #include <iostream>
 #include <stdexcept>
@@ -53,12 +54,14 @@ Yuv420pToRgbaPass::Yuv420pToRgbaPass(Engine2D* engine,
                                      uint32_t framesInFlight,
                                      int width,
                                      int height,
-                                     VkDescriptorType inputDescriptorType)
+                                     VkDescriptorType inputDescriptorType,
+                                     VkFormat outputFormat)
     : engine_(engine),
       framesInFlight_(framesInFlight),
       width_(width),
       height_(height),
-      inputDescriptorType_(inputDescriptorType)
+      inputDescriptorType_(inputDescriptorType),
+      outFormat_(outputFormat)
 {
     if (!engine_ || engine_->logicalDevice == VK_NULL_HANDLE)
         throw std::runtime_error("Yuv420pToRgbaPass: invalid engine");
@@ -77,6 +80,10 @@ Yuv420pToRgbaPass::Yuv420pToRgbaPass(Engine2D* engine,
     // That requires COMBINED_IMAGE_SAMPLER descriptors.
     if (!isSampledInputType(inputDescriptorType_))
         throw std::runtime_error("Yuv420pToRgbaPass: shader uses sampler2D, so inputDescriptorType must be VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER");
+
+    // The shader's output has no format qualifier; either intermediate format works.
+    if (outFormat_ != VK_FORMAT_R8G8B8A8_UNORM && outFormat_ != VK_FORMAT_R16G16B16A16_SFLOAT)
+        throw std::runtime_error("Yuv420pToRgbaPass: output format must be R8G8B8A8_UNORM or R16G16B16A16_SFLOAT");
 }
 
 Yuv420pToRgbaPass::~Yuv420pToRgbaPass()
@@ -86,6 +93,12 @@ Yuv420pToRgbaPass::~Yuv420pToRgbaPass()
 
     vkDeviceWaitIdle(engine_->logicalDevice);
 
+    if (timestampPool_ != VK_NULL_HANDLE)
+    {
+        vkDestroyQueryPool(engine_->logicalDevice, timestampPool_, nullptr);
+        timestampPool_ = VK_NULL_HANDLE;
+    }
+
     destroyDescriptors_();
     destroyOutputs_();
     destroyOutputSampler_();
@@ -100,12 +113,14 @@ void Yuv420pToRgbaPass::initialize()
     createOutputs_();
     createDescriptors_();
     createOutputSampler_();
+    createTimestampQueries_();
 
     initialized_ = true;
 
     if (renderDebugEnabled())
         std::cout << "[Yuv420pToRgbaPass] initialized framesInFlight=" << framesInFlight_
-                  << " size=" << width_ << "x" << height_ << std::endl;
+                  << " size=" << width_ << "x" << height_
+                  << " format=" << (outFormat_ == VK_FORMAT_R16G16B16A16_SFLOAT ? "rgba16f" : "rgba8") << std::endl;
 }
 
 void Yuv420pToRgbaPass::resize(int width, int height)
@@ -117,7 +132,8 @@ void Yuv420pToRgbaPass::resize(int width, int height)
     height_ = height;
 
     pushConstants.rgbaSize = glm::ivec2(width_, height_);
-    pushConstants.uvSize   = glm::ivec2(width_ / 2, height_ / 2);
+    pushConstants.uvSize   = glm::ivec2((width_ + (1 << pushConstants.chromaShift.x) - 1) >> pushConstants.chromaShift.x,
+                                        (height_ + (1 << pushConstants.chromaShift.y) - 1) >> pushConstants.chromaShift.y);
 
     destroyDescriptors_();
     destroyOutputs_();
@@ -157,7 +173,7 @@ void Yuv420pToRgbaPass::dispatch(VkCommandBuffer cmd, uint32_t frameIndex)
     if (!initialized_ || cmd == VK_NULL_HANDLE)
         return;
 
-    if (pipeline_ == VK_NULL_HANDLE || pipelineLayout_ == VK_NULL_HANDLE)
+    if (shaderModule_ == VK_NULL_HANDLE || pipelineLayout_ == VK_NULL_HANDLE)
         return;
 
     // Require inputs (views + samplers) because shader uses sampler2D.
@@ -169,6 +185,9 @@ void Yuv420pToRgbaPass::dispatch(VkCommandBuffer cmd, uint32_t frameIndex)
     if (fi >= outImages_.size() || fi >= descriptorSets_.size())
         return;
 
+    // This slot's previous submission has completed by the time it is recorded again.
+    readTimestamps_(fi);
+
     // Output must be GENERAL for imageStore()
     if (outLayouts_[fi] != VK_IMAGE_LAYOUT_GENERAL)
     {
@@ -189,7 +208,7 @@ void Yuv420pToRgbaPass::dispatch(VkCommandBuffer cmd, uint32_t frameIndex)
         outLayouts_[fi] = VK_IMAGE_LAYOUT_GENERAL;
     }
 
-    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_);
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineFor_(conversion));
     vkCmdBindDescriptorSets(cmd,
                             VK_PIPELINE_BIND_POINT_COMPUTE,
                             pipelineLayout_,
@@ -206,9 +225,21 @@ void Yuv420pToRgbaPass::dispatch(VkCommandBuffer cmd, uint32_t frameIndex)
                        sizeof(yuv420pToBGRPushConstants),
                        &pushConstants);
 
+    if (timestampPool_ != VK_NULL_HANDLE)
+    {
+        vkCmdResetQueryPool(cmd, timestampPool_, fi * 2, 2);
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampPool_, fi * 2);
+    }
+
     const uint32_t groupX = (static_cast<uint32_t>(width_) + 15u) / 16u;
     const uint32_t groupY = (static_cast<uint32_t>(height_) + 15u) / 16u;
     vkCmdDispatch(cmd, groupX, groupY, 1);
+
+    if (timestampPool_ != VK_NULL_HANDLE)
+    {
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, timestampPool_, fi * 2 + 1);
+        timestampsPending_[fi] = true;
+    }
 }
 
 PresentInput Yuv420pToRgbaPass::output(uint32_t frameIndex) const
@@ -288,25 +319,65 @@ void Yuv420pToRgbaPass::createPipeline_()
         throw std::runtime_error("Yuv420pToRgbaPass: failed to create pipeline layout");
 
     // Make sure this SPIR-V is compiled from the sampler2D version of the shader.
+    // The module stays alive so specialised variants can be created as streams need them.
     auto shaderCode = readSPIRVFile("shaders/yuv420p_to_rgba.spv");
-    VkShaderModule shaderModule = engine_->createShaderModule(shaderCode);
+    shaderModule_ = engine_->createShaderModule(shaderCode);
+
+    // Build the variant for the default conversion up front so a bad module fails here.
+    pipelineFor_(conversion);
+}
+
+VkPipeline Yuv420pToRgbaPass::pipelineFor_(const YuvConversion& c)
+{
+    for (const auto& entry : pipelines_)
+    {
+        if (entry.first == c)
+            return entry.second;
+    }
+
+    // constant_id 0..2 in the shader
+    struct SpecializationData
+    {
+        int32_t colorSpace;
+        int32_t colorRange;
+        float sampleScale;
+        VkBool32 swapUV;
+    } data{static_cast<int32_t>(c.colorSpace), static_cast<int32_t>(c.colorRange), yuvSampleScale(c),
+           c.swapUV ? VK_TRUE : VK_FALSE};
+
+    const std::array<VkSpecializationMapEntry, 3> entries{{
+        {0, offsetof(SpecializationData, colorSpace), sizeof(int32_t)},
+        {1, offsetof(SpecializationData, colorRange), sizeof(int32_t)},
+        {2, offsetof(SpecializationData, sampleScale), sizeof(float)},
+    }};
+
+    VkSpecializationInfo specialization{};
+    specialization.mapEntryCount = static_cast<uint32_t>(entries.size());
+    specialization.pMapEntries = entries.data();
+    specialization.dataSize = sizeof(data);
+    specialization.pData = &data;
 
     VkPipelineShaderStageCreateInfo stage{VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO};
     stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
-    stage.module = shaderModule;
+    stage.module = shaderModule_;
     stage.pName = "main";
+    stage.pSpecializationInfo = &specialization;
 
     VkComputePipelineCreateInfo cpi{VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO};
     cpi.stage = stage;
     cpi.layout = pipelineLayout_;
 
-    if (vkCreateComputePipelines(engine_->logicalDevice, VK_NULL_HANDLE, 1, &cpi, nullptr, &pipeline_) != VK_SUCCESS)
-    {
-        vkDestroyShaderModule(engine_->logicalDevice, shaderModule, nullptr);
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    if (vkCreateComputePipelines(engine_->logicalDevice, VK_NULL_HANDLE, 1, &cpi, nullptr, &pipeline) != VK_SUCCESS)
         throw std::runtime_error("Yuv420pToRgbaPass: failed to create compute pipeline");
-    }
 
-    vkDestroyShaderModule(engine_->logicalDevice, shaderModule, nullptr);
+    pipelines_.emplace_back(c, pipeline);
+
+    if (renderDebugEnabled())
+        std::cout << "[Yuv420pToRgbaPass] specialised pipeline colorSpace=" << c.colorSpace << " colorRange=" << c.colorRange
+                  << " bitDepth=" << c.bitDepth << " sampleShift=" << c.sampleShift
+                  << " (" << pipelines_.size() << " cached)" << std::endl;
+    return pipeline;
 }
 
 void Yuv420pToRgbaPass::destroyPipeline_()
@@ -314,10 +385,13 @@ void Yuv420pToRgbaPass::destroyPipeline_()
     if (!engine_ || engine_->logicalDevice == VK_NULL_HANDLE)
         return;
 
-    if (pipeline_ != VK_NULL_HANDLE)
+    for (auto& entry : pipelines_)
+        vkDestroyPipeline(engine_->logicalDevice, entry.second, nullptr);
+    pipelines_.clear();
+    if (shaderModule_ != VK_NULL_HANDLE)
     {
-        vkDestroyPipeline(engine_->logicalDevice, pipeline_, nullptr);
-        pipeline_ = VK_NULL_HANDLE;
+        vkDestroyShaderModule(engine_->logicalDevice, shaderModule_, nullptr);
+        shaderModule_ = VK_NULL_HANDLE;
     }
     if (pipelineLayout_ != VK_NULL_HANDLE)
     {
@@ -350,7 +424,10 @@ void Yuv420pToRgbaPass::createOutputs_()
         ii.arrayLayers = 1;
         ii.samples = VK_SAMPLE_COUNT_1_BIT;
         ii.tiling = VK_IMAGE_TILING_OPTIMAL;
-        ii.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT; // written by compute, can be sampled downstream
+        // written by compute, sampled downstream, copied out by ThumbnailStrip, scrubber hover
+        // thumbnails blitted in by Motive2D
+        ii.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                   VK_IMAGE_USAGE_TRANSFER_DST_BIT;
         ii.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
         ii.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 
@@ -385,7 +462,8 @@ void Yuv420pToRgbaPass::createOutputs_()
 
     // Default push constants
     pushConstants.rgbaSize = glm::ivec2(width_, height_);
-    pushConstants.uvSize   = glm::ivec2(width_ / 2, height_ / 2);
+    pushConstants.uvSize   = glm::ivec2((width_ + (1 << pushConstants.chromaShift.x) - 1) >> pushConstants.chromaShift.x,
+                                        (height_ + (1 << pushConstants.chromaShift.y) - 1) >> pushConstants.chromaShift.y);
 }
 
 void Yuv420pToRgbaPass::destroyOutputs_()
@@ -560,3 +638,43 @@ void Yuv420pToRgbaPass::destroyOutputSampler_()
         outputSampler_ = VK_NULL_HANDLE;
     }
 }
+
+void Yuv420pToRgbaPass::createTimestampQueries_()
+{
+    timestampsPending_.assign(framesInFlight_, false);
+
+    const VkPhysicalDeviceLimits& limits = engine_->getDeviceProperties().limits;
+    if (!limits.timestampComputeAndGraphics || limits.timestampPeriod <= 0.0f)
+        return;
+
+    VkQueryPoolCreateInfo qi{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+    qi.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    qi.queryCount = framesInFlight_ * 2;
+    if (vkCreateQueryPool(engine_->logicalDevice, &qi, nullptr, &timestampPool_) != VK_SUCCESS)
+    {
+        timestampPool_ = VK_NULL_HANDLE;
+        return;
+    }
+    timestampPeriodNs_ = static_cast<double>(limits.timestampPeriod);
+}
+
+void Yuv420pToRgbaPass::readTimestamps_(uint32_t frameIndex)
+{
+    if (timestampPool_ == VK_NULL_HANDLE || !timestampsPending_[frameIndex])
+        return;
+
+    std::array<uint64_t, 2> ticks{};
+    if (vkGetQueryPoolResults(engine_->logicalDevice,
+                              timestampPool_,
+                              frameIndex * 2,
+                              2,
+                              sizeof(ticks),
+                              ticks.data(),
+                              sizeof(uint64_t),
+                              VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+        return;
+
+    timestampsPending_[frameIndex] = false;
+    if (ticks[1] >= ticks[0])
+        lastGpuMs_ = static_cast<double>(ticks[1] - ticks[0]) * timestampPeriodNs_ * 1e-6;
+}
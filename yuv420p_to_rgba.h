@@ -1,11 +1,13 @@
-// yuv420p_to_rgba.h  (YUV420P -> RGBA, pass owns output)
+// yuv420p_to_rgba.h  (3-plane YUV 4:2:0 / 4:2:2 / 4:4:4 -> RGBA, pass owns output)
 #pragma once
 
 #include <vulkan/vulkan.h>
 #include "display2d.h"
+#include "nv12_to_rgba.h" // YuvConversion
 #include <glm/glm.hpp>
 
 #include <cstdint>
+#include <utility>
 #include <vector>
 
 class Engine2D;
@@ -15,10 +17,14 @@ struct yuv420pToBGRPushConstants
 {
     glm::ivec2 rgbaSize{0, 0};
     glm::ivec2 uvSize{0, 0};
-    uint32_t colorSpace = 0; // 0=BT.601, 1=BT.709, 2=BT.2020 (match your convention)
-    uint32_t colorRange = 1; // 1=full, 0=limited (match your convention)
+    glm::ivec2 chromaShift{1, 1}; // log2 chroma subsampling: (1,1) 4:2:0, (1,0) 4:2:2, (0,0) 4:4:4
+    glm::ivec2 srcSize{0, 0};     // luma plane size; when it differs from rgbaSize the output is a filtered downscale
 };
+static_assert(sizeof(yuv420pToBGRPushConstants) == 32, "Push constant size must match shader");
 
+// Converter for sources whose Vulkan frames carry Y, Cb and Cr in separate images
+// (YuvLayout::Planar420/422/444). The subsampling comes from pushConstants.chromaShift, so one
+// pipeline serves all three layouts; 2-plane surfaces go through Nv12ToRgbaPass.
 class Yuv420pToRgbaPass
 {
 public:
@@ -32,7 +38,8 @@ public:
                       uint32_t framesInFlight,
                       int width,
                       int height,
-                      VkDescriptorType inputDescriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+                      VkDescriptorType inputDescriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                      VkFormat outputFormat = VK_FORMAT_R8G8B8A8_UNORM);
 
     ~Yuv420pToRgbaPass();
 
@@ -69,6 +76,14 @@ public:
     // Push constants (set per frame)
     yuv420pToBGRPushConstants pushConstants{};
 
+    // Matrix / range / depth of the current stream (set per frame); dispatch() binds the
+    // pipeline specialised for it, creating and caching it on first use. swapUV is ignored.
+    YuvConversion conversion{};
+
+    // GPU time of the last completed dispatch in milliseconds (0 until one has finished).
+    double lastGpuMilliseconds() const { return lastGpuMs_; }
+    VkFormat outputFormat() const { return outFormat_; }
+
     uint32_t framesInFlight() const { return framesInFlight_; }
     int width() const { return width_; }
     int height() const { return height_; }
@@ -76,6 +91,7 @@ public:
 private:
     void createPipeline_();
     void destroyPipeline_();
+    VkPipeline pipelineFor_(const YuvConversion& conversion);
 
     void createOutputs_();
     void destroyOutputs_();
@@ -87,6 +103,9 @@ private:
     void createOutputSampler_();
     void destroyOutputSampler_();
 
+    void createTimestampQueries_();
+    void readTimestamps_(uint32_t frameIndex);
+
 private:
     Engine2D* engine_ = nullptr;
 
@@ -117,12 +136,19 @@ private:
     VkDescriptorPool descriptorPool_ = VK_NULL_HANDLE;
     std::vector<VkDescriptorSet> descriptorSets_;
 
-    // Pipeline
+    // Pipelines, one per YuvConversion seen so far
     VkPipelineLayout pipelineLayout_ = VK_NULL_HANDLE;
-    VkPipeline pipeline_ = VK_NULL_HANDLE;
+    VkShaderModule shaderModule_ = VK_NULL_HANDLE;
+    std::vector<std::pair<YuvConversion, VkPipeline>> pipelines_;
 
     // Sampler used when *downstream* wants to sample our RGBA output (ColorGrading)
     VkSampler outputSampler_ = VK_NULL_HANDLE;
 
+    // Two timestamps per frame slot around the dispatch
+    VkQueryPool timestampPool_ = VK_NULL_HANDLE;
+    std::vector<bool> timestampsPending_;
+    double timestampPeriodNs_ = 0.0;
+    double lastGpuMs_ = 0.0;
+
     bool initialized_ = false;
 };
\ No newline at end of file
@@ -0,0 +1,490 @@
+// yuv_convert_check.cpp
+//
+// Correctness check of the YUV->RGBA converters against FFmpeg's software conversion. For every
+// surface layout DecoderVulkan hands out (NV12 / P010 through Nv12ToRgbaPass, 3-plane 4:2:0,
+// 4:2:2 and 4:4:4 through Yuv420pToRgbaPass) a synthetic frame is converted by swscale and by
+// the real compute pass, headless: the planes are uploaded into R8/R16(G) UNORM images as the
+// decoder's views expose them, the pass is dispatched with the chromaShift push constant and the
+// YuvConversion specialisation Motive2D picks, and its RGBA8 output is read back. The frame has
+// full luma detail including sub-black / super-white codes and smooth chroma, so chroma siting,
+// which the converters do not model (co-sited point sampling), stays below one LSB. Exits
+// non-zero when any case exceeds the tolerance. Run from the repository root so shaders/*.spv
+// resolve.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "engine2d.h"
+#include "nv12_to_rgba.h"
+#include "yuv420p_to_rgba.h"
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/pixdesc.h>
+#include <libswscale/swscale.h>
+}
+
+namespace
+{
+constexpr int kWidth = 320;
+constexpr int kHeight = 180;
+constexpr int kMaxErrorLsb = 2;
+
+struct Case
+{
+    AVPixelFormat format;
+    const char* shader;
+};
+
+const Case kCases[] = {
+    {AV_PIX_FMT_NV12, "nv12_to_rgba"},
+    {AV_PIX_FMT_P010LE, "nv12_to_rgba"},
+    {AV_PIX_FMT_YUV420P, "yuv420p_to_rgba"},
+    {AV_PIX_FMT_YUV422P, "yuv420p_to_rgba"},
+    {AV_PIX_FMT_YUV444P, "yuv420p_to_rgba"},
+    {AV_PIX_FMT_YUV420P10LE, "yuv420p_to_rgba"},
+    {AV_PIX_FMT_YUV422P10LE, "yuv420p_to_rgba"},
+    {AV_PIX_FMT_YUV444P10LE, "yuv420p_to_rgba"},
+};
+
+// Shader colorSpace convention and the matching swscale table
+const struct
+{
+    int colorSpace;
+    int swsColorSpace;
+    const char* name;
+} kMatrices[] = {
+    {0, SWS_CS_ITU601, "bt601"},
+    {1, SWS_CS_ITU709, "bt709"},
+    {2, SWS_CS_BT2020, "bt2020"},
+};
+
+void storeCode(AVFrame* frame, const AVPixFmtDescriptor* desc, int c, int x, int y, uint32_t code)
+{
+    const AVComponentDescriptor& comp = desc->comp[c];
+    uint8_t* p = frame->data[comp.plane] + y * frame->linesize[comp.plane] + x * comp.step + comp.offset;
+    if (comp.depth > 8)
+    {
+        const uint16_t v = static_cast<uint16_t>(code << comp.shift);
+        std::memcpy(p, &v, sizeof(v));
+    }
+    else
+    {
+        *p = static_cast<uint8_t>(code);
+    }
+}
+
+// Luma detail over the whole code range plus smooth chroma, in source-depth codes
+void fillFrame(AVFrame* frame, const AVPixFmtDescriptor* desc)
+{
+    const int depth = desc->comp[0].depth;
+    const double maxCode = static_cast<double>((1 << depth) - 1);
+    const int chromaW = (kWidth + (1 << desc->log2_chroma_w) - 1) >> desc->log2_chroma_w;
+    const int chromaH = (kHeight + (1 << desc->log2_chroma_h) - 1) >> desc->log2_chroma_h;
+
+    for (int y = 0; y < kHeight; ++y)
+    {
+        for (int x = 0; x < kWidth; ++x)
+        {
+            const double ramp = static_cast<double>(x) / (kWidth - 1);
+            const double detail = ((x * 7 + y * 13) % 17) / 16.0 - 0.5;
+            const double luma = std::clamp(ramp + detail * 0.08, 0.0, 1.0);
+            storeCode(frame, desc, 0, x, y, static_cast<uint32_t>(std::lround(luma * maxCode)));
+        }
+    }
+    for (int y = 0; y < chromaH; ++y)
+    {
+        for (int x = 0; x < chromaW; ++x)
+        {
+            // Under half an 8-bit code per chroma sample
+            const double u = 0.35 + 0.3 * x / chromaW;
+            const double v = 0.65 - 0.3 * y / chromaH;
+            storeCode(frame, desc, 1, x, y, static_cast<uint32_t>(std::lround(u * maxCode)));
+            storeCode(frame, desc, 2, x, y, static_cast<uint32_t>(std::lround(v * maxCode)));
+        }
+    }
+}
+
+void imageBarrier(VkCommandBuffer cmd, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout,
+                  VkAccessFlags srcAccess, VkAccessFlags dstAccess, VkPipelineStageFlags srcStage,
+                  VkPipelineStageFlags dstStage)
+{
+    VkImageMemoryBarrier b{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+    b.oldLayout = oldLayout;
+    b.newLayout = newLayout;
+    b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    b.image = image;
+    b.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    b.subresourceRange.levelCount = 1;
+    b.subresourceRange.layerCount = 1;
+    b.srcAccessMask = srcAccess;
+    b.dstAccessMask = dstAccess;
+    vkCmdPipelineBarrier(cmd, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &b);
+}
+
+// Device-local plane image in SHADER_READ_ONLY_OPTIMAL, filled through a staging buffer
+struct Plane
+{
+    Engine2D* engine = nullptr;
+    VkImage image = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkImageView view = VK_NULL_HANDLE;
+
+    Plane(Engine2D* e, uint32_t width, uint32_t height, VkFormat format, const std::vector<uint8_t>& texels)
+        : engine(e)
+    {
+        VkDevice device = engine->logicalDevice;
+
+        VkImageCreateInfo ii{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+        ii.imageType = VK_IMAGE_TYPE_2D;
+        ii.format = format;
+        ii.extent = VkExtent3D{width, height, 1};
+        ii.mipLevels = 1;
+        ii.arrayLayers = 1;
+        ii.samples = VK_SAMPLE_COUNT_1_BIT;
+        ii.tiling = VK_IMAGE_TILING_OPTIMAL;
+        ii.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        ii.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        ii.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        if (vkCreateImage(device, &ii, nullptr, &image) != VK_SUCCESS)
+            throw std::runtime_error("yuv_convert_check: failed to create plane image");
+
+        VkMemoryRequirements mr{};
+        vkGetImageMemoryRequirements(device, image, &mr);
+        VkMemoryAllocateInfo ai{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+        ai.allocationSize = mr.size;
+        ai.memoryTypeIndex = engine->findMemoryType(mr.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        if (vkAllocateMemory(device, &ai, nullptr, &memory) != VK_SUCCESS)
+            throw std::runtime_error("yuv_convert_check: failed to allocate plane memory");
+        vkBindImageMemory(device, image, memory, 0);
+
+        VkImageViewCreateInfo vi{VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
+        vi.image = image;
+        vi.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        vi.format = format;
+        vi.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        vi.subresourceRange.levelCount = 1;
+        vi.subresourceRange.layerCount = 1;
+        if (vkCreateImageView(device, &vi, nullptr, &view) != VK_SUCCESS)
+            throw std::runtime_error("yuv_convert_check: failed to create plane view");
+
+        VkBuffer staging = VK_NULL_HANDLE;
+        VkDeviceMemory stagingMemory = VK_NULL_HANDLE;
+        engine->createBuffer(texels.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, staging,
+                             stagingMemory);
+        void* mapped = nullptr;
+        vkMapMemory(device, stagingMemory, 0, texels.size(), 0, &mapped);
+        std::memcpy(mapped, texels.data(), texels.size());
+        vkUnmapMemory(device, stagingMemory);
+
+        VkCommandBuffer cmd = engine->beginSingleTimeCommands();
+        imageBarrier(cmd, image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0,
+                     VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+        VkBufferImageCopy region{};
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = VkExtent3D{width, height, 1};
+        vkCmdCopyBufferToImage(cmd, staging, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+        imageBarrier(cmd, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                     VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                     VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+        engine->endSingleTimeCommands(cmd);
+
+        vkDestroyBuffer(device, staging, nullptr);
+        vkFreeMemory(device, stagingMemory, nullptr);
+    }
+
+    ~Plane()
+    {
+        VkDevice device = engine->logicalDevice;
+        vkDestroyImageView(device, view, nullptr);
+        vkDestroyImage(device, image, nullptr);
+        vkFreeMemory(device, memory, nullptr);
+    }
+
+    Plane(const Plane&) = delete;
+    Plane& operator=(const Plane&) = delete;
+};
+
+// One AVFrame plane as tightly packed texels, and the UNORM format DecoderVulkan views it with
+std::vector<uint8_t> planeTexels(const AVFrame* frame, const AVPixFmtDescriptor* desc, int plane, int width,
+                                 int height, VkFormat& format)
+{
+    const bool wide = desc->comp[0].depth > 8;
+    const bool interleaved = plane == 1 && desc->comp[1].plane == desc->comp[2].plane;
+    if (interleaved)
+        format = wide ? VK_FORMAT_R16G16_UNORM : VK_FORMAT_R8G8_UNORM;
+    else
+        format = wide ? VK_FORMAT_R16_UNORM : VK_FORMAT_R8_UNORM;
+
+    const size_t rowBytes = static_cast<size_t>(width) * (wide ? 2 : 1) * (interleaved ? 2 : 1);
+    std::vector<uint8_t> texels(rowBytes * height);
+    for (int y = 0; y < height; ++y)
+        std::memcpy(&texels[rowBytes * y], frame->data[plane] + y * frame->linesize[plane], rowBytes);
+    return texels;
+}
+
+// RGBA8 output of a pass (left in GENERAL by dispatch()) copied to host memory, width * 4 per row
+std::vector<uint8_t> readOutput(Engine2D* engine, const PresentInput& out)
+{
+    const VkDeviceSize size = static_cast<VkDeviceSize>(out.extent.width) * out.extent.height * 4u;
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    engine->createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, buffer, memory);
+
+    VkCommandBuffer cmd = engine->beginSingleTimeCommands();
+    imageBarrier(cmd, out.image, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_SHADER_WRITE_BIT,
+                 VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    VkBufferImageCopy region{};
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent = VkExtent3D{out.extent.width, out.extent.height, 1};
+    vkCmdCopyImageToBuffer(cmd, out.image, VK_IMAGE_LAYOUT_GENERAL, buffer, 1, &region);
+    engine->endSingleTimeCommands(cmd);
+
+    std::vector<uint8_t> pixels(static_cast<size_t>(size));
+    void* mapped = nullptr;
+    vkMapMemory(engine->logicalDevice, memory, 0, size, 0, &mapped);
+    std::memcpy(pixels.data(), mapped, pixels.size());
+    vkUnmapMemory(engine->logicalDevice, memory);
+    vkDestroyBuffer(engine->logicalDevice, buffer, nullptr);
+    vkFreeMemory(engine->logicalDevice, memory, nullptr);
+    return pixels;
+}
+
+// The frame through Nv12ToRgbaPass (2-plane) or Yuv420pToRgbaPass (3-plane), RGBA8 out
+std::vector<uint8_t> gpuConvert(Engine2D* engine, const AVFrame* frame, const AVPixFmtDescriptor* desc,
+                                int colorSpace, int colorRange, VkSampler sampler)
+{
+    const int chromaW = (kWidth + (1 << desc->log2_chroma_w) - 1) >> desc->log2_chroma_w;
+    const int chromaH = (kHeight + (1 << desc->log2_chroma_h) - 1) >> desc->log2_chroma_h;
+
+    YuvConversion conversion{};
+    conversion.colorSpace = static_cast<uint32_t>(colorSpace);
+    conversion.colorRange = static_cast<uint32_t>(colorRange);
+    conversion.bitDepth = static_cast<uint32_t>(desc->comp[0].depth);
+    conversion.sampleShift = static_cast<uint32_t>(desc->comp[0].shift);
+
+    const glm::ivec2 rgbaSize(kWidth, kHeight);
+    const glm::ivec2 uvSize(chromaW, chromaH);
+    const glm::ivec2 chromaShift(desc->log2_chroma_w, desc->log2_chroma_h);
+
+    VkFormat yFormat = VK_FORMAT_UNDEFINED;
+    const std::vector<uint8_t> yTexels = planeTexels(frame, desc, 0, kWidth, kHeight, yFormat);
+    const Plane yPlane(engine, kWidth, kHeight, yFormat, yTexels);
+
+    if (desc->comp[1].plane == desc->comp[2].plane)
+    {
+        VkFormat uvFormat = VK_FORMAT_UNDEFINED;
+        const std::vector<uint8_t> uvTexels = planeTexels(frame, desc, 1, chromaW, chromaH, uvFormat);
+        const Plane uvPlane(engine, chromaW, chromaH, uvFormat, uvTexels);
+
+        Nv12ToRgbaPass pass(engine, 1, kWidth, kHeight);
+        pass.initialize();
+        pass.setInputNV12(yPlane.view, uvPlane.view, sampler, sampler);
+        pass.pushConstants.rgbaSize = rgbaSize;
+        pass.pushConstants.uvSize = uvSize;
+        pass.pushConstants.chromaShift = chromaShift;
+        pass.conversion = conversion;
+
+        VkCommandBuffer cmd = engine->beginSingleTimeCommands();
+        pass.dispatch(cmd, 0);
+        engine->endSingleTimeCommands(cmd);
+        return readOutput(engine, pass.output(0));
+    }
+
+    VkFormat uFormat = VK_FORMAT_UNDEFINED, vFormat = VK_FORMAT_UNDEFINED;
+    const std::vector<uint8_t> uTexels = planeTexels(frame, desc, 1, chromaW, chromaH, uFormat);
+    const std::vector<uint8_t> vTexels = planeTexels(frame, desc, 2, chromaW, chromaH, vFormat);
+    const Plane uPlane(engine, chromaW, chromaH, uFormat, uTexels);
+    const Plane vPlane(engine, chromaW, chromaH, vFormat, vTexels);
+
+    Yuv420pToRgbaPass pass(engine, 1, kWidth, kHeight);
+    pass.initialize();
+    pass.setInputYUV420P(yPlane.view, uPlane.view, vPlane.view, sampler, sampler, sampler);
+    pass.pushConstants.rgbaSize = rgbaSize;
+    pass.pushConstants.uvSize = uvSize;
+    pass.pushConstants.chromaShift = chromaShift;
+    pass.conversion = conversion;
+
+    VkCommandBuffer cmd = engine->beginSingleTimeCommands();
+    pass.dispatch(cmd, 0);
+    engine->endSingleTimeCommands(cmd);
+    return readOutput(engine, pass.output(0));
+}
+
+struct CaseResult
+{
+    int maxError = 0;
+    double meanError = 0.0;
+};
+
+bool runCase(Engine2D* engine, VkSampler sampler, AVPixelFormat format, int colorSpace, int swsColorSpace,
+             int colorRange, CaseResult& result)
+{
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(format);
+    AVFrame* src = av_frame_alloc();
+    AVFrame* ref = av_frame_alloc();
+    if (!desc || !src || !ref)
+    {
+        av_frame_free(&src);
+        av_frame_free(&ref);
+        return false;
+    }
+
+    src->format = format;
+    src->width = kWidth;
+    src->height = kHeight;
+    ref->format = AV_PIX_FMT_RGBA;
+    ref->width = kWidth;
+    ref->height = kHeight;
+    SwsContext* sws = nullptr;
+    bool ok = av_frame_get_buffer(src, 32) >= 0 && av_frame_get_buffer(ref, 32) >= 0;
+    if (ok)
+    {
+        fillFrame(src, desc);
+        // Point chroma and full-resolution chroma interpolation, closest to the shaders' fetch
+        sws = sws_getContext(kWidth, kHeight, format, kWidth, kHeight, AV_PIX_FMT_RGBA,
+                             SWS_POINT | SWS_ACCURATE_RND | SWS_FULL_CHR_H_INT, nullptr, nullptr, nullptr);
+        ok = sws != nullptr;
+    }
+    if (ok)
+    {
+        const int* coefficients = sws_getCoefficients(swsColorSpace);
+        sws_setColorspaceDetails(sws, coefficients, colorRange, coefficients, 1, 0, 1 << 16, 1 << 16);
+        ok = sws_scale(sws, src->data, src->linesize, 0, kHeight, ref->data, ref->linesize) == kHeight;
+    }
+
+    if (ok)
+    {
+        std::vector<uint8_t> converted;
+        try
+        {
+            converted = gpuConvert(engine, src, desc, colorSpace, colorRange, sampler);
+        }
+        catch (...)
+        {
+            sws_freeContext(sws);
+            av_frame_free(&src);
+            av_frame_free(&ref);
+            throw;
+        }
+        int64_t sum = 0;
+        result = CaseResult{};
+        for (int y = 0; y < kHeight; ++y)
+        {
+            const uint8_t* row = ref->data[0] + y * ref->linesize[0];
+            const uint8_t* rgb = &converted[static_cast<size_t>(y) * kWidth * 4];
+            for (int x = 0; x < kWidth; ++x)
+            {
+                for (int i = 0; i < 3; ++i)
+                {
+                    const int error = std::abs(static_cast<int>(rgb[x * 4 + i]) - static_cast<int>(row[x * 4 + i]));
+                    result.maxError = std::max(result.maxError, error);
+                    sum += error;
+                }
+            }
+        }
+        result.meanError = static_cast<double>(sum) / (3.0 * kWidth * kHeight);
+    }
+
+    sws_freeContext(sws);
+    av_frame_free(&src);
+    av_frame_free(&ref);
+    return ok;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h")
+        {
+            std::cout << "Usage: yuv_convert_check\n";
+            return 0;
+        }
+    }
+
+    Engine2D engine;
+    if (!engine.initialize(false))
+    {
+        std::cerr << "yuv_convert_check: failed to initialise Vulkan" << std::endl;
+        return 1;
+    }
+
+    // The shaders texelFetch the planes; the sampler only completes the combined descriptors
+    VkSamplerCreateInfo si{VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
+    si.magFilter = VK_FILTER_NEAREST;
+    si.minFilter = VK_FILTER_NEAREST;
+    si.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    si.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    si.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    VkSampler sampler = VK_NULL_HANDLE;
+    if (vkCreateSampler(engine.logicalDevice, &si, nullptr, &sampler) != VK_SUCCESS)
+    {
+        std::cerr << "yuv_convert_check: failed to create sampler" << std::endl;
+        return 1;
+    }
+
+    std::cout << "YUV->RGBA converters on " << engine.getDeviceProperties().deviceName << " vs swscale (" << kWidth
+              << "x" << kHeight << ", RGBA8, tolerance " << kMaxErrorLsb << " LSB):\n";
+    std::cout << "   format          shader             matrix   range     max err   mean err\n";
+    std::cout << std::fixed << std::setprecision(3);
+
+    int failures = 0;
+    for (const Case& c : kCases)
+    {
+        for (const auto& matrix : kMatrices)
+        {
+            for (int colorRange = 0; colorRange <= 1; ++colorRange)
+            {
+                CaseResult result;
+                bool ran = false;
+                std::string error = "swscale failed";
+                try
+                {
+                    ran = runCase(&engine, sampler, c.format, matrix.colorSpace, matrix.swsColorSpace, colorRange,
+                                  result);
+                }
+                catch (const std::exception& e)
+                {
+                    error = e.what();
+                }
+                const bool pass = ran && result.maxError <= kMaxErrorLsb;
+                failures += pass ? 0 : 1;
+
+                std::cout << "   " << std::left << std::setw(16) << av_get_pix_fmt_name(c.format) << std::setw(19)
+                          << c.shader << std::setw(9) << matrix.name << std::setw(8)
+                          << (colorRange ? "full" : "limited") << std::right;
+                if (!ran)
+                {
+                    std::cout << "   " << error << "   FAIL\n";
+                    continue;
+                }
+                std::cout << std::setw(9) << result.maxError << std::setw(11) << result.meanError
+                          << (pass ? "   ok" : "   FAIL") << "\n";
+            }
+        }
+    }
+
+    vkDestroySampler(engine.logicalDevice, sampler, nullptr);
+    if (failures)
+    {
+        std::cout << "FAILED: " << failures << " case(s) over tolerance\n";
+        return 1;
+    }
+    std::cout << "All cases within tolerance\n";
+    return 0;
+}